@@ -0,0 +1,256 @@
+#include "Bench.h"
+
+#include "spdlog/fmt/fmt.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <ostream>
+#include <thread>
+
+#include <new>
+
+#include <unistd.h>
+
+namespace
+{
+std::atomic<uint64_t> allocation_count{0};
+}	 // namespace
+
+// counts every allocation of the process, the array and nothrow forms end up here as well
+void* operator new(std::size_t size)
+{
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	if (void* result = std::malloc(size != 0 ? size : 1))
+	{
+		return result;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+
+namespace rd
+{
+namespace bench
+{
+State::State(uint64_t iterations) : iterations_(iterations)
+{
+	resume_timing();
+}
+
+uint64_t State::iterations() const
+{
+	return iterations_;
+}
+
+void State::pause_timing()
+{
+	if (running)
+	{
+		elapsed += std::chrono::steady_clock::now() - started;
+		running = false;
+	}
+}
+
+void State::resume_timing()
+{
+	if (!running)
+	{
+		started = std::chrono::steady_clock::now();
+		running = true;
+	}
+}
+
+std::chrono::nanoseconds State::measured() const
+{
+	auto total = elapsed;
+	if (running)
+	{
+		total += std::chrono::steady_clock::now() - started;
+	}
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(total);
+}
+
+uint64_t allocations()
+{
+	return allocation_count.load(std::memory_order_relaxed);
+}
+
+void check_failed(char const* condition, char const* file, int line)
+{
+	std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, condition);
+	std::abort();
+}
+
+std::vector<Benchmark>& registry()
+{
+	static std::vector<Benchmark> benchmarks;
+	return benchmarks;
+}
+
+Registrar::Registrar(std::string name, body_t body, uint64_t fixed_iterations)
+{
+	registry().push_back(Benchmark{std::move(name), std::move(body), fixed_iterations});
+}
+
+double Result::median_ns_per_op() const
+{
+	std::vector<double> sorted = ns_per_op;
+	std::sort(sorted.begin(), sorted.end());
+	return sorted.empty() ? 0 : sorted[sorted.size() / 2];
+}
+
+namespace
+{
+State run_once(Benchmark const& benchmark, uint64_t iterations)
+{
+	State state(iterations);
+	benchmark.body(state);
+	state.pause_timing();
+	return state;
+}
+
+/**
+ * \brief Grows the iteration count until a run takes a tenth of the minimum time, then scales it to the whole.
+ */
+uint64_t calibrate(Benchmark const& benchmark, std::chrono::nanoseconds min_time)
+{
+	uint64_t iterations = 1;
+	while (true)
+	{
+		const auto measured = run_once(benchmark, iterations).measured();
+		if (measured >= min_time / 10 || iterations >= (uint64_t(1) << 32))
+		{
+			const double scale = static_cast<double>(min_time.count()) / (std::max)(measured.count(), int64_t(1));
+			return (std::max)(static_cast<uint64_t>(static_cast<double>(iterations) * scale), uint64_t(1));
+		}
+		iterations *= 10;
+	}
+}
+
+std::string escape(std::string const& value)
+{
+	std::string result;
+	for (const char c : value)
+	{
+		if (c == '"' || c == '\\')
+		{
+			result += '\\';
+		}
+		result += c;
+	}
+	return result;
+}
+}	 // namespace
+
+std::vector<Result> run(Options const& options)
+{
+	std::vector<Result> results;
+	for (auto const& benchmark : registry())
+	{
+		if (benchmark.name.find(options.filter) == std::string::npos)
+		{
+			continue;
+		}
+
+		Result result;
+		result.name = benchmark.name;
+		result.iterations = benchmark.fixed_iterations != 0 ? benchmark.fixed_iterations : calibrate(benchmark, options.min_time);
+
+		std::vector<std::pair<double, State>> runs;
+		for (size_t i = 0; i < (std::max)(options.repetitions, size_t(1)); ++i)
+		{
+			State state = run_once(benchmark, result.iterations);
+			const double ns = static_cast<double>(state.measured().count()) / static_cast<double>(result.iterations);
+			result.ns_per_op.push_back(ns);
+			runs.emplace_back(ns, std::move(state));
+		}
+		// the counters of the median run go with the median time
+		std::sort(runs.begin(), runs.end(), [](auto const& lhs, auto const& rhs) { return lhs.first < rhs.first; });
+		auto const& median = runs[runs.size() / 2].second;
+		result.bytes_processed = median.bytes_processed;
+		result.counters = median.counters;
+
+		std::string line = fmt::format("{:<48} {:>12.1f} ns/op {:>14.0f} op/s", result.name, result.median_ns_per_op(),
+			1e9 / result.median_ns_per_op());
+		if (result.bytes_processed != 0)
+		{
+			const double seconds = result.median_ns_per_op() * static_cast<double>(result.iterations) / 1e9;
+			line += fmt::format(" {:>10.1f} MB/s", static_cast<double>(result.bytes_processed) / seconds / 1e6);
+		}
+		for (auto const& counter : result.counters)
+		{
+			line += fmt::format(" {}={:.1f}", counter.first, counter.second);
+		}
+		std::fprintf(options.table, "%s\n", line.c_str());
+		std::fflush(options.table);
+
+		results.push_back(std::move(result));
+	}
+	return results;
+}
+
+void write_json(std::ostream& out, std::vector<Result> const& results, Options const& options)
+{
+	char host[256] = {};
+	gethostname(host, sizeof(host) - 1);
+	char date[32] = {};
+	const std::time_t now = std::time(nullptr);
+	std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+	out << "{\n";
+	out << "  \"context\": {\n";
+	out << fmt::format("    \"date\": \"{}\",\n", date);
+	out << fmt::format("    \"host\": \"{}\",\n", escape(host));
+	out << fmt::format("    \"cpus\": {},\n", std::thread::hardware_concurrency());
+	out << fmt::format("    \"compiler\": \"{}\",\n", escape(__VERSION__));
+#if defined(NDEBUG)
+	out << "    \"optimized\": true,\n";
+#else
+	out << "    \"optimized\": false,\n";
+#endif
+	out << fmt::format("    \"min_time_ms\": {},\n", options.min_time.count());
+	out << fmt::format("    \"repetitions\": {}\n", options.repetitions);
+	out << "  },\n";
+	out << "  \"benchmarks\": [";
+	for (size_t i = 0; i < results.size(); ++i)
+	{
+		auto const& result = results[i];
+		const double ns = result.median_ns_per_op();
+		const auto bounds = std::minmax_element(result.ns_per_op.begin(), result.ns_per_op.end());
+
+		out << (i == 0 ? "\n" : ",\n");
+		out << "    {\n";
+		out << fmt::format("      \"name\": \"{}\",\n", escape(result.name));
+		out << fmt::format("      \"iterations\": {},\n", result.iterations);
+		out << fmt::format("      \"ns_per_op\": {:.3f},\n", ns);
+		out << fmt::format("      \"ns_per_op_min\": {:.3f},\n", *bounds.first);
+		out << fmt::format("      \"ns_per_op_max\": {:.3f},\n", *bounds.second);
+		out << fmt::format("      \"ops_per_second\": {:.1f}", 1e9 / ns);
+		if (result.bytes_processed != 0)
+		{
+			const double seconds = ns * static_cast<double>(result.iterations) / 1e9;
+			out << fmt::format(",\n      \"bytes_per_second\": {:.1f}", static_cast<double>(result.bytes_processed) / seconds);
+		}
+		for (auto const& counter : result.counters)
+		{
+			out << fmt::format(",\n      \"{}\": {:.3f}", escape(counter.first), counter.second);
+		}
+		out << "\n    }";
+	}
+	out << "\n  ]\n";
+	out << "}\n";
+}
+}	 // namespace bench
+}	 // namespace rd
@@ -0,0 +1,136 @@
+#ifndef RD_CPP_BENCH_H
+#define RD_CPP_BENCH_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace rd
+{
+namespace bench
+{
+/**
+ * \brief What a benchmark body gets: the number of iterations to run and the means to report on them.
+ */
+class State
+{
+	uint64_t iterations_;
+	std::chrono::steady_clock::duration elapsed{};
+	std::chrono::steady_clock::time_point started{};
+	bool running = false;
+
+public:
+	uint64_t bytes_processed = 0;
+
+	/**
+	 * \brief Extra figures of the run, e.g. latency percentiles, reported as they are.
+	 */
+	std::map<std::string, double> counters;
+
+	explicit State(uint64_t iterations);
+
+	uint64_t iterations() const;
+
+	/**
+	 * \brief Excludes what follows from the measured time, e.g. setup inside the body.
+	 */
+	void pause_timing();
+
+	void resume_timing();
+
+	std::chrono::nanoseconds measured() const;
+};
+
+using body_t = std::function<void(State&)>;
+
+struct Benchmark
+{
+	std::string name;
+	body_t body;
+	/**
+	 * \brief Iterations of each run, or 0 to calibrate them to the minimum time.
+	 */
+	uint64_t fixed_iterations = 0;
+};
+
+std::vector<Benchmark>& registry();
+
+struct Registrar
+{
+	Registrar(std::string name, body_t body, uint64_t fixed_iterations = 0);
+};
+
+struct Options
+{
+	std::chrono::milliseconds min_time{500};
+	size_t repetitions = 3;
+	std::string filter;
+	std::string json_path;
+	/**
+	 * \brief Where a line per benchmark goes while they run.
+	 */
+	std::FILE* table = stdout;
+};
+
+struct Result
+{
+	std::string name;
+	uint64_t iterations = 0;
+	std::vector<double> ns_per_op;
+	uint64_t bytes_processed = 0;
+	std::map<std::string, double> counters;
+
+	double median_ns_per_op() const;
+};
+
+/**
+ * \brief Runs the registered benchmarks whose name contains [Options::filter], printing a line for each.
+ */
+std::vector<Result> run(Options const& options);
+
+/**
+ * \brief Writes [results] as JSON, together with the build and machine they were taken on.
+ */
+void write_json(std::ostream& out, std::vector<Result> const& results, Options const& options);
+
+/**
+ * \brief Heap allocations made so far by the whole process, through the global operator new.
+ */
+uint64_t allocations();
+
+/**
+ * \brief Reports a failed RD_BENCH_CHECK and aborts the run.
+ */
+[[noreturn]] void check_failed(char const* condition, char const* file, int line);
+
+/**
+ * \brief Keeps the compiler from dropping the computation of [value].
+ */
+template <typename T>
+inline void do_not_optimize(T const& value)
+{
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+}	 // namespace bench
+}	 // namespace rd
+
+#define RD_BENCH_CONCAT_IMPL(a, b) a##b
+#define RD_BENCH_CONCAT(a, b) RD_BENCH_CONCAT_IMPL(a, b)
+
+/**
+ * \brief Registers a benchmark: RD_BENCHMARK("group/name", [](State& state) { ... }) or with fixed iterations as a third
+ * argument.
+ */
+#define RD_BENCHMARK(...) static rd::bench::Registrar RD_BENCH_CONCAT(rd_bench_registrar_, __LINE__)(__VA_ARGS__)
+
+/**
+ * \brief Aborts the run when [condition] doesn't hold, for benchmarks that also check the behavior they measure.
+ */
+#define RD_BENCH_CHECK(condition) ((condition) ? (void) 0 : rd::bench::check_failed(#condition, __FILE__, __LINE__))
+
+#endif	  // RD_CPP_BENCH_H
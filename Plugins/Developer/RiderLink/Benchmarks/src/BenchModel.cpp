@@ -0,0 +1,242 @@
+#include "BenchModel.h"
+
+#include "std/to_string.h"
+#include "util/core_util.h"
+
+namespace rd
+{
+namespace bench
+{
+// region StringRange
+
+StringRange::StringRange(int32_t first_, int32_t last_) : first_(first_), last_(last_)
+{
+}
+
+StringRange StringRange::read(SerializationCtx& /*ctx*/, Buffer& buffer)
+{
+	auto first_ = buffer.read_integral<int32_t>();
+	auto last_ = buffer.read_integral<int32_t>();
+	return StringRange{first_, last_};
+}
+
+void StringRange::write(SerializationCtx& /*ctx*/, Buffer& buffer) const
+{
+	buffer.write_integral(first_);
+	buffer.write_integral(last_);
+}
+
+std::string StringRange::type_name() const
+{
+	return "StringRange";
+}
+
+std::string StringRange::static_type_name()
+{
+	return "StringRange";
+}
+
+std::string StringRange::toString() const
+{
+	return "StringRange(" + std::to_string(first_) + ", " + std::to_string(last_) + ")";
+}
+
+bool StringRange::equals(ISerializable const& object) const
+{
+	auto const& other = dynamic_cast<StringRange const&>(object);
+	return first_ == other.first_ && last_ == other.last_;
+}
+
+size_t StringRange::hashCode() const noexcept
+{
+	return static_cast<size_t>(first_) * 31 + static_cast<size_t>(last_);
+}
+
+// endregion
+
+// region LogMessageInfo
+
+LogMessageInfo::LogMessageInfo(int32_t type_, std::wstring category_, optional<DateTime> time_)
+	: type_(type_), category_(std::move(category_)), time_(std::move(time_))
+{
+}
+
+LogMessageInfo LogMessageInfo::read(SerializationCtx& /*ctx*/, Buffer& buffer)
+{
+	auto type_ = buffer.read_enum_ordinal();
+	auto category_ = buffer.read_wstring();
+	auto time_ = buffer.read_nullable<DateTime>([&buffer]() mutable { return buffer.read_date_time(); });
+	return LogMessageInfo{type_, std::move(category_), std::move(time_)};
+}
+
+void LogMessageInfo::write(SerializationCtx& /*ctx*/, Buffer& buffer) const
+{
+	buffer.write_enum_ordinal(type_);
+	buffer.write_wstring(category_);
+	buffer.write_nullable<DateTime>(time_, [&buffer](DateTime const& it) mutable -> void { buffer.write_date_time(it); });
+}
+
+std::string LogMessageInfo::type_name() const
+{
+	return "LogMessageInfo";
+}
+
+std::string LogMessageInfo::static_type_name()
+{
+	return "LogMessageInfo";
+}
+
+std::string LogMessageInfo::toString() const
+{
+	return "LogMessageInfo(" + std::to_string(type_) + ", " + to_string(category_) + ")";
+}
+
+bool LogMessageInfo::equals(ISerializable const& object) const
+{
+	auto const& other = dynamic_cast<LogMessageInfo const&>(object);
+	return type_ == other.type_ && category_ == other.category_ && time_ == other.time_;
+}
+
+size_t LogMessageInfo::hashCode() const noexcept
+{
+	size_t result = static_cast<size_t>(type_);
+	result = result * 31 + std::hash<std::wstring>()(category_);
+	result = result * 31 + (time_ ? rd::hash<DateTime>()(*time_) : 0);
+	return result;
+}
+
+// endregion
+
+// region UnrealLogEvent
+
+UnrealLogEvent::UnrealLogEvent(LogMessageInfo info_, std::wstring text_, std::vector<Wrapper<StringRange>> bpPathRanges_,
+	std::vector<Wrapper<StringRange>> methodRanges_)
+	: info_(std::move(info_))
+	, text_(std::move(text_))
+	, bpPathRanges_(std::move(bpPathRanges_))
+	, methodRanges_(std::move(methodRanges_))
+{
+}
+
+UnrealLogEvent UnrealLogEvent::read(SerializationCtx& ctx, Buffer& buffer)
+{
+	auto info_ = LogMessageInfo::read(ctx, buffer);
+	auto text_ = buffer.read_wstring();
+	auto bpPathRanges_ = buffer.read_array<std::vector, StringRange>(
+		[&ctx, &buffer]() mutable { return wrapper::make_wrapper<StringRange>(StringRange::read(ctx, buffer)); });
+	auto methodRanges_ = buffer.read_array<std::vector, StringRange>(
+		[&ctx, &buffer]() mutable { return wrapper::make_wrapper<StringRange>(StringRange::read(ctx, buffer)); });
+	return UnrealLogEvent{std::move(info_), std::move(text_), std::move(bpPathRanges_), std::move(methodRanges_)};
+}
+
+void UnrealLogEvent::write(SerializationCtx& ctx, Buffer& buffer) const
+{
+	info_.write(ctx, buffer);
+	buffer.write_wstring(text_);
+	buffer.write_array<std::vector, StringRange>(
+		bpPathRanges_, [&ctx, &buffer](StringRange const& it) mutable -> void { it.write(ctx, buffer); });
+	buffer.write_array<std::vector, StringRange>(
+		methodRanges_, [&ctx, &buffer](StringRange const& it) mutable -> void { it.write(ctx, buffer); });
+}
+
+std::string UnrealLogEvent::type_name() const
+{
+	return "UnrealLogEvent";
+}
+
+std::string UnrealLogEvent::static_type_name()
+{
+	return "UnrealLogEvent";
+}
+
+std::string UnrealLogEvent::toString() const
+{
+	return "UnrealLogEvent(" + info_.toString() + ", " + to_string(text_) + ")";
+}
+
+bool UnrealLogEvent::equals(ISerializable const& object) const
+{
+	auto const& other = dynamic_cast<UnrealLogEvent const&>(object);
+	return info_.equals(other.info_) && text_ == other.text_ && bpPathRanges_ == other.bpPathRanges_ &&
+		   methodRanges_ == other.methodRanges_;
+}
+
+size_t UnrealLogEvent::hashCode() const noexcept
+{
+	size_t result = info_.hashCode();
+	result = result * 31 + std::hash<std::wstring>()(text_);
+	for (auto const& it : bpPathRanges_)
+	{
+		result = result * 31 + it->hashCode();
+	}
+	for (auto const& it : methodRanges_)
+	{
+		result = result * 31 + it->hashCode();
+	}
+	return result;
+}
+
+// endregion
+
+// region IScriptMsg
+
+Wrapper<IScriptMsg> IScriptMsg::readUnknownInstance(
+	SerializationCtx& /*ctx*/, Buffer& buffer, RdId const& /*unknownId*/, int32_t size)
+{
+	// every type of the benchmarks is registered, an unknown one is skipped
+	buffer.set_position(buffer.get_position() + static_cast<size_t>(size));
+	return {};
+}
+
+std::string IScriptMsg::type_name() const
+{
+	return "IScriptMsg";
+}
+
+std::string IScriptMsg::static_type_name()
+{
+	return "IScriptMsg";
+}
+
+ScriptMsgException::ScriptMsgException(std::wstring message_) : message_(std::move(message_))
+{
+}
+
+ScriptMsgException ScriptMsgException::read(SerializationCtx& /*ctx*/, Buffer& buffer)
+{
+	return ScriptMsgException{buffer.read_wstring()};
+}
+
+void ScriptMsgException::write(SerializationCtx& /*ctx*/, Buffer& buffer) const
+{
+	buffer.write_wstring(message_);
+}
+
+std::string ScriptMsgException::type_name() const
+{
+	return "ScriptMsgException";
+}
+
+std::string ScriptMsgException::static_type_name()
+{
+	return "ScriptMsgException";
+}
+
+std::string ScriptMsgException::toString() const
+{
+	return "ScriptMsgException(" + to_string(message_) + ")";
+}
+
+bool ScriptMsgException::equals(ISerializable const& object) const
+{
+	return message_ == dynamic_cast<ScriptMsgException const&>(object).message_;
+}
+
+size_t ScriptMsgException::hashCode() const noexcept
+{
+	return std::hash<std::wstring>()(message_);
+}
+
+// endregion
+}	 // namespace bench
+}	 // namespace rd
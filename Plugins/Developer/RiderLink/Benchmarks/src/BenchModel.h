@@ -0,0 +1,132 @@
+#ifndef RD_CPP_BENCHMODEL_H
+#define RD_CPP_BENCHMODEL_H
+
+#include "protocol/Buffer.h"
+#include "serialization/ISerializable.h"
+#include "serialization/SerializationCtx.h"
+#include "types/DateTime.h"
+#include "types/wrapper.h"
+
+#include <string>
+#include <vector>
+
+namespace rd
+{
+namespace bench
+{
+/**
+ * \brief Stand-ins for the pregenerated UE4Library data classes, which need Unreal's FString and TArray. Fields and
+ * wire layout follow StringRange, LogMessageInfo, UnrealLogEvent and the IScriptMsg hierarchy, with std::wstring and
+ * std::vector in place of the Unreal containers.
+ */
+class StringRange : public IPolymorphicSerializable
+{
+	int32_t first_;
+	int32_t last_;
+
+public:
+	StringRange(int32_t first_, int32_t last_);
+
+	static StringRange read(SerializationCtx& ctx, Buffer& buffer);
+
+	void write(SerializationCtx& ctx, Buffer& buffer) const override;
+
+	std::string type_name() const override;
+
+	static std::string static_type_name();
+
+	std::string toString() const override;
+
+	bool equals(ISerializable const& object) const override;
+
+	size_t hashCode() const noexcept override;
+};
+
+class LogMessageInfo : public IPolymorphicSerializable
+{
+	int32_t type_;
+	std::wstring category_;
+	optional<DateTime> time_;
+
+public:
+	LogMessageInfo(int32_t type_, std::wstring category_, optional<DateTime> time_);
+
+	static LogMessageInfo read(SerializationCtx& ctx, Buffer& buffer);
+
+	void write(SerializationCtx& ctx, Buffer& buffer) const override;
+
+	std::string type_name() const override;
+
+	static std::string static_type_name();
+
+	std::string toString() const override;
+
+	bool equals(ISerializable const& object) const override;
+
+	size_t hashCode() const noexcept override;
+};
+
+class UnrealLogEvent : public IPolymorphicSerializable
+{
+	LogMessageInfo info_;
+	std::wstring text_;
+	std::vector<Wrapper<StringRange>> bpPathRanges_;
+	std::vector<Wrapper<StringRange>> methodRanges_;
+
+public:
+	UnrealLogEvent(LogMessageInfo info_, std::wstring text_, std::vector<Wrapper<StringRange>> bpPathRanges_,
+		std::vector<Wrapper<StringRange>> methodRanges_);
+
+	static UnrealLogEvent read(SerializationCtx& ctx, Buffer& buffer);
+
+	void write(SerializationCtx& ctx, Buffer& buffer) const override;
+
+	std::string type_name() const override;
+
+	static std::string static_type_name();
+
+	std::string toString() const override;
+
+	bool equals(ISerializable const& object) const override;
+
+	size_t hashCode() const noexcept override;
+};
+
+/**
+ * \brief Abstract base read through the Serializers registry, as fields of an open type are.
+ */
+class IScriptMsg : public IPolymorphicSerializable
+{
+public:
+	static Wrapper<IScriptMsg> readUnknownInstance(SerializationCtx& ctx, Buffer& buffer, RdId const& unknownId, int32_t size);
+
+	std::string type_name() const override;
+
+	static std::string static_type_name();
+};
+
+class ScriptMsgException final : public IScriptMsg
+{
+	std::wstring message_;
+
+public:
+	explicit ScriptMsgException(std::wstring message_);
+
+	static ScriptMsgException read(SerializationCtx& ctx, Buffer& buffer);
+
+	void write(SerializationCtx& ctx, Buffer& buffer) const override;
+
+	std::string type_name() const override;
+
+	static std::string static_type_name();
+
+	std::string toString() const override;
+
+	bool equals(ISerializable const& object) const override;
+
+	size_t hashCode() const noexcept override;
+};
+}	 // namespace bench
+}	 // namespace rd
+
+#endif	  // RD_CPP_BENCHMODEL_H
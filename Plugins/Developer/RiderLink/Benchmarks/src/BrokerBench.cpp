@@ -0,0 +1,225 @@
+#include "Bench.h"
+
+#include "base/RdReactiveBase.h"
+#include "lifetime/LifetimeDefinition.h"
+#include "protocol/MessageBroker.h"
+#include "scheduler/SingleThreadScheduler.h"
+#include "scheduler/SynchronousScheduler.h"
+#include "scheduler/WorkStealingScheduler.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace rd;
+using rd::bench::State;
+
+namespace
+{
+// subscriptions in the broker, as many as a small model binds
+constexpr int64_t ENTITIES = 512;
+
+class Subscriber final : public RdReactiveBase
+{
+	IScheduler* scheduler;
+
+public:
+	mutable std::atomic<uint64_t> received{0};
+
+	Subscriber(IScheduler* scheduler, int64_t id) : scheduler(scheduler)
+	{
+		set_id(RdId(id));
+	}
+
+	IScheduler* get_wire_scheduler() const override
+	{
+		return scheduler;
+	}
+
+	void on_wire_received(Buffer /*buffer*/) const override
+	{
+		received.fetch_add(1, std::memory_order_release);
+	}
+};
+
+Buffer message()
+{
+	Buffer buffer(16);
+	buffer.write_integral<int16_t>(0);
+	buffer.write_integral<int64_t>(42);
+	return Buffer(std::move(buffer).getRealArray());
+}
+
+/**
+ * \brief Messages dispatched from this thread to subscribers whose wire scheduler is [wire_scheduler], or the broker's
+ * own scheduler if it is null.
+ */
+void dispatch(State& state, IScheduler* wire_scheduler)
+{
+	state.pause_timing();
+	SynchronousScheduler default_scheduler;
+	LifetimeDefinition definition(false);
+	MessageBroker broker(&default_scheduler);
+	std::vector<std::unique_ptr<Subscriber>> subscribers;
+	default_scheduler.queue([&] {
+		for (int64_t id = 1; id <= ENTITIES; ++id)
+		{
+			subscribers.push_back(std::make_unique<Subscriber>(wire_scheduler != nullptr ? wire_scheduler : &default_scheduler, id));
+			broker.advise_on(definition.lifetime, subscribers.back().get());
+		}
+	});
+	state.resume_timing();
+
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		broker.dispatch(RdId(static_cast<int64_t>(i % ENTITIES) + 1), message());
+	}
+	for (int64_t id = 0; id < ENTITIES; ++id)
+	{
+		const uint64_t expected = state.iterations() / ENTITIES + (static_cast<uint64_t>(id) < state.iterations() % ENTITIES ? 1 : 0);
+		while (subscribers[id]->received.load(std::memory_order_acquire) < expected)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	state.pause_timing();
+	definition.terminate();
+}
+
+/**
+ * \brief Runs the queued actions only when flushed, on the flushing thread, so a test can hold them back.
+ */
+class ManualScheduler final : public IScheduler
+{
+	std::deque<util::unique_function<void()>> actions;
+
+public:
+	void queue(util::unique_function<void()> action) override
+	{
+		actions.push_back(std::move(action));
+	}
+
+	void flush() override
+	{
+		while (!actions.empty())
+		{
+			auto action = std::move(actions.front());
+			actions.pop_front();
+			action();
+		}
+	}
+
+	bool is_active() const override
+	{
+		return true;
+	}
+};
+
+/**
+ * \brief Records the sequence numbers it receives.
+ */
+class OrderedSubscriber final : public RdReactiveBase
+{
+	IScheduler* scheduler;
+
+public:
+	mutable std::vector<int64_t> received;
+
+	OrderedSubscriber(IScheduler* scheduler, int64_t id) : scheduler(scheduler)
+	{
+		set_id(RdId(id));
+	}
+
+	IScheduler* get_wire_scheduler() const override
+	{
+		return scheduler;
+	}
+
+	void on_wire_received(Buffer buffer) const override
+	{
+		received.push_back(buffer.read_integral<int64_t>());
+	}
+};
+
+Buffer numbered_message(int64_t seqn)
+{
+	Buffer buffer(16);
+	buffer.write_integral<int16_t>(0);
+	buffer.write_integral<int64_t>(seqn);
+	return Buffer(std::move(buffer).getRealArray());
+}
+
+/**
+ * \brief Messages that arrive before their entity is advised, then more while it is advised on a wire scheduler, then
+ * the entity is advised again on the broker's own scheduler before the queue is delivered. Checks that every message
+ * reaches the last subscription, in order.
+ */
+void switch_scheduler(State& state)
+{
+	constexpr int64_t ID = 1;
+	constexpr int64_t QUEUED = 32;
+	constexpr int64_t HELD_BACK = 32;
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		ManualScheduler default_scheduler;
+		SynchronousScheduler wire_scheduler;
+		LifetimeDefinition definition(false);
+		MessageBroker broker(&default_scheduler);
+		OrderedSubscriber on_wire_scheduler(&wire_scheduler, ID);
+		OrderedSubscriber on_default_scheduler(&default_scheduler, ID);
+
+		int64_t seqn = 0;
+		while (seqn < QUEUED)
+		{
+			broker.dispatch(RdId(ID), numbered_message(seqn++));
+		}
+		broker.advise_on(definition.lifetime, &on_wire_scheduler);
+		while (seqn < QUEUED + HELD_BACK)
+		{
+			broker.dispatch(RdId(ID), numbered_message(seqn++));
+		}
+		broker.advise_on(definition.lifetime, &on_default_scheduler);
+		default_scheduler.flush();
+
+		RD_BENCH_CHECK(on_wire_scheduler.received.empty());
+		RD_BENCH_CHECK(on_default_scheduler.received.size() == QUEUED + HELD_BACK);
+		for (int64_t k = 0; k < QUEUED + HELD_BACK; ++k)
+		{
+			RD_BENCH_CHECK(on_default_scheduler.received[k] == k);
+		}
+		definition.terminate();
+	}
+}
+
+void dispatch_to_scheduler_thread(State& state)
+{
+	state.pause_timing();
+	LifetimeDefinition definition(false);
+	// the scheduler registers a logger under its name, which must not be taken yet
+	static int runs = 0;
+	SingleThreadScheduler scheduler(definition.lifetime, "BenchWireScheduler" + std::to_string(runs++));
+	state.resume_timing();
+	dispatch(state, &scheduler);
+	definition.terminate();
+}
+
+void dispatch_to_worker_threads(State& state)
+{
+	state.pause_timing();
+	LifetimeDefinition definition(false);
+	static int runs = 0;
+	WorkStealingScheduler scheduler(definition.lifetime, "BenchWorkStealingScheduler" + std::to_string(runs++));
+	state.resume_timing();
+	dispatch(state, &scheduler);
+	definition.terminate();
+}
+}	 // namespace
+
+RD_BENCHMARK("messagebroker/dispatch/default_scheduler", [](State& state) { dispatch(state, nullptr); });
+RD_BENCHMARK("messagebroker/dispatch/wire_scheduler", dispatch_to_scheduler_thread);
+RD_BENCHMARK("messagebroker/dispatch/work_stealing_scheduler", dispatch_to_worker_threads);
+RD_BENCHMARK("messagebroker/switch_scheduler", switch_scheduler);
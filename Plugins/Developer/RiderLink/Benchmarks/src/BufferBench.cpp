@@ -0,0 +1,211 @@
+#include "Bench.h"
+
+#include "protocol/Buffer.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using rd::Buffer;
+using rd::WireFormat;
+using rd::bench::State;
+using rd::bench::do_not_optimize;
+
+namespace
+{
+// values per pass over the buffer, so that it stays in cache and does not grow
+constexpr uint64_t BATCH = 1024;
+
+template <typename T>
+void write_integral(State& state)
+{
+	Buffer buffer(BATCH * sizeof(T));
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		if (i % BATCH == 0)
+		{
+			buffer.rewind();
+		}
+		buffer.write_integral<T>(static_cast<T>(i));
+	}
+	do_not_optimize(buffer);
+	state.bytes_processed = state.iterations() * sizeof(T);
+}
+
+template <typename T>
+void read_integral(State& state)
+{
+	Buffer buffer(BATCH * sizeof(T));
+	for (uint64_t i = 0; i < BATCH; ++i)
+	{
+		buffer.write_integral<T>(static_cast<T>(i));
+	}
+	T sum = 0;
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		if (i % BATCH == 0)
+		{
+			buffer.rewind();
+		}
+		sum += buffer.read_integral<T>();
+	}
+	do_not_optimize(sum);
+	state.bytes_processed = state.iterations() * sizeof(T);
+}
+
+void write_varint(State& state)
+{
+	Buffer buffer(BATCH * 10);
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		if (i % BATCH == 0)
+		{
+			buffer.rewind();
+		}
+		// ids and lengths are mostly small
+		buffer.write_varint(i % 20000);
+	}
+	do_not_optimize(buffer);
+}
+
+void read_varint(State& state)
+{
+	Buffer buffer(BATCH * 10);
+	for (uint64_t i = 0; i < BATCH; ++i)
+	{
+		buffer.write_varint(i % 20000);
+	}
+	uint64_t sum = 0;
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		if (i % BATCH == 0)
+		{
+			buffer.rewind();
+		}
+		sum += buffer.read_varint();
+	}
+	do_not_optimize(sum);
+}
+
+std::wstring sample_string(size_t length)
+{
+	std::wstring result;
+	const std::wstring text = L"LogSlash: Warning: Enemy_C_12 took 10 damage from Sword_BP ";
+	while (result.size() < length)
+	{
+		result += text;
+	}
+	result.resize(length);
+	return result;
+}
+
+void write_wstring(State& state, size_t length)
+{
+	const std::wstring value = sample_string(length);
+	const uint64_t batch = (std::max)(BATCH / length, uint64_t(1));
+	Buffer buffer(batch * (length * 2 + 4));
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		if (i % batch == 0)
+		{
+			buffer.rewind();
+		}
+		buffer.write_wstring(value);
+	}
+	do_not_optimize(buffer);
+	state.bytes_processed = state.iterations() * (length * 2 + 4);
+}
+
+void read_wstring(State& state, size_t length)
+{
+	const std::wstring value = sample_string(length);
+	const uint64_t batch = (std::max)(BATCH / length, uint64_t(1));
+	Buffer buffer(batch * (length * 2 + 4));
+	for (uint64_t i = 0; i < batch; ++i)
+	{
+		buffer.write_wstring(value);
+	}
+	size_t total = 0;
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		if (i % batch == 0)
+		{
+			buffer.rewind();
+		}
+		total += buffer.read_wstring().size();
+	}
+	do_not_optimize(total);
+	state.bytes_processed = state.iterations() * (length * 2 + 4);
+}
+std::vector<uint16_t> char16_round_trip(std::vector<uint16_t> const& units)
+{
+	Buffer buffer;
+	buffer.set_format(WireFormat::V2);
+	buffer.write_char16_string(units.data(), units.size());
+	buffer.rewind();
+	uint16_t* chars = buffer.read_char16_string();
+	std::vector<uint16_t> result(chars, std::char_traits<char16_t>::length(reinterpret_cast<char16_t*>(chars)) + chars);
+	delete[] chars;
+	return result;
+}
+
+std::wstring utf8_read(Buffer::ByteArray const& bytes)
+{
+	Buffer buffer;
+	buffer.set_format(WireFormat::V2);
+	buffer.write_length(static_cast<int32_t>(bytes.size()));
+	buffer.write_byte_array_raw(bytes);
+	buffer.rewind();
+	return buffer.read_wstring();
+}
+
+/**
+ * Checks that V2 strings survive malformed UTF-16 and UTF-8 by replacing it with U+FFFD, then measures the round trip of
+ * text with two-, three- and four-byte sequences.
+ */
+void utf8_round_trip(State& state)
+{
+	constexpr uint16_t R = 0xFFFD;
+	RD_BENCH_CHECK((char16_round_trip({'a', 0xD83D, 0xDE00, 'b'}) == std::vector<uint16_t>{'a', 0xD83D, 0xDE00, 'b'}));
+	RD_BENCH_CHECK((char16_round_trip({'a', 0xD800, 'b'}) == std::vector<uint16_t>{'a', R, 'b'}));
+	RD_BENCH_CHECK((char16_round_trip({0xDC00, 0xD800}) == std::vector<uint16_t>{R, R}));
+	RD_BENCH_CHECK((char16_round_trip({'x', 0xD83D}) == std::vector<uint16_t>{'x', R}));
+	// truncated three-byte sequence, stray continuation, overlong NUL, encoded surrogate, beyond U+10FFFF
+	RD_BENCH_CHECK(utf8_read({0xE2, 0x82, 'b', 0x80, 0xC0, 0x80, 0xED, 0xA0, 0x80, 0xF4, 0x90, 0x80, 0x80}) ==
+				   std::wstring({wchar_t(R), L'b', wchar_t(R), wchar_t(R), wchar_t(R), wchar_t(R), wchar_t(R)}));
+	RD_BENCH_CHECK(utf8_read({0xF0, 0x9F, 0x98, 0x80}) == (sizeof(wchar_t) == 2 ? std::wstring(L"\xD83D\xDE00") : std::wstring(1, wchar_t(0x1F600))));
+
+	std::wstring value = sample_string(64);
+	value += sizeof(wchar_t) == 2 ? std::wstring(L"\xD83D\xDE00") : std::wstring(1, wchar_t(0x1F600));
+	value += L"caf\xE9 \x20AC";
+	value += sizeof(wchar_t) == 2 ? std::wstring(1, wchar_t(0xD800)) : std::wstring(1, wchar_t(0xDC00));
+	std::wstring expected = value;
+	expected.back() = wchar_t(R);
+
+	Buffer buffer(4 * value.size() + 4);
+	buffer.set_format(WireFormat::V2);
+	size_t total = 0;
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		buffer.rewind();
+		buffer.write_wstring(value);
+		buffer.rewind();
+		std::wstring result = buffer.read_wstring();
+		RD_BENCH_CHECK(result == expected);
+		total += result.size();
+	}
+	do_not_optimize(total);
+}
+}	 // namespace
+
+RD_BENCHMARK("buffer/write_integral/int32", write_integral<int32_t>);
+RD_BENCHMARK("buffer/read_integral/int32", read_integral<int32_t>);
+RD_BENCHMARK("buffer/write_integral/int64", write_integral<int64_t>);
+RD_BENCHMARK("buffer/read_integral/int64", read_integral<int64_t>);
+RD_BENCHMARK("buffer/write_varint", write_varint);
+RD_BENCHMARK("buffer/read_varint", read_varint);
+RD_BENCHMARK("buffer/write_wstring/16", [](State& state) { write_wstring(state, 16); });
+RD_BENCHMARK("buffer/read_wstring/16", [](State& state) { read_wstring(state, 16); });
+RD_BENCHMARK("buffer/write_wstring/256", [](State& state) { write_wstring(state, 256); });
+RD_BENCHMARK("buffer/read_wstring/256", [](State& state) { read_wstring(state, 256); });
+RD_BENCHMARK("buffer/utf8_round_trip", utf8_round_trip);
@@ -0,0 +1,33 @@
+#include "DirectWire.h"
+
+#include "util/core_util.h"
+
+namespace rd
+{
+DirectWire::DirectWire(IScheduler* scheduler) : WireBase(scheduler)
+{
+}
+
+std::pair<std::shared_ptr<DirectWire>, std::shared_ptr<DirectWire>> DirectWire::create_pair(
+	IScheduler* first_scheduler, IScheduler* second_scheduler)
+{
+	auto first = std::make_shared<DirectWire>(first_scheduler);
+	auto second = std::make_shared<DirectWire>(second_scheduler);
+	first->counterpart = second.get();
+	second->counterpart = first.get();
+	first->connected.set(true);
+	second->connected.set(true);
+	return {std::move(first), std::move(second)};
+}
+
+void DirectWire::send(RdId const& rd_id, std::function<void(Buffer& buffer)> writer) const
+{
+	RD_ASSERT_MSG(!rd_id.isNull(), "DirectWire: id mustn't be null");
+
+	// what SocketWire dispatches once the length and the id are read: the context placeholder and the payload
+	Buffer buffer;
+	buffer.write_integral<int16_t>(0);
+	writer(buffer);
+	counterpart->message_broker.dispatch(rd_id, Buffer(std::move(buffer).getRealArray()));
+}
+}	 // namespace rd
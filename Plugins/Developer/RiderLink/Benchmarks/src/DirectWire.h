@@ -0,0 +1,36 @@
+#ifndef RD_CPP_DIRECTWIRE_H
+#define RD_CPP_DIRECTWIRE_H
+
+#include "base/WireBase.h"
+
+#include <memory>
+#include <utility>
+
+namespace rd
+{
+/**
+ * \brief In-process wire that hands each message to its counterpart's broker on the sending thread, without sockets or
+ * framing. Two Protocols on a DirectWire pair measure the framework alone.
+ */
+class DirectWire final : public WireBase
+{
+	DirectWire const* counterpart = nullptr;
+
+public:
+	// region ctor/dtor
+
+	explicit DirectWire(IScheduler* scheduler);
+
+	// endregion
+
+	/**
+	 * \brief Creates two connected wires; messages sent on one are dispatched on the other with its [scheduler].
+	 */
+	static std::pair<std::shared_ptr<DirectWire>, std::shared_ptr<DirectWire>> create_pair(
+		IScheduler* first_scheduler, IScheduler* second_scheduler);
+
+	void send(RdId const& rd_id, std::function<void(Buffer& buffer)> writer) const override;
+};
+}	 // namespace rd
+
+#endif	  // RD_CPP_DIRECTWIRE_H
@@ -0,0 +1,114 @@
+#include "Bench.h"
+
+#include "util/logging.h"
+
+#include "spdlog/sinks/basic_file_sink.h"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+using namespace rd;
+using rd::bench::State;
+
+namespace
+{
+// what a reactive entity formats for a trace line, built whether or not the line is written
+std::string logmsg(uint64_t i)
+{
+	return " map 42:: ver = " + std::to_string(i) + ", key = " + std::to_string(i * 7) + ", value = <some long value string>";
+}
+
+/**
+ * \brief The pre-macro call sites: a registry lookup under its mutex and the message built before the level check.
+ */
+void spdlog_get_eager(State& state)
+{
+	util::send_logger();
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		spdlog::get("logSend")->trace("SEND{}", logmsg(i));
+	}
+}
+
+// the benchmarks build RD without trace statements, these two compare the trace level compiled in and out
+#undef RD_LOG_ACTIVE_LEVEL
+#define RD_LOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+
+void rd_log_runtime_disabled(State& state)
+{
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		RD_LOG_TRACE(util::send_logger(), "SEND{}", logmsg(i));
+	}
+}
+
+#undef RD_LOG_ACTIVE_LEVEL
+#define RD_LOG_ACTIVE_LEVEL SPDLOG_LEVEL_INFO
+
+void rd_log_compiled_out(State& state)
+{
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		RD_LOG_TRACE(util::send_logger(), "SEND{}", logmsg(i));
+	}
+}
+
+std::string log_path(char const* kind)
+{
+	return "/tmp/rd_bench_" + std::string(kind) + "_" + std::to_string(getpid()) + ".log";
+}
+
+// lines logged back to back before the logging thread goes idle, as a busy editor session does
+constexpr uint64_t BURST = 1000;
+
+/**
+ * \brief Caller-side cost of an enabled trace line written to a file, directly or through an AsyncSink. With [bursts]
+ * the logging thread pauses untimed after every [BURST] lines, which gives the AsyncSink's worker time to drain.
+ */
+void file_sink(State& state, bool async, bool bursts)
+{
+	state.pause_timing();
+	const std::string path = log_path(async ? "async" : "sync");
+	std::shared_ptr<util::AsyncSink> async_sink;
+	std::shared_ptr<spdlog::sinks::sink> sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(path, true);
+	if (async)
+	{
+		async_sink = std::make_shared<util::AsyncSink>(sink);
+		sink = async_sink;
+	}
+	spdlog::logger logger("bench", sink);
+	logger.set_level(spdlog::level::trace);
+	state.resume_timing();
+
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		logger.trace("SEND{}", logmsg(i));
+		if (bursts && i % BURST == BURST - 1)
+		{
+			state.pause_timing();
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+			state.resume_timing();
+		}
+	}
+
+	state.pause_timing();
+	logger.flush();
+	if (async_sink)
+	{
+		state.counters["dropped_pct"] = 100.0 * async_sink->get_dropped() / state.iterations();
+	}
+	std::remove(path.c_str());
+}
+}	 // namespace
+
+RD_BENCHMARK("logging/disabled/spdlog_get_eager", spdlog_get_eager);
+RD_BENCHMARK("logging/disabled/rd_log_trace", rd_log_runtime_disabled);
+RD_BENCHMARK("logging/disabled/compiled_out", rd_log_compiled_out);
+RD_BENCHMARK("logging/enabled/sync_file_sink", [](State& state) { file_sink(state, false, false); });
+RD_BENCHMARK("logging/enabled/async_sink", [](State& state) { file_sink(state, true, false); });
+RD_BENCHMARK("logging/enabled/sync_file_sink/bursts", [](State& state) { file_sink(state, false, true); }, 200 * BURST);
+RD_BENCHMARK("logging/enabled/async_sink/bursts", [](State& state) { file_sink(state, true, true); }, 200 * BURST);
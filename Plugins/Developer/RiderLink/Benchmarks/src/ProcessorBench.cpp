@@ -0,0 +1,95 @@
+#include "Bench.h"
+
+#include "wire/ByteBufferAsyncProcessor.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace rd;
+using rd::bench::State;
+
+namespace
+{
+// a small message, so the cost is in handing packets over rather than copying them
+constexpr size_t PACKET_SIZE = 32;
+
+/**
+ * \brief [producers] threads put packets into one ByteBufferAsyncProcessor at once, as the game and editor threads do
+ * into a SocketWire, while a sender that writes nowhere takes them and an acknowledger releases them every 200 us.
+ * Measures until every packet has been sent; put_ns is the time a producer spends per put of its own.
+ */
+void contended_put(State& state, size_t producers)
+{
+	state.pause_timing();
+	std::atomic<uint64_t> sent{0};
+	ByteBufferAsyncProcessor processor("BenchProcessor",
+		[&sent](ByteBufferAsyncProcessor::packet_iterator first, ByteBufferAsyncProcessor::packet_iterator last, sequence_number_t) {
+			const size_t count = static_cast<size_t>(last - first);
+			sent.fetch_add(count, std::memory_order_release);
+			return count;
+		});
+	processor.start();
+
+	std::atomic<bool> acknowledging{true};
+	std::thread acknowledger([&] {
+		uint64_t acknowledged = 0;
+		while (acknowledging.load(std::memory_order_acquire))
+		{
+			const uint64_t current = sent.load(std::memory_order_acquire);
+			if (current > acknowledged)
+			{
+				processor.acknowledge(static_cast<int64_t>(current));
+				acknowledged = current;
+			}
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+		}
+	});
+
+	const uint64_t per_producer = state.iterations() / producers;
+	const uint64_t total = per_producer * producers;
+	std::atomic<bool> go{false};
+	std::atomic<uint64_t> put_ns{0};
+	std::vector<std::thread> threads;
+	for (size_t p = 0; p < producers; ++p)
+	{
+		threads.emplace_back([&] {
+			while (!go.load(std::memory_order_acquire))
+			{
+				std::this_thread::yield();
+			}
+			const auto start = std::chrono::steady_clock::now();
+			for (uint64_t i = 0; i < per_producer; ++i)
+			{
+				processor.put(OutgoingPacket{Buffer::ByteArray(PACKET_SIZE)});
+			}
+			put_ns.fetch_add(static_cast<uint64_t>(
+				std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
+		});
+	}
+	state.resume_timing();
+
+	go.store(true, std::memory_order_release);
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+	while (sent.load(std::memory_order_acquire) < total)
+	{
+		std::this_thread::yield();
+	}
+
+	state.pause_timing();
+	acknowledging.store(false, std::memory_order_release);
+	acknowledger.join();
+	processor.terminate(std::chrono::milliseconds(1000));
+	state.bytes_processed = total * PACKET_SIZE;
+	state.counters["put_ns"] = static_cast<double>(put_ns.load()) / static_cast<double>(total);
+	state.counters["blocked_puts"] = static_cast<double>(processor.get_window_stats().blocked_puts);
+}
+}	 // namespace
+
+RD_BENCHMARK("processor/put/1_producer", [](State& state) { contended_put(state, 1); });
+RD_BENCHMARK("processor/put/4_producers", [](State& state) { contended_put(state, 4); });
+RD_BENCHMARK("processor/put/16_producers", [](State& state) { contended_put(state, 16); });
@@ -0,0 +1,143 @@
+#include "Bench.h"
+#include "DirectWire.h"
+
+#include "impl/RdMap.h"
+#include "lifetime/LifetimeDefinition.h"
+#include "protocol/Protocol.h"
+#include "reactive/base/SignalX.h"
+#include "scheduler/SynchronousScheduler.h"
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace rd;
+using rd::bench::State;
+using rd::bench::do_not_optimize;
+
+namespace
+{
+void signal_fire(State& state, size_t subscribers)
+{
+	LifetimeDefinition definition(false);
+	Signal<int64_t> signal;
+	int64_t sum = 0;
+	for (size_t i = 0; i < subscribers; ++i)
+	{
+		signal.advise(definition.lifetime, [&sum](int64_t const& value) { sum += value; });
+	}
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		signal.fire(static_cast<int64_t>(i));
+	}
+	do_not_optimize(sum);
+	state.counters["deliveries_per_second"] =
+		static_cast<double>(state.iterations() * subscribers) / (static_cast<double>(state.measured().count()) / 1e9);
+}
+
+void signal_fire_batch(State& state, size_t subscribers)
+{
+	constexpr uint64_t BATCH = 64;
+	LifetimeDefinition definition(false);
+	Signal<int64_t> signal;
+	int64_t sum = 0;
+	for (size_t i = 0; i < subscribers; ++i)
+	{
+		signal.advise(definition.lifetime, [&sum](int64_t const& value) { sum += value; });
+	}
+	std::vector<int64_t> values(BATCH);
+	for (uint64_t i = 0; i < state.iterations(); i += BATCH)
+	{
+		values[0] = static_cast<int64_t>(i);
+		signal.fire_batch(values.data(), (std::min)(BATCH, state.iterations() - i));
+	}
+	do_not_optimize(sum);
+	state.counters["deliveries_per_second"] =
+		static_cast<double>(state.iterations() * subscribers) / (static_cast<double>(state.measured().count()) / 1e9);
+}
+
+/**
+ * \brief A signal with [subscribers] listeners for good, and one more per iteration that sees a single value and is
+ * gone, as views of a property come and go.
+ */
+void signal_churn(State& state, size_t subscribers)
+{
+	LifetimeDefinition definition(false);
+	Signal<int64_t> signal;
+	int64_t sum = 0;
+	for (size_t i = 0; i < subscribers; ++i)
+	{
+		signal.advise(definition.lifetime, [&sum](int64_t const& value) { sum += value; });
+	}
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		LifetimeDefinition nested(definition.lifetime);
+		signal.advise(nested.lifetime, [&sum](int64_t const& value) { sum -= value; });
+		signal.fire(static_cast<int64_t>(i));
+		nested.terminate();
+	}
+	do_not_optimize(sum);
+}
+
+/**
+ * \brief A master map on one Protocol and its counterpart on another, connected by a DirectWire pair. Every put
+ * travels to the counterpart and its acknowledgement comes back before set returns.
+ */
+struct MapFixture
+{
+	LifetimeDefinition definition{false};
+	SynchronousScheduler scheduler;
+	std::pair<std::shared_ptr<DirectWire>, std::shared_ptr<DirectWire>> wires =
+		DirectWire::create_pair(&scheduler, &scheduler);
+	Protocol server{Identities::SERVER, &scheduler, wires.first, definition.lifetime};
+	Protocol client{Identities::CLIENT, &scheduler, wires.second, definition.lifetime};
+	RdMap<int32_t, std::wstring> master;
+	RdMap<int32_t, std::wstring> slave;
+
+	MapFixture()
+	{
+		master.is_master = true;
+		statics(master, 1);
+		statics(slave, 1);
+		scheduler.queue([this] {
+			master.bind(definition.lifetime, &server, "map");
+			slave.bind(definition.lifetime, &client, "map");
+		});
+	}
+
+	~MapFixture()
+	{
+		// unbinds the maps while they are still alive
+		definition.terminate();
+	}
+};
+
+void map_put_ack(State& state, int32_t keys)
+{
+	state.pause_timing();
+	MapFixture fixture;
+	const std::wstring value = L"/Game/Blueprints/BP_Enemy.BP_Enemy_C";
+	state.resume_timing();
+
+	fixture.scheduler.queue([&] {
+		for (uint64_t i = 0; i < state.iterations(); ++i)
+		{
+			fixture.master.set(static_cast<int32_t>(i % static_cast<uint64_t>(keys)), value + std::to_wstring(i));
+		}
+	});
+
+	state.pause_timing();
+	do_not_optimize(fixture.slave.size());
+}
+}	 // namespace
+
+RD_BENCHMARK("signal/fire/1", [](State& state) { signal_fire(state, 1); });
+RD_BENCHMARK("signal/fire/16", [](State& state) { signal_fire(state, 16); });
+RD_BENCHMARK("signal/fire/256", [](State& state) { signal_fire(state, 256); });
+RD_BENCHMARK("signal/fire_batch/16", [](State& state) { signal_fire_batch(state, 16); });
+RD_BENCHMARK("signal/fire_batch/256", [](State& state) { signal_fire_batch(state, 256); });
+RD_BENCHMARK("signal/churn/16", [](State& state) { signal_churn(state, 16); });
+// a put of a new key and an update of a present one differ in the event fired on both sides
+RD_BENCHMARK("rdmap/put_ack/new_keys", [](State& state) { map_put_ack(state, (std::numeric_limits<int32_t>::max)()); });
+RD_BENCHMARK("rdmap/put_ack/update", [](State& state) { map_put_ack(state, 64); });
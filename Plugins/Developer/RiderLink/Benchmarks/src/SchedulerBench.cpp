@@ -0,0 +1,167 @@
+#include "Bench.h"
+
+#include "lifetime/LifetimeDefinition.h"
+#include "scheduler/SingleThreadScheduler.h"
+#include "scheduler/SynchronousScheduler.h"
+#include "scheduler/WorkStealingScheduler.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+
+using namespace rd;
+using rd::bench::State;
+
+namespace
+{
+// what a typical closure captures: a few pointers and ids, the size of a Buffer
+using Payload = std::array<uint64_t, 5>;
+
+void report_allocations(State& state, uint64_t allocations_before)
+{
+	state.counters["allocs/op"] = static_cast<double>(bench::allocations() - allocations_before) / static_cast<double>(state.iterations());
+}
+
+void queue_small(State& state)
+{
+	SynchronousScheduler scheduler;
+	uint64_t sum = 0;
+	const uint64_t allocations_before = bench::allocations();
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		scheduler.queue([&sum] { ++sum; });
+	}
+	report_allocations(state, allocations_before);
+	bench::do_not_optimize(sum);
+}
+
+void queue_large(State& state)
+{
+	SynchronousScheduler scheduler;
+	uint64_t sum = 0;
+	const uint64_t allocations_before = bench::allocations();
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		Payload payload{i, i + 1, i + 2, i + 3, i + 4};
+		scheduler.queue([&sum, payload] { sum += payload[4]; });
+	}
+	report_allocations(state, allocations_before);
+	bench::do_not_optimize(sum);
+}
+
+void queue_move_only(State& state)
+{
+	SynchronousScheduler scheduler;
+	uint64_t sum = 0;
+	const uint64_t allocations_before = bench::allocations();
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		auto payload = std::make_unique<Payload>();
+		(*payload)[0] = i;
+		scheduler.queue([&sum, payload = std::move(payload)] { sum += (*payload)[0]; });
+	}
+	// the payload itself is one of them
+	report_allocations(state, allocations_before);
+	bench::do_not_optimize(sum);
+}
+
+void queue_to_scheduler_thread(State& state)
+{
+	state.pause_timing();
+	LifetimeDefinition definition(false);
+	// the scheduler registers a logger under its name, which must not be taken yet
+	static int runs = 0;
+	SingleThreadScheduler scheduler(definition.lifetime, "BenchQueueScheduler" + std::to_string(runs++));
+	std::atomic<uint64_t> sum{0};
+	state.resume_timing();
+
+	const uint64_t allocations_before = bench::allocations();
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		Payload payload{i, i + 1, i + 2, i + 3, i + 4};
+		scheduler.queue([&sum, payload] { sum.fetch_add(payload[4], std::memory_order_relaxed); });
+	}
+	scheduler.flush();
+	report_allocations(state, allocations_before);
+
+	state.pause_timing();
+	definition.terminate();
+}
+
+void queue_and_flush(State& state)
+{
+	state.pause_timing();
+	LifetimeDefinition definition(false);
+	static int runs = 0;
+	SingleThreadScheduler scheduler(definition.lifetime, "BenchFlushScheduler" + std::to_string(runs++));
+	uint64_t sum = 0;
+	state.resume_timing();
+
+	// the thread sleeps between the actions, so each one wakes it up and the flush waits for it
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		scheduler.queue([&sum] { ++sum; });
+		scheduler.flush();
+	}
+
+	state.pause_timing();
+	bench::do_not_optimize(sum);
+	definition.terminate();
+}
+
+// what a CPU-heavy handler does with a message, e.g. scanning a log line
+uint64_t crunch(uint64_t seed)
+{
+	uint64_t hash = seed;
+	for (int i = 0; i < 2048; ++i)
+	{
+		hash = (hash ^ static_cast<uint64_t>(i)) * 0x100000001B3ull;
+	}
+	return hash;
+}
+
+void cpu_bound(State& state, IScheduler& scheduler)
+{
+	std::atomic<uint64_t> sum{0};
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		scheduler.queue([&sum, i] { sum.fetch_add(crunch(i), std::memory_order_relaxed); });
+	}
+	scheduler.flush();
+	bench::do_not_optimize(sum);
+}
+
+void cpu_bound_on_scheduler_thread(State& state)
+{
+	state.pause_timing();
+	LifetimeDefinition definition(false);
+	static int runs = 0;
+	SingleThreadScheduler scheduler(definition.lifetime, "BenchCpuScheduler" + std::to_string(runs++));
+	state.resume_timing();
+	cpu_bound(state, scheduler);
+	state.pause_timing();
+	definition.terminate();
+}
+
+void cpu_bound_on_worker_threads(State& state)
+{
+	state.pause_timing();
+	LifetimeDefinition definition(false);
+	static int runs = 0;
+	WorkStealingScheduler scheduler(definition.lifetime, "BenchCpuWorkStealingScheduler" + std::to_string(runs++));
+	state.counters["workers"] = static_cast<double>(scheduler.get_worker_count());
+	state.resume_timing();
+	cpu_bound(state, scheduler);
+	state.pause_timing();
+	definition.terminate();
+}
+}	 // namespace
+
+RD_BENCHMARK("scheduler/queue/synchronous/small_capture", queue_small);
+RD_BENCHMARK("scheduler/queue/synchronous/large_capture", queue_large);
+RD_BENCHMARK("scheduler/queue/synchronous/move_only_capture", queue_move_only);
+RD_BENCHMARK("scheduler/queue/single_thread", queue_to_scheduler_thread);
+RD_BENCHMARK("scheduler/queue_flush/single_thread", queue_and_flush);
+RD_BENCHMARK("scheduler/cpu_bound/single_thread", cpu_bound_on_scheduler_thread);
+RD_BENCHMARK("scheduler/cpu_bound/work_stealing", cpu_bound_on_worker_threads);
@@ -0,0 +1,120 @@
+#include "Bench.h"
+#include "BenchModel.h"
+
+#include "serialization/Polymorphic.h"
+#include "serialization/Serializers.h"
+
+using namespace rd;
+using rd::bench::State;
+using rd::bench::do_not_optimize;
+
+namespace
+{
+constexpr uint64_t BATCH = 64;
+
+struct SerializationFixture
+{
+	Serializers serializers;
+	SerializationCtx ctx{&serializers};
+
+	SerializationFixture()
+	{
+		serializers.registry<bench::ScriptMsgException>();
+	}
+};
+
+bench::UnrealLogEvent sample_log_event()
+{
+	const std::wstring text = L"LogBlueprintUserMessages: [BP_Enemy_C_12] /Game/Blueprints/BP_Enemy.BP_Enemy:TakeDamage took 10 damage";
+	return bench::UnrealLogEvent{bench::LogMessageInfo{5, L"LogBlueprintUserMessages", DateTime(1700000000)}, text,
+		{wrapper::make_wrapper<bench::StringRange>(27, 58)}, {wrapper::make_wrapper<bench::StringRange>(59, 69)}};
+}
+
+void write_log_event(State& state)
+{
+	SerializationFixture fixture;
+	const auto event = sample_log_event();
+	Buffer buffer;
+	size_t bytes = 0;
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		if (i % BATCH == 0)
+		{
+			bytes += buffer.get_position();
+			buffer.rewind();
+		}
+		Polymorphic<bench::UnrealLogEvent>::write(fixture.ctx, buffer, event);
+	}
+	do_not_optimize(buffer);
+	state.bytes_processed = bytes + buffer.get_position();
+}
+
+void read_log_event(State& state)
+{
+	SerializationFixture fixture;
+	const auto event = sample_log_event();
+	Buffer buffer;
+	for (uint64_t i = 0; i < BATCH; ++i)
+	{
+		Polymorphic<bench::UnrealLogEvent>::write(fixture.ctx, buffer, event);
+	}
+	const size_t batch_bytes = buffer.get_position();
+	size_t hash = 0;
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		if (i % BATCH == 0)
+		{
+			buffer.rewind();
+		}
+		// a field of a data class is read by its static type, as RdSignal<UnrealLogEvent> does
+		auto value = Polymorphic<bench::UnrealLogEvent>::read(fixture.ctx, buffer);
+		hash += value.hashCode();
+	}
+	do_not_optimize(hash);
+	state.bytes_processed = state.iterations() * batch_bytes / BATCH;
+}
+
+void write_script_msg(State& state)
+{
+	SerializationFixture fixture;
+	const Wrapper<bench::IScriptMsg> message = wrapper::make_wrapper<bench::ScriptMsgException>(L"Accessed None trying to read Target");
+	Buffer buffer;
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		if (i % BATCH == 0)
+		{
+			buffer.rewind();
+		}
+		fixture.serializers.writePolymorphic(fixture.ctx, buffer, message);
+	}
+	do_not_optimize(buffer);
+}
+
+void read_script_msg(State& state)
+{
+	SerializationFixture fixture;
+	const Wrapper<bench::IScriptMsg> message = wrapper::make_wrapper<bench::ScriptMsgException>(L"Accessed None trying to read Target");
+	Buffer buffer;
+	for (uint64_t i = 0; i < BATCH; ++i)
+	{
+		fixture.serializers.writePolymorphic(fixture.ctx, buffer, message);
+	}
+	size_t hash = 0;
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		if (i % BATCH == 0)
+		{
+			buffer.rewind();
+		}
+		// through the registry by the type id, as a field of an abstract type is read
+		auto value = fixture.serializers.readPolymorphic<bench::IScriptMsg>(fixture.ctx, buffer);
+		hash += value->hashCode();
+	}
+	do_not_optimize(hash);
+}
+}	 // namespace
+
+RD_BENCHMARK("serialization/write/UnrealLogEvent", write_log_event);
+RD_BENCHMARK("serialization/read/UnrealLogEvent", read_log_event);
+RD_BENCHMARK("serialization/write_polymorphic/IScriptMsg", write_script_msg);
+RD_BENCHMARK("serialization/read_polymorphic/IScriptMsg", read_script_msg);
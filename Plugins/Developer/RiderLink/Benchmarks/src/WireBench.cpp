@@ -0,0 +1,444 @@
+#include "Bench.h"
+#include "BenchModel.h"
+#include "DirectWire.h"
+
+#include "base/RdReactiveBase.h"
+#include "lifetime/LifetimeDefinition.h"
+#include "scheduler/SynchronousScheduler.h"
+#include "serialization/Polymorphic.h"
+#include "serialization/Serializers.h"
+#include "wire/ShmWire.h"
+#include "wire/SocketWire.h"
+#include "wire/WireUtil.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace rd;
+using rd::bench::State;
+
+namespace
+{
+constexpr int64_t PING_ID = 1;
+constexpr int64_t PONG_ID = 2;
+
+/**
+ * \brief Counts the messages for its id and passes them to [handler] on the wire's receiving thread.
+ */
+class Receiver final : public RdReactiveBase
+{
+	IScheduler* scheduler;
+
+public:
+	mutable std::atomic<uint64_t> received{0};
+	std::function<void(Buffer&)> handler;
+
+	Receiver(IScheduler* scheduler, int64_t id) : scheduler(scheduler)
+	{
+		set_id(RdId(id));
+	}
+
+	IScheduler* get_wire_scheduler() const override
+	{
+		return scheduler;
+	}
+
+	void on_wire_received(Buffer buffer) const override
+	{
+		if (handler)
+		{
+			handler(buffer);
+		}
+		received.fetch_add(1, std::memory_order_release);
+	}
+};
+
+void wait_for(std::atomic<uint64_t> const& counter, uint64_t value)
+{
+	while (counter.load(std::memory_order_acquire) < value)
+	{
+		std::this_thread::yield();
+	}
+}
+
+/**
+ * \brief A SocketWire Server and a Client connected over loopback, with message bodies in [format] once negotiated.
+ */
+struct SocketFixture
+{
+	LifetimeDefinition definition{false};
+	SynchronousScheduler scheduler;
+	std::unique_ptr<SocketWire::Server> server;
+	std::unique_ptr<SocketWire::Client> client;
+
+	explicit SocketFixture(WireFormat format = WireFormat::V1)
+	{
+		server = std::make_unique<SocketWire::Server>(definition.lifetime, &scheduler, 0, "BenchServer");
+		server->set_preferred_format(format);
+		client = std::make_unique<SocketWire::Client>(definition.lifetime, &scheduler, server->port, "BenchClient");
+		client->set_preferred_format(format);
+		while (!server->connected.get() || !client->connected.get() || client->get_format() != format ||
+			   server->get_format() != format)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	~SocketFixture()
+	{
+		definition.terminate();
+	}
+};
+
+void socket_throughput(State& state, size_t size)
+{
+	state.pause_timing();
+	SynchronousScheduler receiver_scheduler;
+	Receiver receiver(&receiver_scheduler, PING_ID);
+	SocketFixture fixture;
+	fixture.server->advise(fixture.definition.lifetime, &receiver);
+	const Buffer::ByteArray payload(size, 0x5A);
+	state.resume_timing();
+
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		fixture.client->send(RdId(PING_ID), [&payload](Buffer& buffer) { buffer.write_byte_array_raw(payload); });
+	}
+	wait_for(receiver.received, state.iterations());
+
+	state.pause_timing();
+	state.bytes_processed = state.iterations() * size;
+}
+
+/**
+ * \brief Round trips of a [size] byte message that the server sends straight back from its receiving thread.
+ */
+void socket_latency(State& state, size_t size)
+{
+	state.pause_timing();
+	SynchronousScheduler receiver_scheduler;
+	Receiver ping(&receiver_scheduler, PING_ID);
+	Receiver pong(&receiver_scheduler, PONG_ID);
+	SocketFixture fixture;
+	ping.handler = [&fixture](Buffer& buffer) {
+		auto bytes = buffer.getArray();
+		fixture.server->send(RdId(PONG_ID), [&bytes](Buffer& reply) { reply.write_byte_array_raw(bytes); });
+	};
+	fixture.server->advise(fixture.definition.lifetime, &ping);
+	fixture.client->advise(fixture.definition.lifetime, &pong);
+	const Buffer::ByteArray payload(size, 0x5A);
+	std::vector<double> round_trips;
+	round_trips.reserve(state.iterations());
+	state.resume_timing();
+
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		fixture.client->send(RdId(PING_ID), [&payload](Buffer& buffer) { buffer.write_byte_array_raw(payload); });
+		wait_for(pong.received, i + 1);
+		round_trips.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	state.pause_timing();
+	std::sort(round_trips.begin(), round_trips.end());
+	state.counters["p50_us"] = round_trips[round_trips.size() / 2];
+	state.counters["p99_us"] = round_trips[round_trips.size() * 99 / 100];
+	state.counters["max_us"] = round_trips.back();
+}
+
+/**
+ * \brief The receiving side alone: a plain socket writes prebuilt V1 packages of one [size] byte message each to a
+ * SocketWire Server as fast as the kernel takes them, and the server parses and dispatches them.
+ */
+void socket_receive(State& state, size_t size)
+{
+	state.pause_timing();
+	SynchronousScheduler receiver_scheduler;
+	Receiver receiver(&receiver_scheduler, PING_ID);
+	LifetimeDefinition definition(false);
+	SynchronousScheduler scheduler;
+	auto server = std::make_unique<SocketWire::Server>(definition.lifetime, &scheduler, 0, "BenchServer");
+	server->advise(definition.lifetime, &receiver);
+
+	const int fd = socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in address{};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(server->port);
+	inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+	RD_BENCH_CHECK(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+
+	// a package is [length][seqn] followed by one message [length][id][context][payload]
+	const size_t message_size = 4 + 8 + 2 + size;
+	const size_t package_size = 4 + 8 + message_size;
+	std::vector<uint8_t> stream(package_size * state.iterations());
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		uint8_t* package = stream.data() + i * package_size;
+		const int32_t package_length = static_cast<int32_t>(message_size);
+		const int64_t seqn = static_cast<int64_t>(i) + 1;
+		const int32_t message_length = static_cast<int32_t>(message_size - 4);
+		const int64_t id = PING_ID;
+		std::memcpy(package, &package_length, 4);
+		std::memcpy(package + 4, &seqn, 8);
+		std::memcpy(package + 12, &message_length, 4);
+		std::memcpy(package + 16, &id, 8);
+	}
+	// the server acknowledges every package, nobody reads those
+	std::thread drain([fd] {
+		char acks[65536];
+		while (recv(fd, acks, sizeof(acks), 0) > 0)
+		{
+		}
+	});
+	state.resume_timing();
+
+	for (size_t offset = 0; offset < stream.size();)
+	{
+		const ssize_t written = send(fd, stream.data() + offset, stream.size() - offset, 0);
+		RD_BENCH_CHECK(written > 0);
+		offset += static_cast<size_t>(written);
+	}
+	wait_for(receiver.received, state.iterations());
+
+	state.pause_timing();
+	const auto stats = server->get_receive_stats();
+	state.bytes_processed = state.iterations() * size;
+	state.counters["copied_pct"] = stats.bytes != 0 ? 100.0 * stats.copied_bytes / stats.bytes : 0.0;
+	shutdown(fd, SHUT_RDWR);
+	definition.terminate();
+	drain.join();
+	close(fd);
+}
+
+/**
+ * \brief Transport between the editor and a separate process in the cross-process benchmarks.
+ */
+enum class Transport
+{
+	Socket,
+	Shm
+};
+
+std::unique_ptr<IWire> make_wire(
+	Transport transport, bool server, Lifetime lifetime, IScheduler* scheduler, uint16_t port, std::string const& name)
+{
+	if (transport == Transport::Shm)
+	{
+		if (server)
+		{
+			return std::make_unique<ShmWire::Server>(lifetime, scheduler, name);
+		}
+		return std::make_unique<ShmWire::Client>(lifetime, scheduler, name);
+	}
+	if (server)
+	{
+		return std::make_unique<SocketWire::Server>(lifetime, scheduler, port);
+	}
+	return std::make_unique<SocketWire::Client>(lifetime, scheduler, port);
+}
+
+/**
+ * \brief The forked counterpart: takes [count] pings and echoes each of them with [round_trip], or answers the last one
+ * only otherwise. Never returns; its exit status tells whether all pings arrived within a minute.
+ */
+[[noreturn]] void run_counterpart(Transport transport, uint16_t port, std::string const& name, uint64_t count, bool round_trip)
+{
+	LifetimeDefinition definition(false);
+	SynchronousScheduler scheduler;
+	const auto wire = make_wire(transport, false, definition.lifetime, &scheduler, port, name);
+	Receiver ping(&scheduler, PING_ID);
+	ping.handler = [&](Buffer& buffer) {
+		if (round_trip)
+		{
+			auto bytes = buffer.getArray();
+			wire->send(RdId(PONG_ID), [&bytes](Buffer& reply) { reply.write_byte_array_raw(bytes); });
+		}
+		else if (ping.received.load() + 1 == count)
+		{
+			wire->send(RdId(PONG_ID), [](Buffer& reply) { reply.write_bool(true); });
+		}
+	};
+	wire->advise(definition.lifetime, &ping);
+
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::minutes(1);
+	while (ping.received.load(std::memory_order_acquire) < count && std::chrono::steady_clock::now() < deadline)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	// lets the last reply leave before the connection goes
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	definition.terminate();
+	_exit(ping.received.load() == count ? 0 : 1);
+}
+
+/**
+ * \brief [size] byte messages to a forked process over [transport]: round trips that the counterpart echoes with
+ * [round_trip], or a one-way stream that the counterpart confirms once it has read all of it.
+ */
+void cross_process(State& state, Transport transport, size_t size, bool round_trip)
+{
+	state.pause_timing();
+	const uint64_t count = state.iterations();
+	const uint16_t port = transport == Transport::Socket ? util::find_free_port() : 0;
+	const std::string name = "/rd-bench-" + std::to_string(getpid());
+	const pid_t child = fork();
+	RD_BENCH_CHECK(child >= 0);
+	if (child == 0)
+	{
+		run_counterpart(transport, port, name, count, round_trip);
+	}
+
+	LifetimeDefinition definition(false);
+	SynchronousScheduler scheduler;
+	const auto wire = make_wire(transport, true, definition.lifetime, &scheduler, port, name);
+	Receiver pong(&scheduler, PONG_ID);
+	wire->advise(definition.lifetime, &pong);
+	while (!wire->connected.get())
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	const Buffer::ByteArray payload(size, 0x5A);
+	std::vector<double> round_trips;
+	round_trips.reserve(round_trip ? count : 0);
+	state.resume_timing();
+
+	for (uint64_t i = 0; i < count; ++i)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		wire->send(RdId(PING_ID), [&payload](Buffer& buffer) { buffer.write_byte_array_raw(payload); });
+		if (round_trip)
+		{
+			wait_for(pong.received, i + 1);
+			round_trips.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+		}
+	}
+	if (!round_trip)
+	{
+		wait_for(pong.received, 1);
+	}
+
+	state.pause_timing();
+	int status = 0;
+	waitpid(child, &status, 0);
+	RD_BENCH_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+	definition.terminate();
+	state.bytes_processed = count * size;
+	if (round_trip)
+	{
+		std::sort(round_trips.begin(), round_trips.end());
+		state.counters["p50_us"] = round_trips[round_trips.size() / 2];
+		state.counters["p99_us"] = round_trips[round_trips.size() * 99 / 100];
+	}
+}
+
+/**
+ * \brief Bytes on the wire for a representative editor session in [format]: log events, property and map updates and
+ * signals with short strings in equal parts. Reported per message, so the formats compare.
+ */
+void socket_session(State& state, WireFormat format)
+{
+	state.pause_timing();
+	Serializers serializers;
+	SerializationCtx ctx{&serializers};
+	SynchronousScheduler receiver_scheduler;
+	Receiver receiver(&receiver_scheduler, PING_ID);
+	SocketFixture fixture(format);
+	fixture.server->advise(fixture.definition.lifetime, &receiver);
+	const auto bytes_before = fixture.client->get_send_stats().bytes;
+	state.resume_timing();
+
+	size_t body_bytes = 0;
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		fixture.client->send(RdId(PING_ID), [&ctx, &body_bytes, i](Buffer& buffer) {
+			const size_t start = buffer.get_position();
+			switch (i % 4)
+			{
+				case 0:
+				{
+					const bench::UnrealLogEvent event{
+						bench::LogMessageInfo{static_cast<int32_t>(i % 7), L"LogSlash", DateTime(1700000000 + i)},
+						L"LogSlash: Warning: Enemy_C_" + std::to_wstring(i % 100) + L" took 10 damage from Sword_BP",
+						{wrapper::make_wrapper<bench::StringRange>(19, 31)}, {}};
+					Polymorphic<bench::UnrealLogEvent>::write(ctx, buffer, event);
+					break;
+				}
+				case 1:
+					// property update: version, value
+					buffer.write_integral<int64_t>(static_cast<int64_t>(i));
+					buffer.write_integral<int32_t>(static_cast<int32_t>(i % 3));
+					break;
+				case 2:
+					// map put: header, version, key, value
+					buffer.write_integral<int32_t>(1);
+					buffer.write_integral<int64_t>(static_cast<int64_t>(i));
+					buffer.write_wstring(L"BP_Enemy_C_" + std::to_wstring(i % 50));
+					buffer.write_integral<int32_t>(100);
+					break;
+				default:
+					// signal with a short argument
+					buffer.write_wstring(std::wstring(L"Play"));
+					buffer.write_bool(i % 2 == 0);
+					break;
+			}
+			body_bytes += buffer.get_position() - start;
+		});
+	}
+	wait_for(receiver.received, state.iterations());
+
+	state.pause_timing();
+	const auto wire_bytes = fixture.client->get_send_stats().bytes - bytes_before;
+	state.bytes_processed = wire_bytes;
+	state.counters["wire_bytes_per_msg"] = static_cast<double>(wire_bytes) / state.iterations();
+	state.counters["body_bytes_per_msg"] = static_cast<double>(body_bytes) / state.iterations();
+}
+
+/**
+ * \brief The cost of a message without the transport: framing into a Buffer and the broker's dispatch.
+ */
+void direct_send(State& state, size_t size)
+{
+	SynchronousScheduler scheduler;
+	LifetimeDefinition definition(false);
+	Receiver receiver(&scheduler, PING_ID);
+	auto wires = DirectWire::create_pair(&scheduler, &scheduler);
+	wires.second->advise(definition.lifetime, &receiver);
+	const Buffer::ByteArray payload(size, 0x5A);
+
+	for (uint64_t i = 0; i < state.iterations(); ++i)
+	{
+		wires.first->send(RdId(PING_ID), [&payload](Buffer& buffer) { buffer.write_byte_array_raw(payload); });
+	}
+	wait_for(receiver.received, state.iterations());
+	state.bytes_processed = state.iterations() * size;
+	definition.terminate();
+}
+}	 // namespace
+
+RD_BENCHMARK("directwire/send/64", [](State& state) { direct_send(state, 64); });
+RD_BENCHMARK("directwire/send/4096", [](State& state) { direct_send(state, 4096); });
+RD_BENCHMARK("socketwire/throughput/64", [](State& state) { socket_throughput(state, 64); });
+RD_BENCHMARK("socketwire/throughput/1024", [](State& state) { socket_throughput(state, 1024); });
+RD_BENCHMARK("socketwire/throughput/65536", [](State& state) { socket_throughput(state, 65536); });
+RD_BENCHMARK("socketwire/latency/64", [](State& state) { socket_latency(state, 64); }, 5000);
+RD_BENCHMARK("socketwire/latency/4096", [](State& state) { socket_latency(state, 4096); }, 5000);
+RD_BENCHMARK("socketwire/receive/64", [](State& state) { socket_receive(state, 64); }, 200000);
+RD_BENCHMARK("socketwire/receive/1024", [](State& state) { socket_receive(state, 1024); }, 50000);
+RD_BENCHMARK("socketwire/receive/65536", [](State& state) { socket_receive(state, 65536); }, 1000);
+RD_BENCHMARK("crossprocess/socketwire/latency/64", [](State& state) { cross_process(state, Transport::Socket, 64, true); }, 20000);
+RD_BENCHMARK("crossprocess/shmwire/latency/64", [](State& state) { cross_process(state, Transport::Shm, 64, true); }, 20000);
+RD_BENCHMARK("crossprocess/socketwire/throughput/64", [](State& state) { cross_process(state, Transport::Socket, 64, false); }, 500000);
+RD_BENCHMARK("crossprocess/shmwire/throughput/64", [](State& state) { cross_process(state, Transport::Shm, 64, false); }, 500000);
+RD_BENCHMARK("crossprocess/socketwire/throughput/4096", [](State& state) { cross_process(state, Transport::Socket, 4096, false); }, 50000);
+RD_BENCHMARK("crossprocess/shmwire/throughput/4096", [](State& state) { cross_process(state, Transport::Shm, 4096, false); }, 50000);
+RD_BENCHMARK("socketwire/session/v1", [](State& state) { socket_session(state, WireFormat::V1); }, 20000);
+RD_BENCHMARK("socketwire/session/v2", [](State& state) { socket_session(state, WireFormat::V2); }, 20000);
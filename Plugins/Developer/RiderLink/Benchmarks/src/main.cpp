@@ -0,0 +1,87 @@
+#include "Bench.h"
+
+#include "spdlog/spdlog.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+void print_usage()
+{
+	std::puts(
+		"Usage: rd_bench [options]\n"
+		"  --filter <text>        run only the benchmarks whose name contains <text>\n"
+		"  --min-time <ms>        time each calibrated run takes at least, 500 by default\n"
+		"  --repetitions <count>  runs of each benchmark, the median is reported, 3 by default\n"
+		"  --json <path>          write the results as JSON, '-' for stdout\n"
+		"  --list                 print the names of the benchmarks");
+}
+}	 // namespace
+
+int main(int argc, char** argv)
+{
+	rd::bench::Options options;
+	for (int i = 1; i < argc; ++i)
+	{
+		const bool has_value = i + 1 < argc;
+		if (std::strcmp(argv[i], "--filter") == 0 && has_value)
+		{
+			options.filter = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--min-time") == 0 && has_value)
+		{
+			options.min_time = std::chrono::milliseconds(std::atoll(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--repetitions") == 0 && has_value)
+		{
+			options.repetitions = static_cast<size_t>(std::atoll(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--json") == 0 && has_value)
+		{
+			options.json_path = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--list") == 0)
+		{
+			for (auto const& benchmark : rd::bench::registry())
+			{
+				std::puts(benchmark.name.c_str());
+			}
+			return 0;
+		}
+		else
+		{
+			print_usage();
+			return std::strcmp(argv[i], "--help") == 0 ? 0 : 1;
+		}
+	}
+
+	// connection errors at the end of the wire benchmarks are expected
+	spdlog::set_level(spdlog::level::off);
+
+	if (options.json_path == "-")
+	{
+		// keeps stdout valid JSON
+		options.table = stderr;
+	}
+
+	const auto results = rd::bench::run(options);
+	if (options.json_path == "-")
+	{
+		rd::bench::write_json(std::cout, results, options);
+	}
+	else if (!options.json_path.empty())
+	{
+		std::ofstream out(options.json_path);
+		if (!out)
+		{
+			std::fprintf(stderr, "Cannot write %s\n", options.json_path.c_str());
+			return 1;
+		}
+		rd::bench::write_json(out, results, options);
+	}
+	return 0;
+}
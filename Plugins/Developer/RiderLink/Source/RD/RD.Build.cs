@@ -66,6 +66,10 @@ public class RD : ModuleRules
 			"nssv_CONFIG_SELECT_STRING_VIEW=nssv_STRING_VIEW_NONSTD");
 		PublicDefinitions.Add("FMT_SHARED");
 
+		// Most verbose RD log level compiled in, as SPDLOG_LEVEL_*: 0 trace, 1 debug, 2 info. Per-packet logging is
+		// debug and trace, set 0 together with ENABLE_LOG_FILE in RiderLink.Build.cs to get it into the log file.
+		PublicDefinitions.Add("RD_LOG_ACTIVE_LEVEL=2");
+
 		string[] Paths =
 		{
 			"src", "src/rd_core_cpp", "src/rd_core_cpp/src/main"
@@ -7,9 +7,12 @@
 #include <lifetime/Lifetime.h>
 #include <util/core_util.h>
 
-#include <utility>
-#include <functional>
+#include <algorithm>
 #include <atomic>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
 
 namespace rd
 {
@@ -38,51 +41,139 @@ private:
 		}
 
 		Event(Event&&) = default;
+
+		Event& operator=(Event&&) = default;
 		// endregion
 
 		bool is_alive() const
 		{
-			return !lifetime->is_terminated();
+			return action && !lifetime->is_terminated();
 		}
 
-		void execute_if_alive(T const& value) const
+		void execute(T const& value) const
 		{
-			if (is_alive())
-			{
-				action(value);
-			}
+			action(value);
+		}
+
+		/**
+		 * \brief Drops the action of a dead listener, returns whether there was one.
+		 */
+		bool bury()
+		{
+			const bool had_action = static_cast<bool>(action);
+			action = nullptr;
+			return had_action;
 		}
 	};
 
-	using counter_t = int32_t;
-	using listeners_t = std::map<counter_t, Event>;
+	/**
+	 * \brief Listeners in the order they were advised. A dead one stays in place as a tombstone until they make up a
+	 * quarter of the array, so a fire usually removes nothing. While a fire walks the array it doesn't move: listeners
+	 * advised meanwhile wait in [pending], and only the outermost fire buries or takes them in.
+	 */
+	struct Listeners
+	{
+		std::vector<Event> events;
+		std::vector<Event> pending;
+		size_t tombstones = 0;
+		int32_t firing = 0;
+	};
 
-	mutable counter_t advise_id = 0;
-	mutable listeners_t listeners, priority_listeners;
+	class FiringGuard
+	{
+		Listeners& queue;
+
+	public:
+		explicit FiringGuard(Listeners& queue) : queue(queue)
+		{
+			++queue.firing;
+		}
+
+		FiringGuard(FiringGuard const&) = delete;
+
+		~FiringGuard()
+		{
+			--queue.firing;
+		}
+	};
+
+	mutable Listeners listeners, priority_listeners;
+
+	static bool take_pending(Listeners& queue)
+	{
+		if (queue.firing > 1 || queue.pending.empty())
+		{
+			return false;
+		}
+		std::move(queue.pending.begin(), queue.pending.end(), std::back_inserter(queue.events));
+		queue.pending.clear();
+		return true;
+	}
 
-	static void cleanup(listeners_t& queue)
+	static void cleanup(Listeners& queue)
 	{
-		util::erase_if(queue, [](Event const& e) -> bool { return !e.is_alive(); });
+		if (queue.firing != 0)
+		{
+			return;
+		}
+		take_pending(queue);
+		if (queue.tombstones != 0 && queue.tombstones * 4 >= queue.events.size())
+		{
+			auto& events = queue.events;
+			events.erase(std::remove_if(events.begin(), events.end(), [](Event const& e) -> bool { return !e.is_alive(); }),
+				events.end());
+			queue.tombstones = 0;
+		}
 	}
 
-	void fire_impl(T const& value, listeners_t& queue) const
+	/**
+	 * \brief Calls [deliver] with every live listener, including the ones it advises on the way, as the map they used to
+	 * be kept in did.
+	 */
+	template <typename F>
+	static void for_each_alive(Listeners& queue, F&& deliver)
 	{
-		for (auto const& p : queue)
 		{
-			auto const& event = p.second;
-			event.execute_if_alive(value);
+			FiringGuard guard(queue);
+			for (size_t i = 0; i < queue.events.size() || take_pending(queue); ++i)
+			{
+				Event& event = queue.events[i];
+				if (!event.is_alive())
+				{
+					// a nested fire may be inside the action of a listener that has just died
+					if (queue.firing == 1 && event.bury())
+					{
+						++queue.tombstones;
+					}
+					continue;
+				}
+				deliver(event);
+			}
 		}
 		cleanup(queue);
 	}
 
+	void fire_impl(T const& value, Listeners& queue) const
+	{
+		for_each_alive(queue, [&value](Event const& event) { event.execute(value); });
+	}
+
+	void fire_batch_impl(T const* values, size_t count, Listeners& queue) const
+	{
+		for_each_alive(queue, [values, count](Event const& event) {
+			for (size_t i = 0; i < count && event.is_alive(); ++i)
+			{
+				event.execute(values[i]);
+			}
+		});
+	}
+
 	template <typename F>
-	void advise0(const Lifetime& lifetime, F&& handler, listeners_t& queue) const
+	void advise0(const Lifetime& lifetime, F&& handler, Listeners& queue) const
 	{
 		if (lifetime->is_terminated())
 			return;
-		counter_t id = advise_id /*.load()*/;
-		queue.emplace(id, Event(std::forward<F>(handler), lifetime));
-		++advise_id;
+		(queue.firing != 0 ? queue.pending : queue.events).emplace_back(std::forward<F>(handler), lifetime);
 	}
 
 public:
@@ -110,6 +201,22 @@ public:
 		fire_impl(value, listeners);
 	}
 
+	/**
+	 * \brief Fires [count] values at once, walking the listeners only once: each listener gets all of them in order
+	 * before the next one does. As with fire, every priority listener gets them before any other, and a listener whose
+	 * lifetime ends halfway gets no more.
+	 */
+	void fire_batch(T const* values, size_t count) const
+	{
+		fire_batch_impl(values, count, priority_listeners);
+		fire_batch_impl(values, count, listeners);
+	}
+
+	void fire_batch(std::vector<T> const& values) const
+	{
+		fire_batch(values.data(), values.size());
+	}
+
 	using ISignal<T>::advise;
 
 	void advise(Lifetime lifetime, std::function<void(T const&)> handler) const override
@@ -5,6 +5,7 @@
 #include "gen_util.h"
 #include "overloaded.h"
 #include "shared_function.h"
+#include "unique_function.h"
 
 #include <std/hash.h>
 #include <std/to_string.h>
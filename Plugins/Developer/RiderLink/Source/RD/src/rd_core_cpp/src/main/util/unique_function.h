@@ -0,0 +1,204 @@
+#ifndef RD_CPP_UNIQUE_FUNCTION_H
+#define RD_CPP_UNIQUE_FUNCTION_H
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace rd
+{
+namespace util
+{
+template <typename Signature>
+class unique_function;
+
+/**
+ * \brief Move-only counterpart of std::function. A callable of up to [INLINE_SIZE] bytes that moves without throwing is
+ * kept inside the object, so wrapping it allocates nothing, and a move-only callable needs no make_shared_function.
+ * Bigger ones are moved to the heap once and only the pointer moves afterwards.
+ */
+template <typename R, typename... Args>
+class unique_function<R(Args...)>
+{
+public:
+	static constexpr size_t INLINE_SIZE = 64;
+
+private:
+	struct Ops
+	{
+		R (*invoke)(void* callable, Args&&... args);
+		/**
+		 * \brief Move-constructs the callable at [from] into [to] and destroys the one at [from].
+		 */
+		void (*relocate)(void* to, void* from) noexcept;
+		void (*destroy)(void* callable) noexcept;
+	};
+
+	template <typename F>
+	static constexpr bool stored_inline = sizeof(F) <= INLINE_SIZE && alignof(std::max_align_t) % alignof(F) == 0 &&
+										  std::is_nothrow_move_constructible<F>::value;
+
+	template <typename F>
+	struct InlineOps
+	{
+		static R invoke(void* callable, Args&&... args)
+		{
+			return (*static_cast<F*>(callable))(std::forward<Args>(args)...);
+		}
+
+		static void relocate(void* to, void* from) noexcept
+		{
+			::new (to) F(std::move(*static_cast<F*>(from)));
+			static_cast<F*>(from)->~F();
+		}
+
+		static void destroy(void* callable) noexcept
+		{
+			static_cast<F*>(callable)->~F();
+		}
+
+		static constexpr Ops ops{&invoke, &relocate, &destroy};
+	};
+
+	template <typename F>
+	struct HeapOps
+	{
+		static R invoke(void* callable, Args&&... args)
+		{
+			return (**static_cast<F**>(callable))(std::forward<Args>(args)...);
+		}
+
+		static void relocate(void* to, void* from) noexcept
+		{
+			*static_cast<F**>(to) = *static_cast<F**>(from);
+		}
+
+		static void destroy(void* callable) noexcept
+		{
+			delete *static_cast<F**>(callable);
+		}
+
+		static constexpr Ops ops{&invoke, &relocate, &destroy};
+	};
+
+	template <typename F>
+	static bool is_null(F const& f)
+	{
+		if constexpr (std::is_pointer<F>::value || std::is_member_pointer<F>::value)
+		{
+			return f == nullptr;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	template <typename Other>
+	static bool is_null(std::function<Other> const& f)
+	{
+		return !f;
+	}
+
+	mutable std::aligned_storage_t<INLINE_SIZE, alignof(std::max_align_t)> storage;
+	Ops const* ops = nullptr;
+
+	void reset() noexcept
+	{
+		if (ops != nullptr)
+		{
+			ops->destroy(&storage);
+			ops = nullptr;
+		}
+	}
+
+public:
+	// region ctor/dtor
+
+	unique_function() noexcept = default;
+
+	unique_function(std::nullptr_t) noexcept
+	{
+	}
+
+	template <typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, unique_function>::value &&
+													  std::is_invocable_r<R, std::decay_t<F>&, Args...>::value>>
+	unique_function(F&& f)
+	{
+		using Callable = std::decay_t<F>;
+		if (is_null(f))
+		{
+			return;
+		}
+		if constexpr (stored_inline<Callable>)
+		{
+			::new (&storage) Callable(std::forward<F>(f));
+			ops = &InlineOps<Callable>::ops;
+		}
+		else
+		{
+			::new (&storage) Callable*(new Callable(std::forward<F>(f)));
+			ops = &HeapOps<Callable>::ops;
+		}
+	}
+
+	unique_function(unique_function&& other) noexcept : ops(other.ops)
+	{
+		if (ops != nullptr)
+		{
+			ops->relocate(&storage, &other.storage);
+			other.ops = nullptr;
+		}
+	}
+
+	unique_function& operator=(unique_function&& other) noexcept
+	{
+		if (this != &other)
+		{
+			reset();
+			if (other.ops != nullptr)
+			{
+				other.ops->relocate(&storage, &other.storage);
+				ops = other.ops;
+				other.ops = nullptr;
+			}
+		}
+		return *this;
+	}
+
+	unique_function& operator=(std::nullptr_t) noexcept
+	{
+		reset();
+		return *this;
+	}
+
+	unique_function(unique_function const&) = delete;
+
+	unique_function& operator=(unique_function const&) = delete;
+
+	~unique_function()
+	{
+		reset();
+	}
+	// endregion
+
+	explicit operator bool() const noexcept
+	{
+		return ops != nullptr;
+	}
+
+	R operator()(Args... args) const
+	{
+		if (ops == nullptr)
+		{
+			throw std::bad_function_call();
+		}
+		return ops->invoke(&storage, std::forward<Args>(args)...);
+	}
+};
+}	 // namespace util
+}	 // namespace rd
+
+#endif	  // RD_CPP_UNIQUE_FUNCTION_H
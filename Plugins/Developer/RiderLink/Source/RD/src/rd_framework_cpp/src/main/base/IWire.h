@@ -47,6 +47,14 @@ public:
 	 * \param entity to be subscripted
 	 */
 	virtual void advise(Lifetime lifetime, RdReactiveBase const* entity) const = 0;
+
+	/**
+	 * \brief Format the buffers passed to writers are in. Wires that don't negotiate formats always write V1.
+	 */
+	virtual WireFormat get_format() const
+	{
+		return WireFormat::V1;
+	}
 };
 }	 // namespace rd
 #if defined(_MSC_VER)
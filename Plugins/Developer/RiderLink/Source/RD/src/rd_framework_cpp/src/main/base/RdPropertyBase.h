@@ -81,7 +81,7 @@ public:
 			get_wire()->send(rdid, [this, &v](Buffer& buffer) {
 				buffer.write_integral<int32_t>(master_version);
 				S::write(this->get_serialization_context(), buffer, v);
-				spdlog::get("logSend")->trace("SEND property {} + {}:: ver = {}, value = {}", to_string(location), to_string(rdid),
+				RD_LOG_TRACE(util::send_logger(), "SEND property {} + {}:: ver = {}, value = {}", to_string(location), to_string(rdid),
 					std::to_string(master_version), to_string(v));
 			});
 		});
@@ -105,7 +105,7 @@ public:
 		WT v = S::read(this->get_serialization_context(), buffer);
 
 		bool rejected = is_master && version < master_version;
-		spdlog::get("logSend")->trace("RECV property {} {}:: oldver={}, ver={}, value = {}{}", to_string(location), to_string(rdid),
+		RD_LOG_TRACE(util::send_logger(), "RECV property {} {}:: oldver={}, ver={}, value = {}{}", to_string(location), to_string(rdid),
 			master_version, version, to_string(v), (rejected ? ">> REJECTED" : ""));
 		if (rejected)
 		{
@@ -4,6 +4,7 @@
 #include "base/RdBindableBase.h"
 #include "base/IRdReactive.h"
 #include "guards.h"
+#include "util/logging.h"
 
 #include "spdlog/spdlog.h"
 
@@ -1,6 +1,7 @@
 #include "ExtWire.h"
 
 #include "protocol/Buffer.h"
+#include "util/logging.h"
 
 namespace rd
 {
@@ -17,11 +18,18 @@ ExtWire::ExtWire()
 					{
 						return;
 					}
-					// auto[id, payload] = std::move(sendQ.front());
-					auto it = std::move(sendQ.front());
+					auto message = std::move(sendQ.front());
 					sendQ.pop();
+					// the bytes can't be re-encoded, a message queued before the wire switched formats is dropped
+					const WireFormat format = realWire->get_format();
+					if (format != message.format)
+					{
+						RD_LOG_ERROR(util::send_logger(), "dropped a message to {} queued in format v{}, the wire is now in v{}",
+							to_string(message.id), static_cast<int>(message.format), static_cast<int>(format));
+						continue;
+					}
 					realWire->send(
-						it.first, [payload = std::move(it.second)](Buffer& buffer) { buffer.write_byte_array_raw(payload); });
+						message.id, [payload = std::move(message.payload)](Buffer& buffer) { buffer.write_byte_array_raw(payload); });
 				}
 			}
 		}
@@ -39,12 +47,19 @@ void ExtWire::send(RdId const& id, std::function<void(Buffer& buffer)> writer) c
 		std::lock_guard<decltype(lock)> guard(lock);
 		if (!sendQ.empty() || !connected.get())
 		{
+			const WireFormat format = get_format();
 			Buffer buffer;
+			buffer.set_format(format);
 			writer(buffer);
-			sendQ.emplace(id, buffer.getRealArray());
+			sendQ.push({id, std::move(buffer).getRealArray(), format});
 			return;
 		}
 	}
 	realWire->send(id, std::move(writer));
 }
+
+WireFormat ExtWire::get_format() const
+{
+	return realWire != nullptr ? realWire->get_format() : WireFormat::V1;
+}
 }	 // namespace rd
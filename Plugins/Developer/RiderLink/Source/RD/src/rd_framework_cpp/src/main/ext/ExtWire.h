@@ -22,7 +22,15 @@ class RD_FRAMEWORK_API ExtWire final : public IWire
 {
 	mutable std::mutex lock;
 
-	mutable std::queue<std::pair<RdId, Buffer::ByteArray> > sendQ;
+	struct QueuedMessage
+	{
+		RdId id;
+		Buffer::ByteArray payload;
+		WireFormat format;
+	};
+
+	// messages are serialized when sent, in the format the real wire had then
+	mutable std::queue<QueuedMessage> sendQ;
 
 public:
 	ExtWire();
@@ -32,6 +40,8 @@ public:
 	void advise(Lifetime lifetime, RdReactiveBase const* entity) const override;
 
 	void send(RdId const& id, std::function<void(Buffer& buffer)> writer) const override;
+
+	WireFormat get_format() const override;
 };
 }	 // namespace rd
 #if defined(_MSC_VER)
@@ -48,7 +48,7 @@ void RdExtBase::init(Lifetime lifetime) const
 void RdExtBase::on_wire_received(Buffer buffer) const
 {
 	ExtState remoteState = buffer.read_enum<ExtState>();
-	traceMe(spdlog::get("logReceived"), "remote: " + to_string(remoteState));
+	traceMe(util::received_logger(), "remote: " + to_string(remoteState));
 
 	switch (remoteState)
 	{
@@ -90,7 +90,7 @@ void RdExtBase::sendState(IWire const& wire, ExtState state) const
 
 void RdExtBase::traceMe(std::shared_ptr<spdlog::logger> logger, string_view message) const
 {
-	logger->trace("ext {} {}:: {}", to_string(location), to_string(rdid), std::string(message));
+	RD_LOG_TRACE(logger, "ext {} {}:: {}", to_string(location), to_string(rdid), std::string(message));
 }
 
 IScheduler* RdExtBase::get_wire_scheduler() const
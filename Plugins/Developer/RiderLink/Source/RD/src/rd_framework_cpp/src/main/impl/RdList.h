@@ -104,7 +104,7 @@ public:
 					{
 						S::write(this->get_serialization_context(), buffer, *new_value);
 					}
-					spdlog::get("logSend")->trace(logmsg(op, next_version - 1, e.get_index(), new_value));
+					RD_LOG_TRACE(util::send_logger(), logmsg(op, next_version - 1, e.get_index(), new_value));
 				});
 			});
 		});
@@ -138,7 +138,7 @@ public:
 			{
 				auto value = S::read(this->get_serialization_context(), buffer);
 
-				spdlog::get("logReceived")->trace(logmsg(op, version, index, &(wrapper::get<T>(value))));
+				RD_LOG_TRACE(util::received_logger(), logmsg(op, version, index, &(wrapper::get<T>(value))));
 
 				(index < 0) ? list::add(std::move(value)) : list::add(static_cast<size_t>(index), std::move(value));
 				break;
@@ -147,14 +147,14 @@ public:
 			{
 				auto value = S::read(this->get_serialization_context(), buffer);
 
-				spdlog::get("logReceived")->trace(logmsg(op, version, index, &(wrapper::get<T>(value))));
+				RD_LOG_TRACE(util::received_logger(), logmsg(op, version, index, &(wrapper::get<T>(value))));
 
 				list::set(static_cast<size_t>(index), std::move(value));
 				break;
 			}
 			case Op::REMOVE:
 			{
-				spdlog::get("logReceived")->trace(logmsg(op, version, index));
+				RD_LOG_TRACE(util::received_logger(), logmsg(op, version, index));
 
 				list::removeAt(static_cast<size_t>(index));
 				break;
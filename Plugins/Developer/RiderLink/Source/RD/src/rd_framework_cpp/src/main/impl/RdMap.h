@@ -125,7 +125,7 @@ public:
 						VS::write(this->get_serialization_context(), buffer, *new_value);
 					}
 
-					spdlog::get("logSend")->trace("SEND{}", logmsg(op, next_version - 1, e.get_key(), new_value));
+					RD_LOG_TRACE(util::send_logger(), "SEND{}", logmsg(op, next_version - 1, e.get_key(), new_value));
 				});
 			});
 		});
@@ -186,16 +186,18 @@ public:
 			}
 			if (errmsg.empty())
 			{
-				spdlog::get("logReceived")->trace(logmsg(Op::ACK, version, &(wrapper::get<K>(key))));
+				RD_LOG_TRACE(util::received_logger(), logmsg(Op::ACK, version, &(wrapper::get<K>(key))));
 			}
 			else
 			{
-				spdlog::get("logReceived")->error(logmsg(Op::ACK, version, &(wrapper::get<K>(key))) + " >> " + errmsg);
+				RD_LOG_ERROR(util::received_logger(), logmsg(Op::ACK, version, &(wrapper::get<K>(key))) + " >> " + errmsg);
 			}
 		}
 		else
 		{
+			// the acknowledgement goes out in the format the message came in
 			Buffer serialized_key;
+			serialized_key.set_format(buffer.get_format());
 			KS::write(this->get_serialization_context(), serialized_key, wrapper::get<K>(key));
 
 			bool is_put = (op == Op::ADD || op == Op::UPDATE);
@@ -207,7 +209,7 @@ public:
 
 			if (msg_versioned || !is_master || pendingForAck.count(key) == 0)
 			{
-				spdlog::get("logReceived")->trace("RECV{}", logmsg(op, version, &(wrapper::get<K>(key)), value));
+				RD_LOG_TRACE(util::received_logger(), "RECV{}", logmsg(op, version, &(wrapper::get<K>(key)), value));
 				if (value.has_value())
 				{
 					map::set(std::move(key), *std::move(value));
@@ -219,7 +221,7 @@ public:
 			}
 			else
 			{
-				spdlog::get("logReceived")->trace("{} >> REJECTED", logmsg(op, version, &(wrapper::get<K>(key)), value));
+				RD_LOG_TRACE(util::received_logger(), "{} >> REJECTED", logmsg(op, version, &(wrapper::get<K>(key)), value));
 			}
 
 			if (msg_versioned)
@@ -229,13 +231,13 @@ public:
 						innerBuffer.write_integral<int32_t>((1u << versionedFlagShift) | static_cast<int32_t>(Op::ACK));
 						innerBuffer.write_integral<int64_t>(version);
 						// KS::write(this->get_serialization_context(), innerBuffer, wrapper::get<K>(key));
-						innerBuffer.write_byte_array_raw(serialized_key.getArray());
+						innerBuffer.write_byte_array_raw(serialized_key.getRealArray());
 						// logSend.trace(logmsg(Op::ACK, version, serialized_key));
 					});
 				get_wire()->send(rdid, std::move(writer));
 				if (is_master)
 				{
-					spdlog::get("logReceived")->error("Both ends are masters: {}", to_string(location));
+					RD_LOG_ERROR(util::received_logger(), "Both ends are masters: {}", to_string(location));
 				}
 			}
 		}
@@ -11,7 +11,7 @@ InternScheduler::InternScheduler()
 	out_of_order_execution = true;
 }
 
-void InternScheduler::queue(std::function<void()> action)
+void InternScheduler::queue(util::unique_function<void()> action)
 {
 	util::increment_guard<int32_t> guard(active_counts);
 	action();
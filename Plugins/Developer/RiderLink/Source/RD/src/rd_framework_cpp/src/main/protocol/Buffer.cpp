@@ -4,6 +4,8 @@
 
 #include <string>
 #include <algorithm>
+#include <iterator>
+#include <type_traits>
 
 namespace rd
 {
@@ -19,6 +21,43 @@ Buffer::Buffer(ByteArray array, size_t offset) : data_(std::move(array)), offset
 {
 }
 
+Buffer::Buffer(Buffer&& other) noexcept
+	: data_(std::move(other.data_))
+	, offset(other.offset)
+	, format(other.format)
+	, block_(std::move(other.block_))
+	, view_(other.view_)
+	, view_size_(other.view_size_)
+{
+	other.offset = 0;
+	other.view_ = nullptr;
+	other.view_size_ = 0;
+}
+
+Buffer& Buffer::operator=(Buffer&& other) noexcept
+{
+	if (this != &other)
+	{
+		data_ = std::move(other.data_);
+		offset = other.offset;
+		format = other.format;
+		block_ = std::move(other.block_);
+		view_ = other.view_;
+		view_size_ = other.view_size_;
+
+		other.offset = 0;
+		other.view_ = nullptr;
+		other.view_size_ = 0;
+	}
+	return *this;
+}
+
+Buffer::Buffer(std::shared_ptr<ByteArray const> block, size_t begin, size_t size)
+	: block_(std::move(block)), view_(block_->data() + begin), view_size_(size)
+{
+	RD_ASSERT_MSG(begin + size <= block_->size(), "view exceeds its block");
+}
+
 size_t Buffer::get_position() const
 {
 	return offset;
@@ -43,7 +82,7 @@ void Buffer::read(word_t* dst, size_t size)
 	if (size == 0)
 		return;
 	check_available(size);
-	std::copy(&data_[offset], &data_[offset] + size, dst);
+	std::copy(storage() + offset, storage() + offset + size, dst);
 	offset += size;
 }
 
@@ -58,7 +97,8 @@ void Buffer::write(const word_t* src, size_t size)
 
 void Buffer::require_available(size_t moreSize)
 {
-	if (offset + moreSize >= size())
+	detach();
+	if (offset + moreSize > size())
 	{
 		const size_t new_size = (std::max)(size() * 2, offset + moreSize);
 		data_.resize(new_size);
@@ -70,13 +110,123 @@ void Buffer::rewind()
 	set_position(0);
 }
 
+bool Buffer::is_view() const
+{
+	return view_ != nullptr;
+}
+
+Buffer Buffer::slice(size_t size)
+{
+	check_available(size);
+	if (is_view())
+	{
+		Buffer result(block_, static_cast<size_t>(view_ - block_->data()) + offset, size);
+		offset += size;
+		return result;
+	}
+	Buffer result(ByteArray(data_.begin() + offset, data_.begin() + offset + size));
+	offset += size;
+	return result;
+}
+
+Buffer::word_t const* Buffer::storage() const
+{
+	return is_view() ? view_ : data_.data();
+}
+
+void Buffer::detach()
+{
+	if (!is_view())
+	{
+		return;
+	}
+	data_.assign(view_, view_ + view_size_);
+	view_ = nullptr;
+	view_size_ = 0;
+	block_.reset();
+}
+
+WireFormat Buffer::get_format() const
+{
+	return format;
+}
+
+void Buffer::set_format(WireFormat value)
+{
+	format = value;
+}
+
+uint64_t Buffer::read_varint()
+{
+	uint64_t result = 0;
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		const word_t byte = read_integral<word_t>();
+		result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+		{
+			return result;
+		}
+	}
+	throw std::out_of_range("Malformed varint: more than 10 bytes");
+}
+
+void Buffer::write_varint(uint64_t value)
+{
+	word_t bytes[10];
+	size_t count = 0;
+	while (value >= 0x80)
+	{
+		bytes[count++] = static_cast<word_t>(value | 0x80);
+		value >>= 7;
+	}
+	bytes[count++] = static_cast<word_t>(value);
+	write(bytes, count);
+}
+
+int32_t Buffer::read_length()
+{
+	if (format == WireFormat::V1)
+	{
+		return read_integral<int32_t>();
+	}
+	return static_cast<int32_t>(static_cast<uint32_t>(read_varint()));
+}
+
+void Buffer::write_length(int32_t value)
+{
+	if (format == WireFormat::V1)
+	{
+		write_integral<int32_t>(value);
+	}
+	else
+	{
+		write_varint(static_cast<uint32_t>(value));
+	}
+}
+
+int32_t Buffer::read_enum_ordinal()
+{
+	return read_length();
+}
+
+void Buffer::write_enum_ordinal(int32_t value)
+{
+	write_length(value);
+}
+
 Buffer::ByteArray Buffer::getArray() const&
 {
+	if (is_view())
+	{
+		return ByteArray(view_, view_ + view_size_);
+	}
 	return data_;
 }
 
 Buffer::ByteArray Buffer::getArray() &&
 {
+	detach();
 	rewind();
 	return std::move(data_);
 }
@@ -90,6 +240,7 @@ Buffer::ByteArray Buffer::getRealArray() const&
 
 Buffer::ByteArray Buffer::getRealArray() &&
 {
+	detach();
 	auto res = std::move(data_);
 	res.resize(offset);
 	rewind();
@@ -98,11 +249,12 @@ Buffer::ByteArray Buffer::getRealArray() &&
 
 Buffer::word_t const* Buffer::data() const
 {
-	return data_.data();
+	return storage();
 }
 
 Buffer::word_t* Buffer::data()
 {
+	detach();
 	return data_.data();
 }
 
@@ -118,7 +270,7 @@ Buffer::word_t* Buffer::current_pointer()
 
 size_t Buffer::size() const
 {
-	return data_.size();
+	return is_view() ? view_size_ : data_.size();
 }
 
 /*std::string Buffer::readString() const {
@@ -131,6 +283,141 @@ std::vector<uint8_t> v(value.begin(), value.end());
 writeArray<uint8_t>(v);
 }*/
 
+namespace
+{
+// V2 strings come from and go to arbitrary UTF-16, so malformed input is replaced rather than failing the whole message
+constexpr char32_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+/**
+ * \brief Reads the code point at [it] from UTF-16 or UTF-32 units, combining surrogate pairs. Unpaired surrogates and
+ * values beyond U+10FFFF become U+FFFD.
+ */
+template <typename It>
+char32_t read_wide_code_point(It& it, It end)
+{
+	using Unit = typename std::make_unsigned<typename std::iterator_traits<It>::value_type>::type;
+	const char32_t unit = static_cast<Unit>(*it++);
+	if (unit < 0xD800 || (unit > 0xDFFF && unit <= 0x10FFFF))
+	{
+		return unit;
+	}
+	if (unit <= 0xDBFF && it != end)
+	{
+		const char32_t low = static_cast<Unit>(*it);
+		if (low >= 0xDC00 && low <= 0xDFFF)
+		{
+			++it;
+			return 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+		}
+	}
+	return REPLACEMENT_CHARACTER;
+}
+
+/**
+ * \brief Reads the UTF-8 sequence at [it]. A bad lead byte, a missing continuation byte, an overlong form, a surrogate or
+ * a value beyond U+10FFFF becomes U+FFFD, and reading resumes after the bytes consumed so far.
+ */
+char32_t read_utf8_code_point(Buffer::word_t const*& it, Buffer::word_t const* end)
+{
+	const uint8_t lead = *it++;
+	if (lead < 0x80)
+	{
+		return lead;
+	}
+
+	size_t continuations;
+	char32_t min;
+	char32_t code_point;
+	if (lead >= 0xC2 && lead <= 0xDF)
+	{
+		continuations = 1, min = 0x80, code_point = lead & 0x1F;
+	}
+	else if ((lead & 0xF0) == 0xE0)
+	{
+		continuations = 2, min = 0x800, code_point = lead & 0x0F;
+	}
+	else if (lead >= 0xF0 && lead <= 0xF4)
+	{
+		continuations = 3, min = 0x10000, code_point = lead & 0x07;
+	}
+	else
+	{
+		return REPLACEMENT_CHARACTER;
+	}
+
+	for (size_t i = 0; i < continuations; ++i)
+	{
+		if (it == end || (*it & 0xC0) != 0x80)
+		{
+			return REPLACEMENT_CHARACTER;
+		}
+		code_point = (code_point << 6) | (*it++ & 0x3F);
+	}
+	if (code_point < min || code_point > 0x10FFFF || (code_point >= 0xD800 && code_point <= 0xDFFF))
+	{
+		return REPLACEMENT_CHARACTER;
+	}
+	return code_point;
+}
+
+template <typename Out>
+void write_utf8_code_point(char32_t code_point, Out& out)
+{
+	if (code_point < 0x80)
+	{
+		*out++ = static_cast<char>(code_point);
+	}
+	else if (code_point < 0x800)
+	{
+		*out++ = static_cast<char>(0xC0 | (code_point >> 6));
+		*out++ = static_cast<char>(0x80 | (code_point & 0x3F));
+	}
+	else if (code_point < 0x10000)
+	{
+		*out++ = static_cast<char>(0xE0 | (code_point >> 12));
+		*out++ = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+		*out++ = static_cast<char>(0x80 | (code_point & 0x3F));
+	}
+	else
+	{
+		*out++ = static_cast<char>(0xF0 | (code_point >> 18));
+		*out++ = static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+		*out++ = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+		*out++ = static_cast<char>(0x80 | (code_point & 0x3F));
+	}
+}
+
+/**
+ * \brief Writes the code point as one UTF-32 unit or as UTF-16, depending on the width of [Unit].
+ */
+template <typename Unit, typename Out>
+void write_wide_code_point(char32_t code_point, Out& out)
+{
+	if (sizeof(Unit) >= 4 || code_point < 0x10000)
+	{
+		*out++ = static_cast<Unit>(code_point);
+		return;
+	}
+	code_point -= 0x10000;
+	*out++ = static_cast<Unit>(0xD800 + (code_point >> 10));
+	*out++ = static_cast<Unit>(0xDC00 + (code_point & 0x3FF));
+}
+
+/**
+ * \brief Decodes [size] bytes of UTF-8 into UTF-16 or UTF-32 units of type [Unit] and returns the end of the output.
+ */
+template <typename Unit, typename Out>
+Out decode_utf8(Buffer::word_t const* it, size_t size, Out out)
+{
+	Buffer::word_t const* const end = it + size;
+	while (it != end)
+	{
+		write_wide_code_point<Unit>(read_utf8_code_point(it, end), out);
+	}
+	return out;
+}
+}	 // namespace
+
 template <int>
 std::wstring read_wstring_spec(Buffer& buffer)
 {
@@ -141,7 +428,7 @@ std::wstring read_wstring_spec(Buffer& buffer)
 template <>
 std::wstring read_wstring_spec<2>(Buffer& buffer)
 {
-	const int32_t len = buffer.read_integral<int32_t>();
+	const int32_t len = buffer.read_length();
 	RD_ASSERT_MSG(len >= 0, "read null string(length =" + std::to_string(len) + ")");
 	std::wstring result;
 	result.resize(len);
@@ -151,6 +438,17 @@ std::wstring read_wstring_spec<2>(Buffer& buffer)
 
 std::wstring Buffer::read_wstring()
 {
+	if (format == WireFormat::V2)
+	{
+		const int32_t len = read_length();
+		RD_ASSERT_MSG(len >= 0, "read null string(length =" + std::to_string(len) + ")");
+		check_available(len);
+		std::wstring result;
+		result.reserve(len);
+		decode_utf8<wchar_t>(storage() + offset, len, std::back_inserter(result));
+		offset += len;
+		return result;
+	}
 	return read_wstring_spec<sizeof(wchar_t)>(*this);
 }
 
@@ -164,7 +462,7 @@ void write_wstring_spec(Buffer& buffer, wstring_view value)
 template <>
 void write_wstring_spec<2>(Buffer& buffer, wstring_view value)
 {
-	buffer.write_integral<int32_t>(static_cast<int32_t>(value.size()));
+	buffer.write_length(static_cast<int32_t>(value.size()));
 	buffer.write(reinterpret_cast<Buffer::word_t const*>(value.data()), sizeof(wchar_t) * value.size());
 }
 
@@ -173,14 +471,51 @@ void Buffer::write_wstring(std::wstring const& value)
 	write_wstring(wstring_view(value));
 }
 
+/**
+ * \brief Writes the characters as a length-prefixed UTF-8 string. The UTF-8 form is built in a per-thread scratch string
+ * first because the length prefix has to precede it. Unpaired surrogates are written as U+FFFD.
+ */
+template <typename It>
+void Buffer::write_utf8(It begin, It end)
+{
+	thread_local std::string scratch;
+	scratch.clear();
+	auto out = std::back_inserter(scratch);
+	while (begin != end)
+	{
+		write_utf8_code_point(read_wide_code_point(begin, end), out);
+	}
+
+	write_length(static_cast<int32_t>(scratch.size()));
+	write(reinterpret_cast<word_t const*>(scratch.data()), scratch.size());
+}
+
 void Buffer::write_char16_string(const uint16_t* data, size_t len)
 {
+	if (format == WireFormat::V2)
+	{
+		const char16_t* chars = reinterpret_cast<const char16_t*>(data);
+		write_utf8(chars, chars + len);
+		return;
+	}
 	write_integral<int32_t>(static_cast<int32_t>(len));
 	write(reinterpret_cast<word_t const*>(data), sizeof(uint16_t) * len);
 }
 
 uint16_t* Buffer::read_char16_string()
 {	
+	if (format == WireFormat::V2)
+	{
+		const int32_t bytes = read_length();
+		RD_ASSERT_MSG(bytes >= 0, "read null string(length =" + std::to_string(bytes) + ")");
+		check_available(bytes);
+		// UTF-16 never needs more code units than UTF-8 needs bytes, a replaced byte included
+		uint16_t* result = new uint16_t[bytes + 1];
+		uint16_t* end = decode_utf8<uint16_t>(storage() + offset, bytes, result);
+		*end = 0;
+		offset += bytes;
+		return result;
+	}
 	const int32_t len = read_integral<int32_t>();
 	RD_ASSERT_MSG(len >= 0, "read null string(length =" + std::to_string(len) + ")");
 	uint16_t * result = new uint16_t[len+1];
@@ -191,6 +526,11 @@ uint16_t* Buffer::read_char16_string()
 
 void Buffer::write_wstring(wstring_view value)
 {
+	if (format == WireFormat::V2)
+	{
+		write_utf8(value.begin(), value.end());
+		return;
+	}
 	write_wstring_spec<sizeof(wchar_t)>(*this, value);
 }
 
@@ -239,7 +579,7 @@ void Buffer::write_char(wchar_t value)
 
 void Buffer::read_byte_array(ByteArray& array)
 {
-	const int32_t length = read_integral<int32_t>();
+	const int32_t length = read_length();
 	array.resize(length);
 	read_byte_array_raw(array);
 }
@@ -256,6 +596,7 @@ void Buffer::write_byte_array_raw(const ByteArray& array)
 
 Buffer::ByteArray& Buffer::get_data()
 {
+	detach();
 	return data_;
 }
 }	 // namespace rd
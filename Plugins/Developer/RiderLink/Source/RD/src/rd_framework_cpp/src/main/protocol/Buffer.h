@@ -21,6 +21,16 @@
 
 namespace rd
 {
+/**
+ * \brief Encoding of lengths, enums and strings in a Buffer, and of package framing in SocketWire.
+ * V1 writes fixed-width little-endian integers and UTF-16 strings. V2 writes LEB128 varints and UTF-8 strings.
+ */
+enum class WireFormat : uint8_t
+{
+	V1 = 1,
+	V2 = 2
+};
+
 /**
  * \brief Simple data buffer. Allows to "SerDes" plenty of types, such as integrals, arrays, etc.
  */
@@ -46,6 +56,21 @@ private:
 
 	size_t offset = 0;
 
+	WireFormat format = WireFormat::V1;
+
+	// region read-only view into a shared block, replaces [data_] while set
+	std::shared_ptr<ByteArray const> block_;
+
+	word_t const* view_ = nullptr;
+
+	size_t view_size_ = 0;
+	// endregion
+
+	word_t const* storage() const;
+
+	// turns a view into an owned copy before the first write
+	void detach();
+
 	// read
 	void read(word_t* dst, size_t size);
 
@@ -54,6 +79,10 @@ private:
 
 	size_t size() const;
 
+	// V2 strings
+	template <typename It>
+	void write_utf8(It begin, It end);
+
 public:
 	// region ctor/dtor
 
@@ -63,13 +92,22 @@ public:
 
 	explicit Buffer(ByteArray array, size_t offset = 0);
 
+	/**
+	 * \brief Read-only view of [size] bytes of [block] starting at [begin]. The view keeps the block alive; the bytes are
+	 * copied out only if the buffer is written to or its mutable storage is requested.
+	 */
+	Buffer(std::shared_ptr<ByteArray const> block, size_t begin, size_t size);
+
 	Buffer(Buffer const&) = delete;
 
 	Buffer& operator=(Buffer const&) = delete;
 
-	Buffer(Buffer&&) noexcept = default;
+	/**
+	 * \brief The moved-from buffer is left empty and owning, never as a view without its block.
+	 */
+	Buffer(Buffer&& other) noexcept;
 
-	Buffer& operator=(Buffer&&) noexcept = default;
+	Buffer& operator=(Buffer&& other) noexcept;
 
 	// endregion
 
@@ -83,6 +121,32 @@ public:
 
 	void rewind();
 
+	bool is_view() const;
+
+	/**
+	 * \brief Next [size] bytes as a separate buffer, advancing the position past them. A view yields a view into the same
+	 * block; an owning buffer yields a copy.
+	 */
+	Buffer slice(size_t size);
+
+	WireFormat get_format() const;
+
+	void set_format(WireFormat value);
+
+	/**
+	 * \brief Unsigned LEB128: seven bits per byte, least significant group first, high bit set on all but the last byte.
+	 */
+	uint64_t read_varint();
+
+	void write_varint(uint64_t value);
+
+	/**
+	 * \brief Length prefix of arrays and strings: int32 in V1, varint in V2.
+	 */
+	int32_t read_length();
+
+	void write_length(int32_t value);
+
 	template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value, T>>
 	T read_integral()
 	{
@@ -115,7 +179,7 @@ public:
 		typename = typename std::enable_if_t<util::is_pod_v<T>>>
 	C<T, A> read_array()
 	{
-		int32_t len = read_integral<int32_t>();
+		int32_t len = read_length();
 		RD_ASSERT_MSG(len >= 0, "read null array(length = " + std::to_string(len) + ")");
 		C<T, A> result;
 		using rd::resize;
@@ -130,7 +194,7 @@ public:
 	template <template <class, class> class C, typename T, typename A = allocator<value_or_wrapper<T>>>
 	C<value_or_wrapper<T>, A> read_array(std::function<value_or_wrapper<T>()> reader)
 	{
-		int32_t len = read_integral<int32_t>();
+		int32_t len = read_length();
 		C<value_or_wrapper<T>, A> result;
 		using rd::resize;
 		resize(result, len);
@@ -147,7 +211,7 @@ public:
 	{
 		using rd::size;
 		const int32_t& len = rd::size(container);
-		write_integral<int32_t>(static_cast<int32_t>(len));
+		write_length(static_cast<int32_t>(len));
 		if (len > 0)
 		{
 			write(reinterpret_cast<word_t const*>(&container[0]), sizeof(T) * len);
@@ -159,7 +223,7 @@ public:
 	void write_array(C<T, A> const& container, std::function<void(T const&)> writer)
 	{
 		using rd::size;
-		write_integral<int32_t>(size(container));
+		write_length(static_cast<int32_t>(size(container)));
 		for (auto const& e : container)
 		{
 			writer(e);
@@ -170,7 +234,7 @@ public:
 	void write_array(C<Wrapper<T>, A> const& container, std::function<void(T const&)> writer)
 	{
 		using rd::size;
-		write_integral<int32_t>(size(container));
+		write_length(static_cast<int32_t>(size(container)));
 		for (auto const& e : container)
 		{
 			writer(*e);
@@ -207,6 +271,13 @@ public:
 
 	void write_wstring(Wrapper<std::wstring> const& value);
 
+	/**
+	 * \brief Enum ordinal or enum set bits: int32 in V1, varint in V2.
+	 */
+	int32_t read_enum_ordinal();
+
+	void write_enum_ordinal(int32_t value);
+
 	DateTime read_date_time();
 
 	void write_date_time(DateTime const& date_time);
@@ -214,27 +285,27 @@ public:
 	template <typename T, typename = typename std::enable_if_t<util::is_enum_v<T>>>
 	T read_enum()
 	{
-		int32_t x = read_integral<int32_t>();
+		int32_t x = read_enum_ordinal();
 		return static_cast<T>(x);
 	}
 
 	template <typename T, typename = typename std::enable_if_t<util::is_enum_v<T>>>
 	void write_enum(T const& x)
 	{
-		write_integral<int32_t>(static_cast<int32_t>(x));
+		write_enum_ordinal(static_cast<int32_t>(x));
 	}
 
 	template <typename T, typename = typename std::enable_if_t<util::is_enum_v<T>>>
 	T read_enum_set()
 	{
-		int32_t x = read_integral<int32_t>();
+		int32_t x = read_enum_ordinal();
 		return static_cast<T>(x);
 	}
 
 	template <typename T, typename = typename std::enable_if_t<util::is_enum_v<T>>>
 	void write_enum_set(T const& x)
 	{
-		write_integral<int32_t>(static_cast<int32_t>(x));
+		write_enum_ordinal(static_cast<int32_t>(x));
 	}
 
 	template <typename T, typename F, typename = typename std::enable_if_t<util::is_same_v<typename util::result_of_t<F()>, T>>>
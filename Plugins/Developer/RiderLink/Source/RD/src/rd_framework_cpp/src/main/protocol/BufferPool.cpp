@@ -0,0 +1,86 @@
+#include "protocol/BufferPool.h"
+
+namespace rd
+{
+constexpr size_t BufferPool::MIN_CLASS_CAPACITY;
+constexpr size_t BufferPool::CLASS_COUNT;
+constexpr size_t BufferPool::MAX_CLASS_CAPACITY;
+constexpr size_t BufferPool::CLASS_BUDGET;
+
+BufferPool& BufferPool::instance()
+{
+	static BufferPool pool;
+	return pool;
+}
+
+size_t BufferPool::class_for(size_t size)
+{
+	size_t index = 0;
+	size_t capacity = MIN_CLASS_CAPACITY;
+	while (capacity < size && index < CLASS_COUNT)
+	{
+		capacity <<= 1;
+		++index;
+	}
+	return index;
+}
+
+Buffer::ByteArray BufferPool::acquire(size_t size_hint)
+{
+	const size_t index = class_for(size_hint);
+	if (index == CLASS_COUNT)
+	{
+		++misses;
+		return Buffer::ByteArray(size_hint);
+	}
+
+	SizeClass& size_class = classes[index];
+	{
+		std::lock_guard<decltype(size_class.lock)> guard(size_class.lock);
+		if (!size_class.free.empty())
+		{
+			Buffer::ByteArray array = std::move(size_class.free.back());
+			size_class.free.pop_back();
+			++hits;
+			array.resize(array.capacity());
+			return array;
+		}
+	}
+
+	++misses;
+	Buffer::ByteArray array;
+	array.reserve(MIN_CLASS_CAPACITY << index);
+	array.resize(array.capacity());
+	return array;
+}
+
+Buffer BufferPool::acquire_buffer(size_t size_hint)
+{
+	return Buffer(acquire(size_hint));
+}
+
+void BufferPool::release(Buffer::ByteArray&& array)
+{
+	const size_t capacity = array.capacity();
+	const size_t index = class_for(capacity);
+	if (index == CLASS_COUNT || (MIN_CLASS_CAPACITY << index) != capacity)
+	{
+		return;
+	}
+
+	SizeClass& size_class = classes[index];
+	std::lock_guard<decltype(size_class.lock)> guard(size_class.lock);
+	if (size_class.free.size() * capacity < CLASS_BUDGET)
+	{
+		size_class.free.push_back(std::move(array));
+	}
+}
+
+BufferPool::Stats BufferPool::get_stats() const
+{
+	Stats stats;
+	stats.hits = hits.load();
+	stats.misses = misses.load();
+	return stats;
+}
+}	 // namespace rd
@@ -0,0 +1,88 @@
+#ifndef RD_CPP_BUFFERPOOL_H
+#define RD_CPP_BUFFERPOOL_H
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable:4251)
+#endif
+
+#include "protocol/Buffer.h"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include <rd_framework_export.h>
+
+namespace rd
+{
+/**
+ * \brief Thread-safe pool of byte arrays bucketed by power-of-two capacity.
+ * Outgoing messages are written into pooled storage and the storage is returned once the packet is acknowledged,
+ * so steady traffic does not touch the heap.
+ */
+class RD_FRAMEWORK_API BufferPool
+{
+public:
+	/**
+	 * \brief Capacity of the smallest size class; each following class doubles it.
+	 */
+	static constexpr size_t MIN_CLASS_CAPACITY = 64;
+	static constexpr size_t CLASS_COUNT = 11;
+	static constexpr size_t MAX_CLASS_CAPACITY = MIN_CLASS_CAPACITY << (CLASS_COUNT - 1);
+
+	/**
+	 * \brief Bytes of free storage kept per size class; anything beyond is returned to the heap.
+	 */
+	static constexpr size_t CLASS_BUDGET = 1u << 20;
+
+	struct Stats
+	{
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+	};
+
+	static BufferPool& instance();
+
+	/**
+	 * \brief Array with capacity for at least [size_hint] bytes, sized to its full capacity so a Buffer can write into it.
+	 * Hints above [MAX_CLASS_CAPACITY] get a fresh allocation of exactly that size.
+	 */
+	Buffer::ByteArray acquire(size_t size_hint);
+
+	/**
+	 * \brief Buffer positioned at zero over pooled storage for at least [size_hint] bytes.
+	 */
+	Buffer acquire_buffer(size_t size_hint);
+
+	/**
+	 * \brief Gives storage back. Arrays whose capacity is not an exact size class are dropped.
+	 */
+	void release(Buffer::ByteArray&& array);
+
+	Stats get_stats() const;
+
+private:
+	struct SizeClass
+	{
+		std::mutex lock;
+		std::vector<Buffer::ByteArray> free;
+	};
+
+	/**
+	 * \brief Index of the smallest class holding [size] bytes, or CLASS_COUNT if there is none.
+	 */
+	static size_t class_for(size_t size);
+
+	std::array<SizeClass, CLASS_COUNT> classes;
+
+	std::atomic<uint64_t> hits{0};
+	std::atomic<uint64_t> misses{0};
+};
+}	 // namespace rd
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+#endif	  // RD_CPP_BUFFERPOOL_H
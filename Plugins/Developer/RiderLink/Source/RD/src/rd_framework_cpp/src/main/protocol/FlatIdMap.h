@@ -0,0 +1,117 @@
+#ifndef RD_CPP_FLATIDMAP_H
+#define RD_CPP_FLATIDMAP_H
+
+#include "protocol/RdId.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace rd
+{
+/**
+ * \brief Open-addressing hash map from RdId to [V] with linear probing in one array, for lookups on the hot path of
+ * every received message. Erasing shifts the following entries back, so there are no tombstones and a miss stops at
+ * the first empty slot. The null id marks empty slots and can't be a key. Not thread-safe.
+ */
+template <typename V>
+class FlatIdMap
+{
+	static constexpr RdId::hash_t EMPTY = RdId::Null().get_hash();
+
+	struct Slot
+	{
+		RdId::hash_t key = EMPTY;
+		V value{};
+	};
+
+	static constexpr size_t MIN_CAPACITY = 64;
+
+	std::vector<Slot> slots = std::vector<Slot>(MIN_CAPACITY);
+	size_t mask = MIN_CAPACITY - 1;
+	size_t count = 0;
+
+	size_t home_of(RdId::hash_t key) const
+	{
+		// static ids are small consecutive numbers, so spread them with a Fibonacci multiplier
+		return static_cast<size_t>((static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+	}
+
+	size_t find_slot(RdId::hash_t key) const
+	{
+		size_t index = home_of(key);
+		while (slots[index].key != EMPTY && slots[index].key != key)
+		{
+			index = (index + 1) & mask;
+		}
+		return index;
+	}
+
+	void grow()
+	{
+		std::vector<Slot> old(slots.size() * 2);
+		old.swap(slots);
+		mask = slots.size() - 1;
+		for (auto& slot : old)
+		{
+			if (slot.key != EMPTY)
+			{
+				slots[find_slot(slot.key)] = std::move(slot);
+			}
+		}
+	}
+
+public:
+	V const* find(RdId const& id) const
+	{
+		Slot const& slot = slots[find_slot(id.get_hash())];
+		return slot.key == EMPTY ? nullptr : &slot.value;
+	}
+
+	void insert_or_assign(RdId const& id, V value)
+	{
+		// at most half full, so probe sequences stay short
+		if ((count + 1) * 2 > slots.size())
+		{
+			grow();
+		}
+		Slot& slot = slots[find_slot(id.get_hash())];
+		if (slot.key == EMPTY)
+		{
+			slot.key = id.get_hash();
+			++count;
+		}
+		slot.value = std::move(value);
+	}
+
+	bool erase(RdId const& id)
+	{
+		size_t hole = find_slot(id.get_hash());
+		if (slots[hole].key == EMPTY)
+		{
+			return false;
+		}
+		// moves back every following entry of the run that may not stay behind the hole
+		for (size_t index = (hole + 1) & mask; slots[index].key != EMPTY; index = (index + 1) & mask)
+		{
+			const size_t home = home_of(slots[index].key);
+			const bool reachable_from_hole = ((index - home) & mask) >= ((index - hole) & mask);
+			if (reachable_from_hole)
+			{
+				slots[hole] = std::move(slots[index]);
+				hole = index;
+			}
+		}
+		slots[hole] = Slot{};
+		--count;
+		return true;
+	}
+
+	size_t size() const
+	{
+		return count;
+	}
+};
+}	 // namespace rd
+
+#endif	  // RD_CPP_FLATIDMAP_H
@@ -1,6 +1,7 @@
 #include "protocol/MessageBroker.h"
 
 #include "base/RdReactiveBase.h"
+#include "util/logging.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 
 namespace rd
@@ -10,122 +11,303 @@ std::shared_ptr<spdlog::logger> MessageBroker::logger =
 
 static void execute(const IRdReactive* that, Buffer msg)
 {
-	msg.read_integral<int16_t>();	   // skip context
+	if (msg.get_format() == WireFormat::V1)
+	{
+		msg.read_integral<int16_t>();	   // skip context, V2 messages carry none
+	}
 	that->on_wire_received(std::move(msg));
 }
 
-void MessageBroker::invoke(const RdReactiveBase* that, Buffer msg, bool sync) const
+class MessageBroker::Deliveries
 {
-	if (sync)
+	struct Node
 	{
-		execute(that, std::move(msg));
+		Node* next = nullptr;
+		RdId id;
+		RdReactiveBase const* entity = nullptr;
+		optional<Buffer> message;
+	};
+
+	// nodes kept for reuse; a burst beyond that goes back to the heap
+	static constexpr size_t MAX_FREE_NODES = 1024;
+
+	MessageBroker const& broker;
+
+	std::mutex lock;
+	Node* head = nullptr;
+	Node* tail = nullptr;
+	bool scheduled = false;
+	Node* free_nodes = nullptr;
+	size_t free_count = 0;
+
+	static void delete_all(Node* node)
+	{
+		while (node != nullptr)
+		{
+			Node* next = node->next;
+			delete node;
+			node = next;
+		}
+	}
+
+	void deliver(RdId const& id, RdReactiveBase const* entity, Buffer message) const
+	{
+		// the entity may be gone by now, so it is only touched while it is still subscribed
+		if (!broker.is_subscribed(id, entity))
+		{
+			RD_LOG_TRACE(logger, "Disappeared Handler for Reactive entities with id: {}", to_string(id));
+			return;
+		}
+		try
+		{
+			execute(entity, std::move(message));
+		}
+		catch (std::exception const& e)
+		{
+			RD_LOG_ERROR(logger, "Handler for id {} failed: {}", to_string(id), e.what());
+		}
 	}
-	else
+
+	void drain()
 	{
-		auto action = [this, that, message = std::move(msg)]() mutable {
-			bool exists_id = false;
+		Node* batch = nullptr;
+		{
+			std::lock_guard<decltype(lock)> guard(lock);
+			batch = head;
+			head = tail = nullptr;
+			scheduled = false;
+		}
+
+		Node* last = nullptr;
+		size_t count = 0;
+		for (Node* node = batch; node != nullptr; node = node->next)
+		{
+			deliver(node->id, node->entity, *std::move(node->message));
+			node->message.reset();
+			last = node;
+			++count;
+		}
+		if (batch == nullptr)
+		{
+			return;
+		}
+
+		std::lock_guard<decltype(lock)> guard(lock);
+		if (free_count + count <= MAX_FREE_NODES)
+		{
+			last->next = free_nodes;
+			free_nodes = batch;
+			free_count += count;
+		}
+		else
+		{
+			delete_all(batch);
+		}
+	}
+
+public:
+	IScheduler* const scheduler;
+
+	Deliveries(MessageBroker const& broker, IScheduler* scheduler) : broker(broker), scheduler(scheduler)
+	{
+	}
+
+	Deliveries(Deliveries const&) = delete;
+
+	Deliveries& operator=(Deliveries const&) = delete;
+
+	~Deliveries()
+	{
+		delete_all(head);
+		delete_all(free_nodes);
+	}
+
+	void push(RdId const& id, RdReactiveBase const* entity, Buffer message)
+	{
+		if (scheduler->out_of_order_execution)
+		{
+			// a task per message, which a parallel scheduler may run alongside the others
+			scheduler->queue([this, id, entity, message = std::move(message)]() mutable { deliver(id, entity, std::move(message)); });
+			return;
+		}
+
+		bool schedule = false;
+		{
+			std::lock_guard<decltype(lock)> guard(lock);
+			Node* node = free_nodes;
+			if (node != nullptr)
 			{
-				std::lock_guard<decltype(lock)> guard(lock);
-				exists_id = subscriptions.count(that->get_id()) > 0;
+				free_nodes = node->next;
+				--free_count;
+				node->next = nullptr;
 			}
-			if (exists_id)
+			else
 			{
-				execute(that, std::move(message));
+				node = new Node();
+			}
+			node->id = id;
+			node->entity = entity;
+			node->message.emplace(std::move(message));
+
+			if (tail != nullptr)
+			{
+				tail->next = node;
 			}
 			else
 			{
-				logger->trace("Disappeared Handler for Reactive entities with id: {}", to_string(that->get_id()));
+				head = node;
 			}
-		};
-		std::function<void()> function = util::make_shared_function(std::move(action));
-		that->get_wire_scheduler()->queue(std::move(function));
+			tail = node;
+			schedule = !scheduled;
+			scheduled = true;
+		}
+		if (schedule)
+		{
+			scheduler->queue([this] { drain(); });
+		}
 	}
-}
+};
 
 MessageBroker::MessageBroker(IScheduler* defaultScheduler) : default_scheduler(defaultScheduler)
 {
 }
 
-void MessageBroker::dispatch(RdId id, Buffer message) const
-{
-	RD_ASSERT_MSG(!id.isNull(), "id mustn't be null")
+MessageBroker::~MessageBroker() = default;
 
-	{	 // synchronized recursively
-		std::lock_guard<decltype(lock)> guard(lock);
-		RdReactiveBase const* s = subscriptions[id];
-		if (s == nullptr)
-		{
-			auto it = broker.find(id);
-			if (it == broker.end())
-			{
-				it = broker.emplace(id, Mq{}).first;
-			}
+bool MessageBroker::find_subscription(RdId const& id, Subscription& result) const
+{
+	std::shared_lock<decltype(subscriptions_lock)> guard(subscriptions_lock);
+	Subscription const* subscription = subscriptions.find(id);
+	if (subscription == nullptr)
+	{
+		return false;
+	}
+	result = *subscription;
+	return true;
+}
 
-			broker[id].default_scheduler_messages.emplace(std::move(message));
+bool MessageBroker::is_subscribed(RdId const& id, RdReactiveBase const* entity) const
+{
+	Subscription subscription;
+	return find_subscription(id, subscription) && subscription.entity == entity;
+}
 
-			auto action = [this, it, id]() mutable {
-				auto& current = it->second;
-				RdReactiveBase const* subscription = subscriptions[id];
+void MessageBroker::deliver_queued(RdId const& id) const
+{
+	std::unique_lock<decltype(queued_lock)> guard(queued_lock);
+	auto it = broker.find(id);
+	if (it == broker.end())
+	{
+		return;
+	}
+	Mq& current = it->second;
+	optional<Buffer> message;
+	if (!current.default_scheduler_messages.empty())
+	{
+		message = make_optional<Buffer>(std::move(current.default_scheduler_messages.front()));
+		current.default_scheduler_messages.pop();
+	}
+	std::vector<Buffer> waiting;
+	const bool drained = current.default_scheduler_messages.empty();
+	if (drained)
+	{
+		waiting = std::move(current.custom_scheduler_messages);
+		broker.erase(it);
+	}
 
-				optional<Buffer> message;
-				{
-					std::lock_guard<decltype(lock)> guard(lock);
-					if (!current.default_scheduler_messages.empty())
-					{
-						message = make_optional<Buffer>(std::move(current.default_scheduler_messages.front()));
-						current.default_scheduler_messages.pop();
-					}
-				}
-				if (subscription != nullptr)
-				{
-					if (message)
-					{
-						invoke(subscription, *std::move(message), subscription->get_wire_scheduler() == default_scheduler);
-					}
-				}
-				else
-				{
-					logger->trace("No handler for id: {}", to_string(id));
-				}
+	Subscription subscription;
+	const bool subscribed = find_subscription(id, subscription);
+	if (subscribed && subscription.deliveries->scheduler != default_scheduler)
+	{
+		// pushed under the lock, so that dispatch can't deliver a newer message in between
+		if (message)
+		{
+			subscription.deliveries->push(id, subscription.entity, *std::move(message));
+		}
+		for (auto& waiting_message : waiting)
+		{
+			subscription.deliveries->push(id, subscription.entity, std::move(waiting_message));
+		}
+	}
+	if (drained)
+	{
+		// only now dispatch may skip the lock, the messages of the queue are all on their way
+		queued_ids.fetch_sub(1, std::memory_order_release);
+	}
+	guard.unlock();
 
-				if (current.default_scheduler_messages.empty())
-				{
-					auto t = std::move(broker[id]);
-					broker.erase(id);
-					for (auto& it : t.custom_scheduler_messages)
-					{
-						RD_ASSERT_MSG(subscription->get_wire_scheduler() != default_scheduler,
-							"require equals of wire and default schedulers")
-						invoke(subscription, std::move(it));
-					}
-				}
-			};
-			std::function<void()> function = util::make_shared_function(std::move(action));
-			default_scheduler->queue(std::move(function));
+	if (!subscribed)
+	{
+		RD_LOG_TRACE(logger, "No handler for id: {}", to_string(id));
+		return;
+	}
+	if (subscription.deliveries->scheduler != default_scheduler)
+	{
+		return;
+	}
+	// later messages for a default scheduler subscription are queued on it behind this task, so they stay in order.
+	// [waiting] is not empty if the entity was advised again on the default scheduler while they were held back
+	auto deliver = [this, &id, &subscription](Buffer next) {
+		try
+		{
+			execute(subscription.entity, std::move(next));
 		}
-		else
+		catch (std::exception const& e)
 		{
-			if (s->get_wire_scheduler() == default_scheduler || s->get_wire_scheduler()->out_of_order_execution)
-			{
-				invoke(s, std::move(message));
-			}
-			else
+			RD_LOG_ERROR(logger, "Handler for id {} failed: {}", to_string(id), e.what());
+		}
+	};
+	if (message)
+	{
+		deliver(*std::move(message));
+	}
+	for (auto& waiting_message : waiting)
+	{
+		deliver(std::move(waiting_message));
+	}
+}
+
+void MessageBroker::dispatch(RdId id, Buffer message) const
+{
+	RD_ASSERT_MSG(!id.isNull(), "id mustn't be null")
+
+	Subscription subscription;
+	if (find_subscription(id, subscription))
+	{
+		IScheduler* scheduler = subscription.deliveries->scheduler;
+		if (!scheduler->out_of_order_execution && queued_ids.load(std::memory_order_acquire) != 0)
+		{
+			std::unique_lock<decltype(queued_lock)> guard(queued_lock);
+			auto it = broker.find(id);
+			if (it != broker.end())
 			{
-				auto it = broker.find(id);
-				if (it == broker.end())
+				// behind the messages that came before the entity was advised
+				if (scheduler != default_scheduler)
 				{
-					invoke(s, std::move(message));
-				}
-				else
-				{
-					Mq& mq = it->second;
-					mq.custom_scheduler_messages.push_back(std::move(message));
+					it->second.custom_scheduler_messages.push_back(std::move(message));
+					return;
 				}
+				it->second.default_scheduler_messages.emplace(std::move(message));
+				guard.unlock();
+				default_scheduler->queue([this, id] { deliver_queued(id); });
+				return;
 			}
 		}
+		subscription.deliveries->push(id, subscription.entity, std::move(message));
+		return;
 	}
 
-	//        }
+	{
+		std::lock_guard<decltype(queued_lock)> guard(queued_lock);
+		auto it = broker.find(id);
+		if (it == broker.end())
+		{
+			it = broker.emplace(id, Mq{}).first;
+			queued_ids.fetch_add(1, std::memory_order_release);
+		}
+		it->second.default_scheduler_messages.emplace(std::move(message));
+	}
+	default_scheduler->queue([this, id] { deliver_queued(id); });
 }
 
 void MessageBroker::advise_on(Lifetime lifetime, RdReactiveBase const* entity) const
@@ -135,12 +317,37 @@ void MessageBroker::advise_on(Lifetime lifetime, RdReactiveBase const* entity) c
 	// advise MUST happen under default scheduler, not custom
 	default_scheduler->assert_thread();
 
-	std::lock_guard<decltype(lock)> guard(lock);
-	if (!lifetime->is_terminated())
+	if (lifetime->is_terminated())
+	{
+		return;
+	}
+	auto key = entity->get_id();
+	IScheduler* scheduler = entity->get_wire_scheduler();
 	{
-		auto key = entity->get_id();
-		subscriptions[key] = entity;
-		lifetime->add_action([this, key]() { subscriptions.erase(key); });
+		std::unique_lock<decltype(subscriptions_lock)> guard(subscriptions_lock);
+		Deliveries* target = nullptr;
+		for (auto const& it : deliveries)
+		{
+			if (it->scheduler == scheduler)
+			{
+				target = it.get();
+			}
+		}
+		if (target == nullptr)
+		{
+			deliveries.push_back(std::make_unique<Deliveries>(*this, scheduler));
+			target = deliveries.back().get();
+		}
+		subscriptions.insert_or_assign(key, Subscription{entity, target});
 	}
+	lifetime->add_action([this, key, entity]() {
+		std::unique_lock<decltype(subscriptions_lock)> guard(subscriptions_lock);
+		// the id may have been advised again by another entity since
+		Subscription const* subscription = subscriptions.find(key);
+		if (subscription != nullptr && subscription->entity == entity)
+		{
+			subscriptions.erase(key);
+		}
+	});
 }
 }	 // namespace rd
@@ -7,12 +7,18 @@
 #endif
 
 #include "base/IRdReactive.h"
+#include "protocol/FlatIdMap.h"
 
 #include "std/unordered_map.h"
 
 #include "spdlog/spdlog.h"
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <queue>
+#include <shared_mutex>
+#include <vector>
 
 #include <rd_framework_export.h>
 
@@ -43,20 +49,57 @@ public:
 class RD_FRAMEWORK_API MessageBroker final
 {
 private:
+	/**
+	 * \brief Messages on their way to the entities of one wire scheduler. One task on the scheduler delivers all that
+	 * were queued until it runs, and the nodes carrying them are reused.
+	 */
+	class Deliveries;
+
+	struct Subscription
+	{
+		RdReactiveBase const* entity = nullptr;
+		Deliveries* deliveries = nullptr;
+	};
+
 	IScheduler* default_scheduler = nullptr;
-	mutable rd::unordered_map<RdId, RdReactiveBase const*> subscriptions;
-	mutable rd::unordered_map<RdId, Mq> broker;
 
-	mutable std::recursive_mutex lock;
+	// read on every message, written only when entities are advised or go away
+	mutable std::shared_mutex subscriptions_lock;
+	mutable FlatIdMap<Subscription> subscriptions;
+	// one per wire scheduler, under [subscriptions_lock]
+	mutable std::vector<std::unique_ptr<Deliveries>> deliveries;
+
+	/**
+	 * \brief Messages that came before their entity was advised, delivered in order on the default scheduler. Messages
+	 * for the same id and a custom scheduler that come meanwhile wait behind them.
+	 */
+	mutable std::recursive_mutex queued_lock;
+	mutable rd::unordered_map<RdId, Mq> broker;
+	// size of [broker], so that dispatch only takes [queued_lock] while something is queued
+	mutable std::atomic<size_t> queued_ids{0};
 
 	static std::shared_ptr<spdlog::logger> logger;
 
-	void invoke(const RdReactiveBase* that, Buffer msg, bool sync = false) const;
+	bool find_subscription(RdId const& id, Subscription& result) const;
+
+	bool is_subscribed(RdId const& id, RdReactiveBase const* entity) const;
+
+	/**
+	 * \brief Delivers the oldest message queued for [id] on the default scheduler, and the ones waiting behind the queue
+	 * once it is empty.
+	 */
+	void deliver_queued(RdId const& id) const;
 
 public:
 	// region ctor/dtor
 
 	explicit MessageBroker(IScheduler* defaultScheduler);
+
+	MessageBroker(MessageBroker const&) = delete;
+
+	MessageBroker& operator=(MessageBroker const&) = delete;
+
+	~MessageBroker();
 	// endregion
 
 	void dispatch(RdId id, Buffer message) const;
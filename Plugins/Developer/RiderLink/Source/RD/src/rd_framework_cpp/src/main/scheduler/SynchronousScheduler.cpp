@@ -6,7 +6,7 @@ namespace rd
 {
 static thread_local int32_t SynchronousScheduler_active_count = 0;
 
-void SynchronousScheduler::queue(std::function<void()> action)
+void SynchronousScheduler::queue(util::unique_function<void()> action)
 {
 	util::increment_guard<int32_t> guard(SynchronousScheduler_active_count);
 	action();
@@ -0,0 +1,247 @@
+#include "WorkStealingScheduler.h"
+
+#include "util/core_util.h"
+#include "util/logging.h"
+
+#include "spdlog/include/spdlog/sinks/stdout_color_sinks.h"
+
+#include <algorithm>
+#include <deque>
+#include <thread>
+
+namespace rd
+{
+struct WorkStealingScheduler::Worker
+{
+	size_t index = 0;
+	std::mutex lock;
+	std::deque<util::unique_function<void()>> actions;
+	std::thread thread;
+};
+
+// the pool the current thread is a worker of
+static thread_local WorkStealingScheduler const* current_scheduler = nullptr;
+static thread_local size_t current_worker = 0;
+
+static constexpr int FLUSH_YIELDS = 16;
+
+WorkStealingScheduler::WorkStealingScheduler(Lifetime lifetime, std::string name, size_t worker_count)
+	: log(spdlog::stderr_color_mt<spdlog::synchronous_factory>(name, spdlog::color_mode::automatic))
+	, name(std::move(name))
+	, lifetime(lifetime)
+{
+	out_of_order_execution = true;
+
+	if (worker_count == 0)
+	{
+		worker_count = (std::max)(std::thread::hardware_concurrency(), 1u);
+	}
+	workers.reserve(worker_count);
+	for (size_t i = 0; i < worker_count; ++i)
+	{
+		workers.push_back(std::make_unique<Worker>());
+		workers.back()->index = i;
+	}
+	// registered first, a terminated lifetime throws before there are threads to join
+	termination_action = lifetime->add_action([this]() {
+		try
+		{
+			stop();
+		}
+		catch (std::exception const& e)
+		{
+			(void)e;
+			RD_LOG_ERROR(log, "Failed to terminate {}", this->name);
+		}
+	});
+
+	running_workers = worker_count;
+	// started once all the deques are there to steal from
+	for (auto& worker : workers)
+	{
+		worker->thread = std::thread([this, target = worker.get()] { run(*target); });
+	}
+}
+
+bool WorkStealingScheduler::take(Worker& worker, util::unique_function<void()>& action)
+{
+	{
+		std::lock_guard<decltype(worker.lock)> guard(worker.lock);
+		if (!worker.actions.empty())
+		{
+			action = std::move(worker.actions.back());
+			worker.actions.pop_back();
+			available.fetch_sub(1);
+			return true;
+		}
+	}
+	for (size_t i = 1; i < workers.size() && available.load() != 0; ++i)
+	{
+		Worker& victim = *workers[(worker.index + i) % workers.size()];
+		std::lock_guard<decltype(victim.lock)> guard(victim.lock);
+		if (!victim.actions.empty())
+		{
+			action = std::move(victim.actions.front());
+			victim.actions.pop_front();
+			available.fetch_sub(1);
+			return true;
+		}
+	}
+	return false;
+}
+
+void WorkStealingScheduler::run(Worker& worker)
+{
+	current_scheduler = this;
+	current_worker = worker.index;
+
+	util::unique_function<void()> action;
+	while (true)
+	{
+		if (take(worker, action))
+		{
+			try
+			{
+				action();
+			}
+			catch (std::exception const& e)
+			{
+				if (current_scheduler != nullptr)
+				{
+					RD_LOG_ERROR(log, "Background task failed, scheduler={}, worker={} | {}", name, worker.index, e.what());
+				}
+			}
+			if (current_scheduler == nullptr)
+			{
+				// the action destroyed the scheduler, none of its members may be touched anymore
+				return;
+			}
+			action = nullptr;
+
+			// a flush waits for all of them, so only the last one wakes it
+			const uint64_t done = executed.fetch_add(1) + 1;
+			if (flush_waiters.load() != 0 && done == queued.load())
+			{
+				std::lock_guard<decltype(lock)> guard(lock);
+				drained.notify_all();
+			}
+			continue;
+		}
+
+		std::unique_lock<decltype(lock)> guard(lock);
+		if (stopping.load() && available.load() == 0)
+		{
+			break;
+		}
+		// seen by a producer that makes its action available after this, or the wait below sees the action
+		sleeping.fetch_add(1);
+		wake.wait(guard, [this] { return available.load() != 0 || stopping.load(); });
+		sleeping.fetch_sub(1);
+	}
+
+	std::lock_guard<decltype(lock)> guard(lock);
+	--running_workers;
+	drained.notify_all();
+}
+
+void WorkStealingScheduler::stop()
+{
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		stopping.store(true);
+	}
+	wake.notify_all();
+	for (auto& worker : workers)
+	{
+		if (worker->thread.joinable() && worker->thread.get_id() != std::this_thread::get_id())
+		{
+			worker->thread.join();
+		}
+	}
+}
+
+void WorkStealingScheduler::queue(util::unique_function<void()> action)
+{
+	if (stopping.load(std::memory_order_acquire))
+	{
+		RD_LOG_DEBUG(log, "Action queued after {} has stopped is dropped", name);
+		return;
+	}
+
+	queued.fetch_add(1);
+	if (current_scheduler == this)
+	{
+		Worker& own = *workers[current_worker];
+		std::lock_guard<decltype(own.lock)> guard(own.lock);
+		// counted before it can be taken, so [available] never drops below the actions left in the deques
+		available.fetch_add(1);
+		own.actions.push_back(std::move(action));
+	}
+	else
+	{
+		Worker& target = *workers[next_worker.fetch_add(1, std::memory_order_relaxed) % workers.size()];
+		std::lock_guard<decltype(target.lock)> guard(target.lock);
+		available.fetch_add(1);
+		target.actions.push_front(std::move(action));
+	}
+
+	if (sleeping.load() != 0)
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		wake.notify_one();
+	}
+}
+
+void WorkStealingScheduler::flush()
+{
+	RD_ASSERT_MSG(!is_active(), "Can't flush this scheduler in a reentrant way: we are inside queued item's execution");
+
+	for (int i = 0; i < FLUSH_YIELDS; ++i)
+	{
+		if (executed.load() == queued.load())
+		{
+			return;
+		}
+		std::this_thread::yield();
+	}
+
+	std::unique_lock<decltype(lock)> guard(lock);
+	flush_waiters.fetch_add(1);
+	// stopped workers may leave behind what was queued after they had looked for the last time
+	drained.wait(guard, [this] { return executed.load() == queued.load() || running_workers == 0; });
+	flush_waiters.fetch_sub(1);
+}
+
+bool WorkStealingScheduler::is_active() const
+{
+	return current_scheduler == this;
+}
+
+void WorkStealingScheduler::assert_thread() const
+{
+	if (!is_active())
+	{
+		RD_LOG_ERROR(log, "Illegal scheduler for current action. Must be a worker of {}, was {}", name, to_string(std::this_thread::get_id()));
+	}
+}
+
+size_t WorkStealingScheduler::get_worker_count() const
+{
+	return workers.size();
+}
+
+WorkStealingScheduler::~WorkStealingScheduler()
+{
+	lifetime->remove_action(termination_action);
+	// joins every worker but the current one, which runs what is left in the deques first
+	stop();
+	if (is_active())
+	{
+		// destroyed by one of its own actions: the worker leaves its loop once the action returns, without touching
+		// the scheduler again
+		RD_LOG_DEBUG(log, "Scheduler {} is destroyed on its worker {}", name, current_worker);
+		workers[current_worker]->thread.detach();
+		current_scheduler = nullptr;
+	}
+}
+}	 // namespace rd
@@ -0,0 +1,98 @@
+#ifndef RD_CPP_WORKSTEALINGSCHEDULER_H
+#define RD_CPP_WORKSTEALINGSCHEDULER_H
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable:4251)
+#endif
+
+#include "scheduler/base/IScheduler.h"
+#include "lifetime/Lifetime.h"
+#include "spdlog/spdlog.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <rd_framework_export.h>
+
+namespace rd
+{
+/**
+ * \brief Runs the queued actions in parallel on a pool of worker threads, in no particular order. Every worker has a
+ * deque of its own: what a worker queues itself goes to its back and is taken from there first, what comes from other
+ * threads is spread over the fronts, and a worker that runs out steals from the front of another's deque.
+ *
+ * An entity whose wire scheduler this is gets its messages handled concurrently, so its handler must be thread-safe.
+ * The workers stop with [lifetime] after running what is queued.
+ */
+class RD_FRAMEWORK_API WorkStealingScheduler : public IScheduler
+{
+	struct Worker;
+
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::atomic<size_t> next_worker{0};
+
+	std::atomic<uint64_t> queued{0};
+	std::atomic<uint64_t> executed{0};
+	// actions in the deques, not taken by a worker yet
+	std::atomic<uint64_t> available{0};
+
+	std::mutex lock;
+	std::condition_variable wake;
+	std::condition_variable drained;
+	std::atomic<uint32_t> sleeping{0};
+	std::atomic<uint32_t> flush_waiters{0};
+	std::atomic<bool> stopping{false};
+	// guarded by [lock]
+	size_t running_workers = 0;
+
+	std::shared_ptr<spdlog::logger> log;
+	std::string name;
+	LifetimeImpl::counter_t termination_action = 0;
+
+	void run(Worker& worker);
+
+	bool take(Worker& worker, util::unique_function<void()>& action);
+
+	void stop();
+
+public:
+	Lifetime lifetime;
+
+	// region ctor/dtor
+
+	/**
+	 * \param worker_count threads of the pool, the number of hardware threads if 0.
+	 */
+	WorkStealingScheduler(Lifetime lifetime, std::string name, size_t worker_count = 0);
+
+	virtual ~WorkStealingScheduler();
+	// endregion
+
+	void queue(util::unique_function<void()> action) override;
+
+	/**
+	 * \brief Waits until the workers have run every queued action, including those they queue in turn.
+	 */
+	void flush() override;
+
+	/**
+	 * \brief Whether the current thread is one of the workers. There is no single thread, so get_thread_id() doesn't
+	 * apply.
+	 */
+	bool is_active() const override;
+
+	void assert_thread() const override;
+
+	size_t get_worker_count() const;
+};
+}	 // namespace rd
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+#endif	  // RD_CPP_WORKSTEALINGSCHEDULER_H
@@ -2,7 +2,6 @@
 
 #include "spdlog/spdlog.h"
 
-#include <functional>
 #include <sstream>
 
 namespace rd
@@ -17,7 +16,7 @@ void IScheduler::assert_thread() const
 	}
 }
 
-void IScheduler::invoke_or_queue(std::function<void()> action)
+void IScheduler::invoke_or_queue(util::unique_function<void()> action)
 {
 	if (is_active())
 	{
@@ -25,7 +24,7 @@ void IScheduler::invoke_or_queue(std::function<void()> action)
 	}
 	else
 	{
-		queue(action);
+		queue(std::move(action));
 	}
 }
 }	 // namespace rd
@@ -6,7 +6,8 @@
 #pragma warning(disable:4251)
 #endif
 
-#include <functional>
+#include "util/unique_function.h"
+
 #include <thread>
 
 #include <rd_framework_export.h>
@@ -30,13 +31,16 @@ public:
 	// endregion
 
 	/**
-	 * \brief Queues the execution of the given [action].
+	 * \brief Queues the execution of the given [action]. It may be move-only; a std::function converts as well.
 	 *
 	 * \param action to be queued.
 	 */
-	virtual void queue(std::function<void()> action) = 0;
+	virtual void queue(util::unique_function<void()> action) = 0;
 
-	// TO-DO
+	/**
+	 * \brief Whether queued actions may run in any order, even at the same time. MessageBroker then queues every
+	 * message on its own instead of a batch.
+	 */
 	bool out_of_order_execution = false;
 
 	virtual void assert_thread() const;
@@ -45,7 +49,7 @@ public:
 	 * \brief invoke action immediately if scheduler is active, queue it otherwise.
 	 * \param action to be invoked
 	 */
-	virtual void invoke_or_queue(std::function<void()> action);
+	virtual void invoke_or_queue(util::unique_function<void()> action);
 
 	virtual void flush() = 0;
 
@@ -1,55 +1,224 @@
 #include "SingleThreadSchedulerBase.h"
 
 #include "util/core_util.h"
+#include "util/logging.h"
 
-#include "ctpl_stl.h"
 #include "spdlog/include/spdlog/sinks/stdout_color_sinks.h"
 
+#include <chrono>
+
 namespace rd
 {
-SingleThreadSchedulerBase::PoolTask::PoolTask(std::function<void()> f, SingleThreadSchedulerBase* scheduler)
-	: f(std::move(f)), scheduler(scheduler)
+struct SingleThreadSchedulerBase::Task
+{
+	std::atomic<Task*> next{nullptr};
+	util::unique_function<void()> action;
+	std::chrono::steady_clock::time_point queued_at;
+};
+
+constexpr size_t SingleThreadSchedulerBase::LATENCY_BUCKETS;
+
+static constexpr int FLUSH_YIELDS = 16;
+
+// set on the scheduler thread when one of its actions destroys the scheduler
+static thread_local bool scheduler_destroyed = false;
+
+static size_t latency_bucket(std::chrono::steady_clock::duration latency)
+{
+	size_t bucket = 0;
+	for (auto rest = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+		 rest > 0 && bucket + 1 < SingleThreadSchedulerBase::LATENCY_BUCKETS; rest >>= 1)
+	{
+		++bucket;
+	}
+	return bucket;
+}
+
+SingleThreadSchedulerBase::SingleThreadSchedulerBase(std::string name)
+	: stub(std::make_unique<Task>())
+	, log(spdlog::stderr_color_mt<spdlog::synchronous_factory>(name, spdlog::color_mode::automatic))
+	, name(std::move(name))
+{
+	head.store(stub.get());
+	tail = stub.get();
+	thread = std::thread([this] { run(); });
+	thread_id = thread.get_id();
+}
+
+void SingleThreadSchedulerBase::push(Task* task)
 {
+	Task* previous = head.exchange(task, std::memory_order_acq_rel);
+	previous->next.store(task, std::memory_order_release);
 }
 
-void SingleThreadSchedulerBase::PoolTask::operator()(int id) const
+SingleThreadSchedulerBase::Task* SingleThreadSchedulerBase::pop()
 {
-	try
+	Task* first = tail;
+	Task* next = first->next.load(std::memory_order_acquire);
+	if (first == stub.get())
 	{
-		f();
-		--scheduler->tasks_executing;
+		if (next == nullptr)
+		{
+			return nullptr;
+		}
+		tail = next;
+		first = next;
+		next = next->next.load(std::memory_order_acquire);
 	}
-	catch (std::exception const& e)
+	if (next != nullptr)
 	{
-		scheduler->log->error("Background task failed, scheduler={}, thread_id={} | {}", scheduler->name, id, e.what());
-		--scheduler->tasks_executing;
+		tail = next;
+		return first;
 	}
+	if (first != head.load(std::memory_order_acquire))
+	{
+		// a producer has taken its place but not linked it yet
+		return nullptr;
+	}
+	// the last task can only be taken with another node behind it
+	stub->next.store(nullptr, std::memory_order_relaxed);
+	push(stub.get());
+	next = first->next.load(std::memory_order_acquire);
+	if (next != nullptr)
+	{
+		tail = next;
+		return first;
+	}
+	return nullptr;
 }
 
-SingleThreadSchedulerBase::SingleThreadSchedulerBase(std::string name)
-	: log(spdlog::stderr_color_mt<spdlog::synchronous_factory>(name, spdlog::color_mode::automatic))
-	, name(std::move(name))
-	, pool(std::make_unique<ctpl::thread_pool>(1))
+uint64_t SingleThreadSchedulerBase::run_batch()
 {
-	RD_ASSERT_THROW_MSG(pool->size() == 1, "Thread pool wasn't properly initalized");
-	thread_id = pool->get_thread(0).get_id();
+	uint64_t count = 0;
+	auto started = std::chrono::steady_clock::now();
+	while (Task* task = pop())
+	{
+		wait_latency[latency_bucket(started - task->queued_at)].fetch_add(1, std::memory_order_relaxed);
+		try
+		{
+			task->action();
+		}
+		catch (std::exception const& e)
+		{
+			if (!scheduler_destroyed)
+			{
+				RD_LOG_ERROR(log, "Background task failed, scheduler={} | {}", name, e.what());
+			}
+		}
+		if (scheduler_destroyed)
+		{
+			// the action destroyed the scheduler, none of its members may be touched anymore
+			delete task;
+			return count;
+		}
+		const auto ended = std::chrono::steady_clock::now();
+		run_latency[latency_bucket(ended - started)].fetch_add(1, std::memory_order_relaxed);
+		started = ended;
+
+		delete task;
+		executed.fetch_add(1);
+		++count;
+	}
+	if (count != 0 && flush_waiters.load() != 0)
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		drained.notify_all();
+	}
+	return count;
+}
+
+void SingleThreadSchedulerBase::run()
+{
+	while (true)
+	{
+		const uint64_t count = run_batch();
+		if (scheduler_destroyed)
+		{
+			return;
+		}
+		if (count != 0)
+		{
+			continue;
+		}
+		if (queued.load() != executed.load(std::memory_order_relaxed))
+		{
+			// counted, but not linked into the queue yet
+			std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock<decltype(lock)> guard(lock);
+		if (stopping.load())
+		{
+			finished = true;
+			break;
+		}
+		// seen by a producer that has counted its task after this, or the wait below sees the task
+		sleeping.store(true);
+		wake.wait(guard, [this] { return queued.load() != executed.load(std::memory_order_relaxed) || stopping.load(); });
+		sleeping.store(false, std::memory_order_relaxed);
+	}
+	drained.notify_all();
+}
+
+void SingleThreadSchedulerBase::stop()
+{
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		stopping.store(true);
+	}
+	wake.notify_all();
+	if (thread.joinable() && !is_active())
+	{
+		thread.join();
+	}
 }
 
 void SingleThreadSchedulerBase::flush()
 {
 	RD_ASSERT_MSG(!is_active(), "Can't flush this scheduler in a reentrant way: we are inside queued item's execution");
 
-	while (tasks_executing != 0)
+	// a short queue is usually done by the time a few time slices are given away, without sleeping on the lock
+	for (int i = 0; i < FLUSH_YIELDS; ++i)
 	{
+		if (executed.load() == queued.load())
+		{
+			return;
+		}
 		std::this_thread::yield();
 	}
+
+	std::unique_lock<decltype(lock)> guard(lock);
+	flush_waiters.fetch_add(1);
+	// a stopped thread may leave behind what was queued after it had looked for the last time
+	drained.wait(guard, [this] { return executed.load() == queued.load() || finished; });
+	flush_waiters.fetch_sub(1);
 }
 
-void SingleThreadSchedulerBase::queue(std::function<void()> action)
+void SingleThreadSchedulerBase::queue(util::unique_function<void()> action)
 {
-	++tasks_executing;
-	PoolTask task(action, this);
-	pool->push(std::move(task));
+	if (stopping.load(std::memory_order_acquire))
+	{
+		RD_LOG_DEBUG(log, "Action queued after {} has stopped is dropped", name);
+		return;
+	}
+
+	auto* task = new Task();
+	task->action = std::move(action);
+	task->queued_at = std::chrono::steady_clock::now();
+
+	const uint64_t depth = queued.fetch_add(1) + 1 - executed.load(std::memory_order_relaxed);
+	uint64_t max_depth = max_queue_depth.load(std::memory_order_relaxed);
+	while (depth > max_depth && !max_queue_depth.compare_exchange_weak(max_depth, depth, std::memory_order_relaxed))
+	{
+	}
+	push(task);
+
+	if (sleeping.load())
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		wake.notify_one();
+	}
 }
 
 bool SingleThreadSchedulerBase::is_active() const
@@ -57,5 +226,34 @@ bool SingleThreadSchedulerBase::is_active() const
 	return thread_id == std::this_thread::get_id();
 }
 
-SingleThreadSchedulerBase::~SingleThreadSchedulerBase() = default;
-}	 // namespace rd
\ No newline at end of file
+SingleThreadSchedulerBase::Statistics SingleThreadSchedulerBase::get_statistics() const
+{
+	Statistics statistics;
+	statistics.executed = executed.load();
+	statistics.queue_depth = queued.load() - statistics.executed;
+	statistics.max_queue_depth = max_queue_depth.load(std::memory_order_relaxed);
+	for (size_t i = 0; i < LATENCY_BUCKETS; ++i)
+	{
+		statistics.wait_latency[i] = wait_latency[i].load(std::memory_order_relaxed);
+		statistics.run_latency[i] = run_latency[i].load(std::memory_order_relaxed);
+	}
+	return statistics;
+}
+
+SingleThreadSchedulerBase::~SingleThreadSchedulerBase()
+{
+	stop();
+	if (thread.joinable())
+	{
+		// destroyed by one of its own actions: the thread leaves its loop once the action returns, without touching the
+		// scheduler again; what is still queued is dropped below
+		RD_LOG_DEBUG(log, "Scheduler {} is destroyed on its own thread", name);
+		thread.detach();
+		scheduler_destroyed = true;
+	}
+	while (Task* task = pop())
+	{
+		delete task;
+	}
+}
+}	 // namespace rd
@@ -10,37 +10,95 @@
 #include "lifetime/Lifetime.h"
 #include "spdlog/spdlog.h"
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <utility>
 
 #include <rd_framework_export.h>
 
-namespace ctpl
-{
-class thread_pool;
-}
-
 namespace rd
 {
+/**
+ * \brief Runs the queued actions one after another on a thread of its own. Producers hand them over through a lock-free
+ * intrusive queue; the thread drains it in batches and sleeps on a condition variable only once it is empty.
+ */
 class RD_FRAMEWORK_API SingleThreadSchedulerBase : public IScheduler
 {
-protected:
-	std::shared_ptr<spdlog::logger> log;
-	std::string name;
+public:
+	/**
+	 * \brief Bucket 0 of a latency histogram counts what took less than a microsecond, bucket i what took
+	 * [2^(i-1), 2^i) microseconds, and the last one everything longer.
+	 */
+	static constexpr size_t LATENCY_BUCKETS = 24;
 
-	std::atomic_uint32_t tasks_executing{0};
-	std::atomic_uint32_t active{0};
-	std::unique_ptr<ctpl::thread_pool> pool;
+	using histogram_t = std::array<uint64_t, LATENCY_BUCKETS>;
 
-	class PoolTask
+	struct Statistics
 	{
-		std::function<void()> f;
-		SingleThreadSchedulerBase* scheduler;
+		uint64_t executed = 0;
+		/**
+		 * \brief Actions queued but not finished yet, the one running included.
+		 */
+		uint64_t queue_depth = 0;
+		uint64_t max_queue_depth = 0;
+		/**
+		 * \brief Time from queue to the start of the action.
+		 */
+		histogram_t wait_latency{};
+		/**
+		 * \brief Time the action ran.
+		 */
+		histogram_t run_latency{};
+	};
 
-	public:
-		explicit PoolTask(std::function<void()> f, SingleThreadSchedulerBase* scheduler);
+private:
+	struct Task;
 
-		void operator()(int id) const;
-	};
+	// Vyukov's queue: producers exchange [head], only the scheduler thread follows [tail]
+	std::atomic<Task*> head;
+	Task* tail;
+	std::unique_ptr<Task> stub;
+
+	std::atomic<uint64_t> queued{0};
+	std::atomic<uint64_t> executed{0};
+	std::atomic<uint64_t> max_queue_depth{0};
+	std::array<std::atomic<uint64_t>, LATENCY_BUCKETS> wait_latency{};
+	std::array<std::atomic<uint64_t>, LATENCY_BUCKETS> run_latency{};
+
+	std::mutex lock;
+	std::condition_variable wake;
+	std::condition_variable drained;
+	std::atomic<bool> sleeping{false};
+	std::atomic<uint32_t> flush_waiters{0};
+	std::atomic<bool> stopping{false};
+	// guarded by [lock]
+	bool finished = false;
+
+	std::thread thread;
+
+	void push(Task* task);
+
+	Task* pop();
+
+	void run();
+
+	/**
+	 * \brief Runs the tasks there are, returns how many.
+	 */
+	uint64_t run_batch();
+
+protected:
+	std::shared_ptr<spdlog::logger> log;
+	std::string name;
+
+	/**
+	 * \brief Lets the thread run what is already queued and end; later actions are dropped. Waits for it unless called
+	 * from the thread itself.
+	 */
+	void stop();
 
 public:
 	// region ctor/dtor
@@ -49,11 +107,16 @@ public:
 	virtual ~SingleThreadSchedulerBase();
 	// endregion
 
+	/**
+	 * \brief Waits until the thread has run every queued action, including those they queue in turn.
+	 */
 	void flush() override;
 
-	void queue(std::function<void()> action) override;
+	void queue(util::unique_function<void()> action) override;
 
 	bool is_active() const override;
+
+	Statistics get_statistics() const;
 };
 }	 // namespace rd
 #if defined(_MSC_VER)
@@ -0,0 +1,122 @@
+#include "util/logging.h"
+
+#include "util/thread_util.h"
+
+#include "spdlog/sinks/stdout_color_sinks.h"
+
+namespace rd
+{
+namespace util
+{
+std::shared_ptr<spdlog::logger> const& send_logger()
+{
+	static const std::shared_ptr<spdlog::logger> logger =
+		spdlog::stderr_color_mt<spdlog::synchronous_factory>("logSend", spdlog::color_mode::automatic);
+	return logger;
+}
+
+std::shared_ptr<spdlog::logger> const& received_logger()
+{
+	static const std::shared_ptr<spdlog::logger> logger =
+		spdlog::stderr_color_mt<spdlog::synchronous_factory>("logReceived", spdlog::color_mode::automatic);
+	return logger;
+}
+
+// registered at startup like the other RD loggers, so sinks added to all loggers at initialization reach them too
+static const bool traffic_loggers_registered = (send_logger(), received_logger(), true);
+
+constexpr size_t AsyncSink::DEFAULT_CAPACITY;
+constexpr std::chrono::milliseconds AsyncSink::DRAIN_INTERVAL;
+
+AsyncSink::AsyncSink(std::shared_ptr<spdlog::sinks::sink> target, size_t capacity)
+	: target(std::move(target)), capacity(capacity), worker([this] { run(); })
+{
+}
+
+AsyncSink::~AsyncSink()
+{
+	{
+		std::lock_guard<std::mutex> guard(queue_lock);
+		stopped = true;
+	}
+	queue_cv.notify_all();
+	worker.join();
+}
+
+uint64_t AsyncSink::get_dropped() const
+{
+	std::lock_guard<std::mutex> guard(queue_lock);
+	return dropped;
+}
+
+void AsyncSink::sink_it_(spdlog::details::log_msg const& msg)
+{
+	bool wake = false;
+	{
+		std::lock_guard<std::mutex> guard(queue_lock);
+		if (queue.size() >= capacity)
+		{
+			queue.pop_front();
+			++dropped;
+		}
+		// the message views the caller's buffers, the copy owns them
+		queue.emplace_back(msg);
+		wake = waiting && queue.size() == capacity / 2;
+	}
+	if (wake)
+	{
+		queue_cv.notify_one();
+	}
+}
+
+void AsyncSink::flush_()
+{
+	{
+		std::unique_lock<std::mutex> guard(queue_lock);
+		flush_requested = true;
+		queue_cv.notify_one();
+		drained_cv.wait(guard, [this] { return queue.empty() && !writing; });
+	}
+	target->flush();
+}
+
+void AsyncSink::run()
+{
+	util::set_thread_name("rd AsyncSink");
+
+	std::deque<spdlog::details::log_msg_buffer> batch;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> guard(queue_lock);
+			writing = false;
+			if (queue.empty())
+			{
+				drained_cv.notify_all();
+			}
+			waiting = true;
+			queue_cv.wait_for(
+				guard, DRAIN_INTERVAL, [this] { return stopped || flush_requested || queue.size() >= capacity / 2; });
+			waiting = false;
+			flush_requested = false;
+			if (queue.empty())
+			{
+				if (stopped)
+				{
+					break;
+				}
+				continue;
+			}
+			batch.swap(queue);
+			writing = true;
+		}
+		for (auto const& msg : batch)
+		{
+			target->log(msg);
+		}
+		batch.clear();
+	}
+	target->flush();
+}
+}	 // namespace util
+}	 // namespace rd
@@ -0,0 +1,114 @@
+#ifndef RD_CPP_LOGGING_H
+#define RD_CPP_LOGGING_H
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable:4251)
+#endif
+
+#include "spdlog/spdlog.h"
+#include "spdlog/sinks/base_sink.h"
+#include "spdlog/details/log_msg_buffer.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <rd_framework_export.h>
+
+/**
+ * \brief Most verbose level compiled into RD, one of the SPDLOG_LEVEL_* values. Statements of finer levels are removed
+ * together with their arguments.
+ */
+#ifndef RD_LOG_ACTIVE_LEVEL
+#define RD_LOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+#endif
+
+/**
+ * \brief Logs through [logger] (a pointer or shared pointer to spdlog::logger) if [level] is compiled in and enabled.
+ * The format arguments are evaluated only in that case, so they may be as expensive as a to_string of a whole value.
+ */
+#define RD_LOG(logger, lvl, lvl_num, ...)                                \
+	do                                                                   \
+	{                                                                    \
+		if (lvl_num >= RD_LOG_ACTIVE_LEVEL && (logger)->should_log(lvl)) \
+		{                                                                \
+			(logger)->log(lvl, __VA_ARGS__);                             \
+		}                                                                \
+	} while (false)
+
+#define RD_LOG_TRACE(logger, ...) RD_LOG(logger, spdlog::level::trace, SPDLOG_LEVEL_TRACE, __VA_ARGS__)
+#define RD_LOG_DEBUG(logger, ...) RD_LOG(logger, spdlog::level::debug, SPDLOG_LEVEL_DEBUG, __VA_ARGS__)
+#define RD_LOG_INFO(logger, ...) RD_LOG(logger, spdlog::level::info, SPDLOG_LEVEL_INFO, __VA_ARGS__)
+#define RD_LOG_WARN(logger, ...) RD_LOG(logger, spdlog::level::warn, SPDLOG_LEVEL_WARN, __VA_ARGS__)
+#define RD_LOG_ERROR(logger, ...) RD_LOG(logger, spdlog::level::err, SPDLOG_LEVEL_ERROR, __VA_ARGS__)
+
+namespace rd
+{
+namespace util
+{
+/**
+ * \brief Loggers of outgoing and incoming reactive traffic, created once and cached, unlike spdlog::get which looks the
+ * registry up under its mutex on every call.
+ */
+RD_FRAMEWORK_API std::shared_ptr<spdlog::logger> const& send_logger();
+
+RD_FRAMEWORK_API std::shared_ptr<spdlog::logger> const& received_logger();
+
+/**
+ * \brief Hands messages to a background thread that writes them into [target], so logging threads never wait for the
+ * file system. The thread drains the queue every [DRAIN_INTERVAL], or earlier once half of [capacity] is pending; when
+ * more than [capacity] messages are pending the oldest are dropped.
+ */
+class RD_FRAMEWORK_API AsyncSink final : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+	static constexpr size_t DEFAULT_CAPACITY = 1u << 14;
+
+	static constexpr std::chrono::milliseconds DRAIN_INTERVAL{50};
+
+	explicit AsyncSink(std::shared_ptr<spdlog::sinks::sink> target, size_t capacity = DEFAULT_CAPACITY);
+
+	AsyncSink(AsyncSink const&) = delete;
+
+	AsyncSink& operator=(AsyncSink const&) = delete;
+
+	~AsyncSink() override;
+
+	uint64_t get_dropped() const;
+
+protected:
+	void sink_it_(spdlog::details::log_msg const& msg) override;
+
+	void flush_() override;
+
+private:
+	void run();
+
+	std::shared_ptr<spdlog::sinks::sink> target;
+	size_t capacity;
+
+	mutable std::mutex queue_lock;
+	std::condition_variable queue_cv;
+	std::condition_variable drained_cv;
+	// a deque, so dropping the oldest message while full costs the same as appending
+	std::deque<spdlog::details::log_msg_buffer> queue;
+	// the worker sleeps on [queue_cv]; producers wake it only when the queue fills up
+	bool waiting = false;
+	bool flush_requested = false;
+	bool writing = false;
+	bool stopped = false;
+	uint64_t dropped = 0;
+
+	std::thread worker;
+};
+}	 // namespace util
+}	 // namespace rd
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+#endif	  // RD_CPP_LOGGING_H
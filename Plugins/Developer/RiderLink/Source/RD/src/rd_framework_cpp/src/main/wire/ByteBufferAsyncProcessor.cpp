@@ -1,22 +1,40 @@
 #include "ByteBufferAsyncProcessor.h"
 
+#include "protocol/BufferPool.h"
 #include "util/guards.h"
+#include "util/logging.h"
 #include <util/thread_util.h>
 
 #include "spdlog/sinks/stdout_color_sinks.h"
 
+#include <algorithm>
+#include <thread>
+
 namespace rd
 {
-size_t ByteBufferAsyncProcessor::INITIAL_CAPACITY = 1024 * 1024;
+constexpr size_t ByteBufferAsyncProcessor::MAX_BATCH_PACKETS;
+constexpr size_t ByteBufferAsyncProcessor::MAX_BATCH_BYTES;
+constexpr size_t ByteBufferAsyncProcessor::INCOMING_CAPACITY;
 
 std::shared_ptr<spdlog::logger> ByteBufferAsyncProcessor::logger =
 	spdlog::stderr_color_mt<spdlog::synchronous_factory>("byteBufferLog", spdlog::color_mode::automatic);
 
-ByteBufferAsyncProcessor::ByteBufferAsyncProcessor(
-	std::string id, std::function<bool(Buffer::ByteArray const&, sequence_number_t)> processor)
-	: id(std::move(id)), processor(std::move(processor))
+template <typename T>
+static void update_max(std::atomic<T>& maximum, T value)
+{
+	T current = maximum.load(std::memory_order_relaxed);
+	while (current < value && !maximum.compare_exchange_weak(current, value, std::memory_order_relaxed))
+	{
+	}
+}
+
+ByteBufferAsyncProcessor::ByteBufferAsyncProcessor(std::string id, batch_processor_t processor)
+	: id(std::move(id)), processor(std::move(processor)), incoming(new IncomingSlot[INCOMING_CAPACITY])
 {
-	data.reserve(INITIAL_CAPACITY);
+	for (size_t i = 0; i < INCOMING_CAPACITY; ++i)
+	{
+		incoming[i].sequence.store(i, std::memory_order_relaxed);
+	}
 }
 
 void ByteBufferAsyncProcessor::cleanup0()
@@ -37,20 +55,21 @@ bool ByteBufferAsyncProcessor::terminate0(time_t timeout, StateKind state_to_set
 		std::lock_guard<decltype(lock)> guard(lock);
 		if (state == StateKind::Initialized)
 		{
-			logger->debug("Can't {} \'{}\', because it hasn't been started yet", std::string(action), id);
+			RD_LOG_DEBUG(logger, "Can't {} \'{}\', because it hasn't been started yet", std::string(action), id);
 			cleanup0();
 			return true;
 		}
 
 		if (state >= state_to_set)
 		{
-			logger->debug("Trying to {} async processor \'{}' but it's in state {}", std::string(action), id, to_string(state));
+			RD_LOG_DEBUG(logger, "Trying to {} async processor \'{}' but it's in state {}", std::string(action), id, to_string(state.load()));
 			return true;
 		}
 
 		state = state_to_set;
 	}
 	cv.notify_all();
+	notify_window();
 
 	std::future_status status = async_future.wait_for(timeout);
 
@@ -58,7 +77,7 @@ bool ByteBufferAsyncProcessor::terminate0(time_t timeout, StateKind state_to_set
 
 	if (status == std::future_status::timeout)
 	{
-		logger->error("Couldn't wait async thread during time: {}", to_string(timeout));
+		RD_LOG_ERROR(logger, "Couldn't wait async thread during time: {}", to_string(timeout));
 		success = false;
 	}
 
@@ -67,42 +86,186 @@ bool ByteBufferAsyncProcessor::terminate0(time_t timeout, StateKind state_to_set
 	return success;
 }
 
-void ByteBufferAsyncProcessor::add_data(std::vector<Buffer::ByteArray>&& new_data)
+bool ByteBufferAsyncProcessor::try_push_incoming(OutgoingPacket& packet)
+{
+	size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+	while (true)
+	{
+		IncomingSlot& slot = incoming[pos & (INCOMING_CAPACITY - 1)];
+		const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+		if (sequence == pos)
+		{
+			if (enqueue_pos.compare_exchange_weak(pos, pos + 1))
+			{
+				slot.packet = std::move(packet);
+				slot.sequence.store(pos + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (sequence < pos)
+		{
+			// the slot still holds the packet put a lap earlier
+			return false;
+		}
+		else
+		{
+			pos = enqueue_pos.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+bool ByteBufferAsyncProcessor::has_incoming() const
+{
+	return enqueue_pos.load() != dequeue_pos || overflowing.load();
+}
+
+bool ByteBufferAsyncProcessor::has_work() const
+{
+	return has_incoming() || release_requested.load();
+}
+
+void ByteBufferAsyncProcessor::drain_incoming()
 {
 	std::lock_guard<decltype(queue_lock)> guard(queue_lock);
-	std::move(new_data.begin(), new_data.end(), std::back_inserter(queue));
-	//		for (auto &&item : new_data) {
-	//			queue.emplace(std::move(item));
-	//		}
+
+	const size_t queued = queue.size();
+	const size_t end = enqueue_pos.load(std::memory_order_acquire);
+	for (; dequeue_pos != end; ++dequeue_pos)
+	{
+		IncomingSlot& slot = incoming[dequeue_pos & (INCOMING_CAPACITY - 1)];
+		// claimed, but the producer has not finished writing it yet
+		while (slot.sequence.load(std::memory_order_acquire) != dequeue_pos + 1)
+		{
+			std::this_thread::yield();
+		}
+		queue.push_back(std::move(slot.packet));
+		slot.sequence.store(dequeue_pos + INCOMING_CAPACITY, std::memory_order_release);
+	}
+
+	if (overflowing.load())
+	{
+		std::lock_guard<decltype(overflow_lock)> overflow_guard(overflow_lock);
+		// packets claimed in the ring before the overflow started have to be sent first
+		if (enqueue_pos.load() == dequeue_pos)
+		{
+			std::move(overflow.begin(), overflow.end(), std::back_inserter(queue));
+			overflow.clear();
+			overflowing = false;
+		}
+	}
+
+	window_packets += queue.size() - queued;
+	update_max(peak_window_bytes, window_bytes.load());
 }
 
-bool ByteBufferAsyncProcessor::reprocess()
+size_t ByteBufferAsyncProcessor::batch_size(packet_iterator first, packet_iterator last)
 {
+	size_t count = 0;
+	size_t bytes = 0;
+	for (auto it = first; it != last && count < MAX_BATCH_PACKETS; ++it, ++count)
 	{
-		std::lock_guard<decltype(queue_lock)> guard(queue_lock);
+		bytes += it->bytes.size();
+		if (bytes > MAX_BATCH_BYTES && count > 0)
+		{
+			break;
+		}
+	}
+	return count;
+}
 
-		logger->debug("{}: reprocessing started", id);
+void ByteBufferAsyncProcessor::release_acknowledged()
+{
+	// cleared before the acknowledged seqn is read, so a later request is either seen below or served on the next pass
+	release_requested = false;
+	if (current_seqn > acknowledged_seqn || pending_queue.empty())
+	{
+		return;
+	}
 
+	const auto now = std::chrono::steady_clock::now();
+	uint64_t packets = 0;
+	uint64_t bytes = 0;
+	int64_t latency_total = 0;
+	int64_t latency_max = 0;
+	while (current_seqn <= acknowledged_seqn && !pending_queue.empty())
+	{
+		OutgoingPacket& packet = pending_queue.front();
+		const int64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(now - packet.sent_at).count();
+		latency_total += latency;
+		latency_max = (std::max)(latency_max, latency);
+		++packets;
+		bytes += packet.bytes.size();
+
+		BufferPool::instance().release(std::move(packet.bytes));
+		pending_queue.pop_front();
+		++current_seqn;
+	}
+
+	acknowledged_packets += packets;
+	total_ack_latency_us += latency_total;
+	update_max(max_ack_latency_us, latency_max);
+
+	window_packets -= packets;
+	window_bytes -= bytes;
+	notify_window();
+}
+
+void ByteBufferAsyncProcessor::wait_for_window()
+{
+	std::unique_lock<decltype(window_lock)> guard(window_lock);
+	// pairs with the check in notify_window: either the release is seen here or this waiter is seen there
+	++window_waiters;
+	++blocked_puts;
+	window_cv.wait(guard, [this] {
+		// acknowledges do not arrive while paused, so the window is not enforced then
+		return window_bytes.load() < window_limit.load() || interrupt_balance != 0 || state >= StateKind::Stopping;
+	});
+	--window_waiters;
+}
+
+void ByteBufferAsyncProcessor::notify_window()
+{
+	if (window_waiters.load() > 0)
+	{
+		std::lock_guard<decltype(window_lock)> guard(window_lock);
+		window_cv.notify_all();
+	}
+}
+
+bool ByteBufferAsyncProcessor::reprocess(bool from_start)
+{
+	bool success = true;
+	{
+		std::lock_guard<decltype(queue_lock)> guard(queue_lock);
 		std::unique_lock<decltype(processing_lock)> ul(processing_lock);
-		processing_cv.wait(ul, [this]() -> bool { return !in_processing; });
+		// a pause from another thread waits for the resend like for any other send
+		util::bool_guard bool_guard(in_processing);
 
-		logger->debug("{}: reprocessing waited for main processing", id);
+		RD_LOG_DEBUG(logger, "{}: reprocessing started", id);
 
-		while (current_seqn <= acknowledged_seqn)
+		release_acknowledged();
+		size_t resent = 0;
+		if (!from_start && written_seqn >= current_seqn)
 		{
-			pending_queue.pop_front();
-			++current_seqn;
+			resent = (std::min)(static_cast<size_t>(written_seqn - current_seqn + 1), pending_queue.size());
 		}
-		for (int i = 0; i < pending_queue.size(); ++i)
+		while (resent < pending_queue.size())
 		{
-			auto const& item = pending_queue[i];
-			if (!processor(item, current_seqn + i))
+			const auto first = pending_queue.cbegin() + resent;
+			const size_t count = batch_size(first, pending_queue.cend());
+			const size_t sent = processor(first, first + count, current_seqn + resent);
+			resent += sent;
+			if (sent != count)
 			{
-				return false;
+				success = false;
+				break;
 			}
 		}
+		written_seqn = current_seqn + static_cast<sequence_number_t>(resent) - 1;
+		release_acknowledged();
 	}
-	return true;
+	processing_cv.notify_all();
+	return success;
 }
 
 void ByteBufferAsyncProcessor::process()
@@ -112,14 +275,32 @@ void ByteBufferAsyncProcessor::process()
 		std::unique_lock<decltype(processing_lock)> ul(processing_lock);
 		util::bool_guard bool_guard(in_processing);
 
-		logger->debug("{}: processing started", id);
+		RD_LOG_DEBUG(logger, "{}: processing started", id);
+
+		release_acknowledged();
 
-		while (!queue.empty() && processor(queue.front(), max_sent_seqn + 1))
+		while (!queue.empty())
 		{
-			++max_sent_seqn;
-			pending_queue.push_back(std::move(queue.front()));
-			queue.pop_front();
+			const size_t count = batch_size(queue.cbegin(), queue.cend());
+			const size_t sent = processor(queue.cbegin(), queue.cbegin() + count, max_sent_seqn + 1);
+
+			max_sent_seqn += sent;
+			const auto now = std::chrono::steady_clock::now();
+			for (auto it = queue.begin(); it != queue.begin() + sent; ++it)
+			{
+				it->sent_at = now;
+				pending_queue.push_back(std::move(*it));
+			}
+			queue.erase(queue.begin(), queue.begin() + sent);
+			written_seqn = max_sent_seqn;
+
+			if (sent != count)
+			{
+				break;
+			}
 		}
+		// acknowledges that came in during the writes could not take the queue
+		release_acknowledged();
 	}
 	processing_cv.notify_all();
 
@@ -133,6 +314,10 @@ void ByteBufferAsyncProcessor::ThreadProc()
 
 	while (true)
 	{
+		std::vector<util::unique_function<void()>> actions;
+		bool reprocessing = false;
+		bool from_start = false;
+		bool processing = false;
 		{
 			std::lock_guard<decltype(lock)> guard(lock);
 
@@ -141,32 +326,57 @@ void ByteBufferAsyncProcessor::ThreadProc()
 				return;
 			}
 
-			while (data.empty() || interrupt_balance != 0)
+			while (posted_actions.empty() && !reprocess_requested && (!has_work() || interrupt_balance != 0))
 			{
 				if (state >= StateKind::Stopping)
 				{
 					return;
 				}
+
+				// pairs with the check in put and acknowledge: either this thread sees the work or its producer sees it parked
+				parked = true;
+				if (has_work() && interrupt_balance == 0)
+				{
+					parked = false;
+					break;
+				}
 				cv.wait(lock);
+				parked = false;
 
-				logger->debug("{}'s ThreadProc waited for notify", id);
+				RD_LOG_DEBUG(logger, "{}'s ThreadProc waited for notify", id);
 
 				if (state >= StateKind::Terminating)
 				{
 					return;
 				}
 			}
-			add_data(std::move(data));
-			data.clear();
+
+			actions.swap(posted_actions);
+			std::swap(reprocessing, reprocess_requested);
+			std::swap(from_start, reprocess_from_start);
+			processing = interrupt_balance == 0;
 		}
 
 		try
 		{
-			process();
+			for (auto& action : actions)
+			{
+				action();
+			}
+			// packets sent before the connection broke go out again before anything new
+			if (reprocessing && !reprocess(from_start))
+			{
+				RD_LOG_DEBUG(logger, "{}: reprocessing stopped at a failed send", id);
+			}
+			if (processing)
+			{
+				drain_incoming();
+				process();
+			}
 		}
 		catch (std::exception const& e)
 		{
-			logger->error("Exception while processing byte queue | {}", e.what());
+			RD_LOG_ERROR(logger, "Exception while processing byte queue | {}", e.what());
 		}
 	}
 }
@@ -178,7 +388,7 @@ void ByteBufferAsyncProcessor::start()
 
 		if (state != StateKind::Initialized)
 		{
-			logger->debug("Trying to START async processor {} but it's in state {}", id, to_string(state));
+			RD_LOG_DEBUG(logger, "Trying to START async processor {} but it's in state {}", id, to_string(state.load()));
 			return;
 		}
 
@@ -198,18 +408,38 @@ bool ByteBufferAsyncProcessor::terminate(time_t timeout)
 	return terminate0(timeout, StateKind::Terminating, "TERMINATE");
 }
 
-void ByteBufferAsyncProcessor::put(Buffer::ByteArray new_data)
+void ByteBufferAsyncProcessor::put(OutgoingPacket new_data, bool may_block)
 {
+	if (state >= StateKind::Stopping)
 	{
-		std::lock_guard<decltype(lock)> guard(lock);
+		return;
+	}
 
-		if (state >= StateKind::Stopping)
-		{
-			return;
-		}
-		data.emplace_back(std::move(new_data));
+	const size_t limit = window_limit.load(std::memory_order_relaxed);
+	if (may_block && limit != 0 && window_bytes.load() >= limit)
+	{
+		wait_for_window();
+	}
+	window_bytes += new_data.bytes.size();
+
+	if (overflowing.load() || !try_push_incoming(new_data))
+	{
+		std::lock_guard<decltype(overflow_lock)> guard(overflow_lock);
+		overflow.emplace_back(std::move(new_data));
+		overflowing = true;
+	}
+
+	wake_sender();
+}
+
+void ByteBufferAsyncProcessor::wake_sender()
+{
+	// only the first producer after the sender thread parked pays for waking it
+	if (parked.load() && parked.exchange(false))
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		cv.notify_all();
 	}
-	cv.notify_all();
 }
 
 void ByteBufferAsyncProcessor::pause(const std::string& reason)
@@ -217,49 +447,89 @@ void ByteBufferAsyncProcessor::pause(const std::string& reason)
 	std::lock_guard<decltype(lock)> guard(lock);
 
 	++interrupt_balance;
+	notify_window();
 
-	logger->debug("{} paused with reason={},state={}", id, reason, to_string(state));
+	RD_LOG_DEBUG(logger, "{} paused with reason={},state={}", id, reason, to_string(state.load()));
 
 	auto current_thread_id = std::this_thread::get_id();
 	if (current_thread_id != async_thread_id)
 	{
-		logger->debug("{} paused from another thread : {}", id, to_string(current_thread_id));
+		RD_LOG_DEBUG(logger, "{} paused from another thread : {}", id, to_string(current_thread_id));
 		std::unique_lock<decltype(processing_lock)> ul(processing_lock);
 		processing_cv.wait(ul, [this]() -> bool { return !in_processing; });
-		logger->debug("{}: pausing waited for main processing", id);
+		RD_LOG_DEBUG(logger, "{}: pausing waited for main processing", id);
 	}
 }
 
-void ByteBufferAsyncProcessor::resume()
+void ByteBufferAsyncProcessor::resume(bool from_start)
 {
 	{
 		std::lock_guard<decltype(lock)> guard(lock);
 
-		reprocess();
+		reprocess_requested = true;
+		reprocess_from_start = reprocess_from_start || from_start;
 
 		--interrupt_balance;
 
-		logger->debug("{} resumed", id);
+		RD_LOG_DEBUG(logger, "{} resumed", id);
 	}
 
 	cv.notify_all();
 }
 
-void ByteBufferAsyncProcessor::acknowledge(sequence_number_t seqn)
+void ByteBufferAsyncProcessor::post(util::unique_function<void()> action)
 {
-	std::lock_guard<decltype(lock)> guard(lock);
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+
+		posted_actions.push_back(std::move(action));
+	}
 
+	cv.notify_all();
+}
+
+void ByteBufferAsyncProcessor::acknowledge(sequence_number_t seqn)
+{
 	if (seqn > acknowledged_seqn)
 	{
-		logger->trace("{}: new acknowledged seqn: {}", this->id, seqn);
+		RD_LOG_TRACE(logger, "{}: new acknowledged seqn: {}", this->id, seqn);
 		acknowledged_seqn = seqn;
+
+		std::unique_lock<decltype(queue_lock)> queue_guard(queue_lock, std::try_to_lock);
+		if (queue_guard.owns_lock())
+		{
+			release_acknowledged();
+			return;
+		}
+		// the queue is held for a write; the sender thread releases the packets once it is done, even if nothing else is put
+		release_requested = true;
+		wake_sender();
 	}
 	else
 	{
-		logger->error("Acknowledge {} called, while next seqn MUST BE greater than {}", seqn, acknowledged_seqn);
+		RD_LOG_ERROR(logger, "Acknowledge {} called, while next seqn MUST BE greater than {}", seqn, acknowledged_seqn.load());
 	}
 }
 
+void ByteBufferAsyncProcessor::set_window_limit(size_t bytes)
+{
+	window_limit = bytes;
+	notify_window();
+}
+
+ByteBufferAsyncProcessor::WindowStats ByteBufferAsyncProcessor::get_window_stats() const
+{
+	WindowStats stats;
+	stats.packets = window_packets.load();
+	stats.bytes = window_bytes.load();
+	stats.peak_bytes = peak_window_bytes.load();
+	stats.acknowledged_packets = acknowledged_packets.load();
+	stats.total_ack_latency = std::chrono::microseconds(total_ack_latency_us.load());
+	stats.max_ack_latency = std::chrono::microseconds(max_ack_latency_us.load());
+	stats.blocked_puts = blocked_puts.load();
+	return stats;
+}
+
 std::string to_string(ByteBufferAsyncProcessor::StateKind state)
 {
 	switch (state)
@@ -7,6 +7,7 @@
 #endif
 
 #include "protocol/Buffer.h"
+#include "util/unique_function.h"
 #include "spdlog/spdlog.h"
 
 #include <chrono>
@@ -15,6 +16,11 @@
 #include <condition_variable>
 #include <future>
 #include <list>
+#include <deque>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 #include <rd_framework_export.h>
 
@@ -22,6 +28,19 @@ namespace rd
 {
 using sequence_number_t = int64_t;
 
+/**
+ * \brief Serialized message waiting to be sent and acknowledged, with the format its body was written in.
+ */
+struct OutgoingPacket
+{
+	Buffer::ByteArray bytes;
+	WireFormat format = WireFormat::V1;
+	/**
+	 * \brief When the packet was first handed to the batch processor, to measure how long it waits for the acknowledge.
+	 */
+	std::chrono::steady_clock::time_point sent_at{};
+};
+
 class RD_FRAMEWORK_API ByteBufferAsyncProcessor
 {
 public:
@@ -37,39 +56,150 @@ public:
 private:
 	using time_t = std::chrono::milliseconds;
 
-	static size_t INITIAL_CAPACITY;
+	/**
+	 * \brief Cell of the incoming ring. [sequence] equals the position a producer may claim while the cell is free,
+	 * and that position plus one once the packet is written.
+	 */
+	struct IncomingSlot
+	{
+		std::atomic<size_t> sequence{0};
+		OutgoingPacket packet;
+	};
 
+public:
+	using packet_iterator = std::deque<OutgoingPacket>::const_iterator;
+
+	/**
+	 * \brief Sends packets [first, last) in one go, numbering them consecutively from [first_seqn].
+	 * \return number of packets from the front of the range that were sent completely.
+	 */
+	using batch_processor_t = std::function<size_t(packet_iterator first, packet_iterator last, sequence_number_t first_seqn)>;
+
+	/**
+	 * \brief Upper bounds of one batch. A single packet larger than [MAX_BATCH_BYTES] still forms a batch of its own.
+	 */
+	static constexpr size_t MAX_BATCH_PACKETS = 256;
+	static constexpr size_t MAX_BATCH_BYTES = 1u << 16;
+
+	/**
+	 * \brief Packets [put] can hand over without taking a lock; a power of two.
+	 */
+	static constexpr size_t INCOMING_CAPACITY = 1u << 12;
+
+	struct WindowStats
+	{
+		/**
+		 * \brief Packets put and not acknowledged yet, whether sent or still queued.
+		 */
+		uint64_t packets = 0;
+		uint64_t bytes = 0;
+		uint64_t peak_bytes = 0;
+
+		uint64_t acknowledged_packets = 0;
+		std::chrono::microseconds total_ack_latency{0};
+		std::chrono::microseconds max_ack_latency{0};
+
+		/**
+		 * \brief Calls to [put] that had to wait for the window to drain.
+		 */
+		uint64_t blocked_puts = 0;
+
+		std::chrono::microseconds average_ack_latency() const
+		{
+			return acknowledged_packets == 0 ? std::chrono::microseconds(0)
+											 : total_ack_latency / static_cast<int64_t>(acknowledged_packets);
+		}
+	};
+
+private:
+
+	// guards the state transitions, pausing, and parking of the sender thread
 	std::recursive_mutex lock;
 	std::condition_variable_any cv;
 
 	std::string id;
 
-	std::function<bool(Buffer::ByteArray const&, sequence_number_t seqn)> processor;
+	batch_processor_t processor;
 
-	StateKind state{StateKind::Initialized};
+	std::atomic<StateKind> state{StateKind::Initialized};
 	static std::shared_ptr<spdlog::logger> logger;
 
 	std::thread::id async_thread_id;
 	std::future<void> async_future;
 
-	std::vector<Buffer::ByteArray> data;
+	/**
+	 * \brief Bounded multi-producer ring the sender thread drains in whole batches. Producers claim positions with a CAS
+	 * on [enqueue_pos]; only the sender thread advances [dequeue_pos].
+	 */
+	std::unique_ptr<IncomingSlot[]> incoming;
+	std::atomic<size_t> enqueue_pos{0};
+	size_t dequeue_pos = 0;
+
+	/**
+	 * \brief Packets put while the ring was full. Once it is non-empty every producer appends here until the sender
+	 * thread takes it, so packets of one thread are never reordered.
+	 */
+	std::mutex overflow_lock;
+	std::vector<OutgoingPacket> overflow;
+	std::atomic<bool> overflowing{false};
+
+	/**
+	 * \brief Set while the sender thread is about to wait on [cv]. Producers take [lock] to wake it only in that case.
+	 */
+	std::atomic<bool> parked{false};
+
+	/**
+	 * \brief Work the sender thread takes on even while paused, guarded by [lock]: actions [post]ed to it, and the resend of
+	 * [pending_queue] [resume] asked for.
+	 */
+	std::vector<util::unique_function<void()>> posted_actions;
+	bool reprocess_requested = false;
+	bool reprocess_from_start = false;
+
 	std::mutex queue_lock;
-	std::deque<Buffer::ByteArray> queue{};
-	std::deque<Buffer::ByteArray> pending_queue{};
+	std::deque<OutgoingPacket> queue{};
+	std::deque<OutgoingPacket> pending_queue{};
 
 	sequence_number_t max_sent_seqn = 0;
 	sequence_number_t current_seqn = 1;
-	sequence_number_t acknowledged_seqn = 0;
-
-	int32_t interrupt_balance = 0;
+	/**
+	 * \brief Highest seqn written since the last resend from the start of [pending_queue].
+	 */
+	sequence_number_t written_seqn = 0;
+	std::atomic<sequence_number_t> acknowledged_seqn{0};
+	/**
+	 * \brief Set by [acknowledge] when it could not take [queue_lock]; the sender thread releases the packets instead.
+	 */
+	std::atomic<bool> release_requested{false};
+
+	std::atomic<int32_t> interrupt_balance{0};
 	bool in_processing = false;
 	std::mutex processing_lock;
 	std::condition_variable processing_cv;
 
+	// region unacknowledged window
+	/**
+	 * \brief [put] waits while this many bytes are put and not acknowledged; 0 for no limit.
+	 */
+	std::atomic<size_t> window_limit{0};
+	std::atomic<uint64_t> window_packets{0};
+	std::atomic<uint64_t> window_bytes{0};
+	std::atomic<uint64_t> peak_window_bytes{0};
+
+	std::mutex window_lock;
+	std::condition_variable window_cv;
+	std::atomic<int32_t> window_waiters{0};
+
+	std::atomic<uint64_t> acknowledged_packets{0};
+	std::atomic<int64_t> total_ack_latency_us{0};
+	std::atomic<int64_t> max_ack_latency_us{0};
+	std::atomic<uint64_t> blocked_puts{0};
+	// endregion
+
 public:
 	// region ctor/dtor
 
-	explicit ByteBufferAsyncProcessor(std::string id, std::function<bool(Buffer::ByteArray const&, sequence_number_t)> processor);
+	explicit ByteBufferAsyncProcessor(std::string id, batch_processor_t processor);
 
 	// endregion
 private:
@@ -77,9 +207,47 @@ private:
 
 	bool terminate0(time_t timeout, StateKind state_to_set, string_view action);
 
-	void add_data(std::vector<Buffer::ByteArray>&& new_data);
+	bool try_push_incoming(OutgoingPacket& packet);
+
+	bool has_incoming() const;
+
+	/**
+	 * \brief Whether there are packets to send or acknowledged packets to release.
+	 */
+	bool has_work() const;
+
+	/**
+	 * \brief Wakes the sender thread if it is parked.
+	 */
+	void wake_sender();
+
+	/**
+	 * \brief Moves the packets put so far to the end of [queue], in the order each thread put them.
+	 */
+	void drain_incoming();
+
+	/**
+	 * \brief Number of packets from [first] that fit into one batch.
+	 */
+	static size_t batch_size(packet_iterator first, packet_iterator last);
 
-	bool reprocess();
+	/**
+	 * \brief Drops acknowledged packets from the front of [pending_queue] and returns their storage to the BufferPool.
+	 * Must be called with [queue_lock] held. Serves a pending [release_requested].
+	 */
+	void release_acknowledged();
+
+	/**
+	 * \brief Blocks until the window has room, the processor is paused, or it is stopping.
+	 */
+	void wait_for_window();
+
+	void notify_window();
+
+	/**
+	 * \brief Resends [pending_queue], from its start or from the first packet not written since the last such resend.
+	 */
+	bool reprocess(bool from_start);
 
 	void process();
 
@@ -92,13 +260,33 @@ public:
 
 	bool terminate(time_t timeout = time_t(0) /*InfiniteDuration*/);
 
-	void put(Buffer::ByteArray new_data);
+	/**
+	 * \brief Queues a packet for sending. With a window limit set, waits for acknowledges while the window is full unless
+	 * [may_block] is false; pass false on threads the acknowledges arrive on.
+	 */
+	void put(OutgoingPacket new_data, bool may_block = true);
 
 	void pause(const std::string& reason);
 
-	void resume();
+	/**
+	 * \brief Lifts one [pause]. The packets pending acknowledge are resent on the sender thread, so this never waits for
+	 * the socket. Without [from_start] the packets already resent on the current connection are skipped.
+	 */
+	void resume(bool from_start = true);
 
+	/**
+	 * \brief Runs [action] on the sender thread ahead of any packets, even while paused.
+	 */
+	void post(util::unique_function<void()> action);
+
+	/**
+	 * \brief Releases every packet up to and including [seqn].
+	 */
 	void acknowledge(int64_t seqn);
+
+	void set_window_limit(size_t bytes);
+
+	WindowStats get_window_stats() const;
 };
 
 std::string to_string(ByteBufferAsyncProcessor::StateKind state);
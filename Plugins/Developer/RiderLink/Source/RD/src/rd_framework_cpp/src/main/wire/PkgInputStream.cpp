@@ -11,6 +11,12 @@ void PkgInputStream::rewind()
 	buffer.rewind();
 }
 
+void PkgInputStream::reset()
+{
+	buffer = Buffer();
+	memory = 0;
+}
+
 void PkgInputStream::require_available(int size)
 {
 	buffer.require_available(size);
@@ -33,18 +39,18 @@ Buffer& PkgInputStream::get_buffer()
 
 int32_t PkgInputStream::try_read(Buffer::word_t* res, size_t size)
 {
-	if (memory == -1 || buffer.get_position() == memory)
+	if (memory == NO_PACKAGE || buffer.get_position() == memory)
 	{
-		memory = request_data();
-		if (memory == -1)
+		const int32_t received = request_data();
+		if (received == -1)
 		{
+			memory = NO_PACKAGE;
 			return -1;
 		}
+		memory = static_cast<size_t>(received);
 	}
 	const int32_t n = static_cast<int32_t>((std::min)(size, memory - buffer.get_position()));
-	Buffer::word_t* start = buffer.current_pointer();
-	std::copy(start, start + n, res);
-	buffer.set_position(buffer.get_position() + n);
+	buffer.read(res, n);
 	return n;
 }
 
@@ -52,7 +58,7 @@ bool PkgInputStream::read(Buffer::word_t* res, size_t size)
 {
 	//		spdlog::trace("PkgInputStream call: size={}, pos={}, memory={}", size, buffer.get_position(), memory);
 
-	int32_t summary_size = 0;
+	size_t summary_size = 0;
 	while (summary_size < size)
 	{
 		const int32_t bytes_read = try_read(res + summary_size, size - summary_size);
@@ -64,4 +70,14 @@ bool PkgInputStream::read(Buffer::word_t* res, size_t size)
 	}
 	return true;
 }
+
+bool PkgInputStream::try_slice(size_t size, Buffer& out)
+{
+	if (memory == NO_PACKAGE || buffer.get_position() + size > memory)
+	{
+		return false;
+	}
+	out = buffer.slice(size);
+	return true;
+}
 }	 // namespace rd
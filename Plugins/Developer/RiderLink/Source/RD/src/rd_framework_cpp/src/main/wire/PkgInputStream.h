@@ -10,6 +10,8 @@
 
 #include <rd_framework_export.h>
 
+#include <limits>
+
 namespace rd
 {
 class RD_FRAMEWORK_API PkgInputStream
@@ -19,6 +21,11 @@ private:
 
 	std::function<int32_t()> request_data;
 
+	/**
+	 * \brief Value of [memory] once [request_data] has failed.
+	 */
+	static constexpr size_t NO_PACKAGE = (std::numeric_limits<size_t>::max)();
+
 	size_t memory = 0;
 
 public:
@@ -29,6 +36,11 @@ public:
 
 	void rewind();
 
+	/**
+	 * \brief Drops the current package, so the next read requests a new one.
+	 */
+	void reset();
+
 	void require_available(int size);
 
 	size_t get_position() const;
@@ -41,6 +53,11 @@ public:
 
 	bool read(Buffer::word_t* res, size_t size);
 
+	/**
+	 * \brief Takes the next [size] bytes as a slice of the current package if they lie entirely within it.
+	 */
+	bool try_slice(size_t size, Buffer& out);
+
 	template <typename T>
 	T read_integral()
 	{
@@ -0,0 +1,333 @@
+#include "wire/Reactor.h"
+
+#include "util/core_util.h"
+#include "util/logging.h"
+#include <util/thread_util.h>
+
+#include "spdlog/sinks/stdout_color_sinks.h"
+
+#include <algorithm>
+#include <array>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace rd
+{
+constexpr std::chrono::milliseconds Reactor::TICK;
+constexpr size_t Reactor::WHEEL_SIZE;
+constexpr int64_t Reactor::WOULD_BLOCK;
+
+std::shared_ptr<spdlog::logger> Reactor::logger =
+	spdlog::stderr_color_mt<spdlog::synchronous_factory>("reactorLog", spdlog::color_mode::automatic);
+
+Reactor::Reactor() : wheel(WHEEL_SIZE), wheel_time(std::chrono::steady_clock::now())
+{
+#if defined(__linux__)
+	epoll_descriptor = epoll_create1(EPOLL_CLOEXEC);
+	RD_ASSERT_THROW_MSG(epoll_descriptor != -1, fmt::format("Reactor: epoll_create1 failed, errno: {}", errno));
+	wake_descriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	RD_ASSERT_THROW_MSG(wake_descriptor != -1, fmt::format("Reactor: eventfd failed, errno: {}", errno));
+
+	epoll_event event{};
+	event.events = EPOLLIN;
+	event.data.fd = wake_descriptor;
+	epoll_ctl(epoll_descriptor, EPOLL_CTL_ADD, wake_descriptor, &event);
+
+	thread = std::thread(&Reactor::run, this);
+#endif
+}
+
+Reactor::~Reactor()
+{
+	stopping = true;
+	wake();
+	if (thread.joinable())
+	{
+		thread.join();
+	}
+#if defined(__linux__)
+	if (wake_descriptor != -1)
+	{
+		::close(wake_descriptor);
+	}
+	if (epoll_descriptor != -1)
+	{
+		::close(epoll_descriptor);
+	}
+#endif
+}
+
+bool Reactor::is_supported()
+{
+#if defined(__linux__)
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool Reactor::is_reactor_thread() const
+{
+	return std::this_thread::get_id() == thread.get_id();
+}
+
+void Reactor::wake() const
+{
+#if defined(__linux__)
+	if (wake_descriptor != -1)
+	{
+		const uint64_t one = 1;
+		const ssize_t written = ::write(wake_descriptor, &one, sizeof(one));
+		(void) written;
+	}
+#endif
+}
+
+Reactor::channel_t Reactor::open_channel()
+{
+	return std::make_shared<Channel>();
+}
+
+void Reactor::close(channel_t const& channel)
+{
+	channel->closed = true;
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		for (const int descriptor : channel->descriptors)
+		{
+#if defined(__linux__)
+			epoll_ctl(epoll_descriptor, EPOLL_CTL_DEL, descriptor, nullptr);
+#endif
+			watches.erase(descriptor);
+		}
+		channel->descriptors.clear();
+		for (auto it = timers.begin(); it != timers.end();)
+		{
+			it = it->second.channel == channel ? timers.erase(it) : std::next(it);
+		}
+	}
+
+	// callbacks only run on the reactor thread; from anywhere else wait for the one that may be running
+	if (!is_reactor_thread())
+	{
+		std::lock_guard<decltype(channel->lock)> guard(channel->lock);
+	}
+}
+
+void Reactor::watch(channel_t const& channel, int descriptor, callback_t on_readable)
+{
+	std::lock_guard<decltype(lock)> guard(lock);
+	if (channel->closed)
+	{
+		return;
+	}
+	watches[descriptor] = std::make_shared<Watch>(Watch{channel, std::move(on_readable)});
+	channel->descriptors.push_back(descriptor);
+#if defined(__linux__)
+	epoll_event event{};
+	event.events = EPOLLIN | EPOLLRDHUP;
+	event.data.fd = descriptor;
+	if (epoll_ctl(epoll_descriptor, EPOLL_CTL_ADD, descriptor, &event) == -1)
+	{
+		RD_LOG_ERROR(logger, "Reactor: failed to watch descriptor {}, errno: {}", descriptor, errno);
+	}
+#endif
+}
+
+void Reactor::unwatch(channel_t const& channel, int descriptor)
+{
+	std::lock_guard<decltype(lock)> guard(lock);
+	auto& descriptors = channel->descriptors;
+	const auto it = std::find(descriptors.begin(), descriptors.end(), descriptor);
+	if (it == descriptors.end())
+	{
+		return;
+	}
+	descriptors.erase(it);
+	watches.erase(descriptor);
+#if defined(__linux__)
+	epoll_ctl(epoll_descriptor, EPOLL_CTL_DEL, descriptor, nullptr);
+#endif
+}
+
+Reactor::timer_id_t Reactor::schedule(channel_t const& channel, std::chrono::milliseconds delay, callback_t callback)
+{
+	timer_id_t id = 0;
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		if (channel->closed)
+		{
+			return 0;
+		}
+		const auto now = std::chrono::steady_clock::now();
+		if (timers.empty())
+		{
+			// the wheel stands still without timers
+			wheel_time = now;
+		}
+		// counted from the last tick, which may lie up to a tick in the past
+		const auto since_tick = std::chrono::duration_cast<std::chrono::milliseconds>(now - wheel_time);
+		const size_t ticks = (std::max)(static_cast<size_t>((delay + since_tick + TICK - std::chrono::milliseconds(1)) / TICK), size_t(1));
+
+		id = next_timer_id++;
+		wheel[(wheel_position + ticks) % WHEEL_SIZE].push_back(TimerEntry{id, (ticks - 1) / WHEEL_SIZE});
+		timers.emplace(id, Timer{channel, std::move(callback)});
+	}
+	if (!is_reactor_thread())
+	{
+		wake();
+	}
+	return id;
+}
+
+void Reactor::cancel(timer_id_t id)
+{
+	// the wheel entry stays behind and is dropped when its slot comes round
+	std::lock_guard<decltype(lock)> guard(lock);
+	timers.erase(id);
+}
+
+void Reactor::invoke(channel_t const& channel, callback_t const& callback)
+{
+	std::lock_guard<decltype(channel->lock)> guard(channel->lock);
+	if (!channel->closed)
+	{
+		callback();
+	}
+}
+
+int Reactor::wait_timeout()
+{
+	std::lock_guard<decltype(lock)> guard(lock);
+	if (timers.empty())
+	{
+		return -1;
+	}
+	const auto until_tick = wheel_time + TICK - std::chrono::steady_clock::now();
+	return static_cast<int>((std::max)(std::chrono::ceil<std::chrono::milliseconds>(until_tick).count(), int64_t(0)));
+}
+
+void Reactor::advance_wheel()
+{
+	std::vector<Timer> due;
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		const auto now = std::chrono::steady_clock::now();
+		if (timers.empty())
+		{
+			return;
+		}
+		while (now - wheel_time >= TICK)
+		{
+			wheel_time += TICK;
+			wheel_position = (wheel_position + 1) % WHEEL_SIZE;
+			auto& slot = wheel[wheel_position];
+			for (size_t i = 0; i < slot.size();)
+			{
+				TimerEntry& entry = slot[i];
+				const auto it = timers.find(entry.id);
+				if (it != timers.end() && entry.rounds > 0)
+				{
+					--entry.rounds;
+					++i;
+					continue;
+				}
+				if (it != timers.end())
+				{
+					due.push_back(std::move(it->second));
+					timers.erase(it);
+				}
+				entry = slot.back();
+				slot.pop_back();
+			}
+		}
+	}
+	for (auto const& timer : due)
+	{
+		invoke(timer.channel, timer.callback);
+	}
+}
+
+void Reactor::run()
+{
+	util::set_thread_name("rd Reactor");
+#if defined(__linux__)
+	std::array<epoll_event, 64> events;
+	while (!stopping)
+	{
+		const int count = epoll_wait(epoll_descriptor, events.data(), static_cast<int>(events.size()), wait_timeout());
+		if (count == -1 && errno != EINTR)
+		{
+			RD_LOG_ERROR(logger, "Reactor: epoll_wait failed, errno: {}", errno);
+			break;
+		}
+		for (int i = 0; i < count; ++i)
+		{
+			const int descriptor = events[i].data.fd;
+			if (descriptor == wake_descriptor)
+			{
+				uint64_t value = 0;
+				const ssize_t read = ::read(wake_descriptor, &value, sizeof(value));
+				(void) read;
+				continue;
+			}
+
+			std::shared_ptr<Watch> watch;
+			{
+				std::lock_guard<decltype(lock)> guard(lock);
+				const auto it = watches.find(descriptor);
+				if (it != watches.end())
+				{
+					watch = it->second;
+				}
+			}
+			if (watch != nullptr)
+			{
+				invoke(watch->channel, watch->on_readable);
+			}
+		}
+		advance_wheel();
+	}
+#endif
+}
+
+int64_t Reactor::try_receive(int descriptor, uint8_t* data, size_t size)
+{
+#if defined(__linux__)
+	const ssize_t read = ::recv(descriptor, data, size, MSG_DONTWAIT);
+	if (read >= 0)
+	{
+		return read;
+	}
+	return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? WOULD_BLOCK : -1;
+#else
+	(void) descriptor;
+	(void) data;
+	(void) size;
+	return -1;
+#endif
+}
+
+int64_t Reactor::try_send(int descriptor, uint8_t const* data, size_t size)
+{
+#if defined(__linux__)
+	const ssize_t sent = ::send(descriptor, data, size, MSG_DONTWAIT | MSG_NOSIGNAL);
+	if (sent >= 0)
+	{
+		return sent;
+	}
+	return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? WOULD_BLOCK : -1;
+#else
+	(void) descriptor;
+	(void) data;
+	(void) size;
+	return -1;
+#endif
+}
+}	 // namespace rd
@@ -0,0 +1,171 @@
+#ifndef RD_CPP_REACTOR_H
+#define RD_CPP_REACTOR_H
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable:4251)
+#endif
+
+#include "spdlog/spdlog.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <rd_framework_export.h>
+
+namespace rd
+{
+/**
+ * \brief One I/O thread that waits for readable sockets of any number of SocketWires with epoll and runs their timers
+ * from a hashed timer wheel, instead of a receive thread and a heartbeat thread per wire.
+ *
+ * Callbacks are registered through a [Channel]. Closing a channel guarantees that none of its callbacks runs
+ * afterwards, so an owner closes its channel before it is destroyed.
+ *
+ * Only available on Linux; elsewhere [is_supported] is false and wires fall back to their own threads.
+ */
+class RD_FRAMEWORK_API Reactor
+{
+public:
+	using callback_t = std::function<void()>;
+	using timer_id_t = uint64_t;
+
+	/**
+	 * \brief Resolution of the timer wheel and the number of its slots; longer delays take several turns.
+	 */
+	static constexpr std::chrono::milliseconds TICK{10};
+	static constexpr size_t WHEEL_SIZE = 512;
+
+	/**
+	 * \brief Returned by [try_receive] and [try_send] when the socket is not ready.
+	 */
+	static constexpr int64_t WOULD_BLOCK = -2;
+
+	class Channel
+	{
+		friend class Reactor;
+
+		// held while one of the channel's callbacks runs
+		std::mutex lock;
+		// registrations on a closed channel are ignored
+		std::atomic<bool> closed{false};
+		std::vector<int> descriptors;
+	};
+
+	using channel_t = std::shared_ptr<Channel>;
+
+private:
+	static std::shared_ptr<spdlog::logger> logger;
+
+	struct Watch
+	{
+		channel_t channel;
+		callback_t on_readable;
+	};
+
+	struct TimerEntry
+	{
+		timer_id_t id;
+		size_t rounds;
+	};
+
+	struct Timer
+	{
+		channel_t channel;
+		callback_t callback;
+	};
+
+	int epoll_descriptor = -1;
+	int wake_descriptor = -1;
+
+	std::mutex lock;
+	std::unordered_map<int, std::shared_ptr<Watch>> watches;
+	std::unordered_map<timer_id_t, Timer> timers;
+	std::vector<std::vector<TimerEntry>> wheel;
+	size_t wheel_position = 0;
+	std::chrono::steady_clock::time_point wheel_time;
+	timer_id_t next_timer_id = 1;
+
+	std::atomic<bool> stopping{false};
+	std::thread thread;
+
+	void run();
+
+	void wake() const;
+
+	/**
+	 * \brief Moves the wheel to the current time and fires the timers that came due.
+	 */
+	void advance_wheel();
+
+	/**
+	 * \brief Milliseconds epoll may sleep before the next tick is due, or -1 without timers.
+	 */
+	int wait_timeout();
+
+	static void invoke(channel_t const& channel, callback_t const& callback);
+
+public:
+	// region ctor/dtor
+
+	Reactor();
+
+	Reactor(Reactor const&) = delete;
+
+	Reactor& operator=(Reactor const&) = delete;
+
+	~Reactor();
+
+	// endregion
+
+	static bool is_supported();
+
+	bool is_reactor_thread() const;
+
+	channel_t open_channel();
+
+	/**
+	 * \brief Stops every callback of [channel]. Once it returns none is running, except the caller itself when it is
+	 * called from a callback on the reactor thread.
+	 */
+	void close(channel_t const& channel);
+
+	/**
+	 * \brief Calls [on_readable] on the reactor thread while [descriptor] has data to read or was closed by the peer.
+	 */
+	void watch(channel_t const& channel, int descriptor, callback_t on_readable);
+
+	void unwatch(channel_t const& channel, int descriptor);
+
+	/**
+	 * \brief Calls [callback] once on the reactor thread after at least [delay], rounded up to [TICK].
+	 */
+	timer_id_t schedule(channel_t const& channel, std::chrono::milliseconds delay, callback_t callback);
+
+	void cancel(timer_id_t id);
+
+	/**
+	 * \brief Reads what [descriptor] has ready without waiting.
+	 * \return bytes read, 0 if the peer closed the connection, [WOULD_BLOCK] if nothing is ready, or -1 on error.
+	 */
+	static int64_t try_receive(int descriptor, uint8_t* data, size_t size);
+
+	/**
+	 * \brief Writes as much of [data] as the socket takes without waiting.
+	 * \return bytes written, [WOULD_BLOCK] if the send buffer is full, or -1 on error.
+	 */
+	static int64_t try_send(int descriptor, uint8_t const* data, size_t size);
+};
+}	 // namespace rd
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+#endif	  // RD_CPP_REACTOR_H
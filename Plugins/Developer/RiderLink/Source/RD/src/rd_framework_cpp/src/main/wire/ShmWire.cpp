@@ -0,0 +1,781 @@
+#include "wire/ShmWire.h"
+
+#include <util/thread_util.h>
+#include "util/core_util.h"
+#include "util/logging.h"
+
+#include "spdlog/sinks/stdout_color_sinks.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace rd
+{
+namespace
+{
+constexpr size_t SERVER_SIDE = 0;
+constexpr size_t CLIENT_SIDE = 1;
+
+constexpr uint32_t SEGMENT_MAGIC = 0x48534452;	  // "RDSH"
+constexpr uint32_t SEGMENT_VERSION = 1;
+
+/**
+ * \brief Longest a thread waits on a futex before it looks at its own state again.
+ */
+constexpr std::chrono::milliseconds WAIT_SLICE{50};
+
+enum SessionState : uint32_t
+{
+	// the rings are clean and a Client may attach
+	SESSION_READY = 0,
+	SESSION_ATTACHED = 1,
+	// the Client left, the Server has to clean up before the next one
+	SESSION_DETACHED = 2,
+	// the Server is gone
+	SESSION_CLOSED = 3
+};
+
+#if defined(__linux__)
+void futex_wait(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::milliseconds timeout)
+{
+	static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain 32-bit integer");
+	const auto ms = (std::max)(timeout.count(), int64_t(0));
+	timespec ts{static_cast<time_t>(ms / 1000), static_cast<long>(ms % 1000) * 1000000};
+	// not FUTEX_PRIVATE_FLAG: the word is shared with the other process
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+}
+
+void futex_wake(std::atomic<uint32_t>& word)
+{
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+}
+#else
+void futex_wait(std::atomic<uint32_t>&, uint32_t, std::chrono::milliseconds timeout)
+{
+	std::this_thread::sleep_for((std::min)(timeout, WAIT_SLICE));
+}
+
+void futex_wake(std::atomic<uint32_t>&)
+{
+}
+#endif
+
+void notify(std::atomic<uint32_t>& word)
+{
+	word.fetch_add(1);
+	futex_wake(word);
+}
+}	 // namespace
+
+/**
+ * \brief Positions of one direction's ring. They only grow; the byte at position p lives at p % capacity.
+ */
+struct ShmWire::Ring
+{
+	alignas(64) std::atomic<uint64_t> head{0};
+	// futex word the consumer sleeps on while [consumer_waiting]
+	std::atomic<uint32_t> data_signal{0};
+	std::atomic<uint32_t> consumer_waiting{0};
+
+	alignas(64) std::atomic<uint64_t> tail{0};
+	std::atomic<uint32_t> space_signal{0};
+	std::atomic<uint32_t> producer_waiting{0};
+
+	void reset()
+	{
+		head = 0;
+		tail = 0;
+		consumer_waiting = 0;
+		producer_waiting = 0;
+	}
+};
+
+/**
+ * \brief Header at the start of the shared segment. The data of ring 0 and then ring 1 follow at [DATA_OFFSET].
+ * Side s writes ring s and its own heartbeat slot.
+ */
+struct ShmWire::Segment
+{
+	std::atomic<uint32_t> magic{0};
+	uint32_t version = SEGMENT_VERSION;
+	uint64_t ring_capacity = 0;
+
+	std::atomic<uint32_t> state{SESSION_READY};
+	std::atomic<int32_t> pid[2] = {};
+
+	std::atomic<int32_t> timestamp[2] = {};
+	std::atomic<int32_t> counterpart_timestamp[2] = {};
+
+	Ring rings[2];
+
+	static constexpr size_t DATA_OFFSET = 4096;
+
+	static size_t size_for(uint64_t capacity)
+	{
+		return DATA_OFFSET + 2 * static_cast<size_t>(capacity);
+	}
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+	"atomics in shared memory must be lock-free");
+
+constexpr size_t ShmWire::Segment::DATA_OFFSET;
+constexpr int32_t ShmWire::Base::MaximumHeartbeatDelay;
+constexpr size_t ShmWire::Server::DEFAULT_RING_CAPACITY;
+
+std::shared_ptr<spdlog::logger> ShmWire::Base::logger =
+	spdlog::stderr_color_mt<spdlog::synchronous_factory>("shmWireLog", spdlog::color_mode::automatic);
+
+std::chrono::milliseconds ShmWire::timeout = std::chrono::milliseconds(500);
+
+static void copy_in(Buffer::word_t* ring, uint64_t capacity, uint64_t position, Buffer::word_t const* data, size_t size)
+{
+	const size_t offset = static_cast<size_t>(position & (capacity - 1));
+	const size_t first = (std::min)(size, static_cast<size_t>(capacity) - offset);
+	memcpy(ring + offset, data, first);
+	memcpy(ring, data + first, size - first);
+}
+
+static void copy_out(Buffer::word_t const* ring, uint64_t capacity, uint64_t position, Buffer::word_t* out, size_t size)
+{
+	const size_t offset = static_cast<size_t>(position & (capacity - 1));
+	const size_t first = (std::min)(size, static_cast<size_t>(capacity) - offset);
+	memcpy(out, ring + offset, first);
+	memcpy(out + first, ring, size - first);
+}
+
+bool ShmWire::is_supported()
+{
+#if defined(__linux__)
+	return true;
+#else
+	return false;
+#endif
+}
+
+ShmWire::Base::Base(std::string id, IScheduler* scheduler, size_t side) : WireBase(scheduler), id(std::move(id)), side(side)
+{
+}
+
+void ShmWire::Base::map_segment(void* address, size_t size)
+{
+	std::lock_guard<decltype(send_lock)> guard(send_lock);
+	segment = static_cast<Segment*>(address);
+	mapped_size = size;
+	Buffer::word_t* const data = static_cast<Buffer::word_t*>(address) + Segment::DATA_OFFSET;
+	const size_t capacity = static_cast<size_t>(segment->ring_capacity);
+	outgoing_data = data + side * capacity;
+	incoming_data = data + (1 - side) * capacity;
+}
+
+void ShmWire::Base::unmap_segment()
+{
+	std::lock_guard<decltype(send_lock)> guard(send_lock);
+	if (segment == nullptr)
+	{
+		return;
+	}
+#if defined(__linux__)
+	munmap(segment, mapped_size);
+#endif
+	segment = nullptr;
+	mapped_size = 0;
+	outgoing_data = nullptr;
+	incoming_data = nullptr;
+}
+
+ShmWire::Ring& ShmWire::Base::outgoing_ring() const
+{
+	return segment->rings[side];
+}
+
+ShmWire::Ring& ShmWire::Base::incoming_ring() const
+{
+	return segment->rings[1 - side];
+}
+
+bool ShmWire::Base::on_receiver_thread() const
+{
+	return std::this_thread::get_id() == thread.get_id();
+}
+
+bool ShmWire::Base::connection_established(int32_t timestamp, int32_t notion_timestamp)
+{
+	return timestamp - notion_timestamp <= MaximumHeartbeatDelay;
+}
+
+void ShmWire::Base::send(RdId const& rd_id, std::function<void(Buffer& buffer)> writer) const
+{
+	RD_ASSERT_MSG(!rd_id.isNull(), "{}: id mustn't be null");
+
+	const size_t size_hint = send_size_hint.load(std::memory_order_relaxed);
+	Buffer local_send_buffer = BufferPool::instance().acquire_buffer(size_hint);
+	local_send_buffer.write_integral<int32_t>(0);	 // placeholder for length
+	rd_id.write(local_send_buffer);					 // write id
+	local_send_buffer.write_integral<int16_t>(0);	 // placeholder for context
+	writer(local_send_buffer);						 // write rest
+
+	int32_t len = static_cast<int32_t>(local_send_buffer.get_position());
+	send_size_hint.store((std::max)(static_cast<size_t>(len), size_hint - size_hint / 8), std::memory_order_relaxed);
+
+	local_send_buffer.rewind();
+	local_send_buffer.write_integral<int32_t>(len - 4);
+	local_send_buffer.set_position(len);
+	Buffer::ByteArray bytes = std::move(local_send_buffer).getRealArray();
+
+	// the receiver thread never waits for room in the ring: the counterpart's sender may be waiting for it to read
+	const bool may_wait = !on_receiver_thread();
+	std::unique_lock<decltype(send_lock)> guard(send_lock, std::defer_lock);
+	if (may_wait)
+	{
+		guard.lock();
+	}
+	else
+	{
+		guard.try_lock();
+	}
+	if (!guard.owns_lock() || !session_active || !flush_backlog(may_wait))
+	{
+		append_backlog(std::move(bytes));
+		return;
+	}
+
+	const size_t written = write_some(bytes.data(), bytes.size(), may_wait);
+	if (written == bytes.size())
+	{
+		BufferPool::instance().release(std::move(bytes));
+	}
+	else if (!may_wait && session_active)
+	{
+		// the backlog was flushed under the same lock, so the rest goes out first
+		append_backlog(std::move(bytes));
+		backlog_offset = written;
+	}
+	else
+	{
+		RD_LOG_DEBUG(logger, "{}: message of {} bytes cut off by the end of the session", this->id, bytes.size());
+	}
+}
+
+void ShmWire::Base::append_backlog(Buffer::ByteArray bytes) const
+{
+	std::lock_guard<decltype(backlog_lock)> guard(backlog_lock);
+	backlog.push_back(std::move(bytes));
+}
+
+bool ShmWire::Base::flush_backlog(bool may_wait) const
+{
+	while (true)
+	{
+		Buffer::ByteArray* front = nullptr;
+		{
+			std::lock_guard<decltype(backlog_lock)> guard(backlog_lock);
+			if (backlog.empty())
+			{
+				return true;
+			}
+			// only threads holding [send_lock] pop, so the front stays put while it is written
+			front = &backlog.front();
+		}
+
+		backlog_offset += write_some(front->data() + backlog_offset, front->size() - backlog_offset, may_wait);
+		if (backlog_offset < front->size())
+		{
+			return false;
+		}
+
+		std::lock_guard<decltype(backlog_lock)> guard(backlog_lock);
+		BufferPool::instance().release(std::move(backlog.front()));
+		backlog.pop_front();
+		backlog_offset = 0;
+	}
+}
+
+size_t ShmWire::Base::write_some(Buffer::word_t const* data, size_t size, bool may_wait) const
+{
+	if (!session_active)
+	{
+		return 0;
+	}
+
+	Ring& ring = outgoing_ring();
+	const uint64_t capacity = segment->ring_capacity;
+	uint64_t head = ring.head.load(std::memory_order_relaxed);
+	size_t written = 0;
+	while (written < size)
+	{
+		const size_t room = static_cast<size_t>(capacity - (head - ring.tail.load(std::memory_order_acquire)));
+		if (room == 0)
+		{
+			if (!may_wait || !session_active || stopping)
+			{
+				break;
+			}
+			// pairs with the consumer, which advances [tail] before it looks at [producer_waiting]
+			const uint32_t seen = ring.space_signal.load();
+			ring.producer_waiting = 1;
+			if (ring.tail.load() + capacity == head)
+			{
+				futex_wait(ring.space_signal, seen, WAIT_SLICE);
+			}
+			ring.producer_waiting.store(0, std::memory_order_relaxed);
+			continue;
+		}
+
+		const size_t chunk = (std::min)(room, size - written);
+		copy_in(outgoing_data, capacity, head, data + written, chunk);
+		head += chunk;
+		written += chunk;
+		ring.head = head;
+		if (ring.consumer_waiting.load() != 0)
+		{
+			notify(ring.data_signal);
+		}
+	}
+	return written;
+}
+
+void ShmWire::Base::read_incoming(Buffer::word_t* out, size_t size)
+{
+	Ring& ring = incoming_ring();
+	const uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+	copy_out(incoming_data, segment->ring_capacity, tail, out, size);
+	ring.tail = tail + size;
+	if (ring.producer_waiting.load() != 0)
+	{
+		notify(ring.space_signal);
+	}
+}
+
+bool ShmWire::Base::receive_available()
+{
+	Ring& ring = incoming_ring();
+	while (true)
+	{
+		const size_t available = static_cast<size_t>(ring.head.load(std::memory_order_acquire) - ring.tail.load(std::memory_order_relaxed));
+		if (sz == -1)
+		{
+			if (available < sizeof(sz) + sizeof(id_))
+			{
+				return true;
+			}
+			read_incoming(reinterpret_cast<Buffer::word_t*>(&sz), sizeof(sz));
+			read_incoming(reinterpret_cast<Buffer::word_t*>(&id_), sizeof(id_));
+			if (sz < static_cast<int32_t>(sizeof(id_)))
+			{
+				RD_LOG_ERROR(logger, "{}: broken message of {} bytes", this->id, sz);
+				return false;
+			}
+			message = Buffer(static_cast<size_t>(sz) - sizeof(id_));
+			message_filled = 0;
+			continue;
+		}
+
+		const size_t length = static_cast<size_t>(sz) - sizeof(id_);
+		const size_t chunk = (std::min)(available, length - message_filled);
+		read_incoming(message.data() + message_filled, chunk);
+		message_filled += chunk;
+		if (message_filled < length)
+		{
+			return true;
+		}
+
+		RD_LOG_TRACE(logger, "{}: message received, id={}, bytes={}", this->id, id_, length);
+		message_broker.dispatch(RdId(id_), std::move(message));
+		sz = -1;
+		id_ = -1;
+	}
+}
+
+void ShmWire::Base::wait_incoming(std::chrono::milliseconds limit)
+{
+	Ring& ring = incoming_ring();
+	// pairs with the producer, which advances [head] before it looks at [consumer_waiting]
+	const uint32_t seen = ring.data_signal.load();
+	ring.consumer_waiting = 1;
+	if (ring.head.load() == ring.tail.load(std::memory_order_relaxed) && !stopping && counterpart_attached())
+	{
+		futex_wait(ring.data_signal, seen, limit);
+	}
+	ring.consumer_waiting.store(0, std::memory_order_relaxed);
+}
+
+void ShmWire::Base::on_ping(int32_t received_timestamp, int32_t received_counterpart_timestamp)
+{
+	counterpart_timestamp = received_timestamp;
+	counterpart_acknowledge_timestamp = received_counterpart_timestamp;
+
+	if (connection_established(current_timestamp, counterpart_acknowledge_timestamp))
+	{
+		if (!heartbeatAlive.get())
+		{	 // only on change
+			RD_LOG_TRACE(logger, "{}: connection is alive, current_timestamp: {}, counterpart_timestamp: {}", id, current_timestamp,
+				counterpart_timestamp);
+		}
+		heartbeatAlive.set(true);
+	}
+}
+
+bool ShmWire::Base::heartbeat()
+{
+	const size_t other = 1 - side;
+#if defined(__linux__)
+	const int32_t pid = segment->pid[other].load();
+	if (pid > 0 && kill(pid, 0) == -1 && errno == ESRCH)
+	{
+		RD_LOG_INFO(logger, "{}: counterpart process {} is gone", this->id, pid);
+		return false;
+	}
+#endif
+	on_ping(segment->timestamp[other].load(), segment->counterpart_timestamp[other].load());
+
+	if (!connection_established(current_timestamp, counterpart_acknowledge_timestamp))
+	{
+		if (heartbeatAlive.get())
+		{	 // only on change
+			RD_LOG_TRACE(logger, "{}: disconnect detected, current_timestamp: {}, counterpart_acknowledge_timestamp: {}", this->id,
+				current_timestamp, counterpart_acknowledge_timestamp);
+		}
+		heartbeatAlive.set(false);
+	}
+	segment->timestamp[side] = current_timestamp;
+	segment->counterpart_timestamp[side] = counterpart_timestamp;
+	++current_timestamp;
+	return true;
+}
+
+void ShmWire::Base::run_session()
+{
+	current_timestamp = 0;
+	counterpart_timestamp = 0;
+	counterpart_acknowledge_timestamp = 0;
+	sz = -1;
+	id_ = -1;
+	message_filled = 0;
+	{
+		std::lock_guard<decltype(send_lock)> guard(send_lock);
+		session_active = true;
+		flush_backlog(false);
+	}
+	RD_LOG_INFO(logger, "{}: connected", this->id);
+	connected.set(true);
+
+	next_heartbeat = std::chrono::steady_clock::now() + heartBeatInterval;
+	while (!stopping && counterpart_attached())
+	{
+		if (std::chrono::steady_clock::now() >= next_heartbeat)
+		{
+			if (!heartbeat())
+			{
+				break;
+			}
+			next_heartbeat += heartBeatInterval;
+		}
+
+		try
+		{
+			if (!receive_available())
+			{
+				break;
+			}
+		}
+		catch (std::exception const& ex)
+		{
+			RD_LOG_ERROR(logger, "{} caught processing | {}", this->id, ex.what());
+			break;
+		}
+
+		bool backlogged = false;
+		{
+			std::lock_guard<decltype(backlog_lock)> guard(backlog_lock);
+			backlogged = !backlog.empty();
+		}
+		if (backlogged)
+		{
+			std::unique_lock<decltype(send_lock)> guard(send_lock, std::try_to_lock);
+			backlogged = !guard.owns_lock() || !flush_backlog(false);
+		}
+
+		// with a backlog, come back soon to push it on as the counterpart makes room
+		const auto until_heartbeat = std::chrono::ceil<std::chrono::milliseconds>(next_heartbeat - std::chrono::steady_clock::now());
+		wait_incoming(backlogged ? std::chrono::milliseconds(1) : (std::max)(until_heartbeat, std::chrono::milliseconds(0)));
+	}
+
+	session_active = false;
+	notify(outgoing_ring().space_signal);
+	{
+		// waits for a sender still writing into the ring
+		std::lock_guard<decltype(send_lock)> guard(send_lock);
+		if (backlog_offset > 0)
+		{
+			// its beginning went out in this session, the rest would be garbage in the next one
+			std::lock_guard<decltype(backlog_lock)> backlog_guard(backlog_lock);
+			backlog.pop_front();
+			backlog_offset = 0;
+		}
+	}
+	message = Buffer();
+	RD_LOG_INFO(logger, "{}: disconnected", this->id);
+	connected.set(false);
+}
+
+void ShmWire::Base::wake_all() const
+{
+	if (segment == nullptr)
+	{
+		return;
+	}
+	for (Ring& ring : segment->rings)
+	{
+		notify(ring.data_signal);
+		notify(ring.space_signal);
+	}
+	futex_wake(segment->state);
+}
+
+ShmWire::Server::Server(Lifetime parentLifetime, IScheduler* scheduler, std::string name, const std::string& id, size_t ring_capacity)
+	: Base(id, scheduler, SERVER_SIDE), name(std::move(name)), serverLifetimeDefinition(parentLifetime)
+{
+#if defined(__linux__)
+	static std::atomic<uint32_t> next_index{0};
+	if (this->name.empty())
+	{
+		this->name = fmt::format("/rd-{}-{}", getpid(), next_index++);
+	}
+	size_t capacity = 4096;
+	while (capacity < ring_capacity)
+	{
+		capacity <<= 1;
+	}
+	static_assert(sizeof(Segment) <= Segment::DATA_OFFSET, "segment header overlaps the rings");
+	const size_t size = Segment::size_for(capacity);
+
+	int descriptor = shm_open(this->name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if (descriptor == -1 && errno == EEXIST)
+	{
+		// left behind by a server that crashed
+		shm_unlink(this->name.c_str());
+		descriptor = shm_open(this->name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	}
+	RD_ASSERT_THROW_MSG(descriptor != -1, fmt::format("{}: failed to create shared memory {}, errno: {}", this->id, this->name, errno));
+	void* address = MAP_FAILED;
+	if (ftruncate(descriptor, static_cast<off_t>(size)) == 0)
+	{
+		address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+	}
+	const int error = errno;
+	close(descriptor);
+	if (address == MAP_FAILED)
+	{
+		shm_unlink(this->name.c_str());
+	}
+	RD_ASSERT_THROW_MSG(address != MAP_FAILED, fmt::format("{}: failed to map shared memory {}, errno: {}", this->id, this->name, error));
+
+	Segment* const header = new (address) Segment();
+	header->ring_capacity = capacity;
+	header->pid[SERVER_SIDE] = static_cast<int32_t>(getpid());
+	// published last, a Client checks it before it reads anything else
+	header->magic.store(SEGMENT_MAGIC, std::memory_order_release);
+	map_segment(address, size);
+
+	RD_LOG_INFO(logger, "{}: listening on shared memory {}", this->id, this->name);
+#else
+	(void) ring_capacity;
+	RD_ASSERT_THROW_MSG(false, fmt::format("{}: shared memory wire is not supported on this platform", this->id));
+#endif
+
+	thread = std::thread([this]() {
+		rd::util::set_thread_name(this->id.empty() ? "ShmWire::Server Thread" : this->id.c_str());
+		while (!stopping)
+		{
+			const uint32_t state = segment->state.load();
+			if (state == SESSION_ATTACHED)
+			{
+				run_session();
+				if (!stopping)
+				{
+					reset_segment();
+				}
+			}
+			else if (state == SESSION_DETACHED)
+			{
+				reset_segment();
+			}
+			else
+			{
+				futex_wait(segment->state, state, timeout);
+			}
+		}
+		RD_LOG_INFO(logger, "{}: terminated", this->id);
+	});
+
+	serverLifetimeDefinition.lifetime->add_action([this] {
+		RD_LOG_INFO(logger, "{}: start terminating lifetime", this->id);
+		stopping = true;
+		{
+			std::lock_guard<decltype(send_lock)> guard(send_lock);
+			segment->state = SESSION_CLOSED;
+			wake_all();
+		}
+		if (thread.joinable())
+		{
+			thread.join();
+		}
+		unmap_segment();
+#if defined(__linux__)
+		shm_unlink(this->name.c_str());
+#endif
+		RD_LOG_INFO(logger, "{}: termination finished", this->id);
+	});
+}
+
+ShmWire::Server::~Server()
+{
+	if (!serverLifetimeDefinition.is_terminated())
+	{
+		serverLifetimeDefinition.terminate();
+	}
+}
+
+bool ShmWire::Server::counterpart_attached() const
+{
+	return segment->state.load() == SESSION_ATTACHED;
+}
+
+void ShmWire::Server::reset_segment()
+{
+	for (Ring& ring : segment->rings)
+	{
+		ring.reset();
+	}
+	for (size_t i = 0; i < 2; ++i)
+	{
+		segment->timestamp[i] = 0;
+		segment->counterpart_timestamp[i] = 0;
+	}
+	segment->pid[CLIENT_SIDE] = 0;
+	segment->state = SESSION_READY;
+	futex_wake(segment->state);
+}
+
+ShmWire::Client::Client(Lifetime parentLifetime, IScheduler* scheduler, std::string name, const std::string& id)
+	: Base(id, scheduler, CLIENT_SIDE), name(std::move(name)), clientLifetimeDefinition(parentLifetime)
+{
+	RD_ASSERT_THROW_MSG(is_supported(), fmt::format("{}: shared memory wire is not supported on this platform", this->id));
+
+	thread = std::thread([this]() {
+		rd::util::set_thread_name(this->id.empty() ? "ShmWire::Client Thread" : this->id.c_str());
+		RD_LOG_INFO(logger, "{}: started, shared memory: {}", this->id, this->name);
+		while (!stopping)
+		{
+			if (attach())
+			{
+				run_session();
+				detach();
+				continue;
+			}
+			std::unique_lock<decltype(lock)> guard(lock);
+			cv.wait_for(guard, timeout, [this] { return stopping.load(); });
+		}
+		RD_LOG_INFO(logger, "{}: terminated", this->id);
+	});
+
+	clientLifetimeDefinition.lifetime->add_action([this] {
+		RD_LOG_INFO(logger, "{}: start terminating lifetime", this->id);
+		{
+			std::lock_guard<decltype(lock)> guard(lock);
+			stopping = true;
+		}
+		cv.notify_all();
+		{
+			std::lock_guard<decltype(send_lock)> guard(send_lock);
+			wake_all();
+		}
+		if (thread.joinable())
+		{
+			thread.join();
+		}
+		RD_LOG_INFO(logger, "{}: termination finished", this->id);
+	});
+}
+
+ShmWire::Client::~Client()
+{
+	if (!clientLifetimeDefinition.is_terminated())
+	{
+		clientLifetimeDefinition.terminate();
+	}
+}
+
+bool ShmWire::Client::counterpart_attached() const
+{
+	return segment->state.load() == SESSION_ATTACHED;
+}
+
+bool ShmWire::Client::attach()
+{
+#if defined(__linux__)
+	const int descriptor = shm_open(name.c_str(), O_RDWR, 0);
+	if (descriptor == -1)
+	{
+		RD_LOG_DEBUG(logger, "{}: shared memory {} is not there, errno: {}", this->id, name, errno);
+		return false;
+	}
+	struct stat info{};
+	void* address = MAP_FAILED;
+	if (fstat(descriptor, &info) == 0 && static_cast<size_t>(info.st_size) >= Segment::DATA_OFFSET)
+	{
+		address = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+	}
+	close(descriptor);
+	if (address == MAP_FAILED)
+	{
+		RD_LOG_WARN(logger, "{}: failed to map shared memory {}", this->id, name);
+		return false;
+	}
+
+	const size_t size = static_cast<size_t>(info.st_size);
+	Segment* const header = static_cast<Segment*>(address);
+	const bool valid = header->magic.load(std::memory_order_acquire) == SEGMENT_MAGIC && header->version == SEGMENT_VERSION &&
+					   Segment::size_for(header->ring_capacity) <= size;
+	uint32_t expected = SESSION_READY;
+	if (!valid || !header->state.compare_exchange_strong(expected, SESSION_ATTACHED))
+	{
+		RD_LOG_DEBUG(logger, "{}: shared memory {} is {}", this->id, name, valid ? "taken" : "not a wire");
+		munmap(address, size);
+		return false;
+	}
+	// only after the session is ours, not to overwrite the pid of another Client
+	header->pid[CLIENT_SIDE] = static_cast<int32_t>(getpid());
+	futex_wake(header->state);
+
+	map_segment(address, size);
+	return true;
+#else
+	return false;
+#endif
+}
+
+void ShmWire::Client::detach()
+{
+	{
+		std::lock_guard<decltype(send_lock)> guard(send_lock);
+		uint32_t expected = SESSION_ATTACHED;
+		segment->state.compare_exchange_strong(expected, SESSION_DETACHED);
+		wake_all();
+	}
+	unmap_segment();
+}
+}	 // namespace rd
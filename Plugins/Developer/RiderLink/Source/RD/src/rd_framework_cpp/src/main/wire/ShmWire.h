@@ -0,0 +1,240 @@
+#ifndef RD_CPP_SHMWIRE_H
+#define RD_CPP_SHMWIRE_H
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable:4251)
+#endif
+
+#include "scheduler/base/IScheduler.h"
+#include "base/WireBase.h"
+#include "protocol/BufferPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <rd_framework_export.h>
+
+namespace rd
+{
+/**
+ * \brief Wire between two processes on the same host through a POSIX shared memory segment, without a socket.
+ *
+ * The segment holds one single-producer/single-consumer byte ring per direction. Messages are framed as in the V1 socket
+ * format. Senders write into the ring under a lock and wake the counterpart with a futex only while it sleeps, so a busy
+ * connection costs no syscalls. Heartbeats are counters in the segment header, with the same [heartbeatAlive] semantics as
+ * SocketWire; [connected] drops once the counterpart detaches or its process is gone.
+ *
+ * The Server creates the segment under [name] and accepts one Client at a time; the Client attaches by that name. Only
+ * available on Linux, see [is_supported].
+ */
+class RD_FRAMEWORK_API ShmWire
+{
+	static std::chrono::milliseconds timeout;
+
+	struct Segment;
+	struct Ring;
+
+public:
+	static bool is_supported();
+
+	class RD_FRAMEWORK_API Base : public WireBase
+	{
+	protected:
+		static std::shared_ptr<spdlog::logger> logger;
+
+		std::string id;
+
+		/**
+		 * \brief Index of this side's ring and heartbeat slot in the segment.
+		 */
+		const size_t side;
+
+		std::thread thread{};
+		std::atomic<bool> stopping{false};
+
+		// region mapping, changed by the receiver thread with [send_lock] held
+		Segment* segment = nullptr;
+		size_t mapped_size = 0;
+		Buffer::word_t* outgoing_data = nullptr;
+		Buffer::word_t const* incoming_data = nullptr;
+		// endregion
+
+		/**
+		 * \brief Serializes writes into the outgoing ring, which has a single producer at a time.
+		 */
+		mutable std::mutex send_lock;
+		mutable std::atomic<bool> session_active{false};
+
+		/**
+		 * \brief Messages sent while disconnected, or on the receiver thread while the ring was full. They go out before any
+		 * later message; the front one may be partially written already.
+		 */
+		mutable std::mutex backlog_lock;
+		mutable std::deque<Buffer::ByteArray> backlog;
+		mutable size_t backlog_offset = 0;
+
+		mutable std::atomic<size_t> send_size_hint{BufferPool::MIN_CLASS_CAPACITY};
+
+		// region receiver state, owned by the receiver thread
+		int32_t current_timestamp = 0;
+		int32_t counterpart_timestamp = 0;
+		int32_t counterpart_acknowledge_timestamp = 0;
+		std::chrono::steady_clock::time_point next_heartbeat{};
+
+		int32_t sz = -1;
+		RdId::hash_t id_ = -1;
+		Buffer message;
+		size_t message_filled = 0;
+		// endregion
+
+		Base(std::string id, IScheduler* scheduler, size_t side);
+
+		/**
+		 * \brief Sets the mapping up after [segment] was mapped at [address].
+		 */
+		void map_segment(void* address, size_t size);
+
+		void unmap_segment();
+
+		Ring& outgoing_ring() const;
+
+		Ring& incoming_ring() const;
+
+		/**
+		 * \brief Copies what fits of [data] into the outgoing ring, waiting for room unless [may_wait] is false.
+		 * Must be called with [send_lock] held.
+		 * \return bytes written.
+		 */
+		size_t write_some(Buffer::word_t const* data, size_t size, bool may_wait) const;
+
+		/**
+		 * \brief Writes the backlog in order. Must be called with [send_lock] held.
+		 * \return true if the backlog is empty afterwards.
+		 */
+		bool flush_backlog(bool may_wait) const;
+
+		void append_backlog(Buffer::ByteArray bytes) const;
+
+		bool on_receiver_thread() const;
+
+		/**
+		 * \brief Serves one attached counterpart until either side detaches.
+		 */
+		void run_session();
+
+		/**
+		 * \brief Reads and dispatches what the incoming ring holds, keeping a partially received message for later.
+		 */
+		bool receive_available();
+
+		void read_incoming(Buffer::word_t* out, size_t size);
+
+		void wait_incoming(std::chrono::milliseconds limit);
+
+		/**
+		 * \brief Exchanges heartbeats through the segment header.
+		 * \return false if the counterpart's process is gone.
+		 */
+		bool heartbeat();
+
+		void on_ping(int32_t received_timestamp, int32_t received_counterpart_timestamp);
+
+		/**
+		 * \brief Whether the session on the current segment is still on from the counterpart's side.
+		 */
+		virtual bool counterpart_attached() const = 0;
+
+		/**
+		 * \brief Wakes every thread of this wire that waits on the segment, after [stopping] was set.
+		 */
+		void wake_all() const;
+
+	public:
+		static constexpr int32_t MaximumHeartbeatDelay = 3;
+		std::chrono::milliseconds heartBeatInterval = std::chrono::milliseconds(500);
+
+		// region ctor/dtor
+
+		virtual ~Base() override = default;
+
+		// endregion
+
+		void send(RdId const& rd_id, std::function<void(Buffer& buffer)> writer) const override;
+
+		static bool connection_established(int32_t timestamp, int32_t acknowledged_timestamp);
+	};
+
+	class RD_FRAMEWORK_API Server : public Base
+	{
+	public:
+		static constexpr size_t DEFAULT_RING_CAPACITY = 1u << 22;
+
+		/**
+		 * \brief Name of the segment for [shm_open], to be handed to the Client.
+		 */
+		std::string name;
+
+		// region ctor/dtor
+
+		/**
+		 * \brief Creates the segment under [name], or under a fresh name if it is empty.
+		 * \param ring_capacity bytes of each direction's ring, rounded up to a power of two.
+		 */
+		Server(Lifetime lifetime, IScheduler* scheduler, std::string name = "", const std::string& id = "ShmServer",
+			size_t ring_capacity = DEFAULT_RING_CAPACITY);
+
+		virtual ~Server() override;
+		// endregion
+
+	private:
+		LifetimeDefinition serverLifetimeDefinition;
+
+		bool counterpart_attached() const override;
+
+		/**
+		 * \brief Clears the rings and heartbeats of a finished session and lets the next Client attach.
+		 */
+		void reset_segment();
+	};
+
+	class RD_FRAMEWORK_API Client : public Base
+	{
+	public:
+		std::string name;
+
+		// region ctor/dtor
+
+		Client(Lifetime lifetime, IScheduler* scheduler, std::string name, const std::string& id = "ShmClient");
+
+		virtual ~Client() override;
+		// endregion
+
+	private:
+		LifetimeDefinition clientLifetimeDefinition;
+
+		// wakes the receiver thread between attempts to attach
+		std::mutex lock;
+		std::condition_variable cv;
+
+		bool counterpart_attached() const override;
+
+		/**
+		 * \brief Maps the Server's segment and takes its free session.
+		 */
+		bool attach();
+
+		void detach();
+	};
+};
+}	 // namespace rd
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+#endif	  // RD_CPP_SHMWIRE_H
@@ -1,6 +1,7 @@
 #include "wire/SocketWire.h"
 
 #include <util/thread_util.h>
+#include "util/logging.h"
 
 #include "spdlog/sinks/stdout_color_sinks.h"
 
@@ -11,6 +12,8 @@
 #include <utility>
 #include <thread>
 #include <csignal>
+#include <algorithm>
+#include <cstring>
 
 namespace rd
 {
@@ -21,14 +24,89 @@ std::chrono::milliseconds SocketWire::timeout = std::chrono::milliseconds(500);
 
 constexpr int32_t SocketWire::Base::ACK_MESSAGE_LENGTH;
 constexpr int32_t SocketWire::Base::PING_MESSAGE_LENGTH;
+constexpr int32_t SocketWire::Base::HELLO_MESSAGE_LENGTH;
+constexpr int32_t SocketWire::Base::SWITCH_MESSAGE_LENGTH;
 constexpr int32_t SocketWire::Base::PACKAGE_HEADER_LENGTH;
+constexpr size_t SocketWire::Base::MESSAGE_PREFIX_LENGTH;
+constexpr size_t SocketWire::Base::MAX_FRAME_HEADER_LENGTH;
+constexpr size_t SocketWire::Base::MAX_INTERNED_IDS;
+constexpr size_t SocketWire::Base::RECEIVE_BLOCK_SIZE;
+constexpr size_t SocketWire::Base::MIN_VIEW_MESSAGE_SIZE;
+constexpr size_t SocketWire::Base::DEFAULT_WINDOW_LIMIT;
+constexpr size_t SocketWire::Base::MIN_RECEIVE_SPACE;
+
+static Buffer::word_t* put_varint(Buffer::word_t* out, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		*out++ = static_cast<Buffer::word_t>(value | 0x80);
+		value >>= 7;
+	}
+	*out++ = static_cast<Buffer::word_t>(value);
+	return out;
+}
+
+/**
+ * \brief Decodes a varint from [in] without consuming anything unless all of it is there.
+ * A malformed varint counts as complete and is reported when the frame is read.
+ */
+static bool peek_varint(Buffer::word_t const*& in, Buffer::word_t const* end, uint64_t& x)
+{
+	x = 0;
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		if (in == end)
+		{
+			return false;
+		}
+		const Buffer::word_t byte = *in++;
+		x |= static_cast<uint64_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+		{
+			return true;
+		}
+	}
+	return true;
+}
+
+template <typename T>
+static Buffer::word_t* put_integral(Buffer::word_t* out, T value)
+{
+	memcpy(out, &value, sizeof(T));
+	return out + sizeof(T);
+}
+
+/**
+ * \brief HELLO or SWITCH control frame: a negative length and an int32 version in V1, a tag and a varint version in V2.
+ */
+static Buffer::word_t* put_version_frame(
+	Buffer::word_t* out, WireFormat frame_format, int32_t v1_length, uint8_t v2_tag, WireFormat version)
+{
+	if (frame_format == WireFormat::V1)
+	{
+		out = put_integral(out, v1_length);
+		return put_integral(out, static_cast<int32_t>(version));
+	}
+	out = put_varint(out, v2_tag);
+	return put_varint(out, static_cast<uint8_t>(version));
+}
 
-SocketWire::Base::Base(std::string id, Lifetime parentLifetime, IScheduler* scheduler)
+SocketWire::Base::Base(std::string id, Lifetime parentLifetime, IScheduler* scheduler, std::shared_ptr<Reactor> reactor)
 	: WireBase(scheduler), id(std::move(id)), scheduler(scheduler), lifetimeDef(parentLifetime)
 {
+	if (reactor != nullptr && !Reactor::is_supported())
+	{
+		RD_LOG_WARN(logger, "{}: reactor is not supported on this platform, falling back to a thread per wire", this->id);
+	}
+	else if (reactor != nullptr)
+	{
+		this->reactor = std::move(reactor);
+		reactor_channel = this->reactor->open_channel();
+	}
+
+	async_send_buffer.set_window_limit(DEFAULT_WINDOW_LIMIT);
 	async_send_buffer.pause("initial");
 	async_send_buffer.start();
-	ping_pkg_header.write_integral(PING_MESSAGE_LENGTH);
 }
 
 SocketWire::Base::~Base()
@@ -47,81 +125,242 @@ void SocketWire::Base::receiverProc() const
 		{
 			if (!socket_provider->IsSocketValid())
 			{
-				logger->debug("{}: stop receive messages because socket disconnected", this->id);
+				RD_LOG_DEBUG(logger, "{}: stop receive messages because socket disconnected", this->id);
 				//					async_send_buffer.terminate();
 				break;
 			}
 
 			if (!read_and_dispatch_message())
 			{
-				logger->debug("{}: connection was gracefully shutdown", id);
+				RD_LOG_DEBUG(logger, "{}: connection was gracefully shutdown", id);
 				//					async_send_buffer.terminate();
 				break;
 			}
 		}
 		catch (std::exception const& ex)
 		{
-			logger->error("{} caught processing | {}", this->id, ex.what());
+			RD_LOG_ERROR(logger, "{} caught processing | {}", this->id, ex.what());
 			//				async_send_buffer.terminate();
 			break;
 		}
 	}
 }
 
-bool SocketWire::Base::send0(Buffer::ByteArray const& msg, sequence_number_t seqn) const
+size_t SocketWire::Base::send_batch(ByteBufferAsyncProcessor::packet_iterator first,
+	ByteBufferAsyncProcessor::packet_iterator last, sequence_number_t first_seqn) const
 {
+	constexpr size_t MAX_PACKETS = ByteBufferAsyncProcessor::MAX_BATCH_PACKETS;
+
+	const size_t count = static_cast<size_t>(std::distance(first, last));
+	RD_ASSERT_MSG(count <= MAX_PACKETS, fmt::format("{}: batch of {} packets exceeds the limit of {}", this->id, count, MAX_PACKETS))
+
+	bool is_negotiated = false;
+	WireFormat counterpart_format = WireFormat::V1;
+	{
+		std::lock_guard<decltype(negotiation_lock)> guard(negotiation_lock);
+		is_negotiated = negotiated;
+		counterpart_format = connection_format;
+	}
+
+	std::array<Buffer::word_t, MAX_FRAME_HEADER_LENGTH * MAX_PACKETS> headers;
+	std::array<iovec, 2 * MAX_PACKETS> vectors;
+	// stream offset at which each packet ends, to tell which packets made it out on a short write
+	std::array<size_t, MAX_PACKETS> packet_ends;
+
+	size_t framed = 0;
+	size_t total = 0;
+	size_t written = 0;
+	bool undeliverable = false;
 	try
 	{
 		std::lock_guard<decltype(socket_send_lock)> guard(socket_send_lock);
 
-		int32_t msglen = static_cast<int32_t>(msg.size());
-
-		send_package_header.rewind();
-		send_package_header.write_integral(msglen);
-		send_package_header.write_integral(seqn);
-
-		RD_ASSERT_THROW_MSG(
-			socket_provider->Send(send_package_header.data(), send_package_header.get_position()) == PACKAGE_HEADER_LENGTH,
-			this->id +
-				": failed to send header over the network"
-				", reason: " +
-				socket_provider->DescribeError())
-
-		RD_ASSERT_THROW_MSG(socket_provider->Send(msg.data(), msglen) == msglen, this->id +
-																					 ": failed to send package over the network"
-																					 ", reason: " +
-																					 socket_provider->DescribeError());
-		logger->info("{}: were sent {} bytes", this->id, msglen);
-		//        RD_ASSERT_MSG(socketProvider->Flush(), "{}: failed to flush");
-		return true;
+		int32_t vector_count = 0;
+		for (auto it = first; it != last; ++it, ++framed)
+		{
+			OutgoingPacket const& packet = *it;
+			const sequence_number_t seqn = first_seqn + static_cast<sequence_number_t>(framed);
+
+			if (packet.format != WireFormat::V1 && !is_negotiated)
+			{
+				// held back until the counterpart's HELLO arrives, which resends everything pending
+				break;
+			}
+			if (packet.format > counterpart_format)
+			{
+				// the body cannot be rewritten without its schema, and skipping it would leave the counterpart out of sync
+				RD_LOG_ERROR(logger, "{}: package seqn={} was serialized in v{} but the counterpart only accepts v{}, closing the connection",
+					this->id, seqn, static_cast<int>(packet.format), static_cast<int>(counterpart_format));
+				undeliverable = true;
+				break;
+			}
+
+			Buffer::word_t* const header = headers.data() + framed * MAX_FRAME_HEADER_LENGTH;
+			Buffer::word_t* out = header;
+			if (packet.format != send_format)
+			{
+				out = put_version_frame(out, send_format, SWITCH_MESSAGE_LENGTH, V2_SWITCH_TAG, packet.format);
+				send_format = packet.format;
+				sent_ids.clear();
+			}
+
+			Buffer::word_t const* payload = packet.bytes.data();
+			size_t payload_length = packet.bytes.size();
+			if (send_format == WireFormat::V1)
+			{
+				out = put_integral(out, static_cast<int32_t>(payload_length));
+				out = put_integral(out, seqn);
+			}
+			else
+			{
+				RdId::hash_t rd_id = 0;
+				memcpy(&rd_id, payload + sizeof(int32_t), sizeof(rd_id));
+				payload += MESSAGE_PREFIX_LENGTH;
+				payload_length -= MESSAGE_PREFIX_LENGTH;
+
+				out = put_varint(out, payload_length + V2_DATA_TAG);
+				out = put_varint(out, static_cast<uint64_t>(seqn));
+				out = put_interned_id(out, rd_id);
+			}
+
+			const size_t header_length = static_cast<size_t>(out - header);
+			vectors[vector_count++] = {header, header_length};
+			vectors[vector_count++] = {const_cast<Buffer::word_t*>(payload), payload_length};
+
+			total += header_length + payload_length;
+			packet_ends[framed] = total;
+		}
+
+		iovec* pending = vectors.data();
+		int32_t pending_count = vector_count;
+		while (written < total)
+		{
+			const int32_t sent = socket_provider->Send(pending, pending_count);
+			++send_syscalls;
+			if (sent == -1 && socket_provider->GetSocketError() == CSimpleSocket::SocketInterrupted)
+			{
+				continue;
+			}
+			RD_ASSERT_THROW_MSG(sent > 0, this->id +
+											  ": failed to send package over the network"
+											  ", reason: " +
+											  socket_provider->DescribeError())
+
+			written += sent;
+
+			// drop the vectors written completely and trim the one written partially
+			size_t rest = static_cast<size_t>(sent);
+			while (pending_count > 0 && rest >= pending->iov_len)
+			{
+				rest -= pending->iov_len;
+				++pending;
+				--pending_count;
+			}
+			if (rest > 0)
+			{
+				pending->iov_base = static_cast<Buffer::word_t*>(pending->iov_base) + rest;
+				pending->iov_len -= rest;
+			}
+		}
+		RD_LOG_DEBUG(logger, "{}: were sent {} packets, {} bytes", this->id, framed, total);
+
+		if (undeliverable)
+		{
+			shutdown_socket();
+		}
 	}
 	catch (std::exception const& e)
 	{
-		//			async_send_buffer.pause("send0");
-		logger->warn("Send0 failed due to: | {}", e.what());
-		return false;
+		RD_LOG_WARN(logger, "send_batch failed due to: | {}", e.what());
+	}
+
+	const size_t completed =
+		static_cast<size_t>(std::upper_bound(packet_ends.begin(), packet_ends.begin() + framed, written) - packet_ends.begin());
+	sent_packets += completed;
+	sent_bytes += written;
+	return completed;
+}
+
+Buffer::word_t* SocketWire::Base::put_interned_id(Buffer::word_t* out, RdId::hash_t rd_id) const
+{
+	// even: index of an id sent before; 1: new id that takes the next index; 3: id sent as is, the table is full
+	const auto it = sent_ids.find(rd_id);
+	if (it != sent_ids.end())
+	{
+		return put_varint(out, static_cast<uint64_t>(it->second) << 1);
+	}
+	if (sent_ids.size() < MAX_INTERNED_IDS)
+	{
+		sent_ids.emplace(rd_id, static_cast<uint32_t>(sent_ids.size()));
+		out = put_varint(out, 1);
 	}
+	else
+	{
+		out = put_varint(out, 3);
+	}
+	return put_integral(out, rd_id);
+}
+
+SocketWire::Base::SendStats SocketWire::Base::get_send_stats() const
+{
+	SendStats stats;
+	stats.packets = sent_packets.load();
+	stats.syscalls = send_syscalls.load();
+	stats.bytes = sent_bytes.load();
+	return stats;
+}
+
+SocketWire::Base::ReceiveStats SocketWire::Base::get_receive_stats() const
+{
+	ReceiveStats stats;
+	stats.messages = received_messages.load();
+	stats.packages = received_packages.load();
+	stats.bytes = received_bytes.load();
+	stats.copied_bytes = receive_copied_bytes.load();
+	stats.acks = sent_acks.load();
+	return stats;
+}
+
+ByteBufferAsyncProcessor::WindowStats SocketWire::Base::get_window_stats() const
+{
+	return async_send_buffer.get_window_stats();
+}
+
+void SocketWire::Base::set_window_limit(size_t bytes)
+{
+	async_send_buffer.set_window_limit(bytes);
 }
 
 void SocketWire::Base::send(RdId const& rd_id, std::function<void(Buffer& buffer)> writer) const
 {
 	RD_ASSERT_MSG(!rd_id.isNull(), "{}: id mustn't be null");
 
-	Buffer local_send_buffer;
+	// size the pooled storage after recent messages so typical ones are written without growing
+	const size_t size_hint = send_size_hint.load(std::memory_order_relaxed);
+	const WireFormat format = body_format.load();
+	Buffer local_send_buffer = BufferPool::instance().acquire_buffer(size_hint);
+	local_send_buffer.set_format(format);
 	local_send_buffer.write_integral<int32_t>(0);	 // placeholder for length
 	rd_id.write(local_send_buffer);					 // write id
 	local_send_buffer.write_integral<int16_t>(0);	 // placeholder for context
 	writer(local_send_buffer);						 // write rest
 
 	int32_t len = static_cast<int32_t>(local_send_buffer.get_position());
+	send_size_hint.store((std::max)(static_cast<size_t>(len), size_hint - size_hint / 8), std::memory_order_relaxed);
 
 	local_send_buffer.rewind();
 	local_send_buffer.write_integral<int32_t>(len - 4);
 	local_send_buffer.set_position(len);
-	async_send_buffer.put(std::move(local_send_buffer).getRealArray());
+	// the receiver thread must not wait for acknowledges, it is the one that reads them
+	async_send_buffer.put({std::move(local_send_buffer).getRealArray(), format}, !on_receiver_thread());
 }
 
-void SocketWire::Base::set_socket_provider(std::shared_ptr<CActiveSocket> new_socket)
+bool SocketWire::Base::on_receiver_thread() const
+{
+	return reactor != nullptr ? reactor->is_reactor_thread() : std::this_thread::get_id() == thread.get_id();
+}
+
+bool SocketWire::Base::install_socket(std::shared_ptr<CActiveSocket> new_socket)
 {
 	{
 		std::lock_guard<decltype(socket_send_lock)> guard(socket_send_lock);
@@ -132,8 +371,29 @@ void SocketWire::Base::set_socket_provider(std::shared_ptr<CActiveSocket> new_so
 		std::lock_guard<decltype(lock)> guard(lock);
 		if (lifetimeDef.lifetime->is_terminated())
 		{
-			return;
+			return false;
+		}
+	}
+
+	reset_connection_state();
+	if (preferred_format != WireFormat::V1)
+	{
+		// newer-format packets wait for the counterpart's answer; older ones go out meanwhile on reprocessing
+		async_send_buffer.pause("Negotiation");
+		{
+			std::lock_guard<decltype(negotiation_lock)> guard(negotiation_lock);
+			negotiation_pause = true;
 		}
+		send_hello();
+	}
+	return true;
+}
+
+void SocketWire::Base::set_socket_provider(std::shared_ptr<CActiveSocket> new_socket)
+{
+	if (!install_socket(std::move(new_socket)))
+	{
+		return;
 	}
 
 	auto heartbeat = LifetimeDefinition::use([this](Lifetime heartbeatLifetime) {
@@ -147,22 +407,31 @@ void SocketWire::Base::set_socket_provider(std::shared_ptr<CActiveSocket> new_so
 
 		connected.set(false);
 
+		// bodies are written in v1 again until the next counterpart answers, it may be an older one
+		body_format = WireFormat::V1;
+		end_negotiation_pause();
+
 		async_send_buffer.pause("Disconnected");
 
 		return heartbeat;
 	});
 	const auto status = heartbeat.wait_for(timeout);
 
-	logger->debug("{}: waited for heartbeat to stop with status: {}", this->id, static_cast<uint32_t>(status));
+	RD_LOG_DEBUG(logger, "{}: waited for heartbeat to stop with status: {}", this->id, static_cast<uint32_t>(status));
 
+	shutdown_socket();
+}
+
+void SocketWire::Base::shutdown_socket() const
+{
 	if (!socket_provider->IsSocketValid())
 	{
-		logger->debug("{}: socket was already shut down", this->id);
+		RD_LOG_DEBUG(logger, "{}: socket was already shut down", this->id);
 	}
 	else if (!socket_provider->Shutdown(CSimpleSocket::Both))
 	{
 		// double close?
-		logger->warn("{}: possibly double close after disconnect", this->id);
+		RD_LOG_WARN(logger, "{}: possibly double close after disconnect", this->id);
 	}
 }
 
@@ -182,6 +451,70 @@ std::future<void> SocketWire::Base::start_heartbeat(Lifetime lifetime)
 	});
 }
 
+void SocketWire::Base::reserve_receive_block(size_t size) const
+{
+	if (receive_block != nullptr && lo + size <= receive_block->size())
+	{
+		return;
+	}
+
+	const size_t unread = hi - lo;
+	// only this thread creates views of the block, so once no view is left it can be reused in place
+	if (receive_block != nullptr && receive_block.use_count() == 1 && size <= receive_block->size())
+	{
+		if (lo == 0)
+		{
+			return;
+		}
+		std::copy(receive_block->begin() + lo, receive_block->begin() + hi, receive_block->begin());
+	}
+	else
+	{
+		std::shared_ptr<Buffer::ByteArray> block(
+			new Buffer::ByteArray(BufferPool::instance().acquire((std::max)(size, RECEIVE_BLOCK_SIZE))), [](Buffer::ByteArray* array) {
+				BufferPool::instance().release(std::move(*array));
+				delete array;
+			});
+		if (unread > 0)
+		{
+			std::copy(receive_block->begin() + lo, receive_block->begin() + hi, block->begin());
+		}
+		receive_block = std::move(block);
+	}
+	receive_copied_bytes += unread;
+	lo = 0;
+	hi = unread;
+}
+
+bool SocketWire::Base::receive_into_block() const
+{
+	// the receive may block, so whatever was received up to here is acknowledged first
+	flush_ack();
+
+	RD_LOG_TRACE(logger, "{}: receive started", this->id);
+	const int32_t read =
+		socket_provider->Receive(static_cast<int32_t>(receive_block->size() - hi), receive_block->data() + hi);
+	if (read == -1)
+	{
+		auto err = socket_provider->GetSocketError();
+		if (err == CSimpleSocket::SocketInvalidSocket)
+		{
+			RD_LOG_INFO(logger, "{}: socket was shut down for receiving", this->id);
+			return false;
+		}
+		RD_LOG_ERROR(logger, "{}: error has occurred while receiving", this->id);
+		return false;
+	}
+	if (read == 0)
+	{
+		RD_LOG_INFO(logger, "{}: socket was shut down for receiving", this->id);
+		return false;
+	}
+	hi += read;
+	RD_LOG_TRACE(logger, "{}: receive finished: {} bytes read", this->id, read);
+	return true;
+}
+
 bool SocketWire::Base::read_from_socket(Buffer::word_t* res, int32_t msglen) const
 {
 	int32_t ptr = 0;
@@ -195,139 +528,285 @@ bool SocketWire::Base::read_from_socket(Buffer::word_t* res, int32_t msglen) con
 		if (available > 0)
 		{
 			int32_t copylen = (std::min)(rest, available);
-			std::copy(lo, lo + copylen, res + ptr);
+			std::copy(receive_block->begin() + lo, receive_block->begin() + lo + copylen, res + ptr);
 			lo += copylen;
 			ptr += copylen;
 		}
 		else
 		{
-			if (hi == receiver_buffer.end())
-			{
-				hi = lo = receiver_buffer.begin();
-			}
-			logger->info("{}: receive started", this->id);
-			int32_t read = socket_provider->Receive(static_cast<int32_t>(receiver_buffer.end() - hi), &*hi);
-			if (read == -1)
-			{
-				auto err = socket_provider->GetSocketError();
-				if (err == CSimpleSocket::SocketInvalidSocket)
-				{
-					logger->info("{}: socket was shut down for receiving", this->id);
-					return false;
-				}
-				logger->error("{}: error has occurred while receiving", this->id);
-				return false;
-			}
-			if (read == 0)
+			reserve_receive_block(1);
+			if (!receive_into_block())
 			{
-				logger->info("{}: socket was shut down for receiving", this->id);
 				return false;
 			}
-			hi += read;
-			if (read > 0)
-			{
-				logger->info("{}: receive finished: {} bytes read", this->id, read);
-			}
 		}
 	}
-	if (ptr != msglen)
+	return true;
+}
+
+bool SocketWire::Base::read_slice_from_socket(size_t len, Buffer& out) const
+{
+	reserve_receive_block(len);
+	while (hi - lo < len)
 	{
-		logger->error("read invalid number of bytes from socket, expected: {}, actual: {}", msglen, ptr);
-		assert(false);
+		if (!receive_into_block())
+		{
+			return false;
+		}
 	}
+	out = Buffer(receive_block, lo, len);
+	lo += len;
+	received_bytes += len;
 	return true;
 }
 
-static constexpr std::pair<int, sequence_number_t> INVALID_HEADER = std::make_pair(-1, -1);
+bool SocketWire::Base::read_varint_from_socket(uint64_t& x) const
+{
+	x = 0;
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		Buffer::word_t byte = 0;
+		if (!read_integral_from_socket(byte))
+		{
+			return false;
+		}
+		x |= static_cast<uint64_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+		{
+			return true;
+		}
+	}
+	RD_LOG_ERROR(logger, "{}: malformed varint in package header", this->id);
+	return false;
+}
+
+bool SocketWire::Base::read_header(PackageHeader& header) const
+{
+	do
+	{
+		header = PackageHeader();
+		if (!read_frame(header))
+		{
+			return false;
+		}
+	} while (header.len < 0);
+	return true;
+}
 
-std::pair<int, sequence_number_t> SocketWire::Base::read_header() const
+bool SocketWire::Base::read_frame(PackageHeader& header) const
 {
-	int32_t len = 0;
-	sequence_number_t seqn = 0;
-	while (true)
+	if (receive_format == WireFormat::V1)
 	{
+		int32_t len = 0;
 		if (!read_integral_from_socket(len))
 		{
-			return INVALID_HEADER;
+			return false;
 		}
 		if (len == PING_MESSAGE_LENGTH)
 		{
 			int32_t received_timestamp = 0;
 			int32_t received_counterpart_timestamp = 0;
-			if (!read_integral_from_socket(received_timestamp))
+			if (!read_integral_from_socket(received_timestamp) || !read_integral_from_socket(received_counterpart_timestamp))
 			{
-				return INVALID_HEADER;
+				return false;
 			}
-			if (!read_integral_from_socket(received_counterpart_timestamp))
+			on_ping(received_timestamp, received_counterpart_timestamp);
+			return true;
+		}
+		if (len == HELLO_MESSAGE_LENGTH || len == SWITCH_MESSAGE_LENGTH)
+		{
+			int32_t version = 0;
+			if (!read_integral_from_socket(version))
 			{
-				return INVALID_HEADER;
+				return false;
 			}
-
-			counterpart_timestamp = received_timestamp;
-			counterpart_acknowledge_timestamp = received_counterpart_timestamp;
-
-			if ((connection_established(current_timestamp, counterpart_acknowledge_timestamp)))
+			if (len == HELLO_MESSAGE_LENGTH)
 			{
-				if (!heartbeatAlive.get())
-				{	 // only on change
-					logger->trace(
-						"Connection is alive after receiving PING {}: "
-						"received_timestamp: {}, "
-						"received_counterpart_timestamp: {}, "
-						"current_timestamp: {}, "
-						"counterpart_timestamp: {}, "
-						"counterpart_acknowledge_timestamp: {}, ",
-						id, received_timestamp, received_counterpart_timestamp, current_timestamp, counterpart_timestamp,
-						counterpart_acknowledge_timestamp);
-				}
-				heartbeatAlive.set(true);
+				on_hello(version);
+			}
+			else if (!on_switch(version))
+			{
+				return false;
 			}
-			continue;
+			return true;
 		}
+
+		sequence_number_t seqn = 0;
 		if (!read_integral_from_socket(seqn))
 		{
-			return INVALID_HEADER;
+			return false;
 		}
-
 		if (len == ACK_MESSAGE_LENGTH)
 		{
 			async_send_buffer.acknowledge(seqn);
-			continue;
+			return true;
+		}
+
+		header.len = len;
+		header.seqn = seqn;
+		header.id = 0;
+		return true;
+	}
+
+	uint64_t tag = 0;
+	if (!read_varint_from_socket(tag))
+	{
+		return false;
+	}
+	switch (tag)
+	{
+		case V2_ACK_TAG:
+		{
+			uint64_t seqn = 0;
+			if (!read_varint_from_socket(seqn))
+			{
+				return false;
+			}
+			async_send_buffer.acknowledge(static_cast<sequence_number_t>(seqn));
+			return true;
+		}
+		case V2_PING_TAG:
+		{
+			uint64_t received_timestamp = 0;
+			uint64_t received_counterpart_timestamp = 0;
+			if (!read_varint_from_socket(received_timestamp) || !read_varint_from_socket(received_counterpart_timestamp))
+			{
+				return false;
+			}
+			on_ping(static_cast<int32_t>(received_timestamp), static_cast<int32_t>(received_counterpart_timestamp));
+			return true;
+		}
+		case V2_HELLO_TAG:
+		case V2_SWITCH_TAG:
+		{
+			uint64_t version = 0;
+			if (!read_varint_from_socket(version))
+			{
+				return false;
+			}
+			if (tag == V2_HELLO_TAG)
+			{
+				on_hello(static_cast<int32_t>(version));
+			}
+			else if (!on_switch(static_cast<int32_t>(version)))
+			{
+				return false;
+			}
+			return true;
+		}
+		default:
+			break;
+	}
+
+	uint64_t seqn = 0;
+	uint64_t id_ref = 0;
+	if (!read_varint_from_socket(seqn) || !read_varint_from_socket(id_ref))
+	{
+		return false;
+	}
+	if ((id_ref & 1) == 0)
+	{
+		const size_t index = static_cast<size_t>(id_ref >> 1);
+		if (index >= received_ids.size())
+		{
+			RD_LOG_ERROR(logger, "{}: package refers to unknown interned id {}", this->id, index);
+			return false;
+		}
+		header.id = received_ids[index];
+	}
+	else
+	{
+		if (!read_integral_from_socket(header.id))
+		{
+			return false;
+		}
+		if (id_ref == 1)
+		{
+			received_ids.push_back(header.id);
 		}
-		return std::make_pair(len, seqn);
 	}
+
+	header.len = static_cast<int32_t>(tag - V2_DATA_TAG);
+	header.seqn = static_cast<sequence_number_t>(seqn);
+	return true;
 }
 
 int32_t SocketWire::Base::read_package() const
 {
-	receive_pkg.rewind();
+	if (reactor != nullptr)
+	{
+		// [on_readable] queues whole packages and only reads a message once all of its bytes are queued
+		if (queued_packages.empty())
+		{
+			return -1;
+		}
+		const int32_t len = queued_packages.front().first;
+		receive_pkg.get_buffer() = std::move(queued_packages.front().second);
+		queued_packages.pop_front();
+		return len;
+	}
 
-	const auto pair = read_header();
-	if (pair == INVALID_HEADER)
+	while (true)
 	{
-		logger->debug("{}: failed to read header", this->id);
-		return -1;
+		PackageHeader header;
+		if (!read_header(header))
+		{
+			RD_LOG_DEBUG(logger, "{}: failed to read header", this->id);
+			return -1;
+		}
+		const int32_t len = header.len;
+
+		Buffer package;
+		if (!read_slice_from_socket(len, package))
+		{
+			RD_LOG_DEBUG(logger, "{}: failed to read package", this->id);
+			return -1;
+		}
+
+		if (accept_package(header, package))
+		{
+			receive_pkg.get_buffer() = std::move(package);
+			return len;
+		}
 	}
-	const auto len = pair.first;
-	const auto seqn = pair.second;
+}
+
+bool SocketWire::Base::accept_package(PackageHeader const& header, Buffer& package) const
+{
+	const int32_t len = header.len;
+	const auto seqn = header.seqn;
 
-	logger->debug("{}: read len={}, seqn={}, max_received_seqn={}", this->id, len, seqn, max_received_seqn);
+	RD_LOG_DEBUG(logger, "{}: read len={}, seqn={}, max_received_seqn={}", this->id, len, seqn, max_received_seqn);
 
-	receive_pkg.require_available(len);
-	if (!read_data_from_socket(receive_pkg.data(), len))
+	const bool duplicate = seqn <= max_received_seqn && seqn != 1;
+	if (!duplicate)
+	{
+		max_received_seqn = seqn;
+	}
+	++received_packages;
+	queue_ack();
+	if (duplicate)
 	{
-		logger->debug("{}: failed to read package", this->id);
-		return -1;
+		return false;
 	}
-	send_ack(seqn);
-	if (seqn <= max_received_seqn && seqn != 1)
+
+	RD_LOG_DEBUG(logger, "{}: was received package, bytes={}, seqn={}", this->id, len, seqn);
+
+	if (receive_format == WireFormat::V1)
 	{
 		return true;
 	}
-	max_received_seqn = seqn;
 
-	logger->info("{}: was received package, bytes={}, seqn={}", this->id, len, seqn);
-	return len;
+	// a V2 package is exactly one message body, so it is dispatched as is without passing through [receive_pkg]
+	if (static_cast<size_t>(len) < MIN_VIEW_MESSAGE_SIZE)
+	{
+		package = Buffer(std::move(package).getArray());
+		receive_copied_bytes += len;
+	}
+	package.set_format(WireFormat::V2);
+	++received_messages;
+	message_broker.dispatch(RdId(header.id), std::move(package));
+	return false;
 }
 
 bool SocketWire::Base::read_and_dispatch_message() const
@@ -335,41 +814,239 @@ bool SocketWire::Base::read_and_dispatch_message() const
 	sz = (sz == -1 ? receive_pkg.read_integral<int32_t>() : sz);
 	if (sz == -1)
 	{
-		logger->debug("{}: sz == -1", this->id);
+		RD_LOG_DEBUG(logger, "{}: sz == -1", this->id);
 		return false;
 	}
 	id_ = (id_ == -1 ? receive_pkg.read_integral<RdId::hash_t>() : id_);
 	if (id_ == -1)
 	{
-		logger->error("id == -1");
+		RD_LOG_ERROR(logger, "id == -1");
 		return false;
 	}
-	logger->trace("{}: message info: sz={}, id={}", this->id, sz, id_);
+	RD_LOG_TRACE(logger, "{}: message info: sz={}, id={}", this->id, sz, id_);
 	const RdId rd_id{id_};
 	sz -= 8;	// RdId
-	message.require_available(sz);
 
-	if (!receive_pkg.read(message.data() + message.get_position(), sz - message.get_position()))
+	Buffer message;
+	if (static_cast<size_t>(sz) < MIN_VIEW_MESSAGE_SIZE || !receive_pkg.try_slice(sz, message))
 	{
-		logger->error("{}: constructing message failed", this->id);
-		return false;
+		// the message is small or spans packages
+		message = Buffer(sz);
+		if (!receive_pkg.read(message.data(), sz))
+		{
+			RD_LOG_ERROR(logger, "{}: constructing message failed", this->id);
+			return false;
+		}
+		receive_copied_bytes += sz;
 	}
 
-	logger->debug("{}: message received", this->id);
+	RD_LOG_DEBUG(logger, "{}: message received", this->id);
+	++received_messages;
 	message_broker.dispatch(rd_id, std::move(message));
-	logger->debug("{}: message dispatched", this->id);
+	RD_LOG_DEBUG(logger, "{}: message dispatched", this->id);
 
 	sz = -1;
 	id_ = -1;
-	message.rewind();
 	return true;
 	//		RD_ASSERT_MSG(summary_size == sz, "Broken message, read:%d bytes, expected:%d bytes", summary_size, sz)
 }
 
-CSimpleSocket* SocketWire::Base::get_socket_provider() const
+bool SocketWire::Base::frame_buffered(size_t& length) const
 {
-	return socket_provider.get();
-}
+	const size_t available = hi - lo;
+	if (receive_format == WireFormat::V1)
+	{
+		int32_t len = 0;
+		if (available < sizeof(len))
+		{
+			length = sizeof(len);
+			return false;
+		}
+		memcpy(&len, receive_block->data() + lo, sizeof(len));
+		switch (len)
+		{
+			case PING_MESSAGE_LENGTH:
+				length = 3 * sizeof(int32_t);
+				break;
+			case HELLO_MESSAGE_LENGTH:
+			case SWITCH_MESSAGE_LENGTH:
+				length = 2 * sizeof(int32_t);
+				break;
+			default:
+				length = PACKAGE_HEADER_LENGTH + static_cast<size_t>((std::max)(len, 0));
+				break;
+		}
+		return available >= length;
+	}
+
+	Buffer::word_t const* const begin = available == 0 ? nullptr : receive_block->data() + lo;
+	Buffer::word_t const* const end = begin + available;
+	Buffer::word_t const* in = begin;
+	uint64_t tag = 0;
+	uint64_t first = 0;
+	uint64_t second = 0;
+	// pings and data packages carry two varints after the tag, the other control frames one
+	if (!peek_varint(in, end, tag) || !peek_varint(in, end, first) ||
+		((tag == V2_PING_TAG || tag >= V2_DATA_TAG) && !peek_varint(in, end, second)))
+	{
+		length = available + 1;
+		return false;
+	}
+	length = static_cast<size_t>(in - begin);
+	if (tag >= V2_DATA_TAG)
+	{
+		// [second] is the id reference, followed by the id itself unless it is interned
+		length += ((second & 1) != 0 ? sizeof(RdId::hash_t) : 0) + static_cast<size_t>(tag - V2_DATA_TAG);
+	}
+	return available >= length;
+}
+
+bool SocketWire::Base::read_buffered_frame() const
+{
+	PackageHeader header;
+	if (!read_frame(header))
+	{
+		return false;
+	}
+	if (header.len < 0)
+	{
+		return true;
+	}
+
+	Buffer package;
+	if (!read_slice_from_socket(header.len, package))
+	{
+		return false;
+	}
+	if (!accept_package(header, package))
+	{
+		return true;
+	}
+	received_stream_bytes += header.len;
+	queued_packages.emplace_back(header.len, std::move(package));
+	return dispatch_queued_messages();
+}
+
+bool SocketWire::Base::dispatch_queued_messages() const
+{
+	while (true)
+	{
+		if (sz == -1)
+		{
+			if (received_stream_bytes < sizeof(int32_t))
+			{
+				return true;
+			}
+			sz = receive_pkg.read_integral<int32_t>();
+			received_stream_bytes -= sizeof(int32_t);
+		}
+		if (sz < 0 || received_stream_bytes < static_cast<size_t>(sz))
+		{
+			return sz >= 0;
+		}
+		received_stream_bytes -= sz;
+		if (!read_and_dispatch_message())
+		{
+			return false;
+		}
+	}
+}
+
+bool SocketWire::Base::on_readable() const
+{
+	while (true)
+	{
+		size_t length = 0;
+		while (frame_buffered(length))
+		{
+			if (!read_buffered_frame())
+			{
+				RD_LOG_ERROR(logger, "{}: failed to read a received frame", this->id);
+				return false;
+			}
+		}
+
+		reserve_receive_block((std::max)(length, hi - lo + MIN_RECEIVE_SPACE));
+		const int64_t read = Reactor::try_receive(watched_descriptor, receive_block->data() + hi, receive_block->size() - hi);
+		if (read == Reactor::WOULD_BLOCK)
+		{
+			break;
+		}
+		if (read <= 0)
+		{
+			RD_LOG_INFO(logger, "{}: socket was shut down for receiving", this->id);
+			return false;
+		}
+		hi += static_cast<size_t>(read);
+	}
+	flush_ack();
+	return true;
+}
+
+void SocketWire::Base::start_reactor_connection(std::shared_ptr<CActiveSocket> new_socket)
+{
+	if (!install_socket(std::move(new_socket)))
+	{
+		return;
+	}
+	reactor_connected = true;
+	watched_descriptor = static_cast<int>(socket_provider->GetSocketDescriptor());
+
+	schedule_heartbeat();
+	async_send_buffer.resume();
+	connected.set(true);
+
+	reactor->watch(reactor_channel, watched_descriptor, [this] {
+		if (!on_readable())
+		{
+			end_reactor_connection();
+		}
+	});
+}
+
+void SocketWire::Base::end_reactor_connection()
+{
+	if (!reactor_connected)
+	{
+		return;
+	}
+	reactor_connected = false;
+
+	reactor->unwatch(reactor_channel, watched_descriptor);
+	reactor->cancel(heartbeat_timer);
+	reactor->cancel(ack_timer);
+	heartbeat_timer = ack_timer = 0;
+
+	connected.set(false);
+	// a send blocked on the dead connection fails once the socket is shut down, so the pause below does not wait for it
+	shutdown_socket();
+	// bodies are written in v1 again until the next counterpart answers, it may be an older one
+	body_format = WireFormat::V1;
+	end_negotiation_pause();
+	async_send_buffer.pause("Disconnected");
+
+	on_reactor_disconnected();
+}
+
+void SocketWire::Base::schedule_heartbeat()
+{
+	heartbeat_timer = reactor->schedule(reactor_channel, heartBeatInterval, [this] {
+		ping();
+		schedule_heartbeat();
+	});
+}
+
+void SocketWire::Base::stop_reactor()
+{
+	reactor->close(reactor_channel);
+	// no callback of this wire runs anymore, so its connection state can be touched from here
+	end_reactor_connection();
+}
+
+CSimpleSocket* SocketWire::Base::get_socket_provider() const
+{
+	return socket_provider.get();
+}
 
 void SocketWire::Base::ping() const
 {
@@ -377,7 +1054,7 @@ void SocketWire::Base::ping() const
 	{
 		if (heartbeatAlive.get())
 		{	 // only on change
-			logger->trace(
+			RD_LOG_TRACE(logger, 
 				"Disconnect detected while sending PING {}: "
 				"current_timestamp: {}, "
 				"counterpart_timestamp: {}, "
@@ -386,54 +1063,256 @@ void SocketWire::Base::ping() const
 		}
 		heartbeatAlive.set(false);
 	}
-	try
 	{
-		ping_pkg_header.set_position(sizeof(PING_MESSAGE_LENGTH));
-		ping_pkg_header.write_integral(current_timestamp);
-		ping_pkg_header.write_integral(counterpart_timestamp);
+		std::unique_lock<decltype(socket_send_lock)> guard(socket_send_lock, std::defer_lock);
+		if (!lock_for_control_frame(guard))
 		{
-			std::lock_guard<decltype(socket_send_lock)> guard(socket_send_lock);
-			int32_t sent = socket_provider->Send(ping_pkg_header.data(), ping_pkg_header.get_position());
-			if (sent == 0 && !socket_provider->IsSocketValid())
-			{
-				logger->debug("{}: failed to send ping over the network, reason: socket was shut down for sending", this->id);
-				return;
-			}
-			RD_ASSERT_THROW_MSG(sent == PACKAGE_HEADER_LENGTH,
-				fmt::format("{}: failed to send ping over the network, reason: {}", this->id, socket_provider->DescribeError()))
+			// the counterpart tolerates a few missing pings
+			return;
 		}
 
-		++current_timestamp;
+		std::array<Buffer::word_t, MAX_FRAME_HEADER_LENGTH> frame;
+		Buffer::word_t* out = frame.data();
+		if (send_format == WireFormat::V1)
+		{
+			out = put_integral(out, PING_MESSAGE_LENGTH);
+			out = put_integral(out, current_timestamp);
+			out = put_integral(out, counterpart_timestamp);
+		}
+		else
+		{
+			out = put_varint(out, V2_PING_TAG);
+			out = put_varint(out, static_cast<uint32_t>(current_timestamp));
+			out = put_varint(out, static_cast<uint32_t>(counterpart_timestamp));
+		}
+		if (!send_control_frame(frame.data(), out - frame.data(), "ping", true))
+		{
+			return;
+		}
 	}
-	catch (std::exception const& e)
+
+	++current_timestamp;
+}
+
+bool SocketWire::Base::send_ack(sequence_number_t seqn) const
+{
+	RD_LOG_TRACE(logger, "{} send ack {}", id, seqn);
+
+	std::unique_lock<decltype(socket_send_lock)> guard(socket_send_lock, std::defer_lock);
+	if (!lock_for_control_frame(guard))
+	{
+		return false;
+	}
+
+	std::array<Buffer::word_t, MAX_FRAME_HEADER_LENGTH> frame;
+	Buffer::word_t* out = frame.data();
+	if (send_format == WireFormat::V1)
+	{
+		out = put_integral(out, ACK_MESSAGE_LENGTH);
+		out = put_integral(out, seqn);
+	}
+	else
 	{
-		logger->debug("{}: exception raised during PING | {}", this->id, e.what());
+		out = put_varint(out, V2_ACK_TAG);
+		out = put_varint(out, static_cast<uint64_t>(seqn));
 	}
+	return send_control_frame(frame.data(), out - frame.data(), "ack", true);
 }
 
-bool SocketWire::Base::send_ack(sequence_number_t seqn) const
+void SocketWire::Base::queue_ack() const
 {
-	logger->trace("{} send ack {}", id, seqn);
-	try
+	const auto now = std::chrono::steady_clock::now();
+	if (unacked_packages++ == 0)
 	{
-		ack_buffer.rewind();
-		ack_buffer.write_integral(ACK_MESSAGE_LENGTH);
-		ack_buffer.write_integral(seqn);
+		first_unacked_at = now;
+	}
+	if (unacked_packages >= ack_packets || now - first_unacked_at >= ack_delay)
+	{
+		flush_ack();
+	}
+}
+
+void SocketWire::Base::flush_ack() const
+{
+	if (unacked_packages == 0)
+	{
+		return;
+	}
+	if (!send_ack(max_received_seqn))
+	{
+		// the packages stay unacknowledged and are acknowledged with the next ones, or by the timer when idle
+		if (reactor_connected && ack_timer == 0)
 		{
-			std::lock_guard<decltype(socket_send_lock)> guard(socket_send_lock);
-			RD_ASSERT_THROW_MSG(socket_provider->Send(ack_buffer.data(), ack_buffer.get_position()) == PACKAGE_HEADER_LENGTH,
-				this->id +
-					": failed to send ack over the network"
-					", reason: " +
-					socket_provider->DescribeError())
+			ack_timer = reactor->schedule(reactor_channel, std::chrono::ceil<std::chrono::milliseconds>(ack_delay), [this] {
+				ack_timer = 0;
+				flush_ack();
+			});
 		}
+		return;
+	}
+	unacked_packages = 0;
+	++sent_acks;
+}
+
+bool SocketWire::Base::lock_for_control_frame(std::unique_lock<std::mutex>& guard) const
+{
+	if (reactor == nullptr)
+	{
+		guard.lock();
 		return true;
 	}
-	catch (std::exception const& e)
+	return guard.try_lock();
+}
+
+bool SocketWire::Base::send_control_frame(Buffer::word_t const* frame, size_t length, string_view what, bool may_defer) const
+{
+	if (may_defer && reactor != nullptr)
+	{
+		const int64_t sent = Reactor::try_send(watched_descriptor, frame, length);
+		if (sent == Reactor::WOULD_BLOCK)
+		{
+			RD_LOG_TRACE(logger, "{}: deferred {}, send buffer is full", this->id, std::string(what));
+			return false;
+		}
+		if (sent >= 0)
+		{
+			// a frame is never left half written; the rest of a few bytes is sent even if it has to wait
+			return static_cast<size_t>(sent) == length ||
+				   send_control_frame(frame + sent, length - static_cast<size_t>(sent), what);
+		}
+	}
+
+	const int32_t sent = socket_provider->Send(frame, length);
+	if (sent == static_cast<int32_t>(length))
 	{
-		logger->warn("{}: exception raised during ACK, seqn = {} | {}", id, seqn, e.what());
+		return true;
+	}
+	if (sent == 0 && !socket_provider->IsSocketValid())
+	{
+		RD_LOG_DEBUG(logger, "{}: failed to send {} over the network, reason: socket was shut down for sending", this->id,
+			std::string(what));
 		return false;
 	}
+	RD_LOG_WARN(logger, "{}: failed to send {} over the network, reason: {}", this->id, std::string(what), socket_provider->DescribeError());
+	return false;
+}
+
+void SocketWire::Base::reset_connection_state() const
+{
+	{
+		std::lock_guard<decltype(socket_send_lock)> guard(socket_send_lock);
+		send_format = WireFormat::V1;
+		hello_sent = false;
+		sent_ids.clear();
+	}
+	receive_format = WireFormat::V1;
+	received_ids.clear();
+	lo = hi = 0;
+	unacked_packages = 0;
+	sz = -1;
+	id_ = -1;
+	receive_pkg.reset();
+	queued_packages.clear();
+	received_stream_bytes = 0;
+	{
+		std::lock_guard<decltype(negotiation_lock)> guard(negotiation_lock);
+		negotiated = false;
+		connection_format = WireFormat::V1;
+	}
+}
+
+void SocketWire::Base::send_hello() const
+{
+	async_send_buffer.post([this] {
+		std::lock_guard<decltype(socket_send_lock)> guard(socket_send_lock);
+		if (hello_sent)
+		{
+			return;
+		}
+		hello_sent = true;
+
+		std::array<Buffer::word_t, MAX_FRAME_HEADER_LENGTH> frame;
+		const Buffer::word_t* end = put_version_frame(frame.data(), send_format, HELLO_MESSAGE_LENGTH, V2_HELLO_TAG, preferred_format);
+		send_control_frame(frame.data(), end - frame.data(), "hello");
+	});
+}
+
+void SocketWire::Base::on_hello(int32_t version) const
+{
+	const WireFormat offered = version >= static_cast<int32_t>(WireFormat::V2) ? WireFormat::V2 : WireFormat::V1;
+	const WireFormat agreed = (std::min)(offered, preferred_format);
+	RD_LOG_INFO(logger, "{}: counterpart offers wire format v{}, using v{}", this->id, version, static_cast<int>(agreed));
+
+	// answer, so that a counterpart which offered first learns our format too
+	send_hello();
+
+	body_format = agreed;
+	{
+		std::lock_guard<decltype(negotiation_lock)> guard(negotiation_lock);
+		negotiated = true;
+		connection_format = agreed;
+	}
+	end_negotiation_pause();
+}
+
+bool SocketWire::Base::on_switch(int32_t version) const
+{
+	if (version != static_cast<int32_t>(WireFormat::V1) && version != static_cast<int32_t>(WireFormat::V2))
+	{
+		RD_LOG_ERROR(logger, "{}: counterpart switched to unknown wire format v{}", this->id, version);
+		return false;
+	}
+	RD_LOG_DEBUG(logger, "{}: counterpart switched to wire format v{}", this->id, version);
+	receive_format = static_cast<WireFormat>(version);
+	received_ids.clear();
+	return true;
+}
+
+void SocketWire::Base::on_ping(int32_t received_timestamp, int32_t received_counterpart_timestamp) const
+{
+	counterpart_timestamp = received_timestamp;
+	counterpart_acknowledge_timestamp = received_counterpart_timestamp;
+
+	if ((connection_established(current_timestamp, counterpart_acknowledge_timestamp)))
+	{
+		if (!heartbeatAlive.get())
+		{	 // only on change
+			RD_LOG_TRACE(logger, 
+				"Connection is alive after receiving PING {}: "
+				"received_timestamp: {}, "
+				"received_counterpart_timestamp: {}, "
+				"current_timestamp: {}, "
+				"counterpart_timestamp: {}, "
+				"counterpart_acknowledge_timestamp: {}, ",
+				id, received_timestamp, received_counterpart_timestamp, current_timestamp, counterpart_timestamp,
+				counterpart_acknowledge_timestamp);
+		}
+		heartbeatAlive.set(true);
+	}
+}
+
+void SocketWire::Base::end_negotiation_pause() const
+{
+	{
+		std::lock_guard<decltype(negotiation_lock)> guard(negotiation_lock);
+		if (!negotiation_pause)
+		{
+			return;
+		}
+		negotiation_pause = false;
+	}
+	// the packets resent when the connection came up are not written again
+	async_send_buffer.resume(false);
+}
+
+void SocketWire::Base::set_preferred_format(WireFormat format)
+{
+	preferred_format = format;
+}
+
+WireFormat SocketWire::Base::get_format() const
+{
+	return body_format.load();
 }
 
 bool SocketWire::Base::try_shutdown_connection() const
@@ -445,103 +1324,153 @@ bool SocketWire::Base::try_shutdown_connection() const
 	return s->Shutdown(CSimpleSocket::Both);
 }
 
-SocketWire::Client::Client(Lifetime parentLifetime, IScheduler* scheduler, uint16_t port, const std::string& id)
-	: Base(id, parentLifetime, scheduler), port(port), clientLifetimeDefinition(parentLifetime)
+SocketWire::Client::Client(
+	Lifetime parentLifetime, IScheduler* scheduler, uint16_t port, const std::string& id, std::shared_ptr<Reactor> reactor)
+	: Base(id, parentLifetime, scheduler, std::move(reactor)), port(port), clientLifetimeDefinition(parentLifetime)
 {
 	Lifetime lifetime = clientLifetimeDefinition.lifetime;
-	thread = std::thread([this, lifetime]() mutable {
-		rd::util::set_thread_name(this->id.empty() ? "SocketWire::Client Thread" : this->id.c_str());
-
-		try
-		{
-			logger->info("{}: started, port: {}.", this->id, this->port);
+	if (this->reactor != nullptr)
+	{
+		RD_LOG_INFO(logger, "{}: started in reactor, port: {}.", this->id, this->port);
+		this->reactor->schedule(reactor_channel, std::chrono::milliseconds(0), [this] { connect_in_reactor(); });
+	}
+	else
+	{
+		thread = std::thread([this, lifetime]() mutable {
+			rd::util::set_thread_name(this->id.empty() ? "SocketWire::Client Thread" : this->id.c_str());
 
-			while (!lifetime->is_terminated())
+			try
 			{
-				try
+				RD_LOG_INFO(logger, "{}: started, port: {}.", this->id, this->port);
+
+				while (!lifetime->is_terminated())
 				{
-					socket = std::make_shared<CActiveSocket>();
-					RD_ASSERT_THROW_MSG(socket->Initialize(),
-						fmt::format("{}: failed to init ActiveSocket, reason: {}", this->id, socket->DescribeError()));
-					RD_ASSERT_THROW_MSG(socket->DisableNagleAlgoritm(),
-						fmt::format("{}: failed to DisableNagleAlgoritm, reason: {}", this->id, socket->DescribeError()));
-
-					// On windows connect will try to send SYN 3 times with interval of 500ms (total time is 1second)
-					// Connect timeout doesn't work if it's more than 1 second. But we don't need it because we can close socket any
-					// moment.
-
-					// https://stackoverflow.com/questions/22417228/prevent-tcp-socket-connection-retries
-					// HKLM\SYSTEM\CurrentControlSet\Services\Tcpip\Parameters\TcpMaxConnectRetransmissions
-					logger->info("{}: connecting 127.0.0.1: {}", this->id, this->port);
-					RD_ASSERT_THROW_MSG(socket->Open("127.0.0.1", this->port),
-						fmt::format("{}: failed to open ActiveSocket, reason: {}", this->id, socket->DescribeError()));
+					try
 					{
-						std::lock_guard<decltype(lock)> guard(lock);
-						if (lifetime->is_terminated())
+						socket = std::make_shared<CActiveSocket>();
+						RD_ASSERT_THROW_MSG(socket->Initialize(),
+							fmt::format("{}: failed to init ActiveSocket, reason: {}", this->id, socket->DescribeError()));
+						RD_ASSERT_THROW_MSG(socket->DisableNagleAlgoritm(),
+							fmt::format("{}: failed to DisableNagleAlgoritm, reason: {}", this->id, socket->DescribeError()));
+
+						// On windows connect will try to send SYN 3 times with interval of 500ms (total time is 1second)
+						// Connect timeout doesn't work if it's more than 1 second. But we don't need it because we can close socket any
+						// moment.
+
+						// https://stackoverflow.com/questions/22417228/prevent-tcp-socket-connection-retries
+						// HKLM\SYSTEM\CurrentControlSet\Services\Tcpip\Parameters\TcpMaxConnectRetransmissions
+						RD_LOG_INFO(logger, "{}: connecting 127.0.0.1: {}", this->id, this->port);
+						RD_ASSERT_THROW_MSG(socket->Open("127.0.0.1", this->port),
+							fmt::format("{}: failed to open ActiveSocket, reason: {}", this->id, socket->DescribeError()));
 						{
-							if (!socket->Close())
+							std::lock_guard<decltype(lock)> guard(lock);
+							if (lifetime->is_terminated())
 							{
-								logger->error("{} failed to close socket, reason: {}", this->id, socket->DescribeError());
+								if (!socket->Close())
+								{
+									RD_LOG_ERROR(logger, "{} failed to close socket, reason: {}", this->id, socket->DescribeError());
+								}
+								return;
 							}
-							return;
 						}
-					}
-
-					set_socket_provider(socket);
-				}
-				catch (std::exception const& e)
-				{
-					logger->debug("{}: connection error for port {} ({}).", this->id, this->port, e.what());
 
-					std::lock_guard<decltype(lock)> guard(lock);
-					bool should_reconnect = false;
-					if (!lifetime->is_terminated())
-					{
-						cv.wait_for(lock, timeout);
-						should_reconnect = !lifetime->is_terminated();
+						set_socket_provider(socket);
 					}
-					if (should_reconnect)
+					catch (std::exception const& e)
 					{
-						continue;
+						RD_LOG_DEBUG(logger, "{}: connection error for port {} ({}).", this->id, this->port, e.what());
+
+						std::lock_guard<decltype(lock)> guard(lock);
+						bool should_reconnect = false;
+						if (!lifetime->is_terminated())
+						{
+							cv.wait_for(lock, timeout);
+							should_reconnect = !lifetime->is_terminated();
+						}
+						if (should_reconnect)
+						{
+							continue;
+						}
+						break;
 					}
-					break;
 				}
 			}
-		}
-		catch (std::exception const& e)
-		{
-			logger->info("{}: closed with exception: {}", this->id, e.what());
-		}
-		logger->info("{}: terminated, port: {}.", this->id, this->port);
-	});
+			catch (std::exception const& e)
+			{
+				RD_LOG_INFO(logger, "{}: closed with exception: {}", this->id, e.what());
+			}
+			RD_LOG_INFO(logger, "{}: terminated, port: {}.", this->id, this->port);
+		});
+	}
 
 	lifetime->add_action([this]() {
-		logger->info("{}: starts terminating lifetime", this->id);
+		RD_LOG_INFO(logger, "{}: starts terminating lifetime", this->id);
 
 		const bool send_buffer_stopped = async_send_buffer.stop(timeout);
-		logger->debug("{}: send buffer stopped, success: {}", this->id, send_buffer_stopped);
+		RD_LOG_DEBUG(logger, "{}: send buffer stopped, success: {}", this->id, send_buffer_stopped);
+
+		if (this->reactor != nullptr)
+		{
+			stop_reactor();
+		}
 
 		{
 			std::lock_guard<decltype(lock)> guard(lock);
-			logger->debug("{}: closing socket", this->id);
+			RD_LOG_DEBUG(logger, "{}: closing socket", this->id);
 
 			if (socket != nullptr)
 			{
 				if (!socket->Close())
 				{
-					logger->error("{}: failed to close socket", this->id);
+					RD_LOG_ERROR(logger, "{}: failed to close socket", this->id);
 				}
 			}
 		}
 		cv.notify_all();
 
-		logger->debug("{}: waiting for receiver thread", this->id);
-		logger->debug("{}: is thread joinable? {}", this->id, thread.joinable());
-		thread.join();
-		logger->info("{}: termination finished", this->id);
+		RD_LOG_DEBUG(logger, "{}: waiting for receiver thread", this->id);
+		RD_LOG_DEBUG(logger, "{}: is thread joinable? {}", this->id, thread.joinable());
+		if (thread.joinable())
+		{
+			thread.join();
+		}
+		RD_LOG_INFO(logger, "{}: termination finished", this->id);
 	});
 }
 
+void SocketWire::Client::connect_in_reactor()
+{
+	try
+	{
+		auto new_socket = std::make_shared<CActiveSocket>();
+		RD_ASSERT_THROW_MSG(new_socket->Initialize(),
+			fmt::format("{}: failed to init ActiveSocket, reason: {}", this->id, new_socket->DescribeError()));
+		RD_ASSERT_THROW_MSG(new_socket->DisableNagleAlgoritm(),
+			fmt::format("{}: failed to DisableNagleAlgoritm, reason: {}", this->id, new_socket->DescribeError()));
+
+		// connecting to the loopback either succeeds or is refused right away, so it is done inline on the reactor thread
+		RD_LOG_INFO(logger, "{}: connecting 127.0.0.1: {}", this->id, this->port);
+		RD_ASSERT_THROW_MSG(new_socket->Open("127.0.0.1", this->port),
+			fmt::format("{}: failed to open ActiveSocket, reason: {}", this->id, new_socket->DescribeError()));
+		{
+			std::lock_guard<decltype(lock)> guard(lock);
+			socket = new_socket;
+		}
+
+		start_reactor_connection(std::move(new_socket));
+	}
+	catch (std::exception const& e)
+	{
+		RD_LOG_DEBUG(logger, "{}: connection error for port {} ({}).", this->id, this->port, e.what());
+		reactor->schedule(reactor_channel, timeout, [this] { connect_in_reactor(); });
+	}
+}
+
+void SocketWire::Client::on_reactor_disconnected()
+{
+	reactor->schedule(reactor_channel, std::chrono::milliseconds(0), [this] { connect_in_reactor(); });
+}
+
 SocketWire::Client::~Client()
 {
 	if (!clientLifetimeDefinition.is_terminated())
@@ -550,8 +1479,9 @@ SocketWire::Client::~Client()
 	}
 }
 
-SocketWire::Server::Server(Lifetime parentLifetime, IScheduler* scheduler, uint16_t port, const std::string& id)
-	: Base(id, parentLifetime, scheduler), ss(std::make_unique<CPassiveSocket>()), serverLifetimeDefinition(parentLifetime)
+SocketWire::Server::Server(
+	Lifetime parentLifetime, IScheduler* scheduler, uint16_t port, const std::string& id, std::shared_ptr<Reactor> reactor)
+	: Base(id, parentLifetime, scheduler, std::move(reactor)), ss(std::make_unique<CPassiveSocket>()), serverLifetimeDefinition(parentLifetime)
 {
 #ifdef SIGPIPE
 	signal(SIGPIPE, SIG_IGN);
@@ -563,97 +1493,148 @@ SocketWire::Server::Server(Lifetime parentLifetime, IScheduler* scheduler, uint1
 	this->port = ss->GetServerPort();
 	RD_ASSERT_MSG(this->port != 0, fmt::format("{}: port wasn't chosen", this->id));
 
-	logger->info("{}: listening 127.0.0.1/{}", this->id, this->port);
+	RD_LOG_INFO(logger, "{}: listening 127.0.0.1/{}", this->id, this->port);
 	Lifetime lifetime = serverLifetimeDefinition.lifetime;
 
-	thread = std::thread([this, lifetime]() mutable {
-		rd::util::set_thread_name(this->id.empty() ? "SocketWire::Server Thread" : this->id.c_str());
+	if (this->reactor != nullptr)
+	{
+		RD_LOG_INFO(logger, "{}: started in reactor, port: {}.", this->id, this->port);
+		listen_in_reactor();
+	}
+	else
+	{
+		thread = std::thread([this, lifetime]() mutable {
+			rd::util::set_thread_name(this->id.empty() ? "SocketWire::Server Thread" : this->id.c_str());
 
-		logger->info("{}: started, port: {}.", this->id, this->port);
+			RD_LOG_INFO(logger, "{}: started, port: {}.", this->id, this->port);
 
-		try
-		{
-			while (!lifetime->is_terminated())
+			try
 			{
-				try
+				while (!lifetime->is_terminated())
 				{
-					logger->info("{}: accepting started", this->id);
-
-					// [HACK]: Fix RIDER-51111.
-					// winsock blocking accept hangs after creating new process with createprocess with inheritHandles=true
-					// property. Unreal Engine uses the same logic for handling sockets where they wait for timeout on select
-					// before trying to accept connection.
-					while(ss->IsSocketValid() && !ss->Select(0, 300)){}
-
-					CActiveSocket* accepted = ss->Accept();
-					RD_ASSERT_THROW_MSG(
-						accepted != nullptr, fmt::format("{}: accepting failed, reason: {}", this->id, ss->DescribeError()));
-					socket.reset(accepted);
-					logger->info("{}: accepted passive socket {}/{}", this->id, socket->GetClientAddr(), socket->GetClientPort());
-					RD_ASSERT_THROW_MSG(socket->DisableNagleAlgoritm(),
-						fmt::format("{}: tcpNoDelay failed, reason: {}", this->id, socket->DescribeError()));
-
+					try
 					{
-						std::lock_guard<decltype(lock)> guard(lock);
-						if (lifetime->is_terminated())
+						RD_LOG_INFO(logger, "{}: accepting started", this->id);
+
+						// [HACK]: Fix RIDER-51111.
+						// winsock blocking accept hangs after creating new process with createprocess with inheritHandles=true
+						// property. Unreal Engine uses the same logic for handling sockets where they wait for timeout on select
+						// before trying to accept connection.
+						while(ss->IsSocketValid() && !ss->Select(0, 300)){}
+
+						CActiveSocket* accepted = ss->Accept();
+						RD_ASSERT_THROW_MSG(
+							accepted != nullptr, fmt::format("{}: accepting failed, reason: {}", this->id, ss->DescribeError()));
+						socket.reset(accepted);
+						RD_LOG_INFO(logger, "{}: accepted passive socket {}/{}", this->id, socket->GetClientAddr(), socket->GetClientPort());
+						RD_ASSERT_THROW_MSG(socket->DisableNagleAlgoritm(),
+							fmt::format("{}: tcpNoDelay failed, reason: {}", this->id, socket->DescribeError()));
+
 						{
-							logger->debug("{}: closing passive socket", this->id);
-							if (!socket->Close())
+							std::lock_guard<decltype(lock)> guard(lock);
+							if (lifetime->is_terminated())
 							{
-								logger->error("{}: failed to close socket", this->id);
+								RD_LOG_DEBUG(logger, "{}: closing passive socket", this->id);
+								if (!socket->Close())
+								{
+									RD_LOG_ERROR(logger, "{}: failed to close socket", this->id);
+								}
+								RD_LOG_INFO(logger, "{}: close passive socket", this->id);
 							}
-							logger->info("{}: close passive socket", this->id);
 						}
-					}
 
-					logger->debug("{}: setting socket provider", this->id);
-					set_socket_provider(socket);
-				}
-				catch (std::exception const& e)
-				{
-					logger->info("{}: closed with exception: {}", this->id, e.what());
+						RD_LOG_DEBUG(logger, "{}: setting socket provider", this->id);
+						set_socket_provider(socket);
+					}
+					catch (std::exception const& e)
+					{
+						RD_LOG_INFO(logger, "{}: closed with exception: {}", this->id, e.what());
+					}
 				}
 			}
-		}
-		catch (std::exception const& e)
-		{
-			logger->error("{}: terminal socket error ({}).", this->id, e.what());
-		}
+			catch (std::exception const& e)
+			{
+				RD_LOG_ERROR(logger, "{}: terminal socket error ({}).", this->id, e.what());
+			}
 
-		logger->info("{}: terminated, port: {}.", this->id, this->port);
-	});
+			RD_LOG_INFO(logger, "{}: terminated, port: {}.", this->id, this->port);
+		});
+	}
 
 	lifetime->add_action([this] {
-		logger->info("{}: start terminating lifetime", this->id);
+		RD_LOG_INFO(logger, "{}: start terminating lifetime", this->id);
 
 		const bool send_buffer_stopped = async_send_buffer.stop(timeout);
-		logger->debug("{}: send buffer stopped, success: {}", this->id, send_buffer_stopped);
+		RD_LOG_DEBUG(logger, "{}: send buffer stopped, success: {}", this->id, send_buffer_stopped);
 
-		logger->debug("{}: closing server socket", this->id);
+		if (this->reactor != nullptr)
+		{
+			stop_reactor();
+		}
+
+		RD_LOG_DEBUG(logger, "{}: closing server socket", this->id);
 		if (!ss->Close())
 		{
-			logger->error("{}: failed to close server socket", this->id);
+			RD_LOG_ERROR(logger, "{}: failed to close server socket", this->id);
 		}
 
 		{
 			std::lock_guard<decltype(lock)> guard(lock);
-			logger->debug("{}: closing socket", this->id);
+			RD_LOG_DEBUG(logger, "{}: closing socket", this->id);
 			if (socket != nullptr)
 			{
 				if (!socket->Close())
 				{
-					logger->error("{}: failed to close socket", this->id);
+					RD_LOG_ERROR(logger, "{}: failed to close socket", this->id);
 				}
 			}
 		}
 
-		logger->debug("{}: waiting for receiver thread", this->id);
-		logger->debug("{}: is thread joinable? {}", this->id, thread.joinable());
-		thread.join();
-		logger->info("{}: termination finished", this->id);
+		RD_LOG_DEBUG(logger, "{}: waiting for receiver thread", this->id);
+		RD_LOG_DEBUG(logger, "{}: is thread joinable? {}", this->id, thread.joinable());
+		if (thread.joinable())
+		{
+			thread.join();
+		}
+		RD_LOG_INFO(logger, "{}: termination finished", this->id);
 	});
 }
 
+void SocketWire::Server::listen_in_reactor()
+{
+	reactor->watch(reactor_channel, static_cast<int>(ss->GetSocketDescriptor()), [this] { accept_in_reactor(); });
+}
+
+void SocketWire::Server::accept_in_reactor()
+{
+	reactor->unwatch(reactor_channel, static_cast<int>(ss->GetSocketDescriptor()));
+	try
+	{
+		CActiveSocket* accepted = ss->Accept();
+		RD_ASSERT_THROW_MSG(accepted != nullptr, fmt::format("{}: accepting failed, reason: {}", this->id, ss->DescribeError()));
+		std::shared_ptr<CActiveSocket> new_socket(accepted);
+		{
+			std::lock_guard<decltype(lock)> guard(lock);
+			socket = new_socket;
+		}
+		RD_LOG_INFO(logger, "{}: accepted passive socket {}/{}", this->id, new_socket->GetClientAddr(), new_socket->GetClientPort());
+		RD_ASSERT_THROW_MSG(new_socket->DisableNagleAlgoritm(),
+			fmt::format("{}: tcpNoDelay failed, reason: {}", this->id, new_socket->DescribeError()));
+
+		start_reactor_connection(std::move(new_socket));
+	}
+	catch (std::exception const& e)
+	{
+		RD_LOG_INFO(logger, "{}: closed with exception: {}", this->id, e.what());
+		listen_in_reactor();
+	}
+}
+
+void SocketWire::Server::on_reactor_disconnected()
+{
+	listen_in_reactor();
+}
+
 SocketWire::Server::~Server()
 {
 	if (!serverLifetimeDefinition.is_terminated())
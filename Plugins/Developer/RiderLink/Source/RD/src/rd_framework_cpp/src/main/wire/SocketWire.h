@@ -9,11 +9,17 @@
 #include "scheduler/base/IScheduler.h"
 #include "base/WireBase.h"
 #include "ByteBufferAsyncProcessor.h"
+#include "protocol/BufferPool.h"
 #include "PkgInputStream.h"
+#include "Reactor.h"
 
 #include <string>
 #include <array>
 #include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <unordered_map>
+#include <vector>
 
 #include <rd_framework_export.h>
 
@@ -47,16 +53,105 @@ public:
 
 		mutable std::condition_variable socket_send_var;
 		mutable ByteBufferAsyncProcessor async_send_buffer{id + "-AsyncSendProcessor",
-			[this](Buffer::ByteArray const& it, sequence_number_t seqn) -> bool { return this->send0(it, seqn); }};
+			[this](ByteBufferAsyncProcessor::packet_iterator first, ByteBufferAsyncProcessor::packet_iterator last,
+				sequence_number_t first_seqn) -> size_t { return this->send_batch(first, last, first_seqn); }};
 
-		static constexpr size_t RECEIVE_BUFFER_SIZE = 1u << 16;
-		mutable std::array<Buffer::word_t, RECEIVE_BUFFER_SIZE> receiver_buffer{};
-		mutable decltype(receiver_buffer)::iterator lo = receiver_buffer.begin(), hi = receiver_buffer.begin();
+		/**
+		 * \brief Decaying maximum of recent message sizes, used to pick pooled storage for the next message.
+		 */
+		mutable std::atomic<size_t> send_size_hint{BufferPool::MIN_CLASS_CAPACITY};
+
+		mutable std::atomic<uint64_t> sent_packets{0};
+		mutable std::atomic<uint64_t> send_syscalls{0};
+		mutable std::atomic<uint64_t> sent_bytes{0};
+
+		/**
+		 * \brief The socket is read into refcounted blocks of pooled storage. Packages are handed on as views into the block
+		 * they arrived in, so a block goes back to the pool only when the last message viewing it is released.
+		 * Bytes are copied between blocks only when a package does not fit into the rest of the current one.
+		 */
+		static constexpr size_t RECEIVE_BLOCK_SIZE = BufferPool::MAX_CLASS_CAPACITY;
+		/**
+		 * \brief Messages smaller than this are copied out of their block rather than viewing it, so that one kept for long
+		 * does not pin a whole block.
+		 */
+		static constexpr size_t MIN_VIEW_MESSAGE_SIZE = 1024;
+		mutable std::shared_ptr<Buffer::ByteArray> receive_block;
+		// unread bytes of [receive_block]
+		mutable size_t lo = 0, hi = 0;
+
+		mutable std::atomic<uint64_t> received_messages{0};
+		mutable std::atomic<uint64_t> received_packages{0};
+		mutable std::atomic<uint64_t> received_bytes{0};
+		mutable std::atomic<uint64_t> receive_copied_bytes{0};
+		mutable std::atomic<uint64_t> sent_acks{0};
+
+		// region delayed acknowledge, owned by the receiver thread
+		mutable size_t unacked_packages = 0;
+		mutable std::chrono::steady_clock::time_point first_unacked_at{};
+		// endregion
 
 		static constexpr int32_t ACK_MESSAGE_LENGTH = -1;
 		static constexpr int32_t PING_MESSAGE_LENGTH = -2;
+		static constexpr int32_t HELLO_MESSAGE_LENGTH = -3;
+		static constexpr int32_t SWITCH_MESSAGE_LENGTH = -4;
 		static constexpr int32_t PACKAGE_HEADER_LENGTH = sizeof(ACK_MESSAGE_LENGTH) + sizeof(sequence_number_t);
-		mutable Buffer ack_buffer{PACKAGE_HEADER_LENGTH};
+
+		/**
+		 * \brief Leading varint of a V2 frame. Tags from [V2_DATA_TAG] up are data packages of (tag - V2_DATA_TAG) body bytes.
+		 */
+		enum V2Tag : uint8_t
+		{
+			V2_ACK_TAG = 0,
+			V2_PING_TAG = 1,
+			V2_HELLO_TAG = 2,
+			V2_SWITCH_TAG = 3,
+			V2_DATA_TAG = 4
+		};
+
+		/**
+		 * \brief Message length, RdId and context placeholder in front of every serialized message. V2 frames carry the id
+		 * in the package header instead and drop the rest.
+		 */
+		static constexpr size_t MESSAGE_PREFIX_LENGTH = sizeof(int32_t) + sizeof(RdId::hash_t) + sizeof(int16_t);
+
+		/**
+		 * \brief Upper bound of one encoded package header or control frame, including a preceding format switch.
+		 */
+		static constexpr size_t MAX_FRAME_HEADER_LENGTH = 48;
+
+		static constexpr size_t MAX_INTERNED_IDS = 1u << 16;
+
+		/**
+		 * \brief Highest format this wire offers in its HELLO. V1 unless opted in with [set_preferred_format].
+		 */
+		WireFormat preferred_format = WireFormat::V1;
+
+		/**
+		 * \brief Format agreed with the current counterpart, V1 while disconnected; new messages are serialized in it.
+		 */
+		mutable std::atomic<WireFormat> body_format{WireFormat::V1};
+
+		// region connection state, guarded by [socket_send_lock]
+		mutable WireFormat send_format = WireFormat::V1;
+		mutable bool hello_sent = false;
+		mutable std::unordered_map<RdId::hash_t, uint32_t> sent_ids;
+		// endregion
+
+		// region connection state, owned by the receiver thread
+		mutable WireFormat receive_format = WireFormat::V1;
+		mutable std::vector<RdId::hash_t> received_ids;
+		// endregion
+
+		// region negotiation of the current connection, guarded by [negotiation_lock]
+		mutable std::mutex negotiation_lock;
+		mutable bool negotiated = false;
+		mutable WireFormat connection_format = WireFormat::V1;
+		/**
+		 * \brief Set while [async_send_buffer] is held paused until the counterpart's HELLO arrives.
+		 */
+		mutable bool negotiation_pause = false;
+		// endregion
 
 		/**
 		 * \brief Timestamp of this wire which increases at intervals of [heartBeatInterval].
@@ -73,20 +168,56 @@ public:
 		 */
 		mutable int32_t counterpart_acknowledge_timestamp = 0;
 
-		mutable Buffer ping_pkg_header{PACKAGE_HEADER_LENGTH};
-
 		mutable sequence_number_t max_received_seqn = 0;
-		mutable Buffer send_package_header{PACKAGE_HEADER_LENGTH};
 
-		static constexpr int32_t CHUNK_SIZE = 16370;
 		mutable int32_t sz = -1;
 		mutable RdId::hash_t id_ = -1;
 		mutable PkgInputStream receive_pkg{[this]() -> int32_t { return this->read_package(); }};
 
-		mutable Buffer message{CHUNK_SIZE};
+		// region reactor mode
+		/**
+		 * \brief Shared I/O thread that reads the socket and runs the heartbeat instead of [thread], or null in
+		 * thread-per-wire mode.
+		 */
+		std::shared_ptr<Reactor> reactor;
+		Reactor::channel_t reactor_channel;
+
+		// owned by the reactor thread
+		mutable bool reactor_connected = false;
+		mutable int watched_descriptor = -1;
+		mutable Reactor::timer_id_t heartbeat_timer = 0;
+		mutable Reactor::timer_id_t ack_timer = 0;
+
+		/**
+		 * \brief Whole V1 packages [receive_pkg] has not taken yet and the bytes left in them and in [receive_pkg]. A message
+		 * is only read once all of its bytes have arrived, so reading it never waits for the socket.
+		 */
+		mutable std::deque<std::pair<int32_t, Buffer>> queued_packages;
+		mutable size_t received_stream_bytes = 0;
+
+		/**
+		 * \brief Free space after [hi] each non-blocking receive asks for at least.
+		 */
+		static constexpr size_t MIN_RECEIVE_SPACE = RECEIVE_BLOCK_SIZE / 4;
+		// endregion
+
+		/**
+		 * \brief Makes [size] bytes from [lo] fit into [receive_block], moving the unread bytes into a fresh block if needed.
+		 */
+		void reserve_receive_block(size_t size) const;
+
+		/**
+		 * \brief Receives whatever the socket has ready into [receive_block] after [hi].
+		 */
+		bool receive_into_block() const;
 
 		bool read_from_socket(Buffer::word_t* res, int32_t msglen) const;
 
+		/**
+		 * \brief Next [len] bytes as a read-only view into the receive block.
+		 */
+		bool read_slice_from_socket(size_t len, Buffer& out) const;
+
 		template <typename T>
 		bool read_integral_from_socket(T& x) const
 		{
@@ -98,23 +229,158 @@ public:
 			return read_from_socket(reinterpret_cast<Buffer::word_t*>(data), static_cast<int32_t>(len));
 		}
 
+		bool read_varint_from_socket(uint64_t& x) const;
+
+		/**
+		 * \brief Counts a received package and acknowledges everything received so far once [ack_packets] packages or
+		 * [ack_delay] have accumulated.
+		 */
+		void queue_ack() const;
+
+		/**
+		 * \brief Sends the acknowledge of [max_received_seqn] if any package is unacknowledged.
+		 */
+		void flush_ack() const;
+
 		void set_socket_provider(std::shared_ptr<CActiveSocket> new_socket);
 
+		/**
+		 * \brief Makes [new_socket] current and starts the handshake on it.
+		 * \return false if the wire was terminated meanwhile.
+		 */
+		bool install_socket(std::shared_ptr<CActiveSocket> new_socket);
+
+		void shutdown_socket() const;
+
+		bool on_receiver_thread() const;
+
+		// region reactor mode
+		/**
+		 * \brief Length of the frame at [lo] and whether all of it is buffered. While its header is incomplete [length]
+		 * is a lower bound.
+		 */
+		bool frame_buffered(size_t& length) const;
+
+		/**
+		 * \brief Processes one buffered frame, dispatching the messages it completes.
+		 */
+		bool read_buffered_frame() const;
+
+		bool dispatch_queued_messages() const;
+
+		/**
+		 * \brief Reads what the socket has ready and processes every complete frame.
+		 * \return false once the connection is closed or broken.
+		 */
+		bool on_readable() const;
+
+		void start_reactor_connection(std::shared_ptr<CActiveSocket> new_socket);
+
+		void end_reactor_connection();
+
+		void schedule_heartbeat();
+
+		/**
+		 * \brief Stops every callback of this wire on the reactor and closes the current connection.
+		 */
+		void stop_reactor();
+
+		/**
+		 * \brief Called on the reactor thread after a connection ended, to wait for the next one.
+		 */
+		virtual void on_reactor_disconnected() = 0;
+		// endregion
+
+		void reset_connection_state() const;
+
+		/**
+		 * \brief Takes [socket_send_lock] for a ping or an acknowledge. The reactor thread serves every wire and must not
+		 * wait for a sender blocked on a full socket, so in reactor mode the lock is only taken if it is free.
+		 */
+		bool lock_for_control_frame(std::unique_lock<std::mutex>& guard) const;
+
+		/**
+		 * \brief Writes a control frame in the current send format. Must be called with [socket_send_lock] held.
+		 * With [may_defer] in reactor mode nothing is written while the socket's send buffer is full.
+		 */
+		bool send_control_frame(Buffer::word_t const* frame, size_t length, string_view what, bool may_defer = false) const;
+
+		/**
+		 * \brief Has the sender thread write HELLO ahead of the resend, so the reactor thread never waits for [socket_send_lock].
+		 */
+		void send_hello() const;
+
+		void on_hello(int32_t version) const;
+
+		bool on_switch(int32_t version) const;
+
+		void on_ping(int32_t received_timestamp, int32_t received_counterpart_timestamp) const;
+
+		void end_negotiation_pause() const;
+
+		/**
+		 * \brief Encodes [rd_id] as a reference into the connection's table of ids sent so far, adding it when new.
+		 * Must be called with [socket_send_lock] held.
+		 */
+		Buffer::word_t* put_interned_id(Buffer::word_t* out, RdId::hash_t rd_id) const;
+
 		CSimpleSocket* get_socket_provider() const;
 
 	public:
 		static constexpr int32_t MaximumHeartbeatDelay = 3;
 		std::chrono::milliseconds heartBeatInterval = std::chrono::milliseconds(500);
 
+		/**
+		 * \brief Received packages are acknowledged cumulatively, with one ACK of the latest sequence number after
+		 * [ack_packets] packages or [ack_delay], whichever comes first. Pending acknowledges are also sent before the
+		 * receiver waits on the socket, so an idle connection never holds them back. 1 acknowledges every package.
+		 */
+		size_t ack_packets = 32;
+		std::chrono::microseconds ack_delay{200};
+
+		/**
+		 * \brief Bytes sent and not yet acknowledged, plus bytes still queued, at which [send] starts waiting for the
+		 * counterpart. Not enforced while disconnected or on the receiver thread.
+		 */
+		static constexpr size_t DEFAULT_WINDOW_LIMIT = 1u << 25;
+
 		// region ctor/dtor
 
-		Base(std::string id, Lifetime lifetime, IScheduler* scheduler);
+		/**
+		 * \brief With a [reactor] the wire is served by its I/O thread instead of receiver and heartbeat threads of its own.
+		 * Where the reactor is not supported the wire falls back to its own threads.
+		 */
+		Base(std::string id, Lifetime lifetime, IScheduler* scheduler, std::shared_ptr<Reactor> reactor = nullptr);
 
 		virtual ~Base() override;
 
 		// endregion
 
-		std::pair<int, sequence_number_t> read_header() const;
+		struct PackageHeader
+		{
+			int32_t len = -1;
+			sequence_number_t seqn = -1;
+			/**
+			 * \brief Carried in the header by V2 frames only.
+			 */
+			RdId::hash_t id = 0;
+		};
+
+		/**
+		 * \brief Reads frames until a data package header, handling control frames on the way.
+		 */
+		bool read_header(PackageHeader& header) const;
+
+		/**
+		 * \brief Reads one frame. Control frames are handled here and leave [header].len negative.
+		 */
+		bool read_frame(PackageHeader& header) const;
+
+		/**
+		 * \brief Acknowledges a received package and drops duplicates. V2 packages are dispatched right away.
+		 * \return true if [package] is a new V1 package to be read as part of the message stream.
+		 */
+		bool accept_package(PackageHeader const& header, Buffer& package) const;
 
 		int32_t read_package() const;
 
@@ -122,7 +388,54 @@ public:
 
 		void receiverProc() const;
 
-		bool send0(Buffer::ByteArray const& msg, sequence_number_t seqn) const;
+		/**
+		 * \brief Writes the packets with their package headers to the socket with as few vectored writes as possible.
+		 * \return number of packets from [first] that were written completely.
+		 */
+		size_t send_batch(ByteBufferAsyncProcessor::packet_iterator first, ByteBufferAsyncProcessor::packet_iterator last,
+			sequence_number_t first_seqn) const;
+
+		struct SendStats
+		{
+			uint64_t packets = 0;
+			uint64_t syscalls = 0;
+			uint64_t bytes = 0;
+
+			double packets_per_syscall() const
+			{
+				return syscalls == 0 ? 0.0 : static_cast<double>(packets) / static_cast<double>(syscalls);
+			}
+		};
+
+		/**
+		 * \brief Packets and bytes written by the send path and the socket writes it took, since the wire was created.
+		 */
+		SendStats get_send_stats() const;
+
+		struct ReceiveStats
+		{
+			uint64_t messages = 0;
+			uint64_t packages = 0;
+			uint64_t bytes = 0;
+			uint64_t copied_bytes = 0;
+			uint64_t acks = 0;
+		};
+
+		/**
+		 * \brief Messages dispatched and package bytes received since the wire was created, with the bytes that had to be
+		 * copied because a package straddled two receive blocks.
+		 */
+		ReceiveStats get_receive_stats() const;
+
+		/**
+		 * \brief Occupancy of the unacknowledged send window and how long sent packets waited for their acknowledge.
+		 */
+		ByteBufferAsyncProcessor::WindowStats get_window_stats() const;
+
+		/**
+		 * \brief Caps the unacknowledged send window at [bytes], 0 for no cap. [DEFAULT_WINDOW_LIMIT] initially.
+		 */
+		void set_window_limit(size_t bytes);
 
 		void send(RdId const& rd_id, std::function<void(Buffer& buffer)> writer) const override;
 
@@ -135,6 +448,17 @@ public:
 		bool send_ack(sequence_number_t seqn) const;
 
 		bool try_shutdown_connection() const;
+
+		/**
+		 * \brief Opts into a newer wire format. It is offered to the counterpart on every connect and used once the
+		 * counterpart offers it too. Only enable this against counterparts that understand the HELLO control frame.
+		 */
+		void set_preferred_format(WireFormat format);
+
+		/**
+		 * \brief Format new messages are serialized in.
+		 */
+		WireFormat get_format() const override;
 		
 	private:		
 		LifetimeDefinition lifetimeDef;
@@ -147,7 +471,8 @@ public:
 
 		// region ctor/dtor
 
-		Client(Lifetime parentLifetime, IScheduler* scheduler, uint16_t port = 0, const std::string& id = "ClientSocket");
+		Client(Lifetime parentLifetime, IScheduler* scheduler, uint16_t port = 0, const std::string& id = "ClientSocket",
+			std::shared_ptr<Reactor> reactor = nullptr);
 
 		virtual ~Client() override;
 		// endregion
@@ -155,6 +480,13 @@ public:
 		std::condition_variable_any cv;
 	private:		
 		LifetimeDefinition clientLifetimeDefinition;
+
+		/**
+		 * \brief Connects on the reactor thread, retrying after [timeout] while the server is not up.
+		 */
+		void connect_in_reactor();
+
+		void on_reactor_disconnected() override;
 	};
 
 	class RD_FRAMEWORK_API Server : public Base
@@ -166,12 +498,19 @@ public:
 
 		// region ctor/dtor
 
-		Server(Lifetime lifetime, IScheduler* scheduler, uint16_t port = 0, const std::string& id = "ServerSocket");
+		Server(Lifetime lifetime, IScheduler* scheduler, uint16_t port = 0, const std::string& id = "ServerSocket",
+			std::shared_ptr<Reactor> reactor = nullptr);
 
 		virtual ~Server() override;
 		// endregion
 	private:
 		LifetimeDefinition serverLifetimeDefinition;
+
+		void listen_in_reactor();
+
+		void accept_in_reactor();
+
+		void on_reactor_disconnected() override;
 	};
 };
 }	 // namespace rd
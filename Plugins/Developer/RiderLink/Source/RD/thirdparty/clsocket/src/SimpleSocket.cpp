@@ -557,13 +557,41 @@ bool CSimpleSocket::Flush()
 //------------------------------------------------------------------------------
 int32_t CSimpleSocket::Writev(const struct iovec *pVector, size_t nCount)
 {
+#ifdef _WIN32
+    //--------------------------------------------------------------------------
+    // Gather the buffers into WSABUFs so the whole vector goes out in one
+    // WSASend call instead of one send per buffer.
+    //--------------------------------------------------------------------------
+    const size_t kMaxBuffers = 1024;
+    WSABUF buffers[kMaxBuffers];
+    int32_t nBytesSent = 0;
+
+    for (size_t nFirst = 0; nFirst < nCount; nFirst += kMaxBuffers)
+    {
+        const size_t nChunk = (nCount - nFirst < kMaxBuffers) ? nCount - nFirst : kMaxBuffers;
+        for (size_t i = 0; i < nChunk; i++)
+        {
+            buffers[i].buf = (CHAR *)pVector[nFirst + i].iov_base;
+            buffers[i].len = (ULONG)pVector[nFirst + i].iov_len;
+        }
+
+        DWORD nBytes = 0;
+        if (WSASend(m_socket, buffers, (DWORD)nChunk, &nBytes, 0, NULL, NULL) == SOCKET_ERROR)
+        {
+            return nBytesSent > 0 ? nBytesSent : CSimpleSocket::SocketError;
+        }
+
+        nBytesSent += (int32_t)nBytes;
+    }
+
+    return nBytesSent;
+#else
     int32_t nBytes     = 0;
     int32_t nBytesSent = 0;
     int32_t i          = 0;
 
     //--------------------------------------------------------------------------
-    // Send each buffer as a separate send, windows does not support this
-    // function call.
+    // Send each buffer as a separate send.
     //--------------------------------------------------------------------------
     for (i = 0; i < (int32_t)nCount; i++)
     {
@@ -581,6 +609,7 @@ int32_t CSimpleSocket::Writev(const struct iovec *pVector, size_t nCount)
     }
 
     return nBytesSent;
+#endif
 }
 
 
@@ -1,6 +1,10 @@
 #include "ProtocolFactory.h"
 
+#include "RiderLink.hpp"
+
 #include "scheduler/base/IScheduler.h"
+#include "util/logging.h"
+#include "wire/ShmWire.h"
 #include "wire/SocketWire.h"
 
 #include "Runtime/Launch/Resources/Version.h"
@@ -34,6 +38,17 @@
 
 #include "spdlog/sinks/daily_file_sink.h"
 
+static FString GetEnvironmentVariable(const FString& EnvironmentVarName)
+{
+#if ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION <= 20
+    TCHAR Value[4096];
+    FPlatformMisc::GetEnvironmentVariable(*EnvironmentVarName, Value, ARRAY_COUNT(Value));
+    return Value;
+#else
+    return FPlatformMisc::GetEnvironmentVariable(*EnvironmentVarName);
+#endif
+}
+
 static FString GetLocalAppdataFolder()
 {
     const FString EnvironmentVarName =
@@ -42,13 +57,7 @@ TEXT("LOCALAPPDATA");
 #else
     TEXT("HOME");
 #endif
-#if ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION <= 20
-    TCHAR CAppDataLocalPath[4096];
-    FPlatformMisc::GetEnvironmentVariable(*EnvironmentVarName, CAppDataLocalPath, ARRAY_COUNT(CAppDataLocalPath));
-    return CAppDataLocalPath;
-#else
-    return FPlatformMisc::GetEnvironmentVariable(*EnvironmentVarName);
-#endif
+    return GetEnvironmentVariable(EnvironmentVarName);
 }
 
 static FString GetMiscFilesFolder()
@@ -89,7 +98,9 @@ void ProtocolFactory::InitRdLogging()
 #if defined(ENABLE_LOG_FILE) && ENABLE_LOG_FILE == 1
     const FString LogFile = GetLogFile(ProjectName);
     const FString Msg = TEXT("[RiderLink] Path to log file: ") + LogFile;
-    auto FileLogger = std::make_shared<spdlog::sinks::daily_file_sink_mt>(*LogFile, 23, 59);
+    // written from a background thread so that the wire threads never wait for the disk
+    auto FileLogger = std::make_shared<rd::util::AsyncSink>(
+        std::make_shared<spdlog::sinks::daily_file_sink_mt>(*LogFile, 23, 59));
     FileLogger->set_level(spdlog::level::trace);
     spdlog::apply_all([FileLogger](std::shared_ptr<spdlog::logger> Logger)
     {
@@ -98,15 +109,31 @@ void ProtocolFactory::InitRdLogging()
 #endif
 }
 
-std::shared_ptr<rd::SocketWire::Server> ProtocolFactory::CreateWire(rd::IScheduler* Scheduler, rd::Lifetime SocketLifetime)
+std::shared_ptr<rd::IWire> ProtocolFactory::CreateWire(rd::IScheduler* Scheduler, rd::Lifetime SocketLifetime)
 {
-    return std::make_shared<rd::SocketWire::Server>(SocketLifetime, Scheduler, 0,
-                                                         TCHAR_TO_UTF8(*FString::Printf(TEXT("UnrealEditorServer-%s"),
-                                                             *ProjectName)));
+    const std::string Id = TCHAR_TO_UTF8(*FString::Printf(TEXT("UnrealEditorServer-%s"), *ProjectName));
+    // only on request: Rider has to know the shared memory wire as well
+    if (GetEnvironmentVariable(TEXT("RIDERLINK_WIRE")) == TEXT("shm") && rd::ShmWire::is_supported())
+    {
+        try
+        {
+            auto Wire = std::make_shared<rd::ShmWire::Server>(SocketLifetime, Scheduler, "", Id);
+            WireAddress = TEXT("shm:") + FString(UTF8_TO_TCHAR(Wire->name.c_str()));
+            return Wire;
+        }
+        catch (std::exception const& e)
+        {
+            UE_LOG(FLogRiderLinkModule, Warning, TEXT("Failed to create shared memory wire, falling back to TCP: %s"),
+                   UTF8_TO_TCHAR(e.what()));
+        }
+    }
+    auto Wire = std::make_shared<rd::SocketWire::Server>(SocketLifetime, Scheduler, 0, Id);
+    WireAddress = FString::FromInt(Wire->port);
+    return Wire;
 }
 
 
-TUniquePtr<rd::Protocol> ProtocolFactory::CreateProtocol(rd::IScheduler* Scheduler, rd::Lifetime SocketLifetime, std::shared_ptr<rd::SocketWire::Server> wire)
+TUniquePtr<rd::Protocol> ProtocolFactory::CreateProtocol(rd::IScheduler* Scheduler, rd::Lifetime SocketLifetime, std::shared_ptr<rd::IWire> wire)
 {
     auto protocol = MakeUnique<rd::Protocol>(rd::Identities::SERVER, Scheduler, wire, SocketLifetime);
 
@@ -117,7 +144,7 @@ TUniquePtr<rd::Protocol> ProtocolFactory::CreateProtocol(rd::IScheduler* Schedul
         const FString ProjectFileName = ProjectName + TEXT(".uproject");
         const FString TmpPortFile = TEXT("~") + ProjectFileName;
         const FString TmpPortFileFullPath = FPaths::Combine(*PortFullDirectoryPath, *TmpPortFile);
-        FFileHelper::SaveStringToFile(FString::FromInt(wire->port), *TmpPortFileFullPath);
+        FFileHelper::SaveStringToFile(WireAddress, *TmpPortFileFullPath);
         const FString PortFileFullPath = FPaths::Combine(*PortFullDirectoryPath, *ProjectFileName);
         IFileManager::Get().Move(*PortFileFullPath, *TmpPortFileFullPath, true, true);
     }
@@ -1,7 +1,7 @@
 ﻿#pragma once
 
 #include <protocol/Protocol.h>
-#include "wire/SocketWire.h"
+#include "base/IWire.h"
 
 #include "Containers/UnrealString.h"
 #include "Templates/UniquePtr.h"
@@ -11,13 +11,16 @@ class ProtocolFactory
 public:
 	explicit ProtocolFactory(const FString& ProjectName);
 
-	std::shared_ptr<rd::SocketWire::Server> CreateWire(rd::IScheduler* Scheduler, rd::Lifetime SocketLifetime);
+	// Shared memory when RIDERLINK_WIRE=shm and the platform supports it, TCP otherwise
+	std::shared_ptr<rd::IWire> CreateWire(rd::IScheduler* Scheduler, rd::Lifetime SocketLifetime);
 	TUniquePtr<rd::Protocol> CreateProtocol(rd::IScheduler* Scheduler, rd::Lifetime SocketLifetime,
-	                                        std::shared_ptr<rd::SocketWire::Server> wire);
+	                                        std::shared_ptr<rd::IWire> wire);
 
 private:
 	void InitRdLogging();
 
 private:
 	FString ProjectName;
+	// What goes into the ports file: the port of the TCP wire or "shm:<name>" of the shared memory one
+	FString WireAddress;
 };
@@ -48,7 +48,7 @@ void FRiderLinkModule::InitProtocol()
 {
 	WireLifetimeDef = MakeUnique<rd::LifetimeDefinition>(ModuleLifetimeDef.lifetime);
 	rd::Lifetime WireLifetime = WireLifetimeDef->lifetime;
-	std::shared_ptr<rd::SocketWire::Server> Wire = ProtocolFactory->CreateWire(&Scheduler, WireLifetime);
+	std::shared_ptr<rd::IWire> Wire = ProtocolFactory->CreateWire(&Scheduler, WireLifetime);
 	Protocol = ProtocolFactory->CreateProtocol(&Scheduler, WireLifetime.create_nested(), Wire);
 	// Exception fired for Server::Base::~Base() when trying to invoke it this way
 //	WireLifetime->add_action([this]()
@@ -103,7 +103,7 @@ bool FRiderLinkModule::SupportsDynamicReloading() { return true; }
 void FRiderLinkModule::ViewModel(rd::Lifetime Lifetime,
                                  TFunction<void(rd::Lifetime, JetBrains::EditorPlugin::RdEditorModel const&)> Handler)
 {
-	Scheduler.invoke_or_queue([this, Lifetime, Handler]
+	Scheduler.invoke_or_queue([this, Lifetime, Handler = MoveTemp(Handler)]
 	{
 		RdIsModelAlive.view(Lifetime, [this, Handler](rd::Lifetime ModelLifetime, bool const& Cond)
 		{
@@ -114,7 +114,7 @@ void FRiderLinkModule::ViewModel(rd::Lifetime Lifetime,
 
 void FRiderLinkModule::QueueModelAction(TFunction<void(JetBrains::EditorPlugin::RdEditorModel const&)> Handler)
 {	
-	Scheduler.invoke_or_queue([this, Handler]
+	Scheduler.invoke_or_queue([this, Handler = MoveTemp(Handler)]
 	{
 		if(!RdIsModelAlive.has_value() || !RdIsModelAlive.get()) return;
 		
@@ -124,7 +124,7 @@ void FRiderLinkModule::QueueModelAction(TFunction<void(JetBrains::EditorPlugin::
 
 void FRiderLinkModule::QueueAction(TFunction<void()> Handler)
 {
-	Scheduler.invoke_or_queue([this, Handler]
+	Scheduler.invoke_or_queue([this, Handler = MoveTemp(Handler)]
 	{
 		Handler();
 	});
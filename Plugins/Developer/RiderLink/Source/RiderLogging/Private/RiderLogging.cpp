@@ -116,9 +116,9 @@ void FRiderLoggingModule::StartupModule()
 				DateTime = GetTimeNow(Time.GetValue());
 			}
 			const FString PlainName = Name.GetPlainNameString();
-			const JetBrains::EditorPlugin::LogMessageInfo MessageInfo{Type, PlainName, DateTime};
+			JetBrains::EditorPlugin::LogMessageInfo MessageInfo{Type, PlainName, DateTime};
 			
-			LoggingScheduler->queue([Msg = FString(msg), MessageInfo]() mutable
+			LoggingScheduler->queue([Msg = FString(msg), MessageInfo = MoveTemp(MessageInfo)]() mutable
 			{
 				LoggingExtensionImpl::ScheduledSendMessage(&Msg, MessageInfo);
 			});
@@ -136,6 +136,12 @@ void FRiderLoggingModule::ShutdownModule()
 {
 	UE_LOG(FLogRiderLoggingModule, Verbose, TEXT("SHUTDOWN START"));
 	ModuleLifetimeDef.terminate();
+	if (LoggingScheduler)
+	{
+		const rd::SingleThreadSchedulerBase::Statistics Statistics = LoggingScheduler->get_statistics();
+		UE_LOG(FLogRiderLoggingModule, Verbose, TEXT("Sent %llu log lines, at most %llu were waiting"),
+			static_cast<unsigned long long>(Statistics.executed), static_cast<unsigned long long>(Statistics.max_queue_depth));
+	}
 	UE_LOG(FLogRiderLoggingModule, Verbose, TEXT("SHUTDOWN FINISH"));
 }
 
@@ -5,6 +5,8 @@
 #include "GeometryCollection/GeometryCollectionComponent.h"
 #include "Item/Treasure.h"
 #include "Components/CapsuleComponent.h"
+#include "Subsystems/ItemPoolSubsystem.h"
+#include "Subsystems/SignificanceSubsystem.h"
 
 // Constructor for the ABreakableActor class
 ABreakableActor::ABreakableActor()
@@ -25,10 +27,36 @@ ABreakableActor::ABreakableActor()
 }
 
 // Called when the game starts or when spawned
+// Each treasure class is pre-warmed in the item pool so breaking the actor mid-fight does not spawn a new actor,
+// and the actor is registered with the significance subsystem.
 void ABreakableActor::BeginPlay()
 {
 	Super::BeginPlay();
 
+	if (UItemPoolSubsystem* ItemPool = GetWorld()->GetSubsystem<UItemPoolSubsystem>())
+	{
+		for (const TSubclassOf<ATreasure>& TreasureClass : TreasureClasses)
+		{
+			ItemPool->Prewarm(TreasureClass, 1);
+		}
+	}
+
+	if (USignificanceSubsystem* Significance = GetWorld()->GetSubsystem<USignificanceSubsystem>())
+	{
+		Significance->Register(this);
+	}
+
+}
+
+// Called when the actor is removed from the world
+// The actor is taken off the significance subsystem so it is neither scored nor counted in a tier any more.
+void ABreakableActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USignificanceSubsystem* Significance = GetWorld()->GetSubsystem<USignificanceSubsystem>())
+	{
+		Significance->Unregister(this);
+	}
+	Super::EndPlay(EndPlayReason);
 }
 
 //  Ticking has been disabled (as seen in the constructor)
@@ -41,21 +69,34 @@ void ABreakableActor::Tick(float DeltaTime)
 // The GetHit_Implementation function is an implementation of a virtual function GetHit that is likely declared in a parent class or an interface that ABreakableActor is inheriting or implementing.
 // This function is called when the ABreakableActor gets hit in the game.
 // It first gets a reference to the current world with UWorld* World = GetWorld();. The GetWorld function is a member of AActor and it returns a pointer to the world in which the actor exists.
-// It then checks if the world exists and if there are any treasure classes available with if (World && TreasureClasses.Num() > 0). TreasureClasses is likely a member variable of ABreakableActor that holds a list of different types of treasures that can be spawned.
+// It then checks if the world and its item pool exist and if there are any treasure classes available with if (World && TreasureClasses.Num() > 0). TreasureClasses is likely a member variable of ABreakableActor that holds a list of different types of treasures that can be spawned.
 // If the conditions are met, it calculates a location for spawning the treasure.
 // It then randomly selects a treasure class from the TreasureClasses array: const int32 Selection = FMath::RandRange(0, TreasureClasses.Num() - 1);.
-// Finally, it spawns an instance of the selected treasure class at the calculated location with the same rotation as the actor: World->SpawnActor<ATreasure>(TreasureClasses[Selection], Location, GetActorRotation());.
+// Finally, it acquires an instance of the selected treasure class from the item pool at the calculated location with the same rotation as the actor. The pool only spawns a new actor if no dormant treasure of that class is available.
 // In summary, when the ABreakableActor gets hit, it spawns a random treasure from a list of possible treasures at a location slightly above its current location.
 void ABreakableActor::GetHit_Implementation(const FVector& ImpactPoint, AActor* Hitter)
 {
 	UWorld* World = GetWorld();
-	if (World && TreasureClasses.Num() > 0)
+	UItemPoolSubsystem* ItemPool = World ? World->GetSubsystem<UItemPoolSubsystem>() : nullptr;
+	if (ItemPool && TreasureClasses.Num() > 0)
 	{
 		FVector Location = GetActorLocation();
 		Location.Z += 75.f;
 		const int32 Selection = FMath::RandRange(0, TreasureClasses.Num() - 1);
-		World->SpawnActor<ATreasure>(TreasureClasses[Selection], Location, GetActorRotation());
+		ItemPool->Acquire<ATreasure>(TreasureClasses[Selection], FTransform(GetActorRotation(), Location));
 	}
 
 }
 
+// Called by the significance subsystem when this actor's tier changes.
+// The geometry collection only needs to simulate at full rate when it is close to the player and visible, so lower tiers tick it less often.
+void ABreakableActor::SetSignificanceTier(ESignificanceTier Tier)
+{
+	static constexpr float GeometryTickIntervals[] = { 0.f, 1.f / 30.f, 0.1f, 0.25f };
+
+	const int32 TierIndex = static_cast<int32>(Tier);
+	if (TierIndex >= UE_ARRAY_COUNT(GeometryTickIntervals)) return;
+
+	SignificanceTier = Tier;
+	GeometryCollection->SetComponentTickInterval(GeometryTickIntervals[TierIndex]);
+}
@@ -10,7 +10,8 @@
 
 // Constructor for the ABaseCharacter class.
 // Sets up the character's attributes and collision responses.
-ABaseCharacter::ABaseCharacter()
+ABaseCharacter::ABaseCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
 {
 	PrimaryActorTick.bCanEverTick = true;
 
@@ -112,9 +113,10 @@ void ABaseCharacter::DirectionalHitReact(const FVector& ImpactPoint)
 }
 
 // The PlayHitSound function plays a sound at the specified impact point.
+// Dormant characters are too far away or hidden for the sound to matter, so it is skipped.
 void ABaseCharacter::PlayHitSound(const FVector& ImpactPoint)
 {
-	if (HitSound)
+	if (HitSound && SignificanceTier != ESignificanceTier::EST_Dormant)
 	{
 		UGameplayStatics::PlaySoundAtLocation(
 			this,
@@ -125,9 +127,10 @@ void ABaseCharacter::PlayHitSound(const FVector& ImpactPoint)
 }
 
 // The SpawnHitParticles function spawns hit particles at the specified impact point.
+// Particles are only spawned for the high and medium significance tiers.
 void ABaseCharacter::SpawnHitParticles(const FVector& ImpactPoint)
 {
-	if (HitParticles && GetWorld())
+	if (HitParticles && GetWorld() && SignificanceTier <= ESignificanceTier::EST_Medium)
 	{
 		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), HitParticles, ImpactPoint);
 	}
@@ -217,25 +220,21 @@ void ABaseCharacter::Tick(float DeltaTime)
 
 }
 
-// This function, SetWeaponCollisionEnabled, is used to control the collision detection state of the character's equipped weapon.
+// This function, SetWeaponCollisionEnabled, is used to open and close the collision window of the character's equipped weapon.
 // It takes a parameter, CollisionEnabled, which is an enumeration type (ECollisionEnabled::Type) that defines the various states of collision detection.
 //
 // The function performs the following steps:
-// 1. It first checks if the character has an equipped weapon and if the weapon has a collision box (EquippedWeapon && EquippedWeapon->GetWeaponBox()).
-//    The GetWeaponBox function likely returns a reference to the weapon's collision box, which is used to detect collisions between the weapon and other objects in the game world.
+// 1. It first checks if the character has an equipped weapon (EquippedWeapon).
 //
-// 2. If the character has an equipped weapon with a collision box, it sets the collision enabled state of the weapon's collision box to the value of CollisionEnabled 
-//    (EquippedWeapon->GetWeaponBox()->SetCollisionEnabled(CollisionEnabled);). This controls whether the weapon's collision box is active or not, and thus whether the weapon can interact with other objects in the game world.
+// 2. If it does, any collision state other than NoCollision starts a swing and NoCollision ends it (EquippedWeapon->SetSwingEnabled(...)).
+//    While a swing is open, the combat trace subsystem sweeps the blade between its previous and current positions every frame and damages each actor it hits once per swing.
+//    Starting a new swing also resets the set of actors already hit, so every attack can damage the same target again.
 //
-// 3. Finally, it clears the IgnoreActors list of the equipped weapon (EquippedWeapon->IgnoreActors.Empty();). This list likely contains references to actors that the weapon's collision box should ignore, i.e., not detect collisions with. 
-//    By clearing this list, the function ensures that the weapon's collision box will detect collisions with all actors in the game world (unless the collision box's collision responses are set to ignore certain actors).
-//
-// In summary, this function is used to control the collision detection of the character's equipped weapon, allowing the weapon to interact with other objects in the game world.
+// In summary, this function is used to control when the character's equipped weapon can deal damage to other objects in the game world.
 void ABaseCharacter::SetWeaponCollisionEnabled(ECollisionEnabled::Type CollisionEnabled)
 {
-	if (EquippedWeapon && EquippedWeapon->GetWeaponBox())
+	if (EquippedWeapon)
 	{
-		EquippedWeapon->GetWeaponBox()->SetCollisionEnabled(CollisionEnabled);
-		EquippedWeapon->IgnoreActors.Empty();
+		EquippedWeapon->SetSwingEnabled(CollisionEnabled != ECollisionEnabled::NoCollision);
 	}
 }
@@ -4,7 +4,6 @@
 #include "Characters/SlashAnimInstance.h"
 #include "Characters/SlashCharacter.h"
 #include "GameFramework/CharacterMovementComponent.h"
-#include "Kismet/KismetMathLibrary.h"
 
 // This function is called when the animation instance is initialized.
 // It sets up the SlashCharacter and SlashCharacterMovement references.
@@ -21,24 +20,42 @@ void USlashAnimInstance::NativeInitializeAnimation()
 	}
 }
 
-// This function is called every frame to update the animation instance.
-// It updates the animation variables based on the character's state.
+// This function is called every frame on the game thread.
+// It only copies the character's state into the snapshot; everything derived from it is computed in NativeThreadSafeUpdateAnimation.
 void USlashAnimInstance::NativeUpdateAnimation(float DeltaTime)
 {
 	// Call the parent class's implementation of this function
 	Super::NativeUpdateAnimation(DeltaTime);
-	// If the SlashCharacterMovement reference is valid, update the animation variables
-	if (SlashCharacterMovement)
+	// If the SlashCharacterMovement reference is valid, capture the character's state
+	Snapshot.bIsValid = SlashCharacterMovement != nullptr;
+	if (Snapshot.bIsValid)
+	{
+		Snapshot.Velocity = SlashCharacterMovement->Velocity;
+		Snapshot.bIsFalling = SlashCharacterMovement->IsFalling();
+		Snapshot.CharacterState = SlashCharacter->GetCharacterState();
+		Snapshot.ActionState = SlashCharacter->GetActionState();
+		Snapshot.DeathPose = SlashCharacter->GetDeathPose();
+	}
+}
+
+// This function is called every frame on an animation worker thread when multi-threaded animation update is enabled.
+// It updates the animation variables from the snapshot and must not touch the character or any other UObject.
+void USlashAnimInstance::NativeThreadSafeUpdateAnimation(float DeltaTime)
+{
+	// Call the parent class's implementation of this function
+	Super::NativeThreadSafeUpdateAnimation(DeltaTime);
+	// If the snapshot was captured this frame, update the animation variables
+	if (Snapshot.bIsValid)
 	{
 		// Update the GroundSpeed variable based on the character's velocity
-		GroundSpeed = UKismetMathLibrary::VSizeXY(SlashCharacterMovement->Velocity);
+		GroundSpeed = Snapshot.Velocity.Size2D();
 		// Update the IsFalling variable based on the character's falling state
-		IsFalling = SlashCharacterMovement->IsFalling();
+		IsFalling = Snapshot.bIsFalling;
 		// Update the CharacterState variable based on the character's state
-		CharacterState = SlashCharacter->GetCharacterState();
+		CharacterState = Snapshot.CharacterState;
 		// Update the ActionState variable based on the character's action state
-		ActionState = SlashCharacter->GetActionState();
+		ActionState = Snapshot.ActionState;
 		// Update the DeathPose variable based on the character's death pose
-		DeathPose = SlashCharacter->GetDeathPose();
+		DeathPose = Snapshot.DeathPose;
 	}
 }
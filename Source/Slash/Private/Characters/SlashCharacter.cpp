@@ -17,6 +17,8 @@
 #include "HUD/SlashHUD.h"
 #include "HUD/SlashOverlay.h"
 #include "Components/AttributeComponent.h"
+#include "Subsystems/SpatialGridSubsystem.h"
+#include "Components/CapsuleComponent.h"
 
 // This constructor sets up the default values for the SlashCharacter class.
 ASlashCharacter::ASlashCharacter()
@@ -90,6 +92,12 @@ void ASlashCharacter::BeginPlay()
 	// In this case, the "Engageable Target" tag is used to identify actors that can be targeted or engaged with by attacking or interacting.
 	Tags.Add(FName("Engageable Target"));
 
+	// The character is also registered in the spatial grid as an engageable target, so enemies can find it with a proximity query instead of scanning actors.
+	if (USpatialGridSubsystem* SpatialGrid = GetWorld()->GetSubsystem<USpatialGridSubsystem>())
+	{
+		SpatialGrid->Register(this, ESpatialGridCategory::ESGC_EngageableTarget);
+	}
+
 	// The InitializeSlashOverlay function is called to set up the SlashOverlay HUD (Heads-Up Display) element for this character.
 	// The HUD is the on-screen display of information and controls that the player sees during gameplay.
 	// The SlashOverlay might contain elements like the character's health bar, gold, souls and stamina bar.
@@ -134,13 +142,34 @@ void ASlashCharacter::Look(const FInputActionValue& Value)
 	AddControllerYawInput(LookAxisVector.X);
 }
 
+// This function finds the weapon the character can pick up
+// The nearest pickups around the character are taken from the spatial grid, and the first weapon whose pickup sphere reaches the character wins.
+// Without a spatial grid it falls back to the item the character last overlapped.
+AWeapon* ASlashCharacter::FindWeaponInReach() const
+{
+	static constexpr int32 MaxPickupCandidates = 4;
+
+	const USpatialGridSubsystem* SpatialGrid = GetWorld()->GetSubsystem<USpatialGridSubsystem>();
+	if (SpatialGrid == nullptr) return Cast<AWeapon>(OverlappingItem);
+
+	TArray<AActor*> Pickups;
+	SpatialGrid->QueryNearest(GetActorLocation(), MaxPickupCandidates, PickupSearchRadius, ESpatialGridCategory::ESGC_Pickup, Pickups, this);
+	for (AActor* Pickup : Pickups)
+	{
+		AWeapon* Weapon = Cast<AWeapon>(Pickup);
+		if (Weapon && Weapon->IsInPickupReach(GetActorLocation(), GetCapsuleComponent()->GetScaledCapsuleRadius()))
+		{
+			return Weapon;
+		}
+	}
+	return nullptr;
+}
+
 // This function is called when the E key is pressed
 void ASlashCharacter::EKeyPressed()
 {
-// The OverlappingItem is an item that the character is currently overlapping with, or in other words, is close enough to interact with.
-// The Cast<AWeapon>(OverlappingItem) function attempts to cast the OverlappingItem to the AWeapon type.
-// This is essentially checking if the OverlappingItem is a weapon.
-AWeapon* OverlappingWeapon = Cast<AWeapon>(OverlappingItem);
+// The weapon in reach is the nearest weapon pickup whose sphere the character stands in, found with a spatial grid query.
+AWeapon* OverlappingWeapon = FindWeaponInReach();
 
 // If the cast was successful (i.e., the OverlappingItem is indeed a weapon), the character equips this weapon.
 if (OverlappingWeapon)
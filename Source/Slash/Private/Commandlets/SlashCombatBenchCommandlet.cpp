@@ -0,0 +1,261 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Commandlets/SlashCombatBenchCommandlet.h"
+#include "Enemy/Enemy.h"
+#include "Enemy/EnemyAIWorldSubsystem.h"
+#include "Subsystems/CombatTraceSubsystem.h"
+#include "Subsystems/ItemPoolSubsystem.h"
+#include "Subsystems/SpatialGridSubsystem.h"
+#include "Interfaces/HitInterface.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/DamageType.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/PlayerStart.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/PlatformMemory.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSlashCombatBench, Log, All);
+
+namespace
+{
+	const TCHAR* DefaultMap = TEXT("/Game/MedievalDungeon/Maps/Dungeon");
+	const TCHAR* DefaultEnemyClass = TEXT("/Game/Blueprints/Enemy/BP_BaseEnemy.BP_BaseEnemy_C");
+	const TCHAR* DefaultEnemyCounts = TEXT("10,100,500,1000");
+}
+
+USlashCombatBenchCommandlet::USlashCombatBenchCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 USlashCombatBenchCommandlet::Main(const FString& Params)
+{
+	FString MapName = DefaultMap;
+	FString EnemyClassPath = DefaultEnemyClass;
+	FString EnemyCountList = DefaultEnemyCounts;
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(TEXT("SlashCombatBench-%s.csv"), *FDateTime::Now().ToString());
+
+	FParse::Value(*Params, TEXT("Map="), MapName);
+	FParse::Value(*Params, TEXT("EnemyClass="), EnemyClassPath);
+	FParse::Value(*Params, TEXT("Enemies="), EnemyCountList, false);
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+	FParse::Value(*Params, TEXT("Frames="), FramesPerPass);
+
+	TArray<FString> CountStrings;
+	EnemyCountList.ParseIntoArray(CountStrings, TEXT(","));
+	TArray<int32> EnemyCounts;
+	for (const FString& CountString : CountStrings)
+	{
+		EnemyCounts.Add(FCString::Atoi(*CountString));
+	}
+
+	TSubclassOf<AEnemy> EnemyClass = LoadClass<AEnemy>(nullptr, *EnemyClassPath);
+	if (EnemyClass == nullptr)
+	{
+		UE_LOG(LogSlashCombatBench, Error, TEXT("Could not load enemy class %s"), *EnemyClassPath);
+		return 1;
+	}
+
+	UWorld* World = LoadWorld(MapName);
+	if (World == nullptr)
+	{
+		UE_LOG(LogSlashCombatBench, Error, TEXT("Could not load map %s"), *MapName);
+		return 1;
+	}
+
+	FString Csv = TEXT("Enemies,Frame,GameThreadMs,AIMs,TraceMs,SpawnedEnemies,AliveEnemies,PoolHits,PoolMisses,UsedPhysicalMB\n");
+	for (const int32 EnemyCount : EnemyCounts)
+	{
+		if (EnemyCount <= 0) continue;
+
+		UE_LOG(LogSlashCombatBench, Display, TEXT("Running %d frames with %d enemies"), FramesPerPass, EnemyCount);
+		RunPass(World, EnemyClass, EnemyCount, Csv);
+	}
+
+	UnloadWorld(World);
+
+	if (!FFileHelper::SaveStringToFile(Csv, *OutputPath))
+	{
+		UE_LOG(LogSlashCombatBench, Error, TEXT("Could not write %s"), *OutputPath);
+		return 1;
+	}
+	UE_LOG(LogSlashCombatBench, Display, TEXT("Wrote %s"), *OutputPath);
+	return 0;
+}
+
+/**
+ * Loads the map package and brings its world up to BeginPlay the way a game client would, without a viewport.
+ */
+UWorld* USlashCombatBenchCommandlet::LoadWorld(const FString& MapName) const
+{
+	UPackage* Package = LoadPackage(nullptr, *MapName, LOAD_None);
+	UWorld* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+	if (World == nullptr) return nullptr;
+
+	World->AddToRoot();
+	World->WorldType = EWorldType::Game;
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	World->InitWorld(UWorld::InitializationValues()
+		.AllowAudioPlayback(false)
+		.CreatePhysicsScene(true)
+		.CreateNavigation(true)
+		.CreateAISystem(true)
+		.ShouldSimulatePhysics(true)
+		.EnableTraceCollision(true));
+	World->UpdateWorldComponents(true, true);
+
+	const FURL URL;
+	World->SetGameMode(URL);
+	World->InitializeActorsForPlay(URL);
+	World->BeginPlay();
+	return World;
+}
+
+void USlashCombatBenchCommandlet::UnloadWorld(UWorld* World) const
+{
+	World->EndPlay(EEndPlayReason::Quit);
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	World->RemoveFromRoot();
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
+
+void USlashCombatBenchCommandlet::RunPass(UWorld* World, TSubclassOf<AEnemy> EnemyClass, int32 EnemyCount, FString& Csv) const
+{
+	FVector Origin = FVector::ZeroVector;
+	if (TActorIterator<APlayerStart> It(World); It)
+	{
+		Origin = It->GetActorLocation();
+	}
+
+	TArray<AActor*> Enemies;
+	TArray<AActor*> StandIns;
+	SpawnEnemies(World, EnemyClass, EnemyCount, Origin, Enemies);
+	SpawnStandIns(World, FMath::DivideAndRoundUp(EnemyCount, EnemiesPerStandIn), Origin, StandIns);
+
+	const UEnemyAIWorldSubsystem* AISubsystem = World->GetSubsystem<UEnemyAIWorldSubsystem>();
+	const UCombatTraceSubsystem* TraceSubsystem = World->GetSubsystem<UCombatTraceSubsystem>();
+	const UItemPoolSubsystem* PoolSubsystem = World->GetSubsystem<UItemPoolSubsystem>();
+
+	for (int32 Frame = 0; Frame < FramesPerPass; Frame++)
+	{
+		DriveStandIns(World, StandIns, Frame);
+
+		const double StartTime = FPlatformTime::Seconds();
+		World->Tick(LEVELTICK_All, FixedDeltaTime);
+		const double GameThreadSeconds = FPlatformTime::Seconds() - StartTime;
+		GFrameCounter++;
+
+		const int32 AliveEnemies = Enemies.FilterByPredicate([](const AActor* Enemy) { return IsValid(Enemy); }).Num();
+		const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+
+		Csv += FString::Printf(TEXT("%d,%d,%.3f,%.3f,%.3f,%d,%d,%d,%d,%.1f\n"),
+			EnemyCount,
+			Frame,
+			GameThreadSeconds * 1000.0,
+			AISubsystem ? AISubsystem->GetLastTickSeconds() * 1000.0 : 0.0,
+			TraceSubsystem ? TraceSubsystem->GetLastTickSeconds() * 1000.0 : 0.0,
+			Enemies.Num(),
+			AliveEnemies,
+			PoolSubsystem ? PoolSubsystem->GetPoolHits() : 0,
+			PoolSubsystem ? PoolSubsystem->GetPoolMisses() : 0,
+			MemoryStats.UsedPhysical / (1024.0 * 1024.0));
+	}
+
+	for (AActor* Actor : Enemies)
+	{
+		if (IsValid(Actor)) Actor->Destroy();
+	}
+	for (AActor* Actor : StandIns)
+	{
+		if (IsValid(Actor)) Actor->Destroy();
+	}
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
+
+/**
+ * Lays the enemies out on a square grid centred on Origin so every pass starts from the same layout.
+ */
+void USlashCombatBenchCommandlet::SpawnEnemies(UWorld* World, TSubclassOf<AEnemy> EnemyClass, int32 Count, const FVector& Origin, TArray<AActor*>& OutActors) const
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	const int32 Side = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Count)));
+	const float HalfExtent = (Side - 1) * SpawnSpacing * 0.5f;
+
+	for (int32 Index = 0; Index < Count; Index++)
+	{
+		const FVector Location = Origin + FVector((Index % Side) * SpawnSpacing - HalfExtent, (Index / Side) * SpawnSpacing - HalfExtent, 0.f);
+		AEnemy* Enemy = World->SpawnActor<AEnemy>(EnemyClass, Location, FRotator::ZeroRotator, SpawnParams);
+		if (Enemy == nullptr) continue;
+
+		if (Enemy->GetController() == nullptr)
+		{
+			Enemy->SpawnDefaultController();
+		}
+		OutActors.Add(Enemy);
+	}
+}
+
+/**
+ * Spawns the game mode's default pawn as player stand-ins, spread on a ring around Origin so they engage different parts of the crowd.
+ */
+void USlashCombatBenchCommandlet::SpawnStandIns(UWorld* World, int32 Count, const FVector& Origin, TArray<AActor*>& OutActors) const
+{
+	const AGameModeBase* GameMode = World->GetAuthGameMode();
+	if (GameMode == nullptr || GameMode->DefaultPawnClass == nullptr) return;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	const float RingRadius = FMath::Sqrt(static_cast<float>(Count * EnemiesPerStandIn)) * SpawnSpacing * 0.5f;
+	for (int32 Index = 0; Index < Count; Index++)
+	{
+		const float Angle = 2.f * PI * Index / Count;
+		const FVector Location = Origin + FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.f) * RingRadius;
+		APawn* StandIn = World->SpawnActor<APawn>(GameMode->DefaultPawnClass, Location, FRotator::ZeroRotator, SpawnParams);
+		if (StandIn == nullptr) continue;
+
+		StandIn->SpawnDefaultController();
+		OutActors.Add(StandIn);
+	}
+}
+
+/**
+ * Stand-ins attack in staggered turns so damage, hit reactions and deaths are spread across frames like a real fight.
+ */
+void USlashCombatBenchCommandlet::DriveStandIns(UWorld* World, const TArray<AActor*>& StandIns, int32 Frame) const
+{
+	const USpatialGridSubsystem* SpatialGrid = World->GetSubsystem<USpatialGridSubsystem>();
+	if (SpatialGrid == nullptr) return;
+
+	TArray<AActor*> Targets;
+	for (int32 Index = 0; Index < StandIns.Num(); Index++)
+	{
+		AActor* StandIn = StandIns[Index];
+		if (!IsValid(StandIn) || (Frame + Index) % AttackIntervalFrames != 0) continue;
+
+		Targets.Reset();
+		SpatialGrid->QueryNearest(StandIn->GetActorLocation(), 1, StandInAttackRadius, ESpatialGridCategory::ESGC_Enemy, Targets, StandIn);
+		if (Targets.Num() == 0 || !IsValid(Targets[0])) continue;
+
+		AActor* Target = Targets[0];
+		UGameplayStatics::ApplyDamage(Target, StandInDamage, StandIn->GetInstigatorController(), StandIn, UDamageType::StaticClass());
+		if (IsValid(Target) && Target->Implements<UHitInterface>())
+		{
+			IHitInterface::Execute_GetHit(Target, StandIn->GetActorLocation(), StandIn);
+		}
+	}
+}
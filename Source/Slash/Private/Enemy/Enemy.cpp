@@ -1,25 +1,43 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "Enemy/Enemy.h"
+#include "Enemy/EnemyAIWorldSubsystem.h"
+#include "Subsystems/SpatialGridSubsystem.h"
+#include "Subsystems/ItemPoolSubsystem.h"
+#include "Subsystems/SignificanceSubsystem.h"
 #include "AIController.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Components/AttributeComponent.h"
 #include "Components/ActorComponent.h"
 #include "Perception/PawnSensingComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
-#include "HUD/HealthBarComponent.h"
+#include "HUD/SlashHUD.h"
 #include "Characters/SlashCharacter.h"
 #include "Item/Weapon/Weapon.h"
 #include "Navigation/PathFollowingComponent.h"
+#include "SkeletalMeshComponentBudgeted.h"
+#include "IAnimationBudgetAllocator.h"
+
+namespace
+{
+ /** Per significance tier, highest first: AI decision interval, movement tick interval, mesh tick interval and sensing interval multiplier. */
+ constexpr float DecisionIntervals[] = { 0.f, 0.1f, 0.25f, 0.5f };
+ constexpr float MovementTickIntervals[] = { 0.f, 1.f / 30.f, 0.1f, 0.25f };
+ constexpr float MeshTickIntervals[] = { 0.f, 0.f, 1.f / 15.f, 0.2f };
+ constexpr float SensingIntervalScales[] = { 1.f, 1.5f, 3.f, 6.f };
+}
 
 /*
  * Constructor for the AEnemy class.
- * This function sets up the mesh collision properties, creates the health bar widget and pawn sensing component, and configures character movement.
+ * This function sets up the mesh collision properties, creates the pawn sensing component, and configures character movement.
+ * The health bar is drawn by ASlashHUD, so the enemy has no widget component of its own.
+ * The mesh is a budgeted skeletal mesh, so the animation budget allocator can throttle enemy animation as the crowd grows.
  */
-AEnemy::AEnemy()
+AEnemy::AEnemy(const FObjectInitializer& ObjectInitializer)
+ : Super(ObjectInitializer.SetDefaultSubobjectClass<USkeletalMeshComponentBudgeted>(ACharacter::MeshComponentName))
 {
- // Set the actor to tick every frame
- PrimaryActorTick.bCanEverTick = true;
+ // AI decisions are made in batch by UEnemyAIWorldSubsystem, so the enemy itself never ticks
+ PrimaryActorTick.bCanEverTick = false;
 
  // Set up the mesh collision properties
  GetMesh()->SetCollisionObjectType(ECollisionChannel::ECC_WorldDynamic);
@@ -27,10 +45,6 @@ AEnemy::AEnemy()
  GetMesh()->SetCollisionResponseToChannel(ECollisionChannel::ECC_Camera, ECollisionResponse::ECR_Ignore);
  GetMesh()->SetGenerateOverlapEvents(true);
 
- // Create the health bar widget and attach it to the root component
- HealthBarWidget = CreateDefaultSubobject<UHealthBarComponent>(TEXT("HealthBar"));
- HealthBarWidget->SetupAttachment(GetRootComponent());
-
  // Configure character movement
  GetCharacterMovement()->bOrientRotationToMovement = true;
  bUseControllerRotationPitch = false;
@@ -43,24 +57,6 @@ AEnemy::AEnemy()
  PawnSensing->SetPeripheralVisionAngle(55.f);
 }
 
-/**
- * @brief Called every frame.
- * Checks if the enemy is dead, and if not, checks the enemy's state and performs the appropriate actions.
- */
-void AEnemy::Tick(float DeltaTime)
-{
- Super::Tick(DeltaTime);
- if (IsDead()) return;
- if (EnemyState > EEnemyState::EES_Patrolling)
- {
-  CheckCombatTarget();
- }
- else
- {
-  CheckPatrolTarget();
- }
-}
-
 /**
  * @brief Called when the enemy takes damage.
  * Handles the damage, sets the combat target to the instigator of the damage, and starts chasing the target.
@@ -69,18 +65,19 @@ void AEnemy::Tick(float DeltaTime)
 float AEnemy::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
  HandleDamage(DamageAmount);
- CombatTarget = EventInstigator->GetPawn();
+ SetCombatTarget(EventInstigator->GetPawn());
  ChaseTarget();
  return DamageAmount;
 }
 
 /**
  * @brief Called when the enemy is destroyed.
- * Destroys the weapon equipped by the enemy.
+ * Returns the weapon equipped by the enemy to the item pool.
  */
 void AEnemy::Destroyed()
 {
- if (EquippedWeapon) EquippedWeapon->Destroy();
+ UItemPoolSubsystem::ReleaseOrDestroy(EquippedWeapon);
+ EquippedWeapon = nullptr;
 };
 
 /**
@@ -95,16 +92,35 @@ void AEnemy::GetHit_Implementation(const FVector& ImpactPoint, AActor* Hitter)
 
 /**
  * @brief Called when the game starts or when the actor is spawned.
- * Sets up the pawn sensing component, initializes the enemy, and adds the "Enemy" tag to the actor.
+ * Registers the enemy with the AI subsystem, the spatial grid and the significance subsystem, initializes the enemy, and adds the "Enemy" tag to the actor.
+ * Sight checks are driven by the AI subsystem from spatial grid queries, so the pawn sensing component's own updates are turned off.
  */
 void AEnemy::BeginPlay()
 {
  Super::BeginPlay();
- if (PawnSensing) PawnSensing->OnSeePawn.AddDynamic(this, &AEnemy::PawnSeen);
+ AISubsystem = GetWorld()->GetSubsystem<UEnemyAIWorldSubsystem>();
+ if (AISubsystem) AISubsystem->RegisterEnemy(this);
+ if (USpatialGridSubsystem* SpatialGrid = GetWorld()->GetSubsystem<USpatialGridSubsystem>()) SpatialGrid->Register(this, ESpatialGridCategory::ESGC_Enemy);
+ if (PawnSensing) DefaultSensingInterval = PawnSensing->SensingInterval;
+ if (PawnSensing) PawnSensing->SetSensingUpdatesEnabled(false);
+ DefaultAnimTickOption = GetMesh()->VisibilityBasedAnimTickOption;
+ if (USignificanceSubsystem* Significance = GetWorld()->GetSubsystem<USignificanceSubsystem>()) Significance->Register(this);
  InitializeEnemy();
  Tags.Add(FName("Enemy"));
 }
 
+/**
+ * @brief Called when the enemy is removed from the world.
+ * Unregisters the enemy from the AI subsystem and the significance subsystem and removes its health bar.
+ */
+void AEnemy::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+ if (AISubsystem) AISubsystem->UnregisterEnemy(this);
+ if (USignificanceSubsystem* Significance = GetWorld()->GetSubsystem<USignificanceSubsystem>()) Significance->Unregister(this);
+ HideHealthBar();
+ Super::EndPlay(EndPlayReason);
+}
+
 /**
  * @brief This function is called when the enemy character dies in the game.
  * 
@@ -112,7 +128,7 @@ void AEnemy::BeginPlay()
  * 
  * 1. `Super::Die();` - Calls the Die function in the parent class. This could include any common functionality that should be executed whenever any character dies, not just enemies.
  * 
- * 2. `EnemyState = EEnemyState::EES_Dead;` - Sets the enemy's state to 'Dead'. This is likely an enumeration value that is used elsewhere in the code to check the enemy's state and perform certain actions accordingly.
+ * 2. `SetEnemyState(EEnemyState::EES_Dead);` - Sets the enemy's state to 'Dead'. The state is mirrored into the AI subsystem so the batched update stops evaluating this enemy.
  * 
  * 3. `ClearAttackTimer();` - Clears the attack timer. This is likely a timer that was set when the enemy started an attack, and it's being cleared now because the enemy is dead and can no longer attack.
  * 
@@ -125,7 +141,7 @@ void AEnemy::BeginPlay()
 void AEnemy::Die()
 {
  Super::Die();
- EnemyState = EEnemyState::EES_Dead;
+ SetEnemyState(EEnemyState::EES_Dead);
  ClearAttackTimer();
  HideHealthBar();
  DisableCapsule();
@@ -138,7 +154,7 @@ void AEnemy::Die()
  */
 void AEnemy::Attack()
 {
- EnemyState = EEnemyState::EES_Engaged;
+ SetEnemyState(EEnemyState::EES_Engaged);
  Super::Attack();
  PlayAttackMontage();
 }
@@ -158,14 +174,60 @@ bool AEnemy::CanAttack()
 
 /**
  * @brief Handles the damage taken by the enemy.
- * Updates the enemy's health bar widget.
+ * Updates the enemy's health bar on the HUD.
  */
 void AEnemy::HandleDamage(float DamageAmount)
 {
  Super::HandleDamage(DamageAmount);
- if (Attribute && HealthBarWidget)
+ ASlashHUD* SlashHUD = ASlashHUD::Get(this);
+ if (Attribute && SlashHUD)
  {
-  HealthBarWidget->SetHealthPercent(Attribute->GetHealthPercent());
+  SlashHUD->SetHealthBarPercent(this, Attribute->GetHealthPercent());
+ }
+}
+
+/**
+ * @brief Checks if the enemy is fighting.
+ * @return True if the enemy is alive and has a combat target.
+ */
+bool AEnemy::IsInCombat() const
+{
+ return CombatTarget != nullptr && EnemyState != EEnemyState::EES_Dead;
+}
+
+/**
+ * @brief Scales the enemy's update cost to its significance tier.
+ * Adjusts how often the AI subsystem evaluates the enemy, the movement tick interval, the sight check interval and the hit FX tier, and the mesh tick interval and update rate optimizations when the mesh is not under the animation budget allocator.
+ */
+void AEnemy::SetSignificanceTier(ESignificanceTier Tier)
+{
+ const int32 TierIndex = static_cast<int32>(Tier);
+ if (TierIndex >= UE_ARRAY_COUNT(MovementTickIntervals)) return;
+
+ SignificanceTier = Tier;
+ if (AISubsystem) AISubsystem->SetEvaluationInterval(AISlot, DecisionIntervals[TierIndex]);
+ GetCharacterMovement()->SetComponentTickInterval(MovementTickIntervals[TierIndex]);
+
+ // While the animation budget allocator is running it owns the mesh tick rate, so only sensing and movement are scaled here
+ USkeletalMeshComponent* EnemyMesh = GetMesh();
+ const IAnimationBudgetAllocator* BudgetAllocator = IAnimationBudgetAllocator::Get(GetWorld());
+ const bool bMeshBudgeted = BudgetAllocator && BudgetAllocator->GetEnabled() && EnemyMesh->IsA<USkeletalMeshComponentBudgeted>();
+ if (AISubsystem) AISubsystem->SetSenseInterval(AISlot, DefaultSensingInterval * SensingIntervalScales[TierIndex]);
+ if (bMeshBudgeted) return;
+
+ EnemyMesh->SetComponentTickInterval(MeshTickIntervals[TierIndex]);
+ EnemyMesh->bEnableUpdateRateOptimizations = Tier != ESignificanceTier::EST_High;
+ switch (Tier)
+ {
+ case ESignificanceTier::EST_High:
+  EnemyMesh->VisibilityBasedAnimTickOption = DefaultAnimTickOption;
+  break;
+ case ESignificanceTier::EST_Medium:
+  EnemyMesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
+  break;
+ default:
+  EnemyMesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+  break;
  }
 }
 
@@ -175,7 +237,7 @@ void AEnemy::HandleDamage(float DamageAmount)
  */
 void AEnemy::AttackEnd()
 {
- EnemyState = EEnemyState::EES_NoState;
+ SetEnemyState(EEnemyState::EES_NoState);
  CheckCombatTarget();
 }
 
@@ -192,55 +254,61 @@ void AEnemy::InitializeEnemy()
 }
 
 /**
- * @brief Spawns the default weapon for the enemy.
+ * @brief Acquires the default weapon for the enemy from the item pool.
  */
 void AEnemy::SpawnDefaultWeapon()
 {
  UWorld* World = GetWorld();
- if (World && WeaponClass)
+ UItemPoolSubsystem* ItemPool = World ? World->GetSubsystem<UItemPoolSubsystem>() : nullptr;
+ if (ItemPool && WeaponClass)
  {
-  AWeapon* DefaultWeapon = World->SpawnActor<AWeapon>(WeaponClass);
+  AWeapon* DefaultWeapon = ItemPool->Acquire<AWeapon>(WeaponClass, GetActorTransform());
+  if (DefaultWeapon == nullptr) return;
   DefaultWeapon->Equip(GetMesh(), FName("RightHandSocket"), this, this);
   EquippedWeapon = DefaultWeapon;
  }
 }
 
 /**
- * @brief Checks the combat target.
+ * @brief Checks the combat target right away instead of waiting for the next batched AI update.
+ */
+void AEnemy::CheckCombatTarget()
+{
+ if (AISubsystem) ApplyAIDecision(AISubsystem->EvaluateCombatTarget(AISlot));
+}
+
+/**
+ * @brief Applies a decision made by the AI subsystem.
  * If the enemy is outside the combat radius, loses interest in the target and starts patrolling.
  * If the enemy is outside the attack radius and not currently chasing, starts chasing the target.
  * If the enemy can attack, starts the attack timer.
+ * If the enemy reached its patrol target, chooses a new patrol target and sets a timer to finish patrolling.
  */
-void AEnemy::CheckCombatTarget()
+void AEnemy::ApplyAIDecision(EEnemyAIDecision Decision)
 {
- if (IsOutsideCombatRadius())
+ switch (Decision)
  {
+ case EEnemyAIDecision::EAD_LoseInterest:
   ClearAttackTimer();
   LoseInterest();
   if (!IsEngaged()) StartPatrolling();
- }
- else if (IsOutsideAttackRadius() && !IsChasing())
- {
+  break;
+ case EEnemyAIDecision::EAD_ChaseTarget:
   ClearAttackTimer();
   if (!IsEngaged()) ChaseTarget();
- }
- else if (CanAttack())
- {
+  break;
+ case EEnemyAIDecision::EAD_StartAttackTimer:
   StartAttackTimer();
- }
-}
-
-/**
- * @brief Checks the patrol target.
- * If the enemy is in range of the patrol target, chooses a new patrol target and sets a timer to finish patrolling.
- */
-void AEnemy::CheckPatrolTarget()
-{
- if (InTargetRange(PatrolTarget, PatrolRadius))
- {
-  PatrolTarget = ChoosePatrolTarget();
-  const float WaitTime = FMath::RandRange(WaitMin, WaitMax);
-  GetWorldTimerManager().SetTimer(PatrolTimer, this, &AEnemy::PatrolTimerFinished, 7.f);
+  break;
+ case EEnemyAIDecision::EAD_PatrolTargetReached:
+  {
+   SetPatrolTarget(ChoosePatrolTarget());
+   const float WaitTime = FMath::RandRange(WaitMin, WaitMax);
+   if (AISubsystem) AISubsystem->StartPatrolTimer(AISlot, WaitTime);
+  }
+  break;
+ default:
+  break;
  }
 }
 
@@ -254,24 +322,25 @@ void AEnemy::PatrolTimerFinished()
 }
 
 /**
- * @brief Hides the enemy's health bar.
+ * @brief Hides the enemy's health bar by unregistering it from the HUD's health bar renderer.
  */
 void AEnemy::HideHealthBar()
 {
- if (HealthBarWidget)
+ if (ASlashHUD* SlashHUD = ASlashHUD::Get(this))
  {
-  HealthBarWidget->SetVisibility(false);
+  SlashHUD->HideHealthBar(this);
  }
 }
 
 /**
- * @brief Shows the enemy's health bar.
+ * @brief Shows the enemy's health bar by registering it with the HUD's health bar renderer.
  */
 void AEnemy::ShowHealthBar()
 {
- if (HealthBarWidget)
+ ASlashHUD* SlashHUD = ASlashHUD::Get(this);
+ if (Attribute && SlashHUD)
  {
-  HealthBarWidget->SetVisibility(true);
+  SlashHUD->ShowHealthBar(this, Attribute->GetHealthPercent());
  }
 }
 
@@ -280,7 +349,7 @@ void AEnemy::ShowHealthBar()
  */
 void AEnemy::LoseInterest()
 {
- CombatTarget = nullptr;
+ SetCombatTarget(nullptr);
  HideHealthBar();
 }
 
@@ -289,7 +358,7 @@ void AEnemy::LoseInterest()
  */
 void AEnemy::StartPatrolling()
 {
- EnemyState = EEnemyState::EES_Patrolling;
+ SetEnemyState(EEnemyState::EES_Patrolling);
  GetCharacterMovement()->MaxWalkSpeed = 125.f;
  MoveToTarget(PatrolTarget);
 }
@@ -299,7 +368,7 @@ void AEnemy::StartPatrolling()
  */
 void AEnemy::ChaseTarget()
 {
- EnemyState = EEnemyState::EES_Chasing;
+ SetEnemyState(EEnemyState::EES_Chasing);
  GetCharacterMovement()->MaxWalkSpeed = ChasingSpeed;
  MoveToTarget(CombatTarget);
 }
@@ -309,7 +378,7 @@ void AEnemy::ChaseTarget()
  */
 void AEnemy::ClearPatrolTimer()
 {
- GetWorldTimerManager().ClearTimer(PatrolTimer);
+ if (AISubsystem) AISubsystem->ClearPatrolTimer(AISlot);
 }
 
 /**
@@ -317,9 +386,9 @@ void AEnemy::ClearPatrolTimer()
  */
 void AEnemy::StartAttackTimer()
 {
- EnemyState = EEnemyState::EES_Attacking;
+ SetEnemyState(EEnemyState::EES_Attacking);
  const float AttackTime = FMath::RandRange(AttackMin, AttackMax);
- GetWorldTimerManager().SetTimer(AttackTimer, this, &AEnemy::Attack, AttackTime);
+ if (AISubsystem) AISubsystem->StartAttackTimer(AISlot, AttackTime);
 }
 
 /**
@@ -327,7 +396,7 @@ void AEnemy::StartAttackTimer()
  */
 void AEnemy::ClearAttackTimer()
 {
- GetWorldTimerManager().ClearTimer(AttackTimer);
+ if (AISubsystem) AISubsystem->ClearAttackTimer(AISlot);
 }
 
 /**
@@ -342,6 +411,33 @@ void AEnemy::MoveToTarget(AActor* Target)
  EnemyController->MoveTo(MoveRequest);
 }
 
+/**
+ * @brief Sets the enemy state and mirrors it into the AI subsystem.
+ */
+void AEnemy::SetEnemyState(EEnemyState NewState)
+{
+ EnemyState = NewState;
+ if (AISubsystem) AISubsystem->SetEnemyState(AISlot, NewState);
+}
+
+/**
+ * @brief Sets the combat target and mirrors it into the AI subsystem.
+ */
+void AEnemy::SetCombatTarget(AActor* Target)
+{
+ CombatTarget = Target;
+ if (AISubsystem) AISubsystem->SetCombatTarget(AISlot, Target);
+}
+
+/**
+ * @brief Sets the patrol target and mirrors it into the AI subsystem.
+ */
+void AEnemy::SetPatrolTarget(AActor* Target)
+{
+ PatrolTarget = Target;
+ if (AISubsystem) AISubsystem->SetPatrolTarget(AISlot, Target);
+}
+
 /**
  * @brief Chooses a new patrol target for the enemy.
  * @return The new patrol target.
@@ -436,8 +532,19 @@ bool AEnemy::IsEngaged()
 bool AEnemy::InTargetRange(AActor* Target, double Radius)
 {
  if (Target == nullptr) return false;
- const double DistanceToTarget =  (Target->GetActorLocation() - GetActorLocation()).Size();
- return DistanceToTarget <= Radius;
+ return FVector::DistSquared(Target->GetActorLocation(), GetActorLocation()) <= FMath::Square(Radius);
+}
+
+/**
+ * @brief Called by the AI subsystem for an engageable target near the enemy once its sight check is due.
+ * Runs the pawn sensing component's sight test, range and field of view first and then line of sight, and reacts as if the pawn had been seen.
+ */
+void AEnemy::SenseTarget(APawn* Target)
+{
+ if (PawnSensing && PawnSensing->CouldSeePawn(Target) && PawnSensing->HasLineOfSightTo(Target))
+ {
+  PawnSeen(Target);
+ }
 }
 
 /**
@@ -452,7 +559,7 @@ void AEnemy::PawnSeen(APawn* SeenPawn)
     SeenPawn->ActorHasTag(FName("Engageable Target"));
  if (bShouldChaseTarget)
  {
-  CombatTarget = SeenPawn;
+  SetCombatTarget(SeenPawn);
   ClearPatrolTimer();
   ChaseTarget();
  }
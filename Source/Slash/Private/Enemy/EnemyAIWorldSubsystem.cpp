@@ -0,0 +1,427 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Enemy/EnemyAIWorldSubsystem.h"
+#include "Enemy/Enemy.h"
+#include "Subsystems/SpatialGridSubsystem.h"
+#include "Perception/PawnSensingComponent.h"
+#include "Async/ParallelFor.h"
+
+/**
+ * @brief Checks a squared distance against a squared radius, so no square root is needed.
+ */
+static FORCEINLINE bool IsWithinRadius(const FVector& Location, const FVector& TargetLocation, bool bHasTarget, double RadiusSquared)
+{
+	return bHasTarget && FVector::DistSquared(Location, TargetLocation) <= RadiusSquared;
+}
+
+/**
+ * @brief Whether an enemy in this state would take a newly seen pawn as its combat target.
+ */
+static FORCEINLINE bool CanAcquireTarget(EEnemyState State)
+{
+	return State != EEnemyState::EES_Dead && State != EEnemyState::EES_Chasing && State < EEnemyState::EES_Attacking;
+}
+
+/**
+ * @brief Updates the registered enemies once per frame.
+ *
+ * 1. Lets the enemies whose sense clock ran out look for engageable targets near them.
+ * 2. Gathers enemy and target locations on the game thread for the enemies due for evaluation, as their significance tier allows.
+ * 3. Evaluates those enemies in parallel from the structure-of-arrays state only.
+ * 4. Applies the resulting state transitions to the actors on the game thread.
+ * 5. Advances the patrol and attack timers and fires the expired ones, after the transitions so a cleared timer never fires.
+ */
+void UEnemyAIWorldSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	LastTickSeconds = 0.0;
+	if (Enemies.Num() == 0) return;
+
+	const double StartTime = FPlatformTime::Seconds();
+	AcquireTargets(DeltaTime);
+	AdvanceEvaluationClocks(DeltaTime);
+	GatherLocations();
+	EvaluateAll();
+	{
+		TGuardValue<bool> ApplyingGuard(bApplyingDecisions, true);
+		ApplyDecisions();
+		AdvanceTimers(DeltaTime);
+		FireExpiredTimers();
+	}
+	FlushPendingRemovals();
+	LastTickSeconds = FPlatformTime::Seconds() - StartTime;
+}
+
+TStatId UEnemyAIWorldSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyAIWorldSubsystem, STATGROUP_Tickables);
+}
+
+/**
+ * @brief Adds an enemy to the batched update and stores its slot on the enemy.
+ */
+void UEnemyAIWorldSubsystem::RegisterEnemy(AEnemy* Enemy)
+{
+	if (Enemy == nullptr || Enemy->AISlot != INDEX_NONE) return;
+
+	const int32 Slot = Enemies.Add(Enemy);
+	Locations.Add(Enemy->GetActorLocation());
+	States.Add(Enemy->EnemyState);
+	CombatRadiiSquared.Add(FMath::Square(Enemy->CombatRadius));
+	AttackRadiiSquared.Add(FMath::Square(Enemy->AttackRadius));
+	PatrolRadiiSquared.Add(FMath::Square(Enemy->PatrolRadius));
+
+	CombatTargets.Add(Enemy->CombatTarget);
+	CombatTargetLocations.Add(FVector::ZeroVector);
+	HasCombatTarget.Add(false);
+
+	PatrolTargets.Add(Enemy->PatrolTarget);
+	PatrolTargetLocations.Add(FVector::ZeroVector);
+	HasPatrolTarget.Add(false);
+
+	EvaluationIntervals.Add(0.f);
+	TimeUntilEvaluation.Add(0.f);
+	DueForEvaluation.Add(true);
+
+	// Sight checks start staggered, as the sensing component's own timer would
+	const float SenseInterval = Enemy->PawnSensing ? Enemy->PawnSensing->SensingInterval : 0.5f;
+	SenseIntervals.Add(SenseInterval);
+	SenseTimeRemaining.Add(FMath::FRand() * SenseInterval);
+	if (Enemy->PawnSensing) MaxSightRadius = FMath::Max(MaxSightRadius, Enemy->PawnSensing->SightRadius);
+
+	PatrolTimeRemaining.Add(-1.f);
+	AttackTimeRemaining.Add(-1.f);
+	Decisions.Add(EEnemyAIDecision::EAD_None);
+
+	Enemy->AISlot = Slot;
+}
+
+/**
+ * @brief Removes an enemy from the batched update.
+ * Removal is deferred while decisions are being applied so the slots being iterated stay stable.
+ */
+void UEnemyAIWorldSubsystem::UnregisterEnemy(AEnemy* Enemy)
+{
+	if (Enemy == nullptr || !Enemies.IsValidIndex(Enemy->AISlot)) return;
+
+	const int32 Slot = Enemy->AISlot;
+	Enemy->AISlot = INDEX_NONE;
+	if (bApplyingDecisions)
+	{
+		Enemies[Slot].Reset();
+		PendingRemovals.Add(Slot);
+		return;
+	}
+	RemoveSlot(Slot);
+}
+
+void UEnemyAIWorldSubsystem::SetEnemyState(int32 Slot, EEnemyState NewState)
+{
+	if (States.IsValidIndex(Slot)) States[Slot] = NewState;
+}
+
+void UEnemyAIWorldSubsystem::SetCombatTarget(int32 Slot, AActor* Target)
+{
+	if (CombatTargets.IsValidIndex(Slot)) CombatTargets[Slot] = Target;
+}
+
+void UEnemyAIWorldSubsystem::SetPatrolTarget(int32 Slot, AActor* Target)
+{
+	if (PatrolTargets.IsValidIndex(Slot)) PatrolTargets[Slot] = Target;
+}
+
+void UEnemyAIWorldSubsystem::SetEvaluationInterval(int32 Slot, float Interval)
+{
+	if (!EvaluationIntervals.IsValidIndex(Slot)) return;
+	EvaluationIntervals[Slot] = Interval;
+	// A shorter interval takes effect right away instead of after the rest of the longer one
+	TimeUntilEvaluation[Slot] = FMath::Min(TimeUntilEvaluation[Slot], Interval);
+}
+
+void UEnemyAIWorldSubsystem::SetSenseInterval(int32 Slot, float Interval)
+{
+	if (SenseIntervals.IsValidIndex(Slot)) SenseIntervals[Slot] = Interval;
+}
+
+void UEnemyAIWorldSubsystem::StartPatrolTimer(int32 Slot, float Time)
+{
+	if (PatrolTimeRemaining.IsValidIndex(Slot)) PatrolTimeRemaining[Slot] = Time;
+}
+
+void UEnemyAIWorldSubsystem::ClearPatrolTimer(int32 Slot)
+{
+	if (PatrolTimeRemaining.IsValidIndex(Slot)) PatrolTimeRemaining[Slot] = -1.f;
+}
+
+void UEnemyAIWorldSubsystem::StartAttackTimer(int32 Slot, float Time)
+{
+	if (AttackTimeRemaining.IsValidIndex(Slot)) AttackTimeRemaining[Slot] = Time;
+}
+
+void UEnemyAIWorldSubsystem::ClearAttackTimer(int32 Slot)
+{
+	if (AttackTimeRemaining.IsValidIndex(Slot)) AttackTimeRemaining[Slot] = -1.f;
+}
+
+/**
+ * @brief Evaluates the combat branch for one enemy with freshly gathered locations.
+ * @return The decision the enemy should apply.
+ */
+EEnemyAIDecision UEnemyAIWorldSubsystem::EvaluateCombatTarget(int32 Slot)
+{
+	if (!Enemies.IsValidIndex(Slot)) return EEnemyAIDecision::EAD_None;
+	GatherLocation(Slot);
+	return EvaluateCombat(Slot);
+}
+
+/**
+ * @brief Lets the enemies whose sense clock ran out check whether they can see an engageable target.
+ * Candidates come from a radius query around each engageable target in the spatial grid, so enemies far from every target are never sight-checked.
+ */
+void UEnemyAIWorldSubsystem::AcquireTargets(float DeltaTime)
+{
+	for (int32 Slot = 0; Slot < Enemies.Num(); ++Slot)
+	{
+		SenseTimeRemaining[Slot] -= DeltaTime;
+	}
+
+	EngageableTargets.Reset();
+	const USpatialGridSubsystem* SpatialGrid = GetWorld()->GetSubsystem<USpatialGridSubsystem>();
+	if (SpatialGrid) SpatialGrid->GetActorsInCategory(ESpatialGridCategory::ESGC_EngageableTarget, EngageableTargets);
+
+	for (AActor* Target : EngageableTargets)
+	{
+		APawn* TargetPawn = Cast<APawn>(Target);
+		if (TargetPawn == nullptr) continue;
+
+		SpatialGrid->QueryRadius(TargetPawn->GetActorLocation(), MaxSightRadius, ESpatialGridCategory::ESGC_Enemy, NearbyEnemies);
+		for (AActor* Actor : NearbyEnemies)
+		{
+			AEnemy* Enemy = Cast<AEnemy>(Actor);
+			if (Enemy == nullptr || !Enemies.IsValidIndex(Enemy->AISlot)) continue;
+
+			const int32 Slot = Enemy->AISlot;
+			if (SenseTimeRemaining[Slot] > 0.f || !CanAcquireTarget(States[Slot])) continue;
+			Enemy->SenseTarget(TargetPawn);
+		}
+	}
+
+	for (int32 Slot = 0; Slot < Enemies.Num(); ++Slot)
+	{
+		if (SenseTimeRemaining[Slot] <= 0.f) SenseTimeRemaining[Slot] = FMath::Max(SenseTimeRemaining[Slot] + SenseIntervals[Slot], 0.f);
+	}
+}
+
+/**
+ * @brief Counts down the evaluation clocks and marks the slots whose clock ran out as due.
+ */
+void UEnemyAIWorldSubsystem::AdvanceEvaluationClocks(float DeltaTime)
+{
+	for (int32 Slot = 0; Slot < Enemies.Num(); ++Slot)
+	{
+		TimeUntilEvaluation[Slot] -= DeltaTime;
+		DueForEvaluation[Slot] = TimeUntilEvaluation[Slot] <= 0.f;
+		if (DueForEvaluation[Slot]) TimeUntilEvaluation[Slot] = FMath::Max(TimeUntilEvaluation[Slot] + EvaluationIntervals[Slot], 0.f);
+	}
+}
+
+/**
+ * @brief Copies the enemy and target locations of the due slots into the arrays read by the parallel evaluation.
+ */
+void UEnemyAIWorldSubsystem::GatherLocations()
+{
+	for (int32 Slot = 0; Slot < Enemies.Num(); ++Slot)
+	{
+		if (DueForEvaluation[Slot]) GatherLocation(Slot);
+	}
+}
+
+void UEnemyAIWorldSubsystem::GatherLocation(int32 Slot)
+{
+	const AEnemy* Enemy = Enemies[Slot].Get();
+	if (Enemy == nullptr) return;
+	Locations[Slot] = Enemy->GetActorLocation();
+
+	const AActor* CombatTarget = CombatTargets[Slot].Get();
+	HasCombatTarget[Slot] = CombatTarget != nullptr;
+	if (CombatTarget) CombatTargetLocations[Slot] = CombatTarget->GetActorLocation();
+
+	const AActor* PatrolTarget = PatrolTargets[Slot].Get();
+	HasPatrolTarget[Slot] = PatrolTarget != nullptr;
+	if (PatrolTarget) PatrolTargetLocations[Slot] = PatrolTarget->GetActorLocation();
+}
+
+/**
+ * @brief Evaluates every due enemy. Only the structure-of-arrays state is read, so slots can be processed on any thread.
+ */
+void UEnemyAIWorldSubsystem::EvaluateAll()
+{
+	ParallelFor(TEXT("EnemyAI.Evaluate"), Enemies.Num(), EvaluateBatchSize, [this](int32 Slot)
+	{
+		Decisions[Slot] = DueForEvaluation[Slot] ? Evaluate(Slot) : EEnemyAIDecision::EAD_None;
+	});
+}
+
+/**
+ * @brief Mirrors the per-enemy tick: the combat branch once the enemy has left patrolling, the patrol branch otherwise.
+ */
+EEnemyAIDecision UEnemyAIWorldSubsystem::Evaluate(int32 Slot) const
+{
+	if (States[Slot] == EEnemyState::EES_Dead) return EEnemyAIDecision::EAD_None;
+	return States[Slot] > EEnemyState::EES_Patrolling ? EvaluateCombat(Slot) : EvaluatePatrol(Slot);
+}
+
+/**
+ * @brief Combat branch.
+ * Outside the combat radius the enemy loses interest, outside the attack radius it chases, and inside it starts the attack timer.
+ */
+EEnemyAIDecision UEnemyAIWorldSubsystem::EvaluateCombat(int32 Slot) const
+{
+	const EEnemyState State = States[Slot];
+	const FVector& Location = Locations[Slot];
+	const FVector& TargetLocation = CombatTargetLocations[Slot];
+	const bool bHasTarget = HasCombatTarget[Slot];
+
+	if (!IsWithinRadius(Location, TargetLocation, bHasTarget, CombatRadiiSquared[Slot]))
+	{
+		return EEnemyAIDecision::EAD_LoseInterest;
+	}
+	const bool bInsideAttackRadius = IsWithinRadius(Location, TargetLocation, bHasTarget, AttackRadiiSquared[Slot]);
+	if (!bInsideAttackRadius && State != EEnemyState::EES_Chasing)
+	{
+		return EEnemyAIDecision::EAD_ChaseTarget;
+	}
+	const bool bCanAttack = bInsideAttackRadius &&
+		State != EEnemyState::EES_Attacking &&
+		State != EEnemyState::EES_Engaged &&
+		State != EEnemyState::EES_Dead;
+	return bCanAttack ? EEnemyAIDecision::EAD_StartAttackTimer : EEnemyAIDecision::EAD_None;
+}
+
+/**
+ * @brief Patrol branch. Reaching the patrol target picks the next one.
+ */
+EEnemyAIDecision UEnemyAIWorldSubsystem::EvaluatePatrol(int32 Slot) const
+{
+	return IsWithinRadius(Locations[Slot], PatrolTargetLocations[Slot], HasPatrolTarget[Slot], PatrolRadiiSquared[Slot])
+		? EEnemyAIDecision::EAD_PatrolTargetReached
+		: EEnemyAIDecision::EAD_None;
+}
+
+/**
+ * @brief Counts down the running timers and records the slots whose timer expired this frame.
+ */
+void UEnemyAIWorldSubsystem::AdvanceTimers(float DeltaTime)
+{
+	ExpiredPatrolTimers.Reset();
+	ExpiredAttackTimers.Reset();
+	for (int32 Slot = 0; Slot < Enemies.Num(); ++Slot)
+	{
+		if (PatrolTimeRemaining[Slot] >= 0.f)
+		{
+			PatrolTimeRemaining[Slot] -= DeltaTime;
+			if (PatrolTimeRemaining[Slot] <= 0.f)
+			{
+				PatrolTimeRemaining[Slot] = -1.f;
+				ExpiredPatrolTimers.Add(Slot);
+			}
+		}
+		if (AttackTimeRemaining[Slot] >= 0.f)
+		{
+			AttackTimeRemaining[Slot] -= DeltaTime;
+			if (AttackTimeRemaining[Slot] <= 0.f)
+			{
+				AttackTimeRemaining[Slot] = -1.f;
+				ExpiredAttackTimers.Add(Slot);
+			}
+		}
+	}
+}
+
+/**
+ * @brief Applies the decisions to the actors. Runs on the game thread.
+ */
+void UEnemyAIWorldSubsystem::ApplyDecisions()
+{
+	const int32 NumSlots = Decisions.Num();
+	for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+	{
+		if (Decisions[Slot] == EEnemyAIDecision::EAD_None) continue;
+		if (AEnemy* Enemy = Enemies[Slot].Get())
+		{
+			Enemy->ApplyAIDecision(Decisions[Slot]);
+		}
+	}
+}
+
+/**
+ * @brief Calls the timer callbacks of the enemies whose timers expired this frame.
+ */
+void UEnemyAIWorldSubsystem::FireExpiredTimers()
+{
+	for (const int32 Slot : ExpiredPatrolTimers)
+	{
+		if (AEnemy* Enemy = Enemies[Slot].Get())
+		{
+			Enemy->PatrolTimerFinished();
+		}
+	}
+	for (const int32 Slot : ExpiredAttackTimers)
+	{
+		if (AEnemy* Enemy = Enemies[Slot].Get())
+		{
+			Enemy->Attack();
+		}
+	}
+}
+
+/**
+ * @brief Removes a slot by swapping the last slot into its place and fixing up the moved enemy's slot index.
+ */
+void UEnemyAIWorldSubsystem::RemoveSlot(int32 Slot)
+{
+	Enemies.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	Locations.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	States.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	CombatRadiiSquared.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	AttackRadiiSquared.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	PatrolRadiiSquared.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	CombatTargets.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	CombatTargetLocations.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	HasCombatTarget.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	PatrolTargets.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	PatrolTargetLocations.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	HasPatrolTarget.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	EvaluationIntervals.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	TimeUntilEvaluation.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	DueForEvaluation.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	SenseIntervals.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	SenseTimeRemaining.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	PatrolTimeRemaining.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	AttackTimeRemaining.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	Decisions.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+
+	if (Enemies.IsValidIndex(Slot))
+	{
+		if (AEnemy* Moved = Enemies[Slot].Get())
+		{
+			Moved->AISlot = Slot;
+		}
+	}
+}
+
+/**
+ * @brief Removes the slots unregistered during the apply loop, highest first so pending indices stay valid.
+ */
+void UEnemyAIWorldSubsystem::FlushPendingRemovals()
+{
+	if (PendingRemovals.Num() == 0) return;
+
+	PendingRemovals.Sort(TGreater<int32>());
+	for (const int32 Slot : PendingRemovals)
+	{
+		RemoveSlot(Slot);
+	}
+	PendingRemovals.Reset();
+}
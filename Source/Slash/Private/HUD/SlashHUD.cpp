@@ -3,6 +3,9 @@
 
 #include "HUD/SlashHUD.h"
 #include "HUD/SlashOverlay.h"
+#include "Engine/Canvas.h"
+#include "Algo/Sort.h"
+#include "Kismet/GameplayStatics.h"
 
 /**
  * @brief This function is called when the game starts or when the actor is spawned.
@@ -28,3 +31,130 @@ void ASlashHUD::BeginPlay()
 		}
 	}
 }
+
+/**
+ * @brief Draws the HUD for this frame.
+ *
+ * In addition to the default HUD drawing, this draws all registered world-space health bars.
+ */
+void ASlashHUD::DrawHUD()
+{
+	Super::DrawHUD();
+
+	if (HealthBars.Num() > 0)
+	{
+		DrawHealthBars();
+	}
+}
+
+/**
+ * @brief Starts drawing a health bar above the given actor.
+ *
+ * If the actor already has a bar, only its percent is updated.
+ *
+ * @param Owner The actor the bar belongs to.
+ * @param Percent The health percent to show.
+ */
+void ASlashHUD::ShowHealthBar(AActor* Owner, float Percent)
+{
+	if (Owner == nullptr) return;
+
+	FHealthBarEntry* Entry = HealthBars.FindByPredicate([Owner](const FHealthBarEntry& Bar) { return Bar.Owner.Get() == Owner; });
+	if (Entry == nullptr)
+	{
+		Entry = &HealthBars.AddDefaulted_GetRef();
+		Entry->Owner = Owner;
+	}
+	Entry->Percent = Percent;
+}
+
+/**
+ * @brief Updates the percent of an actor's health bar, if it is currently shown.
+ *
+ * @param Owner The actor the bar belongs to.
+ * @param Percent The health percent to show.
+ */
+void ASlashHUD::SetHealthBarPercent(AActor* Owner, float Percent)
+{
+	if (FHealthBarEntry* Entry = HealthBars.FindByPredicate([Owner](const FHealthBarEntry& Bar) { return Bar.Owner.Get() == Owner; }))
+	{
+		Entry->Percent = Percent;
+	}
+}
+
+/**
+ * @brief Stops drawing the health bar of the given actor.
+ *
+ * @param Owner The actor the bar belongs to.
+ */
+void ASlashHUD::HideHealthBar(AActor* Owner)
+{
+	HealthBars.RemoveAllSwap([Owner](const FHealthBarEntry& Bar) { return Bar.Owner.Get() == Owner; }, EAllowShrinking::No);
+}
+
+/**
+ * @brief Gets the Slash HUD of the first local player.
+ *
+ * @param WorldContextObject Any object in the world to look in.
+ * @return The HUD, or nullptr if there is no player controller or its HUD is not an ASlashHUD.
+ */
+ASlashHUD* ASlashHUD::Get(const UObject* WorldContextObject)
+{
+	const APlayerController* PlayerController = UGameplayStatics::GetPlayerController(WorldContextObject, 0);
+	return PlayerController ? Cast<ASlashHUD>(PlayerController->GetHUD()) : nullptr;
+}
+
+/**
+ * @brief Draws every visible health bar in one pass.
+ *
+ * The function performs the following steps:
+ * 1. Drops entries whose owner is gone, and culls bars that are too far away, behind the camera, off screen or whose owner was not rendered recently.
+ * 2. If more bars survive than MaxHealthBars, keeps only the nearest ones.
+ * 3. Draws all backgrounds, then all fills, so the canvas can batch the tiles together.
+ */
+void ASlashHUD::DrawHealthBars()
+{
+	if (Canvas == nullptr || PlayerOwner == nullptr || PlayerOwner->PlayerCameraManager == nullptr) return;
+
+	const FVector ViewLocation = PlayerOwner->PlayerCameraManager->GetCameraLocation();
+	const double MaxDistanceSquared = FMath::Square(HealthBarMaxDistance);
+
+	VisibleHealthBars.Reset();
+	for (int32 Index = HealthBars.Num() - 1; Index >= 0; Index--)
+	{
+		const AActor* Owner = HealthBars[Index].Owner.Get();
+		if (Owner == nullptr)
+		{
+			HealthBars.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+			continue;
+		}
+
+		const FVector Anchor = Owner->GetActorLocation() + FVector(0.f, 0.f, Owner->GetSimpleCollisionHalfHeight() + HealthBarHeightOffset);
+		const double DistanceSquared = FVector::DistSquared(ViewLocation, Anchor);
+		if (DistanceSquared > MaxDistanceSquared) continue;
+		if (!Owner->WasRecentlyRendered(0.1f)) continue;
+
+		const FVector Projected = Canvas->Project(Anchor, false);
+		if (Projected.Z <= 0.f) continue;
+		if (Projected.X < 0.f || Projected.X > Canvas->ClipX || Projected.Y < 0.f || Projected.Y > Canvas->ClipY) continue;
+
+		VisibleHealthBars.Add({ FVector2D(Projected.X, Projected.Y), DistanceSquared, HealthBars[Index].Percent });
+	}
+
+	if (VisibleHealthBars.Num() > MaxHealthBars)
+	{
+		Algo::Sort(VisibleHealthBars, [](const FVisibleHealthBar& A, const FVisibleHealthBar& B) { return A.DistanceSquared < B.DistanceSquared; });
+		VisibleHealthBars.SetNum(MaxHealthBars, EAllowShrinking::No);
+	}
+
+	const FVector2D HalfSize = HealthBarSize * 0.5f;
+	for (const FVisibleHealthBar& Bar : VisibleHealthBars)
+	{
+		DrawRect(HealthBarBackgroundColor, Bar.ScreenPosition.X - HalfSize.X, Bar.ScreenPosition.Y - HalfSize.Y, HealthBarSize.X, HealthBarSize.Y);
+	}
+	for (const FVisibleHealthBar& Bar : VisibleHealthBars)
+	{
+		const float FillWidth = HealthBarSize.X * FMath::Clamp(Bar.Percent, 0.f, 1.f);
+		DrawRect(HealthBarFillColor, Bar.ScreenPosition.X - HalfSize.X, Bar.ScreenPosition.Y - HalfSize.Y, FillWidth, HealthBarSize.Y);
+	}
+}
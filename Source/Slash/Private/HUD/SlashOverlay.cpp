@@ -4,64 +4,109 @@
 #include "HUD/SlashOverlay.h"
 #include "Components/ProgressBar.h"
 #include "Components/TextBlock.h"
+#include "Components/InvalidationBox.h"
+
+/**
+ * @brief Called when the overlay is constructed.
+ *
+ * Makes sure the optional invalidation box caches its children, so only the text blocks and progress bars that change get repainted.
+ */
+void USlashOverlay::NativeConstruct()
+{
+	Super::NativeConstruct();
+
+	if (StatsInvalidationBox)
+	{
+		StatsInvalidationBox->SetCanCache(true);
+	}
+}
+
+/**
+ * @brief Called every frame.
+ *
+ * Flushes whatever changed in the view-model since the last frame, so a burst of pickups costs one widget update.
+ */
+void USlashOverlay::NativeTick(const FGeometry& MyGeometry, float InDeltaTime)
+{
+	Super::NativeTick(MyGeometry, InDeltaTime);
+
+	if (ViewModel.IsDirty())
+	{
+		FlushViewModel();
+	}
+}
+
+/**
+ * @brief Pushes the dirty view-model fields to the widgets.
+ *
+ * Texts come from the cached integer-to-text path, so no string is formatted on the hot path.
+ */
+void USlashOverlay::FlushViewModel()
+{
+	const ESlashOverlayField DirtyFields = ViewModel.ConsumeDirtyFields();
+
+	if (HealthProgressBar && EnumHasAnyFlags(DirtyFields, ESlashOverlayField::ESOF_Health))
+	{
+		HealthProgressBar->SetPercent(ViewModel.GetHealthPercent());
+	}
+	if (StaminaProgressBar && EnumHasAnyFlags(DirtyFields, ESlashOverlayField::ESOF_Stamina))
+	{
+		StaminaProgressBar->SetPercent(ViewModel.GetStaminaPercent());
+	}
+	if (GoldText && EnumHasAnyFlags(DirtyFields, ESlashOverlayField::ESOF_Gold))
+	{
+		GoldText->SetText(FSlashNumberText::Get(ViewModel.GetGold()));
+	}
+	if (SoulsText && EnumHasAnyFlags(DirtyFields, ESlashOverlayField::ESOF_Souls))
+	{
+		SoulsText->SetText(FSlashNumberText::Get(ViewModel.GetSouls()));
+	}
+}
 
 /**
  * @brief Sets the health bar percentage for the overlay.
  *
- * This function checks if the HealthProgressBar is null. If it is not, it sets the percentage of the HealthProgressBar to the specified percent.
+ * Records the new percentage in the view-model. The HealthProgressBar is updated on the next flush.
  *
  * @param Percent The new health percentage to set.
  */
 void USlashOverlay::SetHealthBarPercent(float Percent)
 {
-	if (HealthProgressBar)
-	{
-		HealthProgressBar->SetPercent(Percent);
-	}
+	ViewModel.SetHealthPercent(Percent);
 }
 
 /**
  * @brief Sets the stamina bar percentage for the overlay.
  *
- * This function checks if the StaminaProgressBar is null. If it is not, it sets the percentage of the StaminaProgressBar to the specified percent.
+ * Records the new percentage in the view-model. The StaminaProgressBar is updated on the next flush.
  *
  * @param Percent The new stamina percentage to set.
  */
 void USlashOverlay::SetStaminaBarPercent(float Percent)
 {
-	if (StaminaProgressBar)
-	{
-		StaminaProgressBar->SetPercent(Percent);
-	}
+	ViewModel.SetStaminaPercent(Percent);
 }
 
 /**
  * @brief Sets the gold amount for the overlay.
  *
- * This function checks if the GoldText is null. If it is not, it sets the text of the GoldText to the specified gold amount.
+ * Records the new gold amount in the view-model. The GoldText is updated on the next flush.
  *
  * @param Gold The new gold amount to set.
  */
 void USlashOverlay::SetGold(int32 Gold)
 {
-	if (GoldText)
-	{
-		const FString String = FString::Printf(TEXT("%d"), Gold);
-		const FText Text = FText::FromString(String);
-		GoldText->SetText(Text);
-	}
+	ViewModel.SetGold(Gold);
 }
 
 /**
  * @brief Sets the souls amount for the overlay.
  *
- * This function sets the text of the SoulsText to the specified souls amount.
+ * Records the new souls amount in the view-model. The SoulsText is updated on the next flush.
  *
  * @param Souls The new souls amount to set.
  */
 void USlashOverlay::SetSouls(int32 Souls)
 {
-	const FString String = FString::Printf(TEXT("%d"), Souls);
-	const FText Text = FText::FromString(String);
-	SoulsText->SetText(Text);
-}
\ No newline at end of file
+	ViewModel.SetSouls(Souls);
+}
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HUD/SlashOverlayViewModel.h"
+#include "Misc/StringBuilder.h"
+
+namespace
+{
+	/** Progress bar changes smaller than this are not visible and not worth a repaint. */
+	constexpr float PercentTolerance = 0.001f;
+}
+
+void FSlashOverlayViewModel::SetHealthPercent(float Percent)
+{
+	if (FMath::IsNearlyEqual(HealthPercent, Percent, PercentTolerance)) return;
+	HealthPercent = Percent;
+	DirtyFields |= ESlashOverlayField::ESOF_Health;
+}
+
+void FSlashOverlayViewModel::SetStaminaPercent(float Percent)
+{
+	if (FMath::IsNearlyEqual(StaminaPercent, Percent, PercentTolerance)) return;
+	StaminaPercent = Percent;
+	DirtyFields |= ESlashOverlayField::ESOF_Stamina;
+}
+
+void FSlashOverlayViewModel::SetGold(int32 InGold)
+{
+	if (Gold == InGold) return;
+	Gold = InGold;
+	DirtyFields |= ESlashOverlayField::ESOF_Gold;
+}
+
+void FSlashOverlayViewModel::SetSouls(int32 InSouls)
+{
+	if (Souls == InSouls) return;
+	Souls = InSouls;
+	DirtyFields |= ESlashOverlayField::ESOF_Souls;
+}
+
+ESlashOverlayField FSlashOverlayViewModel::ConsumeDirtyFields()
+{
+	const ESlashOverlayField Fields = DirtyFields;
+	DirtyFields = ESlashOverlayField::ESOF_None;
+	return Fields;
+}
+
+FText FSlashNumberText::Get(int32 Value)
+{
+	static TArray<FText> Cache;
+
+	const bool bCacheable = Value >= 0 && Value < CacheSize;
+	if (bCacheable)
+	{
+		if (Cache.Num() == 0)
+		{
+			Cache.SetNum(CacheSize);
+		}
+		if (!Cache[Value].IsEmpty())
+		{
+			return Cache[Value];
+		}
+	}
+
+	// Format on the stack; only the FText itself is allocated, and only once per cached value
+	TStringBuilder<16> Builder;
+	Builder << Value;
+	FText Text = FText::AsCultureInvariant(FString(Builder.ToView()));
+
+	if (bCacheable)
+	{
+		Cache[Value] = Text;
+	}
+	return Text;
+}
@@ -0,0 +1,14 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Interfaces/SignificanceInterface.h"
+
+// Add default functionality here for any ISignificanceInterface functions that are not pure virtual.
+bool ISignificanceInterface::IsInCombat() const
+{
+	return false;
+}
+
+void ISignificanceInterface::SetSignificanceTier(ESignificanceTier Tier)
+{
+}
@@ -6,6 +6,8 @@
 #include "Components/SphereComponent.h"
 #include "Interfaces/PickupInterface.h"
 #include "NiagaraComponent.h"
+#include "Subsystems/SpatialGridSubsystem.h"
+#include "Subsystems/ItemHoverSubsystem.h"
 
 /**
  * @brief Sets default values for this actor's properties.
@@ -14,8 +16,9 @@
  */
 AItem::AItem()
 {
-	// Set this actor to call Tick() every frame
+	// Hovering is driven by UItemHoverSubsystem, so items do not tick unless a subclass turns it on
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 	// Create and configure the item's mesh component
 	ItemMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("ItemMeshComponent"));
 	ItemMesh->SetCollisionResponseToAllChannels(ECR_Ignore);
@@ -33,15 +36,56 @@ AItem::AItem()
 /**
  * @brief Called when the game starts or when spawned.
  *
- * This function sets up the sphere component's overlap events.
+ * This function sets up the sphere component's overlap events, lists hovering items in the spatial grid as pickups and hands them to the hover manager.
  */
 void AItem::BeginPlay()
 {
 	Super::BeginPlay();
+	DefaultSphereCollision = Sphere->GetCollisionEnabled();
 	// Set up the sphere component's overlap events
 	Sphere->OnComponentBeginOverlap.AddDynamic(this, &AItem::OnSphereOverlap);
 	Sphere->OnComponentEndOverlap.AddDynamic(this, &AItem::OnSphereEndOverlap);
-	
+	// List the item as a pickup so nearby actors can find it without an overlap or actor iteration
+	SpatialGrid = GetWorld()->GetSubsystem<USpatialGridSubsystem>();
+	if (SpatialGrid && ItemState == EItemState::EIS_Hovering)
+	{
+		SpatialGrid->Register(this, ESpatialGridCategory::ESGC_Pickup);
+	}
+	HoverSubsystem = GetWorld()->GetSubsystem<UItemHoverSubsystem>();
+	UpdateHoverRegistration();
+}
+
+/**
+ * @brief Called when the item is removed from the world.
+ *
+ * This function takes the item off the hover manager.
+ */
+void AItem::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (HoverSubsystem)
+	{
+		HoverSubsystem->UnregisterItem(this);
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+/**
+ * @brief Keeps the hover manager registration in sync with the item's state.
+ *
+ * Hovering items are registered so their bob is computed in the batched pass; equipped or pooled items are unregistered and left at rest.
+ */
+void AItem::UpdateHoverRegistration()
+{
+	if (HoverSubsystem == nullptr) return;
+
+	if (ItemState == EItemState::EIS_Hovering && !IsHidden())
+	{
+		HoverSubsystem->RegisterItem(this);
+	}
+	else
+	{
+		HoverSubsystem->UnregisterItem(this);
+	}
 }
 
 /**
@@ -56,6 +100,19 @@ float AItem::TransformedSin()
 	return Amplitude * FMath::Sin(RunningTime * TimeConstant);
 }
 
+/**
+ * @brief Returns the peak height of the hover bob.
+ *
+ * Items used to add TransformedSin to their location every frame, which bobs by Amplitude / (TimeConstant * DeltaTime). The height is taken at 60 fps so that tuned Amplitudes keep their look under UItemHoverSubsystem.
+ *
+ * @return The hover height above the rest location.
+ */
+float AItem::GetHoverHeight() const
+{
+	constexpr float ReferenceFrameRate = 60.f;
+	return TimeConstant > 0.f ? Amplitude * ReferenceFrameRate / TimeConstant : 0.f;
+}
+
 /**
  * @brief Returns the transformed cosine value.
  *
@@ -113,9 +170,9 @@ void AItem::OnSphereEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor*
 }
 
 /**
- * @brief Called every frame.
+ * @brief Called every frame while ticking is enabled.
  *
- * This function is called every frame. If the item's state is EIS_Hovering, it adds an offset to the item's world location to create a hovering effect.
+ * Ticking is off by default because the hovering effect is applied by UItemHoverSubsystem. Subclasses that enable it still get RunningTime advanced for TransformedSin and TransformedCos.
  *
  * @param DeltaTime The time elapsed since the last frame.
  */
@@ -124,11 +181,69 @@ void AItem::Tick(float DeltaTime)
 	Super::Tick(DeltaTime);
 
 	RunningTime += DeltaTime;
+}
 
-	if (ItemState == EItemState::EIS_Hovering)
-	{
-	AddActorWorldOffset(FVector(0.f, 0.f, TransformedSin()));
-	}	
+/**
+ * @brief Checks whether something at a location touches the item's pickup sphere.
+ *
+ * This is the overlap test of the sphere component done against a point and a reach, so candidates from a spatial grid query can be filtered without waiting for overlap events.
+ *
+ * @param Location The location to test.
+ * @param Reach The radius around the location, e.g. a capsule radius.
+ * @return True if the location is within the sphere radius plus the reach.
+ */
+bool AItem::IsInPickupReach(const FVector& Location, float Reach) const
+{
+	return FVector::DistSquared(Sphere->GetComponentLocation(), Location) <= FMath::Square(Sphere->GetScaledSphereRadius() + Reach);
 }
 
+/**
+ * @brief Restores a pooled item to the state of a freshly spawned pickup.
+ *
+ * This function is called by UItemPoolSubsystem after the item has been moved to its new transform. It resets the item's state and hover clock, re-enables the sphere collision and the Niagara effect, and lists the item in the spatial grid again.
+ */
+void AItem::OnAcquiredFromPool()
+{
+	ItemState = EItemState::EIS_Hovering;
+	RunningTime = 0.f;
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+	Sphere->SetCollisionEnabled(DefaultSphereCollision);
+	if (ItemEffect)
+	{
+		ItemEffect->Activate(true);
+	}
+	SetActorTickEnabled(PrimaryActorTick.bStartWithTickEnabled);
+	if (SpatialGrid)
+	{
+		SpatialGrid->Register(this, ESpatialGridCategory::ESGC_Pickup);
+	}
+	UpdateHoverRegistration();
+}
 
+/**
+ * @brief Puts the item to sleep instead of destroying it.
+ *
+ * This function is called by UItemPoolSubsystem when the item is released. It detaches and hides the item, disables its collision, ticking and Niagara effect, and removes it from the spatial grid so it cannot be picked up or queried while dormant.
+ */
+void AItem::OnReleasedToPool()
+{
+	ItemState = EItemState::EIS_Hovering;
+	if (HoverSubsystem)
+	{
+		HoverSubsystem->UnregisterItem(this);
+	}
+	DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+	SetActorHiddenInGame(true);
+	Sphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetActorEnableCollision(false);
+	if (ItemEffect)
+	{
+		ItemEffect->DeactivateImmediate();
+	}
+	SetActorTickEnabled(false);
+	if (SpatialGrid)
+	{
+		SpatialGrid->Unregister(this);
+	}
+}
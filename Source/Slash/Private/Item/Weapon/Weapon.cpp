@@ -6,9 +6,10 @@
 #include "Kismet/GameplayStatics.h"
 #include "Components/BoxComponent.h"
 #include "Components/SphereComponent.h"
-#include "Kismet/KismetSystemLibrary.h"
 #include "Interfaces/HitInterface.h"
 #include "NiagaraComponent.h"
+#include "Subsystems/SpatialGridSubsystem.h"
+#include "Subsystems/CombatTraceSubsystem.h"
 
 /**
  * @brief Constructor for the AWeapon class.
@@ -45,16 +46,66 @@ void AWeapon::AttachMeshToSocket(USceneComponent* InParent, const FName& InSocke
  ItemMesh->AttachToComponent(InParent, TransformRules, InSocketName);
 }
 
+/**
+ * @brief Resets the weapon when it goes back to the item pool.
+ *
+ * Clears the owner and instigator left over from the last wielder and closes any open swing so the weapon no longer deals damage.
+ */
+void AWeapon::OnReleasedToPool()
+{
+ Super::OnReleasedToPool();
+ SetSwingEnabled(false);
+ SetOwner(nullptr);
+ SetInstigator(nullptr);
+}
+
 /**
  * @brief Called when the game starts or when the actor is spawned.
  *
- * This function sets up the weapon box overlap event.
+ * Hits are detected by UCombatTraceSubsystem while a swing is open, so the weapon box no longer listens for overlaps.
  */
 void AWeapon::BeginPlay()
 {
  Super::BeginPlay();
+}
+
+/**
+ * @brief Opens or closes the weapon's collision window.
+ *
+ * While open, UCombatTraceSubsystem sweeps the blade every frame and calls ApplySwingHit once per actor hit during the swing.
+ *
+ * @param bEnabled Whether the swing is starting or ending.
+ */
+void AWeapon::SetSwingEnabled(bool bEnabled)
+{
+ UCombatTraceSubsystem* CombatTrace = GetWorld() ? GetWorld()->GetSubsystem<UCombatTraceSubsystem>() : nullptr;
+ if (CombatTrace == nullptr) return;
+
+ if (bEnabled)
+ {
+  CombatTrace->BeginSwing(this);
+ }
+ else
+ {
+  CombatTrace->EndSwing(this);
+ }
+}
 
- WeaponBox->OnComponentBeginOverlap.AddDynamic(this, &AWeapon::AWeapon::OnBoxOverlap);
+/**
+ * @brief Gets the blade segment in world space, from the box trace start to the box trace end.
+ */
+void AWeapon::GetBladeSegment(FVector& OutStart, FVector& OutEnd) const
+{
+ OutStart = BoxTraceStart->GetComponentLocation();
+ OutEnd = BoxTraceEnd->GetComponentLocation();
+}
+
+/**
+ * @brief Gets the orientation used for the blade's sweep box.
+ */
+FQuat AWeapon::GetBladeRotation() const
+{
+ return BoxTraceStart->GetComponentQuat();
 }
 
 /**
@@ -103,12 +154,15 @@ void AWeapon::DiactivateEmbers()
 void AWeapon::Equip(USceneComponent* InParent, FName InSocketName, AActor* NewOwner, APawn* NewInstigator)
 {
  ItemState = EItemState::EIS_Equipped;
+ UpdateHoverRegistration();
  SetOwner(NewOwner);
  SetInstigator(NewInstigator);
  AttachMeshToSocket(InParent, InSocketName);
  DisableSphereCollision();
  PlayEquipSound();
  DiactivateEmbers();
+ // An equipped weapon is no longer a pickup
+ if (SpatialGrid) SpatialGrid->Unregister(this);
 }
 
 /**
@@ -131,63 +185,36 @@ void AWeapon::ExecuteGetHit(FHitResult BoxHit)
  * @param OtherActor The other actor to check.
  * @return True if the actor is of the same type, false otherwise.
  */
-bool AWeapon::ActorIsSameType(AActor* OtherActor)
+bool AWeapon::ActorIsSameType(AActor* OtherActor) const
 {
- return GetOwner()->ActorHasTag(TEXT("Enemy")) && OtherActor->ActorHasTag(TEXT("Enemy"));
+ return GetOwner() && GetOwner()->ActorHasTag(TEXT("Enemy")) && OtherActor->ActorHasTag(TEXT("Enemy"));
 }
 
 /**
- * @brief Called when the weapon box overlaps with another component.
+ * @brief Checks if the actor can be damaged by this weapon.
  *
- * @param OverlappedComponent The overlapped component.
- * @param OtherActor The other actor involved in the overlap.
- * @param OtherComp The other component involved in the overlap.
- * @param OtherBodyIndex The index of the other body involved in the overlap.
- * @param bFromSweep Whether the overlap is from a sweep.
- * @param SweepResult The sweep result.
+ * @param OtherActor The other actor to check.
+ * @return True if the actor is neither the weapon, its owner, nor of the same type.
  */
-void AWeapon::OnBoxOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+bool AWeapon::CanHit(AActor* OtherActor) const
 {
- if (ActorIsSameType(OtherActor)) return;
-
- FHitResult BoxHit;
- BoxTrace(BoxHit);
-
- if (BoxHit.GetActor())
- {
-  if (ActorIsSameType(BoxHit.GetActor())) return;
-
-  UGameplayStatics::ApplyDamage(BoxHit.GetActor(), Damage, GetInstigator()->GetController(), this, UDamageType::StaticClass());
-  ExecuteGetHit(BoxHit);
-  CreateFields(BoxHit.ImpactPoint);
- }
+ return OtherActor && OtherActor != this && OtherActor != GetOwner() && !ActorIsSameType(OtherActor);
 }
 
 /**
- * @brief Performs a box trace.
- *
- * This function is used to perform a box trace (or box collision check) in the game world. A box trace is a type of collision detection that checks for collisions within a box-shaped volume in the game world.
+ * @brief Applies a hit found by the swing sweep.
  *
- * @param BoxHit The hit result. This is an output parameter that will contain the result of the box trace. It will contain information about what was hit, where it was hit, and other related information.
+ * Called by UCombatTraceSubsystem at most once per actor per swing. Applies damage, runs the hit interface and spawns the field.
  *
- * The function performs the following steps:
- * 1. It gets the start and end locations for the box trace from the BoxTraceStart and BoxTraceEnd components respectively.
- * 2. It creates an array of actors to ignore during the box trace. This includes the weapon itself and any actors in the IgnoreActors list.
- * 3. It performs the box trace using the UKismetSystemLibrary::BoxTraceSingle function. This function checks for collisions between the start and end locations, ignoring the actors in the ActorsToIgnore list. The result of the box trace is stored in the BoxHit parameter.
- * 4. If an actor was hit during the box trace, it is added to the IgnoreActors list. This ensures that the actor will be ignored in subsequent box traces.
+ * @param BoxHit The hit result.
  */
-void AWeapon::BoxTrace(FHitResult& BoxHit)
+void AWeapon::ApplySwingHit(const FHitResult& BoxHit)
 {
- const FVector Start = BoxTraceStart->GetComponentLocation();
- const FVector End = BoxTraceEnd->GetComponentLocation();
-
- TArray<AActor*> ActorsToIgnore;
- ActorsToIgnore.Add(this);
+ AActor* HitActor = BoxHit.GetActor();
+ if (HitActor == nullptr) return;
 
- for (AActor* Actor : IgnoreActors)
- {
-  ActorsToIgnore.AddUnique(Actor);
- }
- UKismetSystemLibrary::BoxTraceSingle(this, Start, End, BoxTraceExtent, BoxTraceStart->GetComponentRotation(), TraceTypeQuery1, false, ActorsToIgnore, bShowBoxDebug ? EDrawDebugTrace::ForDuration : EDrawDebugTrace::None, BoxHit, true);
- IgnoreActors.AddUnique(BoxHit.GetActor());
+ AController* InstigatorController = GetInstigator() ? GetInstigator()->GetController() : nullptr;
+ UGameplayStatics::ApplyDamage(HitActor, Damage, InstigatorController, this, UDamageType::StaticClass());
+ ExecuteGetHit(BoxHit);
+ CreateFields(BoxHit.ImpactPoint);
 }
@@ -5,13 +5,14 @@
 #include "Characters/SlashCharacter.h"
 #include "Interfaces/PickupInterface.h"
 #include "Kismet/GameplayStatics.h"
+#include "Subsystems/ItemPoolSubsystem.h"
 
 /**
  * @brief Handles the event when the treasure's sphere component overlaps with another component.
  *
  * This function is triggered when the treasure's sphere component overlaps with another component. It checks if the other actor implements the IPickupInterface. If it does, it calls the AddGold function on the other actor, passing the treasure as a parameter.
  *
- * It also checks if the other actor is of type ASlashCharacter. If it is, and if the PickupSound is not null, it plays the PickupSound at the treasure's location and destroys the treasure.
+ * It also checks if the other actor is of type ASlashCharacter. If it is, and if the PickupSound is not null, it plays the PickupSound at the treasure's location and returns the treasure to the item pool.
  *
  * @param OverlappedComponent The component that was overlapped.
  * @param OtherActor The other actor involved in the overlap.
@@ -37,7 +38,7 @@ void ATreasure::OnSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor
 		// If it is, and if the PickupSound is not null, play the PickupSound at the treasure's location
 		UGameplayStatics::PlaySoundAtLocation(
 		 this, PickupSound, GetActorLocation());
-		// Destroy the treasure
-		Destroy();
+		// Return the treasure to the item pool instead of destroying it
+		UItemPoolSubsystem::ReleaseOrDestroy(this);
 	}
 }
\ No newline at end of file
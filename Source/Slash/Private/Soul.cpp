@@ -3,11 +3,12 @@
 
 #include "Soul.h"
 #include "Interfaces/PickupInterface.h"
+#include "Subsystems/ItemPoolSubsystem.h"
 
 /**
  * @brief Handles the event when the soul's sphere component overlaps with another component.
  *
- * This function is triggered when the soul's sphere component overlaps with another component. It checks if the other actor implements the IPickupInterface. If it does, it calls the AddSouls function on the other actor, passing the soul as a parameter. After this, the soul is destroyed.
+ * This function is triggered when the soul's sphere component overlaps with another component. It checks if the other actor implements the IPickupInterface. If it does, it calls the AddSouls function on the other actor, passing the soul as a parameter. After this, the soul is returned to the item pool.
  *
  * @param OverlappedComponent The component that was overlapped.
  * @param OtherActor The other actor involved in the overlap.
@@ -26,6 +27,6 @@ void ASoul::OnSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* Ot
 		// If it does, call the AddSouls function on the other actor
 		PickupInterface->AddSouls(this);
 	}
-	// Destroy the soul
-	Destroy();
+	// Return the soul to the item pool instead of destroying it
+	UItemPoolSubsystem::ReleaseOrDestroy(this);
 }
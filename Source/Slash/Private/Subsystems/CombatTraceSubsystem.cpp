@@ -0,0 +1,193 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Subsystems/CombatTraceSubsystem.h"
+#include "Item/Weapon/Weapon.h"
+#include "DrawDebugHelpers.h"
+#include "Engine/World.h"
+
+void UCombatTraceSubsystem::Tick(float DeltaTime)
+{
+	LastTickSeconds = 0.0;
+	if (Swings.Num() == 0) return;
+
+	const double StartTime = FPlatformTime::Seconds();
+	CollectResults();
+	DispatchHits();
+	IssueSweeps();
+	LastTickSeconds = FPlatformTime::Seconds() - StartTime;
+}
+
+TStatId UCombatTraceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatTraceSubsystem, STATGROUP_Tickables);
+}
+
+void UCombatTraceSubsystem::BeginSwing(AWeapon* Weapon)
+{
+	if (Weapon == nullptr) return;
+
+	// Traces still in flight belong to the old swing and are collected against its hit set before it is dropped
+	EndSwing(Weapon);
+
+	FWeaponSwing& Swing = Swings.AddDefaulted_GetRef();
+	Swing.Weapon = Weapon;
+	GetBladeSamples(Weapon, Swing.PreviousSamples);
+}
+
+/**
+ * Sweeps the blade from its last swept position to where it is now before closing the window, so the motion of the final frame still hits.
+ * The sweep is synchronous because the swing is dropped as soon as its in-flight traces are collected.
+ */
+void UCombatTraceSubsystem::EndSwing(AWeapon* Weapon)
+{
+	const int32 SwingIndex = Weapon != nullptr ? FindSwing(Weapon) : INDEX_NONE;
+	if (SwingIndex == INDEX_NONE) return;
+
+	FWeaponSwing& Swing = Swings[SwingIndex];
+	Swing.bEnding = true;
+
+	UWorld* World = GetWorld();
+	TArray<FVector, TInlineAllocator<4>> CurrentSamples;
+	GetBladeSamples(Weapon, CurrentSamples);
+	const FQuat Rotation = Weapon->GetBladeRotation();
+	const FCollisionShape Shape = FCollisionShape::MakeBox(Weapon->GetBoxTraceExtent());
+	const FCollisionQueryParams Params = MakeQueryParams(Weapon);
+
+	TArray<FHitResult> Hits;
+	for (int32 Sample = 0; Sample < CurrentSamples.Num(); Sample++)
+	{
+		World->SweepMultiByChannel(Hits, Swing.PreviousSamples[Sample], CurrentSamples[Sample], Rotation, ECC_Visibility, Shape, Params);
+		RecordHits(Swing, Weapon, Hits);
+	}
+
+	Swing.PreviousSamples = CurrentSamples;
+}
+
+bool UCombatTraceSubsystem::IsSwinging(const AWeapon* Weapon) const
+{
+	return FindSwing(Weapon) != INDEX_NONE;
+}
+
+/**
+ * Gathers last frame's sweep results for every swing, keeping only the first hit per actor per swing.
+ */
+void UCombatTraceSubsystem::CollectResults()
+{
+	UWorld* World = GetWorld();
+	FTraceDatum Datum;
+
+	for (FWeaponSwing& Swing : Swings)
+	{
+		const AWeapon* Weapon = Swing.Weapon.Get();
+		for (const FTraceHandle& Handle : Swing.PendingTraces)
+		{
+			if (Weapon == nullptr || !World->QueryTraceData(Handle, Datum)) continue;
+
+			RecordHits(Swing, Weapon, Datum.OutHits);
+		}
+		Swing.PendingTraces.Reset();
+	}
+
+	Swings.RemoveAllSwap([](const FWeaponSwing& Swing) { return Swing.bEnding || !Swing.Weapon.IsValid(); }, EAllowShrinking::No);
+}
+
+/**
+ * Queues the first hit on each actor Swing has not damaged yet.
+ */
+void UCombatTraceSubsystem::RecordHits(FWeaponSwing& Swing, const AWeapon* Weapon, const TArray<FHitResult>& Hits)
+{
+	for (const FHitResult& Hit : Hits)
+	{
+		AActor* HitActor = Hit.GetActor();
+		if (HitActor == nullptr || !Weapon->CanHit(HitActor)) continue;
+
+		bool bAlreadyHit = false;
+		Swing.HitActors.Add(HitActor, &bAlreadyHit);
+		if (!bAlreadyHit)
+		{
+			PendingHits.Add({ Swing.Weapon, Hit });
+		}
+	}
+}
+
+/**
+ * Applies damage for the collected hits. Runs after collection so damage side effects (deaths, swings ending) cannot disturb the swing list mid-iteration.
+ */
+void UCombatTraceSubsystem::DispatchHits()
+{
+	TArray<FPendingHit> Hits = MoveTemp(PendingHits);
+	PendingHits.Reset();
+
+	for (const FPendingHit& PendingHit : Hits)
+	{
+		if (AWeapon* Weapon = PendingHit.Weapon.Get())
+		{
+			Weapon->ApplySwingHit(PendingHit.Hit);
+		}
+	}
+}
+
+/**
+ * Sweeps each blade sample from where it was last frame to where it is now, so fast swings cannot skip past a target between frames.
+ */
+void UCombatTraceSubsystem::IssueSweeps()
+{
+	UWorld* World = GetWorld();
+	TArray<FVector, TInlineAllocator<4>> CurrentSamples;
+
+	for (FWeaponSwing& Swing : Swings)
+	{
+		const AWeapon* Weapon = Swing.Weapon.Get();
+		if (Weapon == nullptr || Swing.bEnding) continue;
+
+		GetBladeSamples(Weapon, CurrentSamples);
+		const FQuat Rotation = Weapon->GetBladeRotation();
+		const FCollisionShape Shape = FCollisionShape::MakeBox(Weapon->GetBoxTraceExtent());
+
+		const FCollisionQueryParams Params = MakeQueryParams(Weapon);
+
+		for (int32 Sample = 0; Sample < CurrentSamples.Num(); Sample++)
+		{
+			const FVector& Start = Swing.PreviousSamples[Sample];
+			const FVector& End = CurrentSamples[Sample];
+			Swing.PendingTraces.Add(World->AsyncSweepByChannel(EAsyncTraceType::Multi, Start, End, Rotation, ECC_Visibility, Shape, Params));
+
+			if (Weapon->ShowsBoxDebug())
+			{
+				DrawDebugSweptBox(World, Start, End, Rotation.Rotator(), Weapon->GetBoxTraceExtent(), FColor::Red, false, 5.f);
+			}
+		}
+
+		Swing.PreviousSamples = CurrentSamples;
+	}
+}
+
+void UCombatTraceSubsystem::GetBladeSamples(const AWeapon* Weapon, TArray<FVector, TInlineAllocator<4>>& OutSamples)
+{
+	FVector BladeStart;
+	FVector BladeEnd;
+	Weapon->GetBladeSegment(BladeStart, BladeEnd);
+
+	OutSamples.Reset();
+	for (int32 Sample = 0; Sample < BladeSamples; Sample++)
+	{
+		const float Alpha = BladeSamples > 1 ? static_cast<float>(Sample) / (BladeSamples - 1) : 0.5f;
+		OutSamples.Add(FMath::Lerp(BladeStart, BladeEnd, Alpha));
+	}
+}
+
+FCollisionQueryParams UCombatTraceSubsystem::MakeQueryParams(const AWeapon* Weapon)
+{
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(WeaponSwing), false, Weapon);
+	Params.AddIgnoredActor(Weapon->GetOwner());
+	return Params;
+}
+
+/**
+ * Finds the open swing of Weapon. Ended swings waiting for their last sweeps are skipped, so a restart never picks up their traces.
+ */
+int32 UCombatTraceSubsystem::FindSwing(const AWeapon* Weapon) const
+{
+	return Swings.IndexOfByPredicate([Weapon](const FWeaponSwing& Swing) { return Swing.Weapon.Get() == Weapon && !Swing.bEnding; });
+}
@@ -0,0 +1,141 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Subsystems/ItemHoverSubsystem.h"
+#include "Item.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/PlayerController.h"
+#include "Math/VectorRegister.h"
+
+namespace
+{
+	constexpr int32 SimdWidth = 4;
+
+	/** Offsets below this are not worth a component move. */
+	constexpr float MinOffsetChange = 0.01f;
+}
+
+void UItemHoverSubsystem::Tick(float DeltaTime)
+{
+	if (Items.Num() == 0) return;
+
+	ComputeOffsets(DeltaTime);
+	ApplyOffsets();
+}
+
+TStatId UItemHoverSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UItemHoverSubsystem, STATGROUP_Tickables);
+}
+
+void UItemHoverSubsystem::RegisterItem(AItem* Item)
+{
+	if (Item == nullptr || Item->HoverSlot != INDEX_NONE) return;
+
+	Item->HoverSlot = Items.Add(Item);
+	RestLocations.Add(Item->GetActorLocation());
+	AppliedOffsets.Add(0.f);
+	Heights.Add(Item->GetHoverHeight());
+	Frequencies.Add(Item->TimeConstant);
+	Phases.Add(0.f);
+	Offsets.Add(0.f);
+}
+
+void UItemHoverSubsystem::UnregisterItem(AItem* Item)
+{
+	if (Item == nullptr || !Items.IsValidIndex(Item->HoverSlot)) return;
+
+	const int32 Slot = Item->HoverSlot;
+	// Leave the item at rest so it is not frozen mid-bob when equipped or pooled
+	if (AppliedOffsets[Slot] != 0.f)
+	{
+		Item->SetActorLocation(RestLocations[Slot]);
+	}
+	RemoveSlot(Slot);
+	Item->HoverSlot = INDEX_NONE;
+}
+
+/**
+ * Advances every phase by the shared frame delta and evaluates Height * sin(Phase) four items at a time.
+ */
+void UItemHoverSubsystem::ComputeOffsets(float DeltaTime)
+{
+	const int32 Num = Items.Num();
+	const int32 NumVectorized = Num - Num % SimdWidth;
+
+	float* PhaseData = Phases.GetData();
+	float* OffsetData = Offsets.GetData();
+	const float* FrequencyData = Frequencies.GetData();
+	const float* HeightData = Heights.GetData();
+
+	const VectorRegister4Float Delta = VectorSetFloat1(DeltaTime);
+	const VectorRegister4Float TwoPi = VectorSetFloat1(UE_TWO_PI);
+	for (int32 Index = 0; Index < NumVectorized; Index += SimdWidth)
+	{
+		VectorRegister4Float Phase = VectorMultiplyAdd(VectorLoad(FrequencyData + Index), Delta, VectorLoad(PhaseData + Index));
+		Phase = VectorMod(Phase, TwoPi);
+		VectorStore(Phase, PhaseData + Index);
+		VectorStore(VectorMultiply(VectorLoad(HeightData + Index), VectorSin(Phase)), OffsetData + Index);
+	}
+
+	for (int32 Index = NumVectorized; Index < Num; Index++)
+	{
+		PhaseData[Index] = FMath::Fmod(PhaseData[Index] + FrequencyData[Index] * DeltaTime, UE_TWO_PI);
+		OffsetData[Index] = HeightData[Index] * FMath::Sin(PhaseData[Index]);
+	}
+}
+
+/**
+ * Moves only the items that are near the view, were rendered recently and actually changed height.
+ */
+void UItemHoverSubsystem::ApplyOffsets()
+{
+	FVector ViewLocation;
+	const bool bHasView = GetViewLocation(ViewLocation);
+	const double HoverRangeSquared = FMath::Square(HoverRange);
+
+	for (int32 Slot = Items.Num() - 1; Slot >= 0; Slot--)
+	{
+		AItem* Item = Items[Slot].Get();
+		if (Item == nullptr)
+		{
+			RemoveSlot(Slot);
+			continue;
+		}
+
+		if (FMath::Abs(Offsets[Slot] - AppliedOffsets[Slot]) < MinOffsetChange) continue;
+		if (bHasView && FVector::DistSquared(ViewLocation, RestLocations[Slot]) > HoverRangeSquared) continue;
+		if (!Item->WasRecentlyRendered(RenderedTolerance)) continue;
+
+		Item->SetActorLocation(RestLocations[Slot] + FVector(0.f, 0.f, Offsets[Slot]));
+		AppliedOffsets[Slot] = Offsets[Slot];
+	}
+}
+
+bool UItemHoverSubsystem::GetViewLocation(FVector& OutViewLocation) const
+{
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	if (PlayerController == nullptr || PlayerController->PlayerCameraManager == nullptr) return false;
+
+	OutViewLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+	return true;
+}
+
+void UItemHoverSubsystem::RemoveSlot(int32 Slot)
+{
+	Items.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	RestLocations.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	AppliedOffsets.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	Heights.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	Frequencies.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	Phases.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	Offsets.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+
+	if (Items.IsValidIndex(Slot))
+	{
+		if (AItem* Moved = Items[Slot].Get())
+		{
+			Moved->HoverSlot = Slot;
+		}
+	}
+}
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Subsystems/ItemPoolSubsystem.h"
+#include "Item.h"
+
+void UItemPoolSubsystem::Deinitialize()
+{
+	Pools.Empty();
+	Super::Deinitialize();
+}
+
+void UItemPoolSubsystem::Prewarm(TSubclassOf<AItem> ItemClass, int32 Count)
+{
+	if (!ItemClass) return;
+
+	FItemPool& Pool = Pools.FindOrAdd(ItemClass.Get());
+	while (Pool.FreeItems.Num() < Count)
+	{
+		AItem* Item = SpawnItem(ItemClass, FTransform::Identity);
+		if (Item == nullptr) return;
+		Item->OnReleasedToPool();
+		Pool.FreeItems.Add(Item);
+	}
+}
+
+AItem* UItemPoolSubsystem::Acquire(TSubclassOf<AItem> ItemClass, const FTransform& Transform)
+{
+	if (!ItemClass) return nullptr;
+
+	if (FItemPool* Pool = Pools.Find(ItemClass.Get()))
+	{
+		while (Pool->FreeItems.Num() > 0)
+		{
+			AItem* Item = Pool->FreeItems.Pop(EAllowShrinking::No);
+			if (!IsValid(Item)) continue;
+
+			PoolHits++;
+			Item->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+			Item->OnAcquiredFromPool();
+			return Item;
+		}
+	}
+
+	PoolMisses++;
+	return SpawnItem(ItemClass, Transform);
+}
+
+void UItemPoolSubsystem::Release(AItem* Item)
+{
+	if (!IsValid(Item)) return;
+
+	FItemPool& Pool = Pools.FindOrAdd(Item->GetClass());
+	if (Pool.FreeItems.Contains(Item)) return;
+
+	Item->OnReleasedToPool();
+	Pool.FreeItems.Add(Item);
+}
+
+void UItemPoolSubsystem::ReleaseOrDestroy(AItem* Item)
+{
+	if (!IsValid(Item)) return;
+
+	UWorld* World = Item->GetWorld();
+	UItemPoolSubsystem* ItemPool = World && !World->bIsTearingDown ? World->GetSubsystem<UItemPoolSubsystem>() : nullptr;
+	if (ItemPool)
+	{
+		ItemPool->Release(Item);
+	}
+	else
+	{
+		Item->Destroy();
+	}
+}
+
+int32 UItemPoolSubsystem::GetNumFree(TSubclassOf<AItem> ItemClass) const
+{
+	const FItemPool* Pool = Pools.Find(ItemClass.Get());
+	return Pool ? Pool->FreeItems.Num() : 0;
+}
+
+AItem* UItemPoolSubsystem::SpawnItem(TSubclassOf<AItem> ItemClass, const FTransform& Transform)
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr) return nullptr;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	return World->SpawnActor<AItem>(ItemClass, Transform, SpawnParams);
+}
@@ -0,0 +1,146 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Subsystems/SignificanceSubsystem.h"
+#include "Interfaces/SignificanceInterface.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/PlayerController.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("High Tier"), STAT_SignificanceHigh, STATGROUP_SlashSignificance);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Medium Tier"), STAT_SignificanceMedium, STATGROUP_SlashSignificance);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Low Tier"), STAT_SignificanceLow, STATGROUP_SlashSignificance);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Dormant Tier"), STAT_SignificanceDormant, STATGROUP_SlashSignificance);
+
+namespace
+{
+	/** Score weights. Combat alone is enough to reach the high tier. */
+	constexpr float CombatScore = 1.f;
+	constexpr float HiddenDistanceScale = 0.4f;
+
+	/** Lower bound of each tier's score, highest tier first. */
+	constexpr float HighTierScore = 0.75f;
+	constexpr float MediumTierScore = 0.4f;
+	constexpr float LowTierScore = 0.1f;
+
+	/** Seconds an actor may go unrendered and still count as visible. */
+	constexpr float VisibilityTolerance = 0.25f;
+}
+
+void USignificanceSubsystem::Tick(float DeltaTime)
+{
+	TimeSinceEvaluation += DeltaTime;
+	if (TimeSinceEvaluation < EvaluationInterval) return;
+
+	TimeSinceEvaluation = 0.f;
+	Evaluate();
+	PublishTierCounts();
+}
+
+TStatId USignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USignificanceSubsystem, STATGROUP_Tickables);
+}
+
+void USignificanceSubsystem::Register(AActor* Actor)
+{
+	if (Actor == nullptr || !Actor->Implements<USignificanceInterface>()) return;
+	if (Actors.Contains(Actor)) return;
+
+	Actors.Add(Actor);
+	Tiers.Add(ESignificanceTier::EST_High);
+	TierCounts[static_cast<int32>(ESignificanceTier::EST_High)]++;
+}
+
+void USignificanceSubsystem::Unregister(AActor* Actor)
+{
+	const int32 Index = Actors.IndexOfByKey(Actor);
+	if (Index == INDEX_NONE) return;
+
+	TierCounts[static_cast<int32>(Tiers[Index])]--;
+	Actors.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Tiers.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+}
+
+int32 USignificanceSubsystem::GetTierCount(ESignificanceTier Tier) const
+{
+	const int32 TierIndex = static_cast<int32>(Tier);
+	return TierIndex < static_cast<int32>(ESignificanceTier::EST_MAX) ? TierCounts[TierIndex] : 0;
+}
+
+ESignificanceTier USignificanceSubsystem::GetTier(const AActor* Actor) const
+{
+	const int32 Index = Actors.IndexOfByKey(Actor);
+	return Index != INDEX_NONE ? Tiers[Index] : ESignificanceTier::EST_High;
+}
+
+/**
+ * Re-scores every actor and notifies only those whose tier changed.
+ */
+void USignificanceSubsystem::Evaluate()
+{
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	if (PlayerController == nullptr || PlayerController->PlayerCameraManager == nullptr) return;
+
+	const FVector ViewLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+
+	for (int32 Index = Actors.Num() - 1; Index >= 0; Index--)
+	{
+		AActor* Actor = Actors[Index].Get();
+		if (Actor == nullptr)
+		{
+			TierCounts[static_cast<int32>(Tiers[Index])]--;
+			Actors.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+			Tiers.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+			continue;
+		}
+
+		const ESignificanceTier NewTier = TierForScore(Score(Actor, ViewLocation));
+		if (NewTier == Tiers[Index]) continue;
+
+		TierCounts[static_cast<int32>(Tiers[Index])]--;
+		TierCounts[static_cast<int32>(NewTier)]++;
+		Tiers[Index] = NewTier;
+
+		if (ISignificanceInterface* Significance = Cast<ISignificanceInterface>(Actor))
+		{
+			Significance->SetSignificanceTier(NewTier);
+		}
+	}
+}
+
+/**
+ * Closeness to the view in [0, 1], scaled down when the actor has not been rendered, plus a flat bonus while in combat.
+ */
+float USignificanceSubsystem::Score(const AActor* Actor, const FVector& ViewLocation) const
+{
+	const float Distance = FVector::Dist(ViewLocation, Actor->GetActorLocation());
+	float Result = 1.f - FMath::Clamp(Distance / MaxSignificanceDistance, 0.f, 1.f);
+
+	if (!Actor->WasRecentlyRendered(VisibilityTolerance))
+	{
+		Result *= HiddenDistanceScale;
+	}
+
+	const ISignificanceInterface* Significance = Cast<const ISignificanceInterface>(Actor);
+	if (Significance && Significance->IsInCombat())
+	{
+		Result += CombatScore;
+	}
+	return Result;
+}
+
+ESignificanceTier USignificanceSubsystem::TierForScore(float Score)
+{
+	if (Score >= HighTierScore) return ESignificanceTier::EST_High;
+	if (Score >= MediumTierScore) return ESignificanceTier::EST_Medium;
+	if (Score >= LowTierScore) return ESignificanceTier::EST_Low;
+	return ESignificanceTier::EST_Dormant;
+}
+
+void USignificanceSubsystem::PublishTierCounts() const
+{
+	SET_DWORD_STAT(STAT_SignificanceHigh, TierCounts[static_cast<int32>(ESignificanceTier::EST_High)]);
+	SET_DWORD_STAT(STAT_SignificanceMedium, TierCounts[static_cast<int32>(ESignificanceTier::EST_Medium)]);
+	SET_DWORD_STAT(STAT_SignificanceLow, TierCounts[static_cast<int32>(ESignificanceTier::EST_Low)]);
+	SET_DWORD_STAT(STAT_SignificanceDormant, TierCounts[static_cast<int32>(ESignificanceTier::EST_Dormant)]);
+}
@@ -0,0 +1,295 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Subsystems/SpatialGridSubsystem.h"
+#include "Components/SceneComponent.h"
+#include "GameFramework/Actor.h"
+#include "Math/VectorRegister.h"
+
+namespace
+{
+	constexpr int32 SimdWidth = 4;
+
+	/** Squared distance from Origin to Num points, four lanes at a time. Num must be a multiple of SimdWidth. */
+	void ComputeDistancesSquared(const float* X, const float* Y, const float* Z, int32 Num, const FVector3f& Origin, float* OutDistSquared)
+	{
+		const VectorRegister4Float OriginX = VectorSetFloat1(Origin.X);
+		const VectorRegister4Float OriginY = VectorSetFloat1(Origin.Y);
+		const VectorRegister4Float OriginZ = VectorSetFloat1(Origin.Z);
+
+		for (int32 Index = 0; Index < Num; Index += SimdWidth)
+		{
+			const VectorRegister4Float DeltaX = VectorSubtract(VectorLoad(X + Index), OriginX);
+			const VectorRegister4Float DeltaY = VectorSubtract(VectorLoad(Y + Index), OriginY);
+			const VectorRegister4Float DeltaZ = VectorSubtract(VectorLoad(Z + Index), OriginZ);
+
+			VectorRegister4Float DistSquared = VectorMultiply(DeltaX, DeltaX);
+			DistSquared = VectorMultiplyAdd(DeltaY, DeltaY, DistSquared);
+			DistSquared = VectorMultiplyAdd(DeltaZ, DeltaZ, DistSquared);
+			VectorStore(DistSquared, OutDistSquared + Index);
+		}
+	}
+}
+
+void USpatialGridSubsystem::Deinitialize()
+{
+	for (int32 Index = 0; Index < Actors.Num(); Index++)
+	{
+		if (USceneComponent* Root = Roots[Index].Get())
+		{
+			Root->TransformUpdated.Remove(TransformHandles[Index]);
+		}
+	}
+
+	Actors.Empty();
+	ActorKeys.Empty();
+	Roots.Empty();
+	TransformHandles.Empty();
+	LocationsX.Empty();
+	LocationsY.Empty();
+	LocationsZ.Empty();
+	EntryCells.Empty();
+	EntryCategories.Empty();
+	EntryIndices.Empty();
+	Cells.Empty();
+
+	Super::Deinitialize();
+}
+
+void USpatialGridSubsystem::Register(AActor* Actor, ESpatialGridCategory Category)
+{
+	if (Actor == nullptr) return;
+	USceneComponent* Root = Actor->GetRootComponent();
+	if (Root == nullptr) return;
+
+	if (const int32* Existing = EntryIndices.Find(Actor))
+	{
+		EntryCategories[*Existing] = Category;
+		return;
+	}
+
+	const FVector Location = Root->GetComponentLocation();
+	const FIntPoint Cell = GetCell(Location);
+	const int32 Index = Actors.Add(Actor);
+	ActorKeys.Add(Actor);
+	Roots.Add(Root);
+	TransformHandles.Add(Root->TransformUpdated.AddUObject(this, &USpatialGridSubsystem::OnTransformUpdated));
+	LocationsX.Add(Location.X);
+	LocationsY.Add(Location.Y);
+	LocationsZ.Add(Location.Z);
+	EntryCells.Add(Cell);
+	EntryCategories.Add(Category);
+
+	EntryIndices.Add(Actor, Index);
+	AddToCell(Cell, Index);
+
+	Actor->OnEndPlay.AddUniqueDynamic(this, &USpatialGridSubsystem::OnActorEndPlay);
+}
+
+void USpatialGridSubsystem::Unregister(AActor* Actor)
+{
+	if (Actor == nullptr) return;
+	if (const int32* Index = EntryIndices.Find(Actor))
+	{
+		Actor->OnEndPlay.RemoveDynamic(this, &USpatialGridSubsystem::OnActorEndPlay);
+		RemoveEntry(*Index);
+	}
+}
+
+bool USpatialGridSubsystem::IsRegistered(const AActor* Actor) const
+{
+	return EntryIndices.Contains(Actor);
+}
+
+void USpatialGridSubsystem::GetActorsInCategory(ESpatialGridCategory Categories, TArray<AActor*>& OutActors) const
+{
+	OutActors.Reset();
+	for (int32 Index = 0; Index < EntryCategories.Num(); Index++)
+	{
+		if (!EnumHasAnyFlags(EntryCategories[Index], Categories)) continue;
+		if (AActor* Actor = Actors[Index].Get())
+		{
+			OutActors.Add(Actor);
+		}
+	}
+}
+
+void USpatialGridSubsystem::QueryRadius(const FVector& Origin, float Radius, ESpatialGridCategory Categories, TArray<AActor*>& OutActors, const AActor* Ignore) const
+{
+	OutActors.Reset();
+	GatherCandidates(Origin, Radius, Categories, Ignore);
+
+	const float RadiusSquared = FMath::Square(Radius);
+	for (int32 Candidate = 0; Candidate < CandidateIndices.Num(); Candidate++)
+	{
+		if (CandidateDistSquared[Candidate] > RadiusSquared) continue;
+		if (AActor* Actor = Actors[CandidateIndices[Candidate]].Get())
+		{
+			OutActors.Add(Actor);
+		}
+	}
+}
+
+void USpatialGridSubsystem::QueryNearest(const FVector& Origin, int32 Count, float MaxRadius, ESpatialGridCategory Categories, TArray<AActor*>& OutActors, const AActor* Ignore) const
+{
+	OutActors.Reset();
+	if (Count <= 0) return;
+
+	// Grow the search ring until it holds enough candidates; most queries resolve within the first ring
+	float Radius = FMath::Min(CellSize, MaxRadius);
+	TArray<int32, TInlineAllocator<16>> InRange;
+	for (;;)
+	{
+		GatherCandidates(Origin, Radius, Categories, Ignore);
+
+		const float RadiusSquared = FMath::Square(Radius);
+		InRange.Reset();
+		for (int32 Candidate = 0; Candidate < CandidateIndices.Num(); Candidate++)
+		{
+			if (CandidateDistSquared[Candidate] <= RadiusSquared)
+			{
+				InRange.Add(Candidate);
+			}
+		}
+
+		if (InRange.Num() >= Count || Radius >= MaxRadius) break;
+		Radius = FMath::Min(Radius * 2.f, MaxRadius);
+	}
+
+	InRange.Sort([this](int32 A, int32 B) { return CandidateDistSquared[A] < CandidateDistSquared[B]; });
+	for (const int32 Candidate : InRange)
+	{
+		if (AActor* Actor = Actors[CandidateIndices[Candidate]].Get())
+		{
+			OutActors.Add(Actor);
+			if (OutActors.Num() == Count) break;
+		}
+	}
+}
+
+void USpatialGridSubsystem::OnTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	if (UpdatedComponent == nullptr) return;
+	if (const int32* Index = EntryIndices.Find(UpdatedComponent->GetOwner()))
+	{
+		UpdateEntry(*Index, UpdatedComponent->GetComponentLocation());
+	}
+}
+
+void USpatialGridSubsystem::OnActorEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason)
+{
+	Unregister(Actor);
+}
+
+void USpatialGridSubsystem::UpdateEntry(int32 Index, const FVector& Location)
+{
+	LocationsX[Index] = Location.X;
+	LocationsY[Index] = Location.Y;
+	LocationsZ[Index] = Location.Z;
+
+	const FIntPoint NewCell = GetCell(Location);
+	if (NewCell != EntryCells[Index])
+	{
+		RemoveFromCell(EntryCells[Index], Index);
+		AddToCell(NewCell, Index);
+		EntryCells[Index] = NewCell;
+	}
+}
+
+void USpatialGridSubsystem::RemoveEntry(int32 Index)
+{
+	if (USceneComponent* Root = Roots[Index].Get())
+	{
+		Root->TransformUpdated.Remove(TransformHandles[Index]);
+	}
+	RemoveFromCell(EntryCells[Index], Index);
+	EntryIndices.Remove(ActorKeys[Index]);
+
+	// Swap-remove keeps the arrays dense; the entry moved into Index needs its cell and lookup patched
+	const int32 LastIndex = Actors.Num() - 1;
+	if (Index != LastIndex)
+	{
+		TArray<int32>& LastCell = Cells.FindChecked(EntryCells[LastIndex]);
+		LastCell[LastCell.Find(LastIndex)] = Index;
+		EntryIndices.Add(ActorKeys[LastIndex], Index);
+	}
+
+	Actors.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	ActorKeys.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Roots.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	TransformHandles.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	LocationsX.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	LocationsY.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	LocationsZ.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	EntryCells.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	EntryCategories.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+}
+
+void USpatialGridSubsystem::AddToCell(const FIntPoint& Cell, int32 Index)
+{
+	Cells.FindOrAdd(Cell).Add(Index);
+}
+
+void USpatialGridSubsystem::RemoveFromCell(const FIntPoint& Cell, int32 Index)
+{
+	if (TArray<int32>* Bucket = Cells.Find(Cell))
+	{
+		Bucket->RemoveSingleSwap(Index, EAllowShrinking::No);
+		if (Bucket->IsEmpty())
+		{
+			Cells.Remove(Cell);
+		}
+	}
+}
+
+FIntPoint USpatialGridSubsystem::GetCell(const FVector& Location)
+{
+	return FIntPoint(
+		FMath::FloorToInt32(Location.X / CellSize),
+		FMath::FloorToInt32(Location.Y / CellSize));
+}
+
+void USpatialGridSubsystem::GatherCandidates(const FVector& Origin, float Radius, ESpatialGridCategory Categories, const AActor* Ignore) const
+{
+	CandidateX.Reset();
+	CandidateY.Reset();
+	CandidateZ.Reset();
+	CandidateIndices.Reset();
+
+	const int32* IgnoreIndex = Ignore ? EntryIndices.Find(Ignore) : nullptr;
+	const FIntPoint MinCell = GetCell(Origin - FVector(Radius));
+	const FIntPoint MaxCell = GetCell(Origin + FVector(Radius));
+
+	for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; CellY++)
+	{
+		for (int32 CellX = MinCell.X; CellX <= MaxCell.X; CellX++)
+		{
+			const TArray<int32>* Bucket = Cells.Find(FIntPoint(CellX, CellY));
+			if (Bucket == nullptr) continue;
+
+			for (const int32 Index : *Bucket)
+			{
+				if (!EnumHasAnyFlags(EntryCategories[Index], Categories)) continue;
+				if (IgnoreIndex && *IgnoreIndex == Index) continue;
+
+				CandidateX.Add(LocationsX[Index]);
+				CandidateY.Add(LocationsY[Index]);
+				CandidateZ.Add(LocationsZ[Index]);
+				CandidateIndices.Add(Index);
+			}
+		}
+	}
+
+	// Pad to a whole number of lanes with points that can never be in range
+	const int32 NumCandidates = CandidateIndices.Num();
+	const int32 PaddedNum = Align(NumCandidates, SimdWidth);
+	for (int32 Pad = NumCandidates; Pad < PaddedNum; Pad++)
+	{
+		CandidateX.Add(MAX_flt);
+		CandidateY.Add(MAX_flt);
+		CandidateZ.Add(MAX_flt);
+	}
+
+	CandidateDistSquared.SetNumUninitialized(PaddedNum, EAllowShrinking::No);
+	ComputeDistancesSquared(CandidateX.GetData(), CandidateY.GetData(), CandidateZ.GetData(), PaddedNum, FVector3f(Origin), CandidateDistSquared.GetData());
+}
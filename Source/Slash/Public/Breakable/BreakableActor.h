@@ -5,12 +5,13 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "Interfaces/HitInterface.h"
+#include "Interfaces/SignificanceInterface.h"
 #include "BreakableActor.generated.h"
 
 class UGeometryCollectionComponent;
 
 UCLASS()
-class SLASH_API ABreakableActor : public AActor, public IHitInterface
+class SLASH_API ABreakableActor : public AActor, public IHitInterface, public ISignificanceInterface
 {
 	GENERATED_BODY()
 
@@ -20,9 +21,12 @@ public:
 
 	virtual void GetHit_Implementation(const FVector& ImpactPoint, AActor* Hitter) override;
 
+	virtual void SetSignificanceTier(ESignificanceTier Tier) override;
+
 protected:
 	
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
 	UGeometryCollectionComponent* GeometryCollection;
@@ -30,6 +34,10 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
 	class UCapsuleComponent* Capsule;
 
+	// Current significance tier, so Blueprint break effects can pick a cheaper variant at lower tiers
+	UPROPERTY(BlueprintReadOnly)
+	ESignificanceTier SignificanceTier = ESignificanceTier::EST_High;
+
 private:
 
 	UPROPERTY(EditAnywhere, Category = "Breakable Properties")
@@ -18,7 +18,7 @@ class SLASH_API ABaseCharacter : public ACharacter, public IHitInterface
 	GENERATED_BODY()
 
 public:
-	ABaseCharacter();
+	ABaseCharacter(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 	virtual void Tick(float DeltaTime) override;
 
 protected:
@@ -56,6 +56,10 @@ protected:
 	UPROPERTY(BlueprintReadOnly)
 	TEnumAsByte<EDeathPose> DeathPose;
 
+	// Set by the significance subsystem for characters that take part in it; lower tiers get cheaper hit FX
+	UPROPERTY(BlueprintReadOnly)
+	ESignificanceTier SignificanceTier = ESignificanceTier::EST_High;
+
 private:
 	void PlayMontageSection(UAnimMontage* Montage, const FName& SectionName);
 	
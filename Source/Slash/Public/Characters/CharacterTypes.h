@@ -35,4 +35,13 @@ enum class EEnemyState : uint8
 	EES_Chasing UMETA(DisplayName = "Chasing"),
 	EES_Attacking UMETA(DisplayName = "Attacking"),
 	EES_Engaged UMETA(DisplayName = "Engaged")
-};
\ No newline at end of file
+};
+UENUM(BlueprintType)
+enum class ESignificanceTier : uint8
+{
+	EST_High UMETA(DisplayName = "High"),
+	EST_Medium UMETA(DisplayName = "Medium"),
+	EST_Low UMETA(DisplayName = "Low"),
+	EST_Dormant UMETA(DisplayName = "Dormant"),
+	EST_MAX UMETA(DisplayName = "DefaultMAX")
+};
@@ -7,6 +7,20 @@
 #include "CharacterTypes.h"
 #include "SlashAnimInstance.generated.h"
 
+/**
+ * Character state copied once per frame on the game thread, so the rest of the update can run on a worker thread
+ * without touching the character or its movement component.
+ */
+struct FSlashAnimSnapshot
+{
+	FVector Velocity = FVector::ZeroVector;
+	bool bIsFalling = false;
+	ECharacterState CharacterState = ECharacterState::ECS_Unequipped;
+	EActionState ActionState = EActionState::EAS_Unoccupied;
+	TEnumAsByte<EDeathPose> DeathPose = EDP_Death1;
+	bool bIsValid = false;
+};
+
 /**
  * 
  */
@@ -17,6 +31,7 @@ class SLASH_API USlashAnimInstance : public UAnimInstance
 public:
 	virtual void NativeInitializeAnimation() override;
 	virtual void NativeUpdateAnimation(float DeltaTime) override;
+	virtual void NativeThreadSafeUpdateAnimation(float DeltaTime) override;
 
 	UPROPERTY(BlueprintReadOnly)
 	class ASlashCharacter* SlashCharacter;
@@ -38,4 +53,8 @@ public:
 
 	UPROPERTY(BlueprintReadOnly, Category = Movement)
 	TEnumAsByte<EDeathPose> DeathPose;
+
+private:
+	// Written on the game thread in NativeUpdateAnimation, read on the worker thread in NativeThreadSafeUpdateAnimation
+	FSlashAnimSnapshot Snapshot;
 };
@@ -64,6 +64,7 @@ protected:
 	void Move(const FInputActionValue& Value);
 	void Look(const FInputActionValue& Value);
 	void EKeyPressed();
+	AWeapon* FindWeaponInReach() const;
 
 	/** Combat */
 	UFUNCTION(BlueprintCallable)
@@ -107,6 +108,10 @@ private:
 	UPROPERTY(VisibleInstanceOnly)
 	AItem* OverlappingItem;
 
+	/** How far around the character the spatial grid is searched for pickups; each pickup's own sphere decides whether it is in reach. */
+	UPROPERTY(EditAnywhere, Category = "Pickup")
+	float PickupSearchRadius = 300.f;
+
 	UPROPERTY(EditDefaultsOnly, Category = Montages)
 	UAnimMontage* EquipMontage;	
 
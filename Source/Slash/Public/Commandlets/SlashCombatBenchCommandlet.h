@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SlashCombatBenchCommandlet.generated.h"
+
+class AEnemy;
+
+/**
+ * Headless combat stress benchmark. Loads the dungeon map, spawns N enemies plus scripted player stand-ins that keep
+ * hitting them, ticks the world for a fixed number of frames and writes one CSV row per frame.
+ *
+ * Usage:
+ *   UnrealEditor-Cmd Slash.uproject -run=SlashCombatBench -nullrhi -unattended
+ *     [-Enemies=10,100,500,1000] [-Frames=600] [-Map=/Game/MedievalDungeon/Maps/Dungeon]
+ *     [-EnemyClass=/Game/Blueprints/Enemy/BP_BaseEnemy.BP_BaseEnemy_C] [-Output=<path.csv>]
+ *
+ * Columns: Enemies, Frame, GameThreadMs, AIMs, TraceMs, SpawnedEnemies, AliveEnemies, PoolHits, PoolMisses, UsedPhysicalMB.
+ */
+UCLASS()
+class SLASH_API USlashCombatBenchCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USlashCombatBenchCommandlet();
+
+	/** <UCommandlet> */
+	virtual int32 Main(const FString& Params) override;
+	/** </UCommandlet> */
+
+private:
+	UWorld* LoadWorld(const FString& MapName) const;
+	void UnloadWorld(UWorld* World) const;
+
+	/** Runs one sweep step with EnemyCount enemies and appends its rows to Csv. */
+	void RunPass(UWorld* World, TSubclassOf<AEnemy> EnemyClass, int32 EnemyCount, FString& Csv) const;
+
+	void SpawnEnemies(UWorld* World, TSubclassOf<AEnemy> EnemyClass, int32 Count, const FVector& Origin, TArray<AActor*>& OutActors) const;
+	void SpawnStandIns(UWorld* World, int32 Count, const FVector& Origin, TArray<AActor*>& OutActors) const;
+
+	/** Every stand-in whose turn it is hits the nearest enemy around it. */
+	void DriveStandIns(UWorld* World, const TArray<AActor*>& StandIns, int32 Frame) const;
+
+	int32 FramesPerPass = 600;
+
+	/** Seconds each benchmark frame advances the world by. */
+	float FixedDeltaTime = 1.f / 60.f;
+
+	/** Spacing of the enemy spawn grid. */
+	float SpawnSpacing = 250.f;
+
+	/** One stand-in is spawned per this many enemies. */
+	int32 EnemiesPerStandIn = 10;
+
+	/** Frames between two attacks of the same stand-in. */
+	int32 AttackIntervalFrames = 30;
+
+	float StandInAttackRadius = 1500.f;
+	float StandInDamage = 10.f;
+};
@@ -5,20 +5,22 @@
 #include "CoreMinimal.h"
 #include "Characters/BaseCharacter.h"
 #include "Characters/CharacterTypes.h"
+#include "Interfaces/SignificanceInterface.h"
+#include "Components/SkinnedMeshComponent.h"
 #include "Enemy.generated.h"
 
-class UHealthBarComponent;
 class UPawnSensingComponent;
+class UEnemyAIWorldSubsystem;
+enum class EEnemyAIDecision : uint8;
 
 UCLASS()
-class SLASH_API AEnemy : public ABaseCharacter
+class SLASH_API AEnemy : public ABaseCharacter, public ISignificanceInterface
 {
 	GENERATED_BODY()
 
 public:
-	AEnemy();
+	AEnemy(const FObjectInitializer& ObjectInitializer);
 	/** <AActor */
-	virtual void Tick(float DeltaTime) override;
 	virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, class AController* EventInstigator, AActor* DamageCauser) override;
 	virtual void Destroyed() override;
 	/** </AActor */
@@ -26,11 +28,16 @@ public:
 	/** <IHitInterface> */
 	virtual void GetHit_Implementation(const FVector& ImpactPoint, AActor* Hitter) override;
 	/** </IHitInterface> */
-	
+
+	/** <ISignificanceInterface> */
+	virtual bool IsInCombat() const override;
+	virtual void SetSignificanceTier(ESignificanceTier Tier) override;
+	/** </ISignificanceInterface> */
 	
 protected:
 	/** <AActor */
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	/** </AActor */
 	
 	/** <ABaseCharacter */
@@ -45,11 +52,14 @@ protected:
 	EEnemyState EnemyState = EEnemyState::EES_Patrolling;
 
 private:
+	/** Decisions are evaluated in batch by the AI subsystem, which calls back into the behavior below. */
+	friend class UEnemyAIWorldSubsystem;
+
 	/** AI Behavior */
 	void InitializeEnemy();
 	void SpawnDefaultWeapon();
 	void CheckCombatTarget();
-	void CheckPatrolTarget();
+	void ApplyAIDecision(EEnemyAIDecision Decision);
 	void PatrolTimerFinished();
 	void HideHealthBar();
 	void ShowHealthBar();
@@ -60,14 +70,20 @@ private:
 	void StartAttackTimer();
 	void ClearAttackTimer();
 	void MoveToTarget(AActor* Target);
+	void SetEnemyState(EEnemyState NewState);
+	void SetCombatTarget(AActor* Target);
+	void SetPatrolTarget(AActor* Target);
 	
 	UPROPERTY()
 	class AAIController* EnemyController;	
 
-	AActor* ChoosePatrolTarget();
+	UPROPERTY()
+	UEnemyAIWorldSubsystem* AISubsystem;
+
+	/** Index of this enemy in the AI subsystem's arrays, INDEX_NONE while unregistered. */
+	int32 AISlot = INDEX_NONE;
 
-	FTimerHandle PatrolTimer;
-	FTimerHandle AttackTimer;
+	AActor* ChoosePatrolTarget();
 	
 	bool IsOutsideCombatRadius();
 	bool IsOutsideAttackRadius();
@@ -78,14 +94,19 @@ private:
 	bool IsEngaged();
 	bool InTargetRange(AActor* Target, double Radius);
 
+	void SenseTarget(APawn* Target);
+
 	UFUNCTION()
-	void PawnSeen(APawn* SeenPawn); //Callback for OnPawnSeen in UpawnSensingComponent
+	void PawnSeen(APawn* SeenPawn);
 	
 	UPROPERTY(VisibleAnywhere)
 	UPawnSensingComponent* PawnSensing;
-	
-	UPROPERTY(VisibleAnywhere)
-	UHealthBarComponent* HealthBarWidget;
+
+	/** Sensing interval as authored, the sight check interval at the highest significance tier. */
+	float DefaultSensingInterval = 0.5f;
+
+	/** Animation tick option as authored, used at the highest significance tier. */
+	EVisibilityBasedAnimTickOption DefaultAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPose;
 	
 	UPROPERTY(EditAnywhere)
 	TSubclassOf<class AWeapon> WeaponClass;
@@ -0,0 +1,128 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Characters/CharacterTypes.h"
+#include "EnemyAIWorldSubsystem.generated.h"
+
+class AEnemy;
+
+/** Result of evaluating one enemy for a frame. Applied on the game thread after the batched pass. */
+enum class EEnemyAIDecision : uint8
+{
+	EAD_None,
+	EAD_LoseInterest,
+	EAD_ChaseTarget,
+	EAD_StartAttackTimer,
+	EAD_PatrolTargetReached
+};
+
+/**
+ * Owns the decision state of every AEnemy in the world and updates all of them in one batched pass per frame.
+ * State is kept in structure-of-arrays form so the evaluation can run in parallel without touching any actor.
+ */
+UCLASS()
+class SLASH_API UEnemyAIWorldSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** <UTickableWorldSubsystem> */
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	/** </UTickableWorldSubsystem> */
+
+	void RegisterEnemy(AEnemy* Enemy);
+	void UnregisterEnemy(AEnemy* Enemy);
+
+	void SetEnemyState(int32 Slot, EEnemyState NewState);
+	void SetCombatTarget(int32 Slot, AActor* Target);
+	void SetPatrolTarget(int32 Slot, AActor* Target);
+
+	/** Seconds between two batched evaluations of the enemy; 0 evaluates it every frame. Timers still run every frame. */
+	void SetEvaluationInterval(int32 Slot, float Interval);
+
+	/** Seconds between two sight checks of the enemy against the engageable targets around it. */
+	void SetSenseInterval(int32 Slot, float Interval);
+
+	void StartPatrolTimer(int32 Slot, float Time);
+	void ClearPatrolTimer(int32 Slot);
+	void StartAttackTimer(int32 Slot, float Time);
+	void ClearAttackTimer(int32 Slot);
+
+	/** Evaluates the combat branch for a single slot outside of the batched pass, e.g. when an attack montage ends. */
+	EEnemyAIDecision EvaluateCombatTarget(int32 Slot);
+
+	FORCEINLINE int32 GetNumEnemies() const { return Enemies.Num(); }
+
+	/** Wall time spent in the last Tick, for benchmarking. */
+	FORCEINLINE double GetLastTickSeconds() const { return LastTickSeconds; }
+
+private:
+	void AcquireTargets(float DeltaTime);
+	void AdvanceEvaluationClocks(float DeltaTime);
+	void GatherLocations();
+	void GatherLocation(int32 Slot);
+	void EvaluateAll();
+	void ApplyDecisions();
+	void AdvanceTimers(float DeltaTime);
+	void FireExpiredTimers();
+
+	EEnemyAIDecision Evaluate(int32 Slot) const;
+	EEnemyAIDecision EvaluateCombat(int32 Slot) const;
+	EEnemyAIDecision EvaluatePatrol(int32 Slot) const;
+
+	void RemoveSlot(int32 Slot);
+	void FlushPendingRemovals();
+
+	/** Minimum enemies per ParallelFor batch; smaller crowds are evaluated inline. */
+	static constexpr int32 EvaluateBatchSize = 64;
+
+	/** Structure-of-arrays decision state, one entry per registered enemy. */
+	TArray<TWeakObjectPtr<AEnemy>> Enemies;
+	TArray<FVector> Locations;
+	TArray<EEnemyState> States;
+	TArray<double> CombatRadiiSquared;
+	TArray<double> AttackRadiiSquared;
+	TArray<double> PatrolRadiiSquared;
+
+	TArray<TWeakObjectPtr<AActor>> CombatTargets;
+	TArray<FVector> CombatTargetLocations;
+	TArray<bool> HasCombatTarget;
+
+	TArray<TWeakObjectPtr<AActor>> PatrolTargets;
+	TArray<FVector> PatrolTargetLocations;
+	TArray<bool> HasPatrolTarget;
+
+	/** Evaluation clocks. Only the slots whose clock ran out this frame are gathered and evaluated. */
+	TArray<float> EvaluationIntervals;
+	TArray<float> TimeUntilEvaluation;
+	TArray<bool> DueForEvaluation;
+
+	/** Sight check clocks. An enemy is checked against the engageable targets near it once its clock runs out. */
+	TArray<float> SenseIntervals;
+	TArray<float> SenseTimeRemaining;
+
+	/** Largest sight radius of any registered enemy, the reach of the query around each engageable target. */
+	float MaxSightRadius = 0.f;
+
+	/** Target acquisition scratch space. */
+	TArray<AActor*> EngageableTargets;
+	TArray<AActor*> NearbyEnemies;
+
+	/** Remaining time of the patrol wait and attack delay, negative while the timer is not running. */
+	TArray<float> PatrolTimeRemaining;
+	TArray<float> AttackTimeRemaining;
+
+	TArray<EEnemyAIDecision> Decisions;
+	TArray<int32> ExpiredPatrolTimers;
+	TArray<int32> ExpiredAttackTimers;
+
+	/** Slots unregistered while decisions were being applied; removed once the apply loop is done. */
+	TArray<int32> PendingRemovals;
+	bool bApplyingDecisions = false;
+
+	double LastTickSeconds = 0.0;
+};
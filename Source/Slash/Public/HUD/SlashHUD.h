@@ -8,21 +8,72 @@
 
 class USlashOverlay;
 
+/** A world-space health bar the HUD draws for an actor, e.g. a damaged enemy. */
+struct FHealthBarEntry
+{
+	TWeakObjectPtr<AActor> Owner;
+	float Percent = 1.f;
+};
+
 UCLASS()
 class SLASH_API ASlashHUD : public AHUD
 {
 	GENERATED_BODY()
 
+public:
+	virtual void DrawHUD() override;
+
+	/** Starts drawing a health bar above Owner, or updates its percent if already drawn. */
+	void ShowHealthBar(AActor* Owner, float Percent);
+	void SetHealthBarPercent(AActor* Owner, float Percent);
+	void HideHealthBar(AActor* Owner);
+
+	/** @return The Slash HUD of the first local player in WorldContextObject's world, if any. */
+	static ASlashHUD* Get(const UObject* WorldContextObject);
+
 protected:
 	virtual void BeginPlay() override;
 
 private:
+	/** Projects, culls and draws every registered health bar in one canvas pass. */
+	void DrawHealthBars();
+
 	UPROPERTY(EditDefaultsOnly, Category = Slash)
 	TSubclassOf<USlashOverlay> SlashOverlayClass;
 
 	UPROPERTY()
 	USlashOverlay* SlashOverlay;
 
+	UPROPERTY(EditDefaultsOnly, Category = "Health Bars")
+	int32 MaxHealthBars = 24;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Health Bars")
+	float HealthBarMaxDistance = 3500.f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Health Bars")
+	FVector2D HealthBarSize = FVector2D(80.f, 8.f);
+
+	/** Height of the bar above the top of the owner's collision. */
+	UPROPERTY(EditDefaultsOnly, Category = "Health Bars")
+	float HealthBarHeightOffset = 30.f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Health Bars")
+	FLinearColor HealthBarBackgroundColor = FLinearColor(0.f, 0.f, 0.f, 0.6f);
+
+	UPROPERTY(EditDefaultsOnly, Category = "Health Bars")
+	FLinearColor HealthBarFillColor = FLinearColor(0.8f, 0.05f, 0.05f, 1.f);
+
+	TArray<FHealthBarEntry> HealthBars;
+
+	/** Per-frame scratch: screen position and squared distance of each visible bar. */
+	struct FVisibleHealthBar
+	{
+		FVector2D ScreenPosition;
+		double DistanceSquared;
+		float Percent;
+	};
+	TArray<FVisibleHealthBar> VisibleHealthBars;
+
 public:
 	FORCEINLINE USlashOverlay* GetSlashOverlay() const { return SlashOverlay; };
 };
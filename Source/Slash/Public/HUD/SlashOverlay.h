@@ -4,10 +4,12 @@
 
 #include "CoreMinimal.h"
 #include "Blueprint/UserWidget.h"
+#include "HUD/SlashOverlayViewModel.h"
 #include "SlashOverlay.generated.h"
 
 /**
- * 
+ * Player overlay. Setters only record values in the view-model; the widgets are updated once per frame in NativeTick,
+ * and only for the values that actually changed.
  */
 UCLASS()
 class SLASH_API USlashOverlay : public UUserWidget
@@ -20,9 +22,21 @@ public:
 	void SetGold(int32 Gold);
 	void SetSouls(int32 Souls);
 	
+	FORCEINLINE const FSlashOverlayViewModel& GetViewModel() const { return ViewModel; }
 
+protected:
+	virtual void NativeConstruct() override;
+	virtual void NativeTick(const FGeometry& MyGeometry, float InDeltaTime) override;
 
 private:
+	void FlushViewModel();
+
+	FSlashOverlayViewModel ViewModel;
+
+	/** Optional invalidation panel around the overlay's stats, so unchanged widgets are served from the cache. */
+	UPROPERTY(meta = (BindWidgetOptional))
+	class UInvalidationBox* StatsInvalidationBox;
+
 	UPROPERTY(meta = (BindWidget))
 	class UProgressBar* HealthProgressBar;
 
@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Bit per overlay value that changed since the last flush. */
+enum class ESlashOverlayField : uint8
+{
+	ESOF_None = 0,
+	ESOF_Health = 1 << 0,
+	ESOF_Stamina = 1 << 1,
+	ESOF_Gold = 1 << 2,
+	ESOF_Souls = 1 << 3
+};
+ENUM_CLASS_FLAGS(ESlashOverlayField);
+
+/**
+ * Latest values the overlay should show. Gameplay writes here as often as it likes;
+ * USlashOverlay pushes the dirty fields to its widgets at most once per frame.
+ */
+struct SLASH_API FSlashOverlayViewModel
+{
+	void SetHealthPercent(float Percent);
+	void SetStaminaPercent(float Percent);
+	void SetGold(int32 Gold);
+	void SetSouls(int32 Souls);
+
+	/** Returns the fields changed since the last call and clears them. */
+	ESlashOverlayField ConsumeDirtyFields();
+
+	FORCEINLINE bool IsDirty() const { return DirtyFields != ESlashOverlayField::ESOF_None; }
+	FORCEINLINE float GetHealthPercent() const { return HealthPercent; }
+	FORCEINLINE float GetStaminaPercent() const { return StaminaPercent; }
+	FORCEINLINE int32 GetGold() const { return Gold; }
+	FORCEINLINE int32 GetSouls() const { return Souls; }
+
+private:
+	float HealthPercent = 1.f;
+	float StaminaPercent = 1.f;
+	int32 Gold = 0;
+	int32 Souls = 0;
+
+	/** Everything starts dirty so the first flush initializes every widget. */
+	ESlashOverlayField DirtyFields = ESlashOverlayField::ESOF_Health | ESlashOverlayField::ESOF_Stamina | ESlashOverlayField::ESOF_Gold | ESlashOverlayField::ESOF_Souls;
+};
+
+/**
+ * Integer-to-text conversion for HUD counters. Texts for small values are built once and shared,
+ * so repeated updates of gold and souls copy a cached FText instead of formatting and allocating a new one.
+ */
+struct SLASH_API FSlashNumberText
+{
+	static FText Get(int32 Value);
+
+	/** Values in [0, CacheSize) are served from the cache. */
+	static constexpr int32 CacheSize = 4096;
+};
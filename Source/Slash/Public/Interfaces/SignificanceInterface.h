@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "Characters/CharacterTypes.h"
+#include "SignificanceInterface.generated.h"
+
+UINTERFACE(MinimalAPI)
+class USignificanceInterface : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Implemented by actors that USignificanceSubsystem scores and scales down when they matter less to the player.
+ */
+class SLASH_API ISignificanceInterface
+{
+	GENERATED_BODY()
+
+public:
+	/** Whether the actor is currently fighting; combat always keeps an actor at the highest tier. */
+	virtual bool IsInCombat() const;
+
+	/** Called when the actor's tier changes. Implementations adjust tick intervals, sensing and FX quality. */
+	virtual void SetSignificanceTier(ESignificanceTier Tier);
+};
@@ -7,6 +7,8 @@
 #include "Item.generated.h"
 
 class USphereComponent;
+class USpatialGridSubsystem;
+class UItemHoverSubsystem;
 
 enum class EItemState : uint8
 {
@@ -18,6 +20,8 @@ UCLASS()
 class SLASH_API AItem : public AActor
 {
 	GENERATED_BODY()
+
+	friend class UItemHoverSubsystem;
 	
 public:	
 	// Sets default values for this actor's properties
@@ -27,12 +31,21 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// Called when the item is removed from the world
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sine Parameters")
 	float Amplitude = 0.25f;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sine Parameters")
 	float TimeConstant = 5.f;
 
+	// Peak height of the hover bob above the item's rest location, as driven by UItemHoverSubsystem
+	float GetHoverHeight() const;
+
+	// Lists the item with the hover manager while it is hovering, and takes it off again otherwise
+	void UpdateHoverRegistration();
+
 	UFUNCTION(BlueprintCallable)
 	float TransformedSin();
 
@@ -58,15 +71,37 @@ protected:
 
 	UPROPERTY(EditAnywhere)
 	class UNiagaraComponent* ItemEffect;
+
+	// Proximity grid the item is listed in as a pickup while it is hovering
+	UPROPERTY()
+	USpatialGridSubsystem* SpatialGrid;
+
+	UPROPERTY()
+	UItemHoverSubsystem* HoverSubsystem;
 	
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
+	// Whether a character at Location, Reach wide, touches the item's pickup sphere
+	bool IsInPickupReach(const FVector& Location, float Reach) const;
+
+	// Called by UItemPoolSubsystem when the item is handed out again; restores the hovering pickup state
+	virtual void OnAcquiredFromPool();
+
+	// Called by UItemPoolSubsystem instead of destroying the item; hides it and turns off collision, effects and ticking
+	virtual void OnReleasedToPool();
+
 private:
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
 	float RunningTime;	
+
+	// Index of this item in the hover manager's arrays, INDEX_NONE while not hovering
+	int32 HoverSlot = INDEX_NONE;
+
+	// Sphere collision as authored, restored when a pooled item is acquired
+	ECollisionEnabled::Type DefaultSphereCollision = ECollisionEnabled::QueryOnly;
 	
 };
 
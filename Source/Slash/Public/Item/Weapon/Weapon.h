@@ -18,24 +18,25 @@ public:
 	AWeapon();
 	void Equip(USceneComponent* InParent, FName InSocketName, AActor* NewOwner, APawn* NewInstigator);
 	void ExecuteGetHit(FHitResult BoxHit);
-	bool ActorIsSameType(AActor* OtherActor);
+	bool ActorIsSameType(AActor* OtherActor) const;
+	bool CanHit(AActor* OtherActor) const;
+	void ApplySwingHit(const FHitResult& BoxHit);
 	void AttachMeshToSocket(USceneComponent* InParent, const FName& InSocketName);
-	TArray<AActor*> IgnoreActors;
+	virtual void OnReleasedToPool() override;
+	void SetSwingEnabled(bool bEnabled);
+	void GetBladeSegment(FVector& OutStart, FVector& OutEnd) const;
+	FQuat GetBladeRotation() const;
 	
 protected:
 	virtual void BeginPlay() override;
 	void PlayEquipSound();
 	void DisableSphereCollision();
 	void DiactivateEmbers();
-	
-	UFUNCTION()
-	void OnBoxOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
 
 	UFUNCTION(BlueprintImplementableEvent)
 	void CreateFields(const FVector& FieldLocation);
 
 private:
-	void BoxTrace(FHitResult& BoxHit);
 
 	UPROPERTY(EditAnywhere, Category = "Weapon Properties")
 	FVector BoxTraceExtent = FVector(5.f);
@@ -60,5 +61,7 @@ private:
 
 public:
 	FORCEINLINE UBoxComponent* GetWeaponBox() const { return WeaponBox; }
+	FORCEINLINE FVector GetBoxTraceExtent() const { return BoxTraceExtent; }
+	FORCEINLINE bool ShowsBoxDebug() const { return bShowBoxDebug; }
 	
 };
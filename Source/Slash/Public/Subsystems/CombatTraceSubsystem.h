@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "UObject/ObjectKey.h"
+#include "CombatTraceSubsystem.generated.h"
+
+class AWeapon;
+
+/** One open collision window of a weapon. */
+struct FWeaponSwing
+{
+	TWeakObjectPtr<AWeapon> Weapon;
+
+	/** Blade sample points as of the last sweep; the next sweep starts from here. */
+	TArray<FVector, TInlineAllocator<4>> PreviousSamples;
+
+	/** Async sweeps issued last frame whose results are collected this frame. */
+	TArray<FTraceHandle, TInlineAllocator<4>> PendingTraces;
+
+	/** Actors already damaged during this swing. */
+	TSet<TObjectKey<AActor>> HitActors;
+
+	/** Set when the window closes; the swing is dropped once its last sweeps have been collected. */
+	bool bEnding = false;
+};
+
+/**
+ * Sweeps the blades of all swinging weapons between their previous and current transforms with async traces.
+ * Sweeps issued in one frame are collected in the next, deduplicated per swing and dispatched as damage once per actor.
+ */
+UCLASS()
+class SLASH_API UCombatTraceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** <UTickableWorldSubsystem> */
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	/** </UTickableWorldSubsystem> */
+
+	/** Opens the collision window of Weapon. Restarting a swing ends the old one and starts a fresh one with its own traces and hit set. */
+	void BeginSwing(AWeapon* Weapon);
+
+	/** Closes the collision window of Weapon, sweeping the blade's motion since the last frame. Sweeps already in flight are still collected. */
+	void EndSwing(AWeapon* Weapon);
+
+	bool IsSwinging(const AWeapon* Weapon) const;
+
+	FORCEINLINE int32 GetNumSwings() const { return Swings.Num(); }
+
+	/** Wall time spent in the last Tick, for benchmarking. */
+	FORCEINLINE double GetLastTickSeconds() const { return LastTickSeconds; }
+
+	/** Number of points along the blade, from base to tip, that are swept each frame. */
+	static constexpr int32 BladeSamples = 3;
+
+private:
+	struct FPendingHit
+	{
+		TWeakObjectPtr<AWeapon> Weapon;
+		FHitResult Hit;
+	};
+
+	void CollectResults();
+	void RecordHits(FWeaponSwing& Swing, const AWeapon* Weapon, const TArray<FHitResult>& Hits);
+	void DispatchHits();
+	void IssueSweeps();
+
+	static void GetBladeSamples(const AWeapon* Weapon, TArray<FVector, TInlineAllocator<4>>& OutSamples);
+	static FCollisionQueryParams MakeQueryParams(const AWeapon* Weapon);
+	int32 FindSwing(const AWeapon* Weapon) const;
+
+	TArray<FWeaponSwing> Swings;
+	TArray<FPendingHit> PendingHits;
+
+	double LastTickSeconds = 0.0;
+};
@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ItemHoverSubsystem.generated.h"
+
+class AItem;
+
+/**
+ * Drives the hover bob of every hovering AItem from one shared frame clock instead of a Tick per item.
+ * Phases and offsets are computed for all items in one vectorized pass and are absolute from each item's rest location, so nothing drifts.
+ * Items outside the hover range or not rendered recently are left where they are.
+ */
+UCLASS()
+class SLASH_API UItemHoverSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** <UTickableWorldSubsystem> */
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	/** </UTickableWorldSubsystem> */
+
+	void RegisterItem(AItem* Item);
+	void UnregisterItem(AItem* Item);
+
+	FORCEINLINE int32 GetNumItems() const { return Items.Num(); }
+
+	/** Items farther than this from the player camera do not hover. */
+	static constexpr float HoverRange = 4000.f;
+
+	/** Items not rendered within this many seconds do not hover. */
+	static constexpr float RenderedTolerance = 0.2f;
+
+private:
+	void ComputeOffsets(float DeltaTime);
+	void ApplyOffsets();
+	bool GetViewLocation(FVector& OutViewLocation) const;
+	void RemoveSlot(int32 Slot);
+
+	/** Structure-of-arrays hover state, one entry per registered item. Phases are in radians and kept within [0, 2*PI). */
+	TArray<TWeakObjectPtr<AItem>> Items;
+	TArray<FVector> RestLocations;
+	TArray<float> AppliedOffsets;
+	TArray<float> Heights;
+	TArray<float> Frequencies;
+	TArray<float> Phases;
+	TArray<float> Offsets;
+};
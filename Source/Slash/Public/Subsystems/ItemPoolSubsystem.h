@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ItemPoolSubsystem.generated.h"
+
+class AItem;
+
+USTRUCT()
+struct FItemPool
+{
+	GENERATED_BODY()
+
+	/** Dormant items of one class, hidden and without collision until acquired. */
+	UPROPERTY()
+	TArray<TObjectPtr<AItem>> FreeItems;
+};
+
+/**
+ * Recycles AItem-derived actors per class so treasure, souls and weapons are not spawned and destroyed during fights.
+ * Acquire hands out a dormant item (or spawns one on a miss) and Release puts it back instead of destroying it.
+ */
+UCLASS()
+class SLASH_API UItemPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** <USubsystem> */
+	virtual void Deinitialize() override;
+	/** </USubsystem> */
+
+	/** Spawns dormant items until the pool for ItemClass holds at least Count of them. */
+	void Prewarm(TSubclassOf<AItem> ItemClass, int32 Count);
+
+	AItem* Acquire(TSubclassOf<AItem> ItemClass, const FTransform& Transform);
+
+	template<typename T>
+	T* Acquire(TSubclassOf<T> ItemClass, const FTransform& Transform);
+
+	void Release(AItem* Item);
+
+	/** Returns the item to the pool of its world, or destroys it if there is none (e.g. during world teardown). */
+	static void ReleaseOrDestroy(AItem* Item);
+
+	UFUNCTION(BlueprintPure, Category = "Item Pool")
+	int32 GetPoolHits() const { return PoolHits; }
+
+	UFUNCTION(BlueprintPure, Category = "Item Pool")
+	int32 GetPoolMisses() const { return PoolMisses; }
+
+	UFUNCTION(BlueprintPure, Category = "Item Pool")
+	int32 GetNumFree(TSubclassOf<AItem> ItemClass) const;
+
+private:
+	AItem* SpawnItem(TSubclassOf<AItem> ItemClass, const FTransform& Transform);
+
+	UPROPERTY()
+	TMap<TObjectPtr<UClass>, FItemPool> Pools;
+
+	/** Acquires served from a pool versus acquires that had to spawn. */
+	int32 PoolHits = 0;
+	int32 PoolMisses = 0;
+};
+
+template <typename T>
+T* UItemPoolSubsystem::Acquire(TSubclassOf<T> ItemClass, const FTransform& Transform)
+{
+	return Cast<T>(Acquire(TSubclassOf<AItem>(ItemClass), Transform));
+}
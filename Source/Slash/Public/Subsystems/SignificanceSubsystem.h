@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Characters/CharacterTypes.h"
+#include "SignificanceSubsystem.generated.h"
+
+DECLARE_STATS_GROUP(TEXT("SlashSignificance"), STATGROUP_SlashSignificance, STATCAT_Advanced);
+
+/**
+ * Scores every registered ISignificanceInterface actor by distance to the view, visibility and combat involvement,
+ * buckets the scores into tiers and tells each actor when its tier changes.
+ * Tier counts are published as stats ("stat SlashSignificance") and through GetTierCount.
+ */
+UCLASS()
+class SLASH_API USignificanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** <UTickableWorldSubsystem> */
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	/** </UTickableWorldSubsystem> */
+
+	/** Registers an actor implementing ISignificanceInterface. It starts at the highest tier until the next evaluation. */
+	void Register(AActor* Actor);
+	void Unregister(AActor* Actor);
+
+	UFUNCTION(BlueprintPure, Category = "Significance")
+	int32 GetTierCount(ESignificanceTier Tier) const;
+
+	UFUNCTION(BlueprintPure, Category = "Significance")
+	ESignificanceTier GetTier(const AActor* Actor) const;
+
+	/** Seconds between re-scoring passes. */
+	static constexpr float EvaluationInterval = 0.25f;
+
+	/** Distance at which the distance part of the score reaches zero. */
+	static constexpr float MaxSignificanceDistance = 6000.f;
+
+private:
+	void Evaluate();
+	float Score(const AActor* Actor, const FVector& ViewLocation) const;
+	static ESignificanceTier TierForScore(float Score);
+	void PublishTierCounts() const;
+
+	TArray<TWeakObjectPtr<AActor>> Actors;
+	TArray<ESignificanceTier> Tiers;
+
+	int32 TierCounts[static_cast<int32>(ESignificanceTier::EST_MAX)] = {};
+
+	float TimeSinceEvaluation = 0.f;
+};
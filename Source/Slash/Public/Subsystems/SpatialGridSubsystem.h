@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "SpatialGridSubsystem.generated.h"
+
+enum class ESpatialGridCategory : uint8
+{
+	ESGC_None = 0,
+	ESGC_Enemy = 1 << 0,
+	ESGC_EngageableTarget = 1 << 1,
+	ESGC_Pickup = 1 << 2,
+	ESGC_All = 0xFF
+};
+ENUM_CLASS_FLAGS(ESpatialGridCategory);
+
+/**
+ * Uniform spatial hash grid over the XY plane for proximity queries between gameplay actors.
+ * Registered actors are rebinned whenever their root component moves, so queries never touch the actors themselves.
+ * Queries are game thread only.
+ */
+UCLASS()
+class SLASH_API USpatialGridSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** <USubsystem> */
+	virtual void Deinitialize() override;
+	/** </USubsystem> */
+
+	void Register(AActor* Actor, ESpatialGridCategory Category);
+	void Unregister(AActor* Actor);
+	bool IsRegistered(const AActor* Actor) const;
+
+	/** Collects every registered actor of the given categories, wherever it is. */
+	void GetActorsInCategory(ESpatialGridCategory Categories, TArray<AActor*>& OutActors) const;
+
+	/** Collects every registered actor of the given categories within Radius of Origin. */
+	void QueryRadius(const FVector& Origin, float Radius, ESpatialGridCategory Categories, TArray<AActor*>& OutActors, const AActor* Ignore = nullptr) const;
+
+	/** Collects up to Count registered actors of the given categories nearest to Origin, closest first, no farther than MaxRadius. */
+	void QueryNearest(const FVector& Origin, int32 Count, float MaxRadius, ESpatialGridCategory Categories, TArray<AActor*>& OutActors, const AActor* Ignore = nullptr) const;
+
+	FORCEINLINE int32 GetNumRegistered() const { return Actors.Num(); }
+
+	/** Edge length of a grid cell in world units. */
+	static constexpr float CellSize = 500.f;
+
+private:
+	void OnTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+	UFUNCTION()
+	void OnActorEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason);
+
+	void UpdateEntry(int32 Index, const FVector& Location);
+	void RemoveEntry(int32 Index);
+	void AddToCell(const FIntPoint& Cell, int32 Index);
+	void RemoveFromCell(const FIntPoint& Cell, int32 Index);
+
+	static FIntPoint GetCell(const FVector& Location);
+
+	/** Fills the candidate scratch arrays from the cells overlapping the query circle and computes their squared distances. */
+	void GatherCandidates(const FVector& Origin, float Radius, ESpatialGridCategory Categories, const AActor* Ignore) const;
+
+	/** Structure-of-arrays entries, one per registered actor. */
+	TArray<TWeakObjectPtr<AActor>> Actors;
+	TArray<TObjectKey<AActor>> ActorKeys;
+	TArray<TWeakObjectPtr<USceneComponent>> Roots;
+	TArray<FDelegateHandle> TransformHandles;
+	TArray<float> LocationsX;
+	TArray<float> LocationsY;
+	TArray<float> LocationsZ;
+	TArray<FIntPoint> EntryCells;
+	TArray<ESpatialGridCategory> EntryCategories;
+
+	TMap<TObjectKey<AActor>, int32> EntryIndices;
+	TMap<FIntPoint, TArray<int32>> Cells;
+
+	/** Query scratch space, padded to the SIMD width. */
+	mutable TArray<float> CandidateX;
+	mutable TArray<float> CandidateY;
+	mutable TArray<float> CandidateZ;
+	mutable TArray<float> CandidateDistSquared;
+	mutable TArray<int32> CandidateIndices;
+};